@@ -0,0 +1,568 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "AsyncIO.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <io.h>
+#include <malloc.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef AUDIO_CODEC_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace AsyncIO {
+
+    ///////////////////////////////////////////////////
+    // 文件操作
+
+    int OpenFileForRead(const std::string& filePath){
+        if (filePath.size() == 0) return -1;
+#ifdef WIN32
+        return _open(filePath.c_str(), _O_RDONLY | _O_BINARY);
+#else
+        return open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+    }
+
+    int OpenFileForWrite(const std::string& filePath){
+        if (filePath.size() == 0) return -1;
+#ifdef WIN32
+        return _open(filePath.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        return open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+    }
+
+    void CloseFile(int fd){
+        if (fd < 0) return;
+#ifdef WIN32
+        _close(fd);
+#else
+        close(fd);
+#endif
+    }
+
+    bool IsSameFile(const std::string& path1, const std::string& path2){
+        if (path1 == path2) return true;
+
+        struct stat st1, st2;
+        if (stat(path1.c_str(), &st1) != 0 || stat(path2.c_str(), &st2) != 0) return false;
+#ifdef WIN32
+        return false;   // Windows 上 st_ino 总是 0，只比较路径
+#else
+        return st1.st_dev == st2.st_dev && st1.st_ino == st2.st_ino;
+#endif
+    }
+
+    int64_t GetFileSize(int fd){
+#ifdef WIN32
+        struct _stat64 st;
+        if (_fstat64(fd, &st) != 0) return -1;
+#else
+        struct stat st;
+        if (fstat(fd, &st) != 0) return -1;
+#endif
+        return (int64_t)st.st_size;
+    }
+
+    bool SetFileSize(int fd, uint64_t size){
+        if (fd < 0) return false;
+#ifdef WIN32
+        return _chsize_s(fd, (__int64)size) == 0;
+#else
+        return ftruncate(fd, (off_t)size) == 0;
+#endif
+    }
+
+    // 按偏移读写，不移动文件指针
+    static int32_t PositionalIO(bool isWrite, const IORequest& req){
+#ifdef WIN32
+        // Windows CRT 没有 pread/pwrite，用全局锁保证 seek + read/write 的原子性
+        static std::mutex s_lock;
+        std::lock_guard<std::mutex> guard(s_lock);
+        if (_lseeki64(req.fd, (__int64)req.offset, SEEK_SET) < 0) return -errno;
+        int ret = isWrite ? _write(req.fd, req.buffer, req.length) : _read(req.fd, req.buffer, req.length);
+        return ret < 0 ? -errno : ret;
+#else
+        while (true) {
+            ssize_t ret = isWrite ? pwrite(req.fd, req.buffer, req.length, (off_t)req.offset)
+                                  : pread(req.fd, req.buffer, req.length, (off_t)req.offset);
+            if (ret >= 0) return (int32_t)ret;
+            if (errno != EINTR) return -errno;
+        }
+#endif
+    }
+
+    static int64_t PositionalIOAll(bool isWrite, int fd, uint8_t* buffer, size_t length, uint64_t offset){
+        if (fd < 0 || (!buffer && length > 0)) return -1;
+
+        size_t done = 0;
+        while (done < length) {
+            IORequest req;
+            req.fd = fd;
+            req.buffer = buffer + done;
+            req.length = (uint32_t)std::min<size_t>(length - done, 1u << 30);
+            req.offset = offset + done;
+
+            int32_t ret = PositionalIO(isWrite, req);
+            if (ret < 0) return -1;
+            if (ret == 0) break; // 文件末尾
+            done += (size_t)ret;
+        }
+        return (int64_t)done;
+    }
+
+    int64_t ReadFileAt(int fd, void* buffer, size_t length, uint64_t offset){
+        return PositionalIOAll(false, fd, (uint8_t*)buffer, length, offset);
+    }
+
+    int64_t WriteFileAt(int fd, const void* buffer, size_t length, uint64_t offset){
+        return PositionalIOAll(true, fd, (uint8_t*)buffer, length, offset);
+    }
+
+#ifdef __linux__
+    // 内核内复制，返回 -errno；glibc 2.27 之前没有 copy_file_range 的封装，直接使用系统调用
+    static int64_t KernelCopy(bool useSendfile, int srcFd, uint64_t srcOffset, int dstFd, uint64_t dstOffset, size_t length){
+        while (true) {
+            ssize_t ret = -1;
+            if (!useSendfile) {
+#ifdef SYS_copy_file_range
+                loff_t inOff = (loff_t)srcOffset, outOff = (loff_t)dstOffset;
+                ret = syscall(SYS_copy_file_range, srcFd, &inOff, dstFd, &outOff, length, 0u);
+#else
+                errno = ENOSYS;
+#endif
+            } else {
+                // sendfile 写到 dstFd 的当前位置
+                off_t inOff = (off_t)srcOffset;
+                if (lseek(dstFd, (off_t)dstOffset, SEEK_SET) < 0) return -errno;
+                ret = sendfile(dstFd, srcFd, &inOff, length);
+            }
+            if (ret >= 0) return (int64_t)ret;
+            if (errno != EINTR) return -errno;
+        }
+    }
+#endif
+
+    int64_t CopyFileRange(int srcFd, uint64_t srcOffset, int dstFd, uint64_t dstOffset, uint64_t length){
+        if (srcFd < 0 || dstFd < 0) return -1;
+
+        uint64_t done = 0;
+#ifdef __linux__
+        // 0: copy_file_range, 1: sendfile；不支持(跨文件系统、老内核、特殊文件系统等)时依次降级
+        int method = 0;
+        while (done < length && method < 2) {
+            size_t chunk = (size_t)std::min<uint64_t>(length - done, 1u << 30);
+            int64_t ret = KernelCopy(method == 1, srcFd, srcOffset + done, dstFd, dstOffset + done, chunk);
+            if (ret > 0) {
+                done += (uint64_t)ret;
+            } else if (ret == 0) {
+                return (int64_t)done; // 源文件末尾
+            } else if (ret == -ENOSYS || ret == -EXDEV || ret == -EINVAL || ret == -EOPNOTSUPP || ret == -EBADF) {
+                method++;
+            } else {
+                return -1;
+            }
+        }
+#endif
+
+        if (done < length) {
+            const size_t kBufferSize = 4 * 1024 * 1024;
+            std::vector<uint8_t> buffer((size_t)std::min<uint64_t>(length - done, kBufferSize));
+            while (done < length) {
+                size_t chunk = (size_t)std::min<uint64_t>(length - done, buffer.size());
+                int64_t nRead = ReadFileAt(srcFd, &buffer[0], chunk, srcOffset + done);
+                if (nRead < 0) return -1;
+                if (nRead == 0) break;
+                if (WriteFileAt(dstFd, &buffer[0], (size_t)nRead, dstOffset + done) != nRead) return -1;
+                done += (uint64_t)nRead;
+            }
+        }
+        return (int64_t)done;
+    }
+
+    int64_t CopyWholeFile(const std::string& srcPath, const std::string& dstPath){
+        if (IsSameFile(srcPath, dstPath)) {
+            printf("copy to the source file itself, %s\n", dstPath.c_str());
+            return -1;
+        }
+
+        int srcFd = OpenFileForRead(srcPath);
+        if (srcFd < 0) return -1;
+        int64_t size = GetFileSize(srcFd);
+        int dstFd = size >= 0 ? OpenFileForWrite(dstPath) : -1;
+        int64_t nCopy = -1;
+        if (dstFd >= 0) {
+            nCopy = CopyFileRange(srcFd, 0, dstFd, 0, (uint64_t)size);
+            CloseFile(dstFd);
+        }
+        CloseFile(srcFd);
+        return nCopy == size ? size : -1;
+    }
+
+    ///////////////////////////////////////////////////
+    // ThreadPoolIOEngine: 线程池实现，每个工作线程执行阻塞的 pread/pwrite
+    class ThreadPoolIOEngine : public IOEngine {
+    public:
+        ThreadPoolIOEngine(uint32_t queueDepth, uint32_t threadCnt) : m_queueDepth(queueDepth) {
+            for (uint32_t i = 0; i < threadCnt; i++) {
+                m_threads.push_back(std::thread(&ThreadPoolIOEngine::WorkerLoop, this));
+            }
+        }
+
+        ~ThreadPoolIOEngine() override {
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                m_stop = true;
+            }
+            m_requestCond.notify_all();
+            for (size_t i = 0; i < m_threads.size(); i++) {
+                m_threads[i].join();
+            }
+        }
+
+        const char* GetName() const override { return "threadpool"; }
+
+        bool RegisterBuffers(uint8_t* const* /*buffers*/, uint32_t /*count*/, uint32_t /*bufferSize*/) override {
+            // 线程池不需要映射用户内存，注册总是成功
+            return true;
+        }
+
+        bool SubmitRead(const IORequest& req) override { return Queue(req, false); }
+        bool SubmitWrite(const IORequest& req) override { return Queue(req, true); }
+
+        size_t WaitCompletions(std::vector<IOCompletion>& completions, uint32_t minCount) override {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_pending.empty()) {
+                m_requests.insert(m_requests.end(), m_pending.begin(), m_pending.end());
+                m_pending.clear();
+                m_requestCond.notify_all();
+            }
+
+            minCount = std::min(minCount, m_inFlight);
+            m_completionCond.wait(lock, [&]{ return m_completed.size() >= minCount; });
+
+            size_t cnt = m_completed.size();
+            completions.insert(completions.end(), m_completed.begin(), m_completed.end());
+            m_completed.clear();
+            m_inFlight -= (uint32_t)cnt;
+            return cnt;
+        }
+
+        uint32_t GetInFlight() const override { return m_inFlight; }
+        uint32_t GetQueueDepth() const override { return m_queueDepth; }
+
+    private:
+        struct Task {
+            IORequest req;
+            bool isWrite;
+        };
+
+        bool Queue(const IORequest& req, bool isWrite){
+            if (m_inFlight >= m_queueDepth) return false;
+            Task task;
+            task.req = req;
+            task.isWrite = isWrite;
+            // m_pending 和 m_inFlight 只在调用线程中访问，WaitCompletions 时才把请求交给工作线程
+            m_pending.push_back(task);
+            m_inFlight++;
+            return true;
+        }
+
+        void WorkerLoop(){
+            while (true) {
+                Task task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_requestCond.wait(lock, [&]{ return m_stop || !m_requests.empty(); });
+                    if (m_requests.empty()) return; // m_stop
+                    task = m_requests.front();
+                    m_requests.pop_front();
+                }
+
+                IOCompletion completion;
+                completion.userData = task.req.userData;
+                completion.result = PositionalIO(task.isWrite, task.req);
+
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_completed.push_back(completion);
+                }
+                m_completionCond.notify_one();
+            }
+        }
+
+        uint32_t m_queueDepth = 0;
+        uint32_t m_inFlight = 0;
+        bool m_stop = false;
+        std::vector<Task> m_pending;
+        std::deque<Task> m_requests;
+        std::vector<IOCompletion> m_completed;
+        std::mutex m_mutex;
+        std::condition_variable m_requestCond;
+        std::condition_variable m_completionCond;
+        std::vector<std::thread> m_threads;
+    };
+
+#ifdef AUDIO_CODEC_HAS_IO_URING
+    ///////////////////////////////////////////////////
+    // IOUringIOEngine: 直接使用 io_uring 系统调用，不依赖 liburing
+    class IOUringIOEngine : public IOEngine {
+    public:
+        IOUringIOEngine() {}
+
+        ~IOUringIOEngine() override {
+            if (m_sqes) munmap(m_sqes, m_sqesSize);
+            if (m_cqRing && m_cqRing != m_sqRing) munmap(m_cqRing, m_cqRingSize);
+            if (m_sqRing) munmap(m_sqRing, m_sqRingSize);
+            if (m_ringFd >= 0) close(m_ringFd);
+        }
+
+        bool Init(uint32_t queueDepth){
+            struct io_uring_params params;
+            memset(&params, 0, sizeof(params));
+            m_ringFd = (int)syscall(__NR_io_uring_setup, queueDepth, &params);
+            if (m_ringFd < 0) return false;
+
+            m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+            bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMmap) {
+                m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+            }
+
+            m_sqRing = (uint8_t*)mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+            if (m_sqRing == MAP_FAILED) { m_sqRing = nullptr; return false; }
+
+            if (singleMmap) {
+                m_cqRing = m_sqRing;
+            } else {
+                m_cqRing = (uint8_t*)mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+                if (m_cqRing == MAP_FAILED) { m_cqRing = nullptr; return false; }
+            }
+
+            m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+            m_sqes = (struct io_uring_sqe*)mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+            if (m_sqes == MAP_FAILED) { m_sqes = nullptr; return false; }
+
+            m_sqHead  = (uint32_t*)(m_sqRing + params.sq_off.head);
+            m_sqTail  = (uint32_t*)(m_sqRing + params.sq_off.tail);
+            m_sqMask  = *(uint32_t*)(m_sqRing + params.sq_off.ring_mask);
+            m_sqArray = (uint32_t*)(m_sqRing + params.sq_off.array);
+            m_cqHead  = (uint32_t*)(m_cqRing + params.cq_off.head);
+            m_cqTail  = (uint32_t*)(m_cqRing + params.cq_off.tail);
+            m_cqMask  = *(uint32_t*)(m_cqRing + params.cq_off.ring_mask);
+            m_cqes    = (struct io_uring_cqe*)(m_cqRing + params.cq_off.cqes);
+
+            // 在途请求数不超过 sq 大小，cq (默认为 sq 的 2 倍) 不会溢出
+            m_queueDepth = params.sq_entries;
+            return true;
+        }
+
+        const char* GetName() const override { return "io_uring"; }
+
+        bool RegisterBuffers(uint8_t* const* buffers, uint32_t count, uint32_t bufferSize) override {
+            std::vector<struct iovec> iovecs(count);
+            for (uint32_t i = 0; i < count; i++) {
+                iovecs[i].iov_base = buffers[i];
+                iovecs[i].iov_len = bufferSize;
+            }
+            int ret = (int)syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_BUFFERS, &iovecs[0], count);
+            return ret == 0; // 常见失败原因：RLIMIT_MEMLOCK 不足
+        }
+
+        bool SubmitRead(const IORequest& req) override {
+            return Queue(req, req.bufIndex >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ);
+        }
+
+        bool SubmitWrite(const IORequest& req) override {
+            return Queue(req, req.bufIndex >= 0 ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE);
+        }
+
+        size_t WaitCompletions(std::vector<IOCompletion>& completions, uint32_t minCount) override {
+            minCount = std::min(minCount, m_inFlight);
+
+            // 提交排队的请求；等待完成时 io_uring_enter 会阻塞到至少 minCount 个请求完成
+            while (m_pending > 0 || minCount > 0) {
+                uint32_t flags = minCount > 0 ? IORING_ENTER_GETEVENTS : 0;
+                int ret = (int)syscall(__NR_io_uring_enter, m_ringFd, m_pending, minCount, flags, nullptr, 0);
+                if (ret < 0) {
+                    if (errno == EINTR) continue;
+                    break;
+                }
+                m_pending -= std::min((uint32_t)ret, m_pending);
+                if (m_pending == 0) break;
+            }
+
+            size_t cnt = 0;
+            uint32_t head = *m_cqHead;
+            uint32_t tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+            while (head != tail) {
+                const struct io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+                IOCompletion completion;
+                completion.userData = cqe.user_data;
+                completion.result = cqe.res;
+                completions.push_back(completion);
+                head++;
+                cnt++;
+            }
+            __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+            m_inFlight -= (uint32_t)cnt;
+            return cnt;
+        }
+
+        uint32_t GetInFlight() const override { return m_inFlight; }
+        uint32_t GetQueueDepth() const override { return m_queueDepth; }
+
+    private:
+        bool Queue(const IORequest& req, uint8_t opcode){
+            if (m_inFlight >= m_queueDepth) return false;
+
+            uint32_t tail = *m_sqTail;
+            uint32_t index = tail & m_sqMask;
+            struct io_uring_sqe* sqe = &m_sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = opcode;
+            sqe->fd = req.fd;
+            sqe->addr = (uint64_t)(uintptr_t)req.buffer;
+            sqe->len = req.length;
+            sqe->off = req.offset;
+            sqe->user_data = req.userData;
+            if (req.bufIndex >= 0) {
+                sqe->buf_index = (uint16_t)req.bufIndex;
+            }
+            m_sqArray[index] = index;
+            __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+            m_pending++;
+            m_inFlight++;
+            return true;
+        }
+
+        int m_ringFd = -1;
+        uint8_t* m_sqRing = nullptr;
+        uint8_t* m_cqRing = nullptr;
+        size_t m_sqRingSize = 0;
+        size_t m_cqRingSize = 0;
+        struct io_uring_sqe* m_sqes = nullptr;
+        size_t m_sqesSize = 0;
+
+        uint32_t* m_sqHead = nullptr;
+        uint32_t* m_sqTail = nullptr;
+        uint32_t* m_sqArray = nullptr;
+        uint32_t m_sqMask = 0;
+        uint32_t* m_cqHead = nullptr;
+        uint32_t* m_cqTail = nullptr;
+        uint32_t m_cqMask = 0;
+        struct io_uring_cqe* m_cqes = nullptr;
+
+        uint32_t m_queueDepth = 0;
+        uint32_t m_pending = 0;  // 已放入 sq 但未提交给内核
+        uint32_t m_inFlight = 0; // 已放入 sq 但未收割
+    };
+#endif
+
+    std::unique_ptr<IOEngine> CreateIOEngine(uint32_t queueDepth, IOBackend backend){
+        if (queueDepth == 0) return std::unique_ptr<IOEngine>();
+
+#ifdef AUDIO_CODEC_HAS_IO_URING
+        if (backend == IOBackendAuto || backend == IOBackendIOUring) {
+            std::unique_ptr<IOUringIOEngine> engine(new IOUringIOEngine());
+            if (engine->Init(queueDepth)) {
+                return std::unique_ptr<IOEngine>(engine.release());
+            }
+            // 内核不支持或被 seccomp 禁用
+        }
+#endif
+        if (backend == IOBackendIOUring) {
+            return std::unique_ptr<IOEngine>();
+        }
+
+        // 线程数不需要和队列深度一样多，能覆盖设备的并发即可
+        uint32_t threadCnt = std::max(1u, std::min(queueDepth, 16u));
+        return std::unique_ptr<IOEngine>(new ThreadPoolIOEngine(queueDepth, threadCnt));
+    }
+
+    ///////////////////////////////////////////////////
+    // IOBufferPool
+    static const size_t kPageSize = 4096;
+
+    IOBufferPool::IOBufferPool(uint32_t count, uint32_t bufferSize) {
+        // 缓冲区大小按页对齐，便于注册和 O_DIRECT
+        m_bufferSize = (uint32_t)((bufferSize + kPageSize - 1) / kPageSize * kPageSize);
+        size_t total = (size_t)count * m_bufferSize;
+        if (total == 0) return;
+
+#ifdef WIN32
+        m_base = (uint8_t*)_aligned_malloc(total, kPageSize);
+#else
+        void* p = nullptr;
+        if (posix_memalign(&p, kPageSize, total) == 0) {
+            m_base = (uint8_t*)p;
+        }
+#endif
+        if (!m_base) return;
+
+        m_count = count;
+        m_free.reserve(count);
+        for (int i = (int)count - 1; i >= 0; i--) {
+            m_free.push_back(i);
+        }
+    }
+
+    IOBufferPool::~IOBufferPool() {
+#ifdef WIN32
+        _aligned_free(m_base);
+#else
+        free(m_base);
+#endif
+    }
+
+    bool IOBufferPool::RegisterTo(IOEngine& engine){
+        if (m_count == 0) return false;
+
+        std::vector<uint8_t*> buffers(m_count);
+        for (uint32_t i = 0; i < m_count; i++) {
+            buffers[i] = GetBuffer((int)i);
+        }
+        m_registered = engine.RegisterBuffers(&buffers[0], m_count, m_bufferSize);
+        return m_registered;
+    }
+
+    int IOBufferPool::Acquire(){
+        if (m_free.empty()) return -1;
+        int index = m_free.back();
+        m_free.pop_back();
+        return index;
+    }
+
+    void IOBufferPool::Release(int index){
+        if (index < 0 || index >= (int)m_count) return;
+        m_free.push_back(index);
+    }
+}
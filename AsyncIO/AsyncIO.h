@@ -0,0 +1,146 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace AsyncIO {
+
+    // IOBackend: 异步 IO 的实现方式
+    enum IOBackend {
+        IOBackendAuto       = 0, // 优先使用 io_uring，不可用时退回线程池
+        IOBackendIOUring    = 1, // Linux io_uring，不可用时创建失败
+        IOBackendThreadPool = 2, // 线程池 + pread/pwrite，所有平台可用
+    };
+
+    // IORequest: 一次异步读写请求，读写位置由 offset 指定，不依赖文件指针
+    struct IORequest {
+        int      fd       = -1;      // 文件描述符
+        uint8_t* buffer   = nullptr; // 数据缓冲区，请求完成前必须保持有效
+        uint32_t length   = 0;       // 要读写的字节数
+        uint64_t offset   = 0;       // 文件中的偏移
+        int      bufIndex = -1;      // buffer 所在的已注册缓冲区下标，-1 表示未注册
+        uint64_t userData = 0;       // 调用者自定义数据，原样返回到 IOCompletion 中
+    };
+
+    // IOCompletion: 请求完成的结果
+    struct IOCompletion {
+        uint64_t userData = 0; // 对应 IORequest::userData
+        int32_t  result   = 0; // >= 0 为实际读写的字节数，< 0 为 -errno
+    };
+
+    // IOEngine: 异步 IO 引擎，可以同时在多个文件上保持多个读写请求
+    // 使用方式：SubmitRead/SubmitWrite 排队请求，WaitCompletions 提交并收割完成的请求
+    // 同一个 IOEngine 只能在一个线程中使用
+    class IOEngine {
+    public:
+        virtual ~IOEngine() {}
+
+        // GetName: 引擎名称，"io_uring" 或 "threadpool"
+        virtual const char* GetName() const = 0;
+
+        // RegisterBuffers: 注册固定缓冲区，避免每次请求都重新映射用户内存
+        // 注册成功后，位于这些缓冲区中的请求需要设置 IORequest::bufIndex
+        // * buffers    : 缓冲区地址数组
+        // * count      : 缓冲区个数
+        // * bufferSize : 每个缓冲区的大小
+        // * 返回值      : 注册是否成功，失败时请求仍可使用 bufIndex = -1 的方式提交
+        virtual bool RegisterBuffers(uint8_t* const* buffers, uint32_t count, uint32_t bufferSize) = 0;
+
+        // SubmitRead/SubmitWrite: 将读写请求加入队列，在下一次 WaitCompletions 时提交
+        // * 返回值 : 队列已满(在途请求数达到 GetQueueDepth)时返回 false
+        virtual bool SubmitRead(const IORequest& req) = 0;
+        virtual bool SubmitWrite(const IORequest& req) = 0;
+
+        // WaitCompletions: 提交所有排队的请求，并等待至少 minCount 个请求完成
+        // minCount 为 0 时不等待，只收割已完成的请求
+        // * completions : 完成的请求会追加到 completions 中
+        // * 返回值       : 本次收割到的完成请求个数
+        virtual size_t WaitCompletions(std::vector<IOCompletion>& completions, uint32_t minCount) = 0;
+
+        // GetInFlight: 已排队或已提交、但尚未收割的请求个数
+        virtual uint32_t GetInFlight() const = 0;
+
+        // GetQueueDepth: 同时在途的最大请求数
+        virtual uint32_t GetQueueDepth() const = 0;
+    };
+
+    // CreateIOEngine: 创建异步 IO 引擎
+    // * queueDepth : 同时在途的最大请求数
+    // * backend    : 实现方式，详见 IOBackend
+    // * 返回值      : 创建失败返回空指针
+    std::unique_ptr<IOEngine> CreateIOEngine(uint32_t queueDepth, IOBackend backend = IOBackendAuto);
+
+    // IOBufferPool: 一组大小相同、按页对齐的缓冲区，可注册到 IOEngine 中作为固定缓冲区
+    class IOBufferPool {
+    public:
+        IOBufferPool(uint32_t count, uint32_t bufferSize);
+        ~IOBufferPool();
+
+        // RegisterTo: 注册到 engine，返回是否注册成功
+        bool RegisterTo(IOEngine& engine);
+
+        // Acquire/Release: 获取/归还一个空闲缓冲区的下标，无空闲时 Acquire 返回 -1
+        int Acquire();
+        void Release(int index);
+
+        uint8_t* GetBuffer(int index) { return m_base + (size_t)index * m_bufferSize; }
+        uint32_t GetBufferSize() const { return m_bufferSize; }
+        uint32_t GetCount() const { return m_count; }
+
+        // IsRegistered: 是否已注册为固定缓冲区，未注册时请求应使用 bufIndex = -1
+        bool IsRegistered() const { return m_registered; }
+
+    private:
+        IOBufferPool(const IOBufferPool&);
+        IOBufferPool& operator=(const IOBufferPool&);
+
+        uint8_t* m_base = nullptr;
+        uint32_t m_count = 0;
+        uint32_t m_bufferSize = 0;
+        bool m_registered = false;
+        std::vector<int> m_free;
+    };
+
+    // OpenFileForRead/OpenFileForWrite/CloseFile: 以文件描述符方式打开、关闭文件，供 IOEngine 使用
+    // 打开失败返回 -1；OpenFileForWrite 会创建或清空文件
+    int OpenFileForRead(const std::string& filePath);
+    int OpenFileForWrite(const std::string& filePath);
+    void CloseFile(int fd);
+
+    // IsSameFile: 两个路径是否指向同一个文件(路径相同，或者设备号和 inode 相同，如硬链接、不同的相对路径)
+    // 输出文件以截断方式打开前用于检查，与源文件相同时会在读取之前把源数据清空；任一文件不存在时返回 false
+    bool IsSameFile(const std::string& path1, const std::string& path2);
+
+    // GetFileSize: 获取文件描述符对应文件的大小，失败返回 -1
+    int64_t GetFileSize(int fd);
+
+    // SetFileSize: 设置文件大小，用于预先分配输出文件，之后各个线程可以按偏移写入
+    bool SetFileSize(int fd, uint64_t size);
+
+    // ReadFileAt/WriteFileAt: 同步地按偏移读写，不移动文件指针，多个线程可以同时读写同一个文件的不同位置
+    // 读写不足时继续，直到完成、出错或到达文件末尾
+    // * 返回值 : 实际读写的字节数，出错返回 -1
+    int64_t ReadFileAt(int fd, void* buffer, size_t length, uint64_t offset);
+    int64_t WriteFileAt(int fd, const void* buffer, size_t length, uint64_t offset);
+
+    // CopyFileRange: 在两个文件之间按偏移复制数据
+    // Linux 上优先使用 copy_file_range(同一文件系统上可能只复制元数据)，不支持时使用 sendfile，数据都不经过用户空间；
+    // 其它平台或两者都不可用时，使用大块缓冲区 pread/pwrite 复制
+    // 不移动 srcFd 的文件指针，dstFd 的文件指针位置不确定
+    // * 返回值 : 实际复制的字节数，源文件提前结束时小于 length，出错返回 -1
+    int64_t CopyFileRange(int srcFd, uint64_t srcOffset, int dstFd, uint64_t dstOffset, uint64_t length);
+
+    // CopyWholeFile: 用 CopyFileRange 复制整个文件，目标文件被创建或清空，与源文件相同时失败
+    // * 返回值 : 复制的字节数，失败返回 -1
+    int64_t CopyWholeFile(const std::string& srcPath, const std::string& dstPath);
+};
+
+#endif //ASYNC_IO_H
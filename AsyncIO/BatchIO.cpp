@@ -0,0 +1,229 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "BatchIO.h"
+
+#include <algorithm>
+
+namespace AsyncIO {
+
+    // userData 的最高位区分数据块请求和 prefix 写请求
+    static const uint64_t kPrefixFlag = 1ULL << 63;
+
+    size_t BatchCopy(IOEngine& engine, std::vector<FileCopyTask>& tasks, uint32_t chunkSize){
+        if (tasks.empty()) return 0;
+        if (chunkSize == 0) chunkSize = 64 * 1024;
+
+        struct TaskState {
+            uint64_t issued = 0;       // 已经分配给数据块的字节数
+            uint32_t outstanding = 0;  // 在途的数据块和 prefix 写请求个数
+            bool prefixIssued = false;
+            bool failed = false;
+        };
+
+        // 数据块在读完之后原地写出，每个数据块占用一个缓冲区
+        struct Slot {
+            size_t   task = 0;
+            uint64_t srcOffset = 0;
+            uint64_t dstOffset = 0;
+            uint32_t length = 0;
+            uint32_t done = 0;
+            bool     writing = false;
+        };
+
+        uint32_t depth = engine.GetQueueDepth();
+        IOBufferPool pool(depth, chunkSize);
+        if (pool.GetCount() == 0) return 0;
+        bool registered = pool.RegisterTo(engine);
+        chunkSize = pool.GetBufferSize();
+
+        std::vector<TaskState> states(tasks.size());
+        std::vector<Slot> slots(pool.GetCount());
+        for (size_t i = 0; i < tasks.size(); i++) {
+            tasks[i].success = false;
+            if (tasks[i].srcFd < 0 || tasks[i].dstFd < 0) states[i].failed = true;
+        }
+
+        // 提交数据块 slot 中剩余部分的读或写
+        auto submitSlot = [&](int index) -> bool {
+            Slot& slot = slots[index];
+            IORequest req;
+            req.fd       = slot.writing ? tasks[slot.task].dstFd : tasks[slot.task].srcFd;
+            req.buffer   = pool.GetBuffer(index) + slot.done;
+            req.length   = slot.length - slot.done;
+            req.offset   = (slot.writing ? slot.dstOffset : slot.srcOffset) + slot.done;
+            req.bufIndex = registered ? index : -1;
+            req.userData = (uint64_t)index;
+            return slot.writing ? engine.SubmitWrite(req) : engine.SubmitRead(req);
+        };
+
+        size_t cursor = 0;      // 轮流给各个任务分配数据块
+        size_t unfinished = tasks.size();
+        std::vector<IOCompletion> completions;
+        while (true) {
+            // 1. 在队列深度允许的范围内提交新的请求，连续一轮没有可提交的任务时停止
+            size_t idle = 0;
+            while (idle < tasks.size() && unfinished > 0 && engine.GetInFlight() < depth) {
+                size_t t = cursor;
+                cursor = (cursor + 1) % tasks.size();
+                FileCopyTask& task = tasks[t];
+                TaskState& state = states[t];
+                idle++;
+                if (state.failed) continue;
+
+                if (!state.prefixIssued && !task.prefix.empty()) {
+                    IORequest req;
+                    req.fd       = task.dstFd;
+                    req.buffer   = &task.prefix[0];
+                    req.length   = (uint32_t)task.prefix.size();
+                    req.offset   = task.prefixOffset;
+                    req.userData = kPrefixFlag | t;
+                    if (!engine.SubmitWrite(req)) break;
+                    state.prefixIssued = true;
+                    state.outstanding++;
+                    idle = 0;
+                    continue;
+                }
+
+                if (state.issued >= task.length) continue;
+                int index = pool.Acquire();
+                if (index < 0) break;
+
+                Slot& slot = slots[index];
+                slot.task      = t;
+                slot.srcOffset = task.srcOffset + state.issued;
+                slot.dstOffset = task.dstOffset + state.issued;
+                slot.length    = (uint32_t)std::min<uint64_t>(chunkSize, task.length - state.issued);
+                slot.done      = 0;
+                slot.writing   = false;
+                if (!submitSlot(index)) {
+                    pool.Release(index);
+                    break;
+                }
+                state.issued += slot.length;
+                state.outstanding++;
+                idle = 0;
+            }
+
+            if (engine.GetInFlight() == 0) break; // 没有在途请求，也无法再提交
+
+            // 2. 收割完成的请求
+            completions.clear();
+            engine.WaitCompletions(completions, 1);
+            for (size_t i = 0; i < completions.size(); i++) {
+                const IOCompletion& completion = completions[i];
+                size_t t;
+                bool finished = false;
+
+                if (completion.userData & kPrefixFlag) {
+                    t = (size_t)(completion.userData & ~kPrefixFlag);
+                    // prefix 很小，短写视为失败
+                    if (completion.result != (int32_t)tasks[t].prefix.size()) states[t].failed = true;
+                    finished = true;
+                } else {
+                    int index = (int)completion.userData;
+                    Slot& slot = slots[index];
+                    t = slot.task;
+
+                    if (completion.result <= 0) {
+                        // 出错，或者文件比预期的短
+                        states[t].failed = true;
+                        finished = true;
+                    } else {
+                        slot.done += (uint32_t)completion.result;
+                        if (slot.done == slot.length) {
+                            if (slot.writing) {
+                                finished = true;
+                            } else {
+                                slot.writing = true; // 读完了，原地写出
+                                slot.done = 0;
+                            }
+                        }
+                        // 短读短写或者读转写，重新提交剩余部分，这里一定有空位：当前请求刚刚完成
+                        if (!finished && !submitSlot(index)) {
+                            states[t].failed = true;
+                            finished = true;
+                        }
+                    }
+
+                    if (finished) pool.Release(index);
+                }
+
+                if (finished) {
+                    TaskState& state = states[t];
+                    state.outstanding--;
+                    bool done = state.issued >= tasks[t].length && (state.prefixIssued || tasks[t].prefix.empty());
+                    if (state.outstanding == 0 && (state.failed || done)) {
+                        tasks[t].success = !state.failed;
+                        state.failed = true; // 不再提交该任务的请求
+                        unfinished--;
+                    }
+                }
+            }
+        }
+
+        // 长度为 0 且没有 prefix 的任务不会产生请求
+        size_t successCnt = 0;
+        for (size_t i = 0; i < tasks.size(); i++) {
+            if (!states[i].failed && tasks[i].length == 0 && tasks[i].prefix.empty()) {
+                tasks[i].success = true;
+            }
+            if (tasks[i].success) successCnt++;
+        }
+        return successCnt;
+    }
+
+    size_t BatchReadHead(IOEngine& engine, const std::vector<int>& fds, uint32_t headSize, std::vector<std::vector<uint8_t>>& heads){
+        heads.assign(fds.size(), std::vector<uint8_t>());
+        if (headSize == 0) return 0;
+
+        std::vector<uint32_t> done(fds.size(), 0);
+        size_t next = 0;
+        size_t successCnt = 0;
+        std::vector<IOCompletion> completions;
+
+        auto submit = [&](size_t i) -> bool {
+            IORequest req;
+            req.fd       = fds[i];
+            req.buffer   = &heads[i][0] + done[i];
+            req.length   = headSize - done[i];
+            req.offset   = done[i];
+            req.userData = i;
+            return engine.SubmitRead(req);
+        };
+
+        while (true) {
+            while (next < fds.size() && engine.GetInFlight() < engine.GetQueueDepth()) {
+                if (fds[next] < 0) { next++; continue; }
+                heads[next].resize(headSize);
+                if (!submit(next)) break;
+                next++;
+            }
+
+            if (engine.GetInFlight() == 0) break;
+
+            completions.clear();
+            engine.WaitCompletions(completions, 1);
+            for (size_t k = 0; k < completions.size(); k++) {
+                size_t i = (size_t)completions[k].userData;
+                int32_t result = completions[k].result;
+                if (result < 0) {
+                    heads[i].clear();
+                    continue;
+                }
+
+                done[i] += (uint32_t)result;
+                if (result == 0 || done[i] == headSize) {
+                    // 读到文件末尾或读满
+                    heads[i].resize(done[i]);
+                    successCnt++;
+                } else if (!submit(i)) {
+                    heads[i].clear();
+                }
+            }
+        }
+
+        return successCnt;
+    }
+}
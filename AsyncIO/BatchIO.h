@@ -0,0 +1,43 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef BATCH_IO_H
+#define BATCH_IO_H
+
+#include "AsyncIO.h"
+
+namespace AsyncIO {
+
+    // FileCopyTask: 将 src 文件 [srcOffset, srcOffset+length) 的数据复制到 dst 文件的 dstOffset 处
+    // 可选地在 dst 文件的 prefixOffset 处写入 prefix (如 wave header)
+    struct FileCopyTask {
+        int      srcFd     = -1;
+        uint64_t srcOffset = 0;
+        uint64_t length    = 0;
+        int      dstFd     = -1;
+        uint64_t dstOffset = 0;
+        std::vector<uint8_t> prefix;
+        uint64_t prefixOffset = 0;
+        bool     success   = false; // [输出] 复制是否成功
+    };
+
+    // BatchCopy: 同时在多个文件上复制数据，IO 请求以 chunkSize 为单位交给 engine，保持队列深度的请求在途
+    // 各个任务的数据块轮流提交，许多小文件可以同时在途
+    // * engine    : 异步 IO 引擎
+    // * tasks     : 复制任务，完成后 success 表明是否成功
+    // * chunkSize : 每个读写请求的大小
+    // * 返回值     : 成功的任务个数
+    size_t BatchCopy(IOEngine& engine, std::vector<FileCopyTask>& tasks, uint32_t chunkSize = 64 * 1024);
+
+    // BatchReadHead: 同时读取多个文件开头的 headSize 字节
+    // 文件长度不足 headSize 时，heads[i] 为整个文件的内容
+    // * engine   : 异步 IO 引擎
+    // * fds      : 文件描述符，小于 0 的会被跳过
+    // * headSize : 要读取的字节数
+    // * heads    : 读取到的数据，与 fds 一一对应，读取失败的为空
+    // * 返回值    : 读取成功的文件个数
+    size_t BatchReadHead(IOEngine& engine, const std::vector<int>& fds, uint32_t headSize, std::vector<std::vector<uint8_t>>& heads);
+};
+
+#endif //BATCH_IO_H
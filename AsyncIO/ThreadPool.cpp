@@ -0,0 +1,70 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "ThreadPool.h"
+
+namespace AsyncIO {
+
+    ThreadPool::ThreadPool(uint32_t threadCnt) {
+        if (threadCnt == 0) threadCnt = GetDefaultThreadCount();
+        for (uint32_t i = 0; i < threadCnt; i++) {
+            m_threads.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        Wait();
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_stop = true;
+        }
+        m_taskCond.notify_all();
+        for (size_t i = 0; i < m_threads.size(); i++) {
+            m_threads[i].join();
+        }
+    }
+
+    uint32_t ThreadPool::GetDefaultThreadCount() {
+        uint32_t cnt = std::thread::hardware_concurrency();
+        return cnt > 0 ? cnt : 1;
+    }
+
+    void ThreadPool::Submit(const std::function<void()>& task) {
+        if (!task) return;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_tasks.push_back(task);
+        }
+        m_taskCond.notify_one();
+    }
+
+    void ThreadPool::Wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleCond.wait(lock, [&]{ return m_tasks.empty() && m_running == 0; });
+    }
+
+    void ThreadPool::WorkerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_taskCond.wait(lock, [&]{ return m_stop || !m_tasks.empty(); });
+                if (m_tasks.empty()) return; // m_stop
+                task.swap(m_tasks.front());
+                m_tasks.pop_front();
+                m_running++;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                m_running--;
+                if (m_running == 0 && m_tasks.empty()) {
+                    m_idleCond.notify_all();
+                }
+            }
+        }
+    }
+}
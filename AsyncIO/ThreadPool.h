@@ -0,0 +1,63 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AsyncIO {
+
+    /*example code
+
+        ThreadPool pool;
+        for(size_t i = 0; i < ranges.size(); i++){
+            pool.Submit([&ranges, i]{ Process(ranges[i]); });
+        }
+        pool.Wait();
+    */
+
+    // ThreadPool: 固定线程数的任务线程池，用于 CPU 密集的并行处理
+    class ThreadPool {
+    public:
+        // * threadCnt : 线程数，为 0 时使用 CPU 核数
+        explicit ThreadPool(uint32_t threadCnt = 0);
+
+        // 等待所有任务完成后退出
+        ~ThreadPool();
+
+        // Submit: 提交一个任务，任务按提交顺序开始执行
+        void Submit(const std::function<void()>& task);
+
+        // Wait: 等待所有已提交的任务完成
+        void Wait();
+
+        uint32_t GetThreadCount() const { return (uint32_t)m_threads.size(); }
+
+        // GetDefaultThreadCount: CPU 核数，无法获取时返回 1
+        static uint32_t GetDefaultThreadCount();
+
+    private:
+        ThreadPool(const ThreadPool&);
+        ThreadPool& operator=(const ThreadPool&);
+
+        void WorkerLoop();
+
+        bool m_stop = false;
+        uint32_t m_running = 0; // 正在执行的任务数
+        std::deque<std::function<void()> > m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_taskCond;
+        std::condition_variable m_idleCond;
+        std::vector<std::thread> m_threads;
+    };
+};
+
+#endif //THREAD_POOL_H
@@ -0,0 +1,387 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "AudioCompare.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include "AsyncIO/ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace AudioReader {
+
+    // 分段信噪比每段的上下限
+    static const double kSegSnrMin = -10.0;
+    static const double kSegSnrMax = 35.0;
+
+    // 粗搜延迟时降采样的目标采样率
+    static const uint32_t kCoarseRate = 8000;
+
+    // SIMD 路径用 float 累加，每累加这么多个采样合并到 double 一次，避免长数据的精度损失
+    static const size_t kAccumulateChunk = 4096;
+
+    // BlockStats: 一段采样的误差统计
+    struct BlockStats {
+        double signal = 0;   // 参考信号能量
+        double error  = 0;   // 误差能量
+        float  maxAbs = 0;   // 最大绝对误差
+        size_t equal  = 0;   // 按位相等的采样数
+    };
+
+    // CompareBlock: 统计 count 个采样的误差，累加到 stats
+    static void CompareBlock(const float* ref, const float* test, size_t count, BlockStats& stats) {
+        size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        while (i + 4 <= count) {
+            size_t end = i + std::min(kAccumulateChunk, (count - i) & ~(size_t)3);
+            __m128 sig = _mm_setzero_ps();
+            __m128 err = _mm_setzero_ps();
+            __m128 maxAbs = _mm_setzero_ps();
+            __m128i equal = _mm_setzero_si128();
+            for (; i < end; i += 4) {
+                __m128 r = _mm_loadu_ps(ref + i);
+                __m128 t = _mm_loadu_ps(test + i);
+                __m128 e = _mm_sub_ps(t, r);
+                sig = _mm_add_ps(sig, _mm_mul_ps(r, r));
+                err = _mm_add_ps(err, _mm_mul_ps(e, e));
+                maxAbs = _mm_max_ps(maxAbs, _mm_and_ps(e, absMask));
+                // 按位比较，相等的通道为 -1
+                equal = _mm_sub_epi32(equal, _mm_cmpeq_epi32(_mm_castps_si128(r), _mm_castps_si128(t)));
+            }
+            float sigLanes[4], errLanes[4], maxLanes[4];
+            uint32_t equalLanes[4];
+            _mm_storeu_ps(sigLanes, sig);
+            _mm_storeu_ps(errLanes, err);
+            _mm_storeu_ps(maxLanes, maxAbs);
+            _mm_storeu_si128((__m128i*)equalLanes, equal);
+            for (int k = 0; k < 4; k++) {
+                stats.signal += sigLanes[k];
+                stats.error += errLanes[k];
+                stats.maxAbs = std::max(stats.maxAbs, maxLanes[k]);
+                stats.equal += equalLanes[k];
+            }
+        }
+#elif defined(__ARM_NEON)
+        while (i + 4 <= count) {
+            size_t end = i + std::min(kAccumulateChunk, (count - i) & ~(size_t)3);
+            float32x4_t sig = vdupq_n_f32(0);
+            float32x4_t err = vdupq_n_f32(0);
+            float32x4_t maxAbs = vdupq_n_f32(0);
+            uint32x4_t equal = vdupq_n_u32(0);
+            for (; i < end; i += 4) {
+                float32x4_t r = vld1q_f32(ref + i);
+                float32x4_t t = vld1q_f32(test + i);
+                float32x4_t e = vsubq_f32(t, r);
+                sig = vmlaq_f32(sig, r, r);
+                err = vmlaq_f32(err, e, e);
+                maxAbs = vmaxq_f32(maxAbs, vabsq_f32(e));
+                equal = vsubq_u32(equal, vceqq_u32(vreinterpretq_u32_f32(r), vreinterpretq_u32_f32(t)));
+            }
+            float sigLanes[4], errLanes[4], maxLanes[4];
+            uint32_t equalLanes[4];
+            vst1q_f32(sigLanes, sig);
+            vst1q_f32(errLanes, err);
+            vst1q_f32(maxLanes, maxAbs);
+            vst1q_u32(equalLanes, equal);
+            for (int k = 0; k < 4; k++) {
+                stats.signal += sigLanes[k];
+                stats.error += errLanes[k];
+                stats.maxAbs = std::max(stats.maxAbs, maxLanes[k]);
+                stats.equal += equalLanes[k];
+            }
+        }
+#endif
+        for (; i < count; i++) {
+            float e = test[i] - ref[i];
+            stats.signal += (double)ref[i] * ref[i];
+            stats.error += (double)e * e;
+            stats.maxAbs = std::max(stats.maxAbs, std::fabs(e));
+            if (memcmp(&ref[i], &test[i], sizeof(float)) == 0) stats.equal++;
+        }
+    }
+
+    static float DotProduct(const float* a, const float* b, size_t count) {
+        size_t i = 0;
+        float sum = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128 acc = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc);
+        sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__ARM_NEON)
+        float32x4_t acc = vdupq_n_f32(0);
+        for (; i + 4 <= count; i += 4) {
+            acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+        }
+        float lanes[4];
+        vst1q_f32(lanes, acc);
+        sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        for (; i < count; i++) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    // SearchLag: 在 [lo, hi] 中搜索 lag，使 ref[base, base + window) 与 test[base + lag, ...) 的归一化互相关最大
+    // 被测信号的窗口能量随 lag 滑动更新；得分相同时优先 lag 0
+    static int64_t SearchLag(const float* ref, const float* test, size_t base, size_t window, int64_t lo, int64_t hi) {
+        const float* r = ref + base;
+        const float* t = test + base;
+        double energy = 0;
+        for (size_t i = 0; i < window; i++) energy += (double)t[lo + (int64_t)i] * t[lo + (int64_t)i];
+
+        int64_t bestLag = lo;
+        double bestScore = -std::numeric_limits<double>::infinity();
+        double zeroScore = bestScore;
+        for (int64_t lag = lo; lag <= hi; lag++) {
+            double score = DotProduct(r, t + lag, window) / std::sqrt(std::max(energy, 1e-20));
+            if (score > bestScore) {
+                bestScore = score;
+                bestLag = lag;
+            }
+            if (lag == 0) zeroScore = score;
+            if (lag < hi) {
+                double out = t[lag];
+                double in = t[lag + (int64_t)window];
+                energy = std::max(0.0, energy - out * out + in * in);
+            }
+        }
+        return zeroScore >= bestScore ? 0 : bestLag;
+    }
+
+    // MixDown: 交错的多声道数据各帧相加为单声道，每 factor 帧再相加为一个点
+    static void MixDown(const float* frames, size_t count, uint16_t channels, uint32_t factor, std::vector<float>& out) {
+        out.assign(count / factor, 0.0f);
+        for (size_t i = 0; i < out.size() * factor; i++) {
+            float sum = 0;
+            for (uint16_t c = 0; c < channels; c++) sum += frames[i * channels + c];
+            out[i / factor] += sum;
+        }
+    }
+
+    // EstimateDelay: 估计 test 相对 ref 的延迟，test[n + delay] 对应 ref[n]
+    // * refHead/testHead : 两个文件开头的数据，分别为 refFrames/testFrames 帧
+    // * maxDelay/window  : 搜索范围和窗口长度(帧)，数据不够时自动缩小
+    static int64_t EstimateDelay(const float* refHead, size_t refFrames, const float* testHead, size_t testFrames, uint16_t channels,
+                                 uint32_t sampleRate, size_t maxDelay, size_t window) {
+        // 参考窗口为 ref[D, D + W)，需要 test[0, 2D + W)
+        size_t delay = std::min(maxDelay, std::min(refFrames, testFrames) / 4);
+        size_t refAvail = refFrames - delay;
+        size_t testAvail = testFrames - 2 * delay;
+        window = std::min(window, std::min(refAvail, testAvail));
+        if (window < 16) return 0;
+
+        std::vector<float> ref, test;
+        MixDown(refHead, delay + window, channels, 1, ref);
+        MixDown(testHead, 2 * delay + window, channels, 1, test);
+
+        int64_t lo = -(int64_t)delay;
+        int64_t hi = (int64_t)delay;
+        uint32_t factor = std::max<uint32_t>(1, sampleRate / kCoarseRate);
+        if (factor > 1 && window / factor >= 16 && delay / factor > 0) {
+            // 先在降采样的数据上搜索整个范围，再在原采样率上搜索粗搜结果附近的 [-factor, factor]
+            std::vector<float> refCoarse, testCoarse;
+            MixDown(refHead, delay + window, channels, factor, refCoarse);
+            MixDown(testHead, 2 * delay + window, channels, factor, testCoarse);
+            int64_t coarseDelay = (int64_t)(delay / factor);
+            int64_t coarse = SearchLag(refCoarse.data(), testCoarse.data(), (size_t)coarseDelay, window / factor, -coarseDelay, coarseDelay);
+            lo = std::max(lo, coarse * factor - factor);
+            hi = std::min(hi, coarse * factor + factor);
+        }
+        return SearchLag(ref.data(), test.data(), delay, window, lo, hi);
+    }
+
+    // FrameSource: 在 AudioFileReader 前面加一段预读的数据，估计延迟时预读的数据之后照常读出
+    class FrameSource {
+    public:
+        FrameSource(AudioFileReader& reader, uint16_t channels) : m_reader(reader), m_channels(channels) {}
+
+        // Prefetch: 预读开头的 frames 帧，返回实际读取的帧数
+        size_t Prefetch(size_t frames) {
+            m_head.resize(frames * m_channels);
+            size_t n = m_reader.ReadFrames(frames, m_head.data());
+            m_head.resize(n * m_channels);
+            m_headPos = 0;
+            return n;
+        }
+
+        const float* GetHead() const { return m_head.data(); }
+
+        size_t Read(size_t frames, float* out) {
+            size_t done = std::min(frames, (m_head.size() - m_headPos) / m_channels);
+            if (done > 0) {
+                memcpy(out, &m_head[m_headPos], done * m_channels * sizeof(float));
+                m_headPos += done * m_channels;
+            }
+            if (done < frames) {
+                done += m_reader.ReadFrames(frames - done, out + done * m_channels);
+            }
+            m_frames += done;
+            return done;
+        }
+
+        // Skip: 丢弃 frames 帧
+        void Skip(uint64_t frames, std::vector<float>& scratch) {
+            size_t chunk = scratch.size() / m_channels;
+            while (frames > 0 && chunk > 0) {
+                size_t n = Read((size_t)std::min<uint64_t>(frames, chunk), scratch.data());
+                if (n == 0) break;
+                frames -= n;
+            }
+        }
+
+        // GetFrames: 已读出(含丢弃)的帧数
+        uint64_t GetFrames() const { return m_frames; }
+
+    private:
+        AudioFileReader& m_reader;
+        uint16_t m_channels;
+        std::vector<float> m_head;
+        size_t m_headPos = 0;
+        uint64_t m_frames = 0;
+    };
+
+    // IsFloatLossless: 采样转换为 float 是否无损，float 的尾数只有 24 位
+    static bool IsFloatLossless(const AudioStreamInfo& info) {
+        if (info.encoding == WaveAudioFormatPCM) return info.bitsPerSample <= 24;
+        if (info.encoding == WaveAudioFormatIeeeFloat) return info.bitsPerSample == 32;
+        return true;   // G.711 和 ADPCM 解码为 16bit
+    }
+
+    static bool OpenInput(const AudioCompareInput& input, AudioFileReader& reader) {
+        if (input.encoding == WaveAudioFormatUnknown) {
+            return reader.Open(input.path);
+        }
+        return reader.OpenRaw(input.path, input.encoding, input.sampleRate, input.bitsPerSample, input.channels);
+    }
+
+    bool CompareAudio(AudioFileReader& ref, AudioFileReader& test, const AudioCompareOptions& options, AudioCompareResult& result) {
+        result = AudioCompareResult();
+        const AudioStreamInfo& refInfo = ref.GetInfo();
+        const AudioStreamInfo& testInfo = test.GetInfo();
+        if (refInfo.sampleRate == 0 || refInfo.channels == 0 || refInfo.sampleRate != testInfo.sampleRate ||
+            refInfo.channels != testInfo.channels) {
+            printf("CompareAudio: format mismatch, ref %uHz/%uch, test %uHz/%uch\n", refInfo.sampleRate, refInfo.channels,
+                   testInfo.sampleRate, testInfo.channels);
+            return false;
+        }
+
+        const uint16_t channels = refInfo.channels;
+        const uint32_t sampleRate = refInfo.sampleRate;
+        const size_t segFrames = std::max<size_t>(1, (size_t)((uint64_t)sampleRate * options.segmentMs / 1000));
+        std::vector<float> refFrames(segFrames * channels);
+        std::vector<float> testFrames(segFrames * channels);
+
+        FrameSource refSource(ref, channels);
+        FrameSource testSource(test, channels);
+        if (options.alignDelay) {
+            size_t maxDelay = (size_t)((uint64_t)sampleRate * options.maxDelayMs / 1000);
+            size_t window = (size_t)((uint64_t)sampleRate * options.windowMs / 1000);
+            size_t refHead = refSource.Prefetch(maxDelay + window);
+            size_t testHead = testSource.Prefetch(2 * maxDelay + window);
+            result.delay = EstimateDelay(refSource.GetHead(), refHead, testSource.GetHead(), testHead, channels, sampleRate, maxDelay, window);
+            if (result.delay > 0) {
+                testSource.Skip((uint64_t)result.delay, testFrames);
+            } else if (result.delay < 0) {
+                refSource.Skip((uint64_t)-result.delay, refFrames);
+            }
+        }
+
+        const double silence = std::pow(10.0, options.silenceDb / 10.0);
+        const uint64_t refStart = refSource.GetFrames();
+        double signal = 0, error = 0, segSum = 0;
+        uint64_t segCount = 0;
+        for (;;) {
+            size_t refRead = refSource.Read(segFrames, refFrames.data());
+            size_t testRead = testSource.Read(segFrames, testFrames.data());
+            size_t n = std::min(refRead, testRead);
+            if (n == 0) break;
+
+            size_t count = n * channels;
+            BlockStats stats;
+            CompareBlock(refFrames.data(), testFrames.data(), count, stats);
+            signal += stats.signal;
+            error += stats.error;
+            result.diffSamples += count - stats.equal;
+            if (stats.maxAbs > result.maxAbsError) {
+                // 只有最大误差刷新时才逐个查找位置
+                for (size_t i = 0; i < count; i++) {
+                    if (std::fabs(testFrames[i] - refFrames[i]) == stats.maxAbs) {
+                        result.maxErrorFrame = refStart + result.frames + i / channels;
+                        break;
+                    }
+                }
+                result.maxAbsError = stats.maxAbs;
+            }
+            if (stats.signal >= silence * count) {
+                double snr = stats.error > 0 ? 10.0 * std::log10(stats.signal / stats.error) : kSegSnrMax;
+                segSum += std::min(kSegSnrMax, std::max(kSegSnrMin, snr));
+                segCount++;
+            }
+            result.frames += n;
+            if (refRead != testRead) break;
+        }
+
+        // 读完较长的文件，统计两个文件的总帧数
+        while (refSource.Read(segFrames, refFrames.data()) > 0) {}
+        while (testSource.Read(segFrames, testFrames.data()) > 0) {}
+        result.refFrames = refSource.GetFrames();
+        result.testFrames = testSource.GetFrames();
+
+        result.snr = error > 0 ? 10.0 * std::log10(signal / error) : std::numeric_limits<double>::infinity();
+        result.segSnr = segCount > 0 ? segSum / segCount : 0;
+        result.bitExact = result.delay == 0 && result.refFrames == result.testFrames && result.diffSamples == 0 &&
+                          IsFloatLossless(refInfo) && IsFloatLossless(testInfo);
+        result.success = true;
+        return true;
+    }
+
+    bool CompareAudioFiles(const AudioCompareInput& ref, const AudioCompareInput& test, const AudioCompareOptions& options,
+                           AudioCompareResult& result) {
+        result = AudioCompareResult();
+        AudioFileReader refReader;
+        AudioFileReader testReader;
+        if (!OpenInput(ref, refReader) || !OpenInput(test, testReader)) {
+            return false;
+        }
+        return CompareAudio(refReader, testReader, options, result);
+    }
+
+    size_t BatchCompareAudioFiles(std::vector<AudioCompareJob>& jobs, const AudioCompareOptions& options, AsyncIO::ThreadPool* pool) {
+        std::unique_ptr<AsyncIO::ThreadPool> ownedPool;
+        if (!pool) {
+            ownedPool.reset(new AsyncIO::ThreadPool());
+            pool = ownedPool.get();
+        }
+
+        for (size_t i = 0; i < jobs.size(); i++) {
+            AudioCompareJob* job = &jobs[i];
+            pool->Submit([job, &options]{
+                CompareAudioFiles(job->ref, job->test, options, job->result);
+            });
+        }
+        pool->Wait();
+
+        size_t succeeded = 0;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (jobs[i].result.success) succeeded++;
+        }
+        return succeeded;
+    }
+}
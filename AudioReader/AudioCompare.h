@@ -0,0 +1,97 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef AUDIO_COMPARE_H
+#define AUDIO_COMPARE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AudioFileReader.h"
+
+namespace AsyncIO {
+    class ThreadPool;
+}
+
+namespace AudioReader {
+
+    // AudioCompareInput: 参与比较的一个文件
+    // encoding 为 WaveAudioFormatUnknown 时按 Wave/AIFF 打开(AudioFileReader::Open)，否则按裸数据打开(OpenRaw)
+    struct AudioCompareInput {
+        std::string path;
+        uint16_t encoding      = WaveAudioFormatUnknown;
+        uint32_t sampleRate    = 0;
+        uint16_t bitsPerSample = 0;
+        uint16_t channels      = 0;
+    };
+
+    // AudioCompareOptions: 比较参数
+    struct AudioCompareOptions {
+        uint32_t segmentMs  = 20;     // 分段信噪比的段长
+        double   silenceDb  = -60.0;  // 参考信号平均功率低于该值(dBFS)的段不计入分段信噪比
+        bool     alignDelay = false;  // 是否先估计两个文件之间的延迟，对齐后再比较
+        uint32_t maxDelayMs = 200;    // 延迟搜索范围 [-maxDelayMs, maxDelayMs]
+        uint32_t windowMs   = 1000;   // 估计延迟使用的数据长度
+    };
+
+    // AudioCompareResult: 比较结果，采样按 [-1, 1) 浮点比较，误差以满幅 1.0 为单位
+    struct AudioCompareResult {
+        bool     success     = false;  // 两个文件都能打开，且采样率和声道数相同
+        bool     bitExact    = false;  // 没有延迟、长度相同、所有采样值相等，输入转换为 float 有损时为 false
+        uint64_t refFrames   = 0;      // 参考文件的帧数
+        uint64_t testFrames  = 0;      // 被测文件的帧数
+        uint64_t frames      = 0;      // 对齐后参与比较的帧数
+        int64_t  delay       = 0;      // 被测文件相对参考文件的延迟(帧)，test[n + delay] 对应 ref[n]
+        uint64_t diffSamples = 0;      // 值不相等的采样数
+        double   snr         = 0;      // 信噪比(dB)，没有误差时为 +inf
+        double   segSnr      = 0;      // 分段信噪比(dB)，每段限制在 [-10, 35] 后取平均
+        double   maxAbsError = 0;      // 最大绝对误差
+        uint64_t maxErrorFrame = 0;    // 最大误差所在的帧(参考文件中的位置)
+    };
+
+    /*example code
+
+        AudioCompareInput ref, test;
+        ref.path = "ref.wav";
+        test.path = "decoded.pcm";
+        test.encoding = WaveAudioFormatPCM;
+        test.sampleRate = 8000;
+        test.bitsPerSample = 16;
+        test.channels = 1;
+
+        AudioCompareOptions options;
+        options.alignDelay = true;          // 编解码引入的延迟先对齐
+        AudioCompareResult result;
+        if(CompareAudioFiles(ref, test, options, result)){
+            printf("snr:%.2f seg_snr:%.2f delay:%lld\n", result.snr, result.segSnr, (long long)result.delay);
+        }
+    */
+
+    // CompareAudioFiles: 逐个采样比较两个文件，通过 AudioFileReader 分段读取，内存占用与文件长度无关
+    // 误差统计(能量、最大误差、不等的采样数)使用 SSE2/NEON；
+    // 对齐时在两个文件开头 windowMs 的单声道混合上做归一化互相关，先降采样到约 8kHz 粗搜，再在原采样率上细搜
+    // 采样转换为 float 后比较，8/16/24bit PCM、G.711、32bit 浮点的 bitExact 是精确的；
+    // 32bit 整数 PCM、64bit 浮点转换为 float 时丢失低位，误差统计只反映高 24 位，bitExact 始终为 false
+    // * 返回值 : result.success
+    bool CompareAudioFiles(const AudioCompareInput& ref, const AudioCompareInput& test, const AudioCompareOptions& options,
+                           AudioCompareResult& result);
+
+    // CompareAudio: 比较两个已经打开的 reader，从当前位置开始读取到结尾
+    bool CompareAudio(AudioFileReader& ref, AudioFileReader& test, const AudioCompareOptions& options, AudioCompareResult& result);
+
+    // AudioCompareJob: 批量比较中的一对文件
+    struct AudioCompareJob {
+        AudioCompareInput ref;
+        AudioCompareInput test;
+        AudioCompareResult result;  // [输出]
+    };
+
+    // BatchCompareAudioFiles: 在线程池中同时比较多对文件，每对文件一个任务
+    // * pool   : 线程池，为空时内部创建一个
+    // * 返回值  : 比较成功(result.success)的个数
+    size_t BatchCompareAudioFiles(std::vector<AudioCompareJob>& jobs, const AudioCompareOptions& options, AsyncIO::ThreadPool* pool = nullptr);
+};
+
+#endif //AUDIO_COMPARE_H
@@ -0,0 +1,464 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "AudioFileReader.h"
+#include "AsyncIO/AsyncIO.h"
+#include "WaveCodec/ByteSwap.h"
+#include "PCMCodec/PCMRequantize.h"
+#include "G711Codec/G711Codec.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace AudioReader {
+
+    // 需要转换时每次读入 IO 缓冲区的帧数
+    static const size_t kIOFrames = 4096;
+
+    const char* GetEncodingName(uint16_t encoding) {
+        switch (encoding) {
+            case WaveAudioFormatPCM:       return "pcm";
+            case WaveAudioFormatIeeeFloat: return "float";
+            case WaveAudioFormatALaw:      return "alaw";
+            case WaveAudioFormatMuLaw:     return "ulaw";
+            case WaveAudioFormatMSADPCM:   return "ms-adpcm";
+            case WaveAudioFormatGSM:       return "gsm";
+            case WaveAudioFormatG721:      return "g721";
+            case WaveAudioFormatG722:      return "g722";
+            default:                       return "unknown";
+        }
+    }
+
+    // G.711 解码为浮点的查找表
+    struct G711FloatTables {
+        float alaw[256];
+        float ulaw[256];
+
+        G711FloatTables() {
+            const G711Codec::G711Tables& tables = G711Codec::GetG711Tables();
+            for (int i = 0; i < 256; i++) {
+                alaw[i] = tables.alawDecode[i] * (1.0f / 32768);
+                ulaw[i] = tables.ulawDecode[i] * (1.0f / 32768);
+            }
+        }
+    };
+
+    static const G711FloatTables& GetG711FloatTables() {
+        static const G711FloatTables tables;
+        return tables;
+    }
+
+    // 浮点采样 -> 16bit，饱和处理
+    static void FloatToInt16(const float* src, size_t count, uint16_t* out) {
+        size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128 scale = _mm_set1_ps(32768.0f), lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+        for (; i + 8 <= count; i += 8) {
+            __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), lo), hi);
+            __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), lo), hi);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        for (; i + 8 <= count; i += 8) {
+            int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), 32768.0f));
+            int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32768.0f));
+            vst1q_s16((int16_t*)(out + i), vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+        }
+#endif
+        for (; i < count; i++) {
+            float v = src[i] * 32768.0f;
+            if (!(v >= -32768.0f)) v = -32768.0f; // 同时处理 NaN
+            if (v > 32767.0f) v = 32767.0f;
+            out[i] = (uint16_t)(int16_t)std::nearbyint(v);
+        }
+    }
+
+    // 解码 count 个采样为 16bit PCM
+    static void Decode(const uint8_t* src, size_t count, uint16_t encoding, uint32_t sampleBytes, uint16_t* out) {
+        if (encoding == WaveAudioFormatALaw) {
+            G711Codec::ALawDecode(src, count, out);
+        } else if (encoding == WaveAudioFormatMuLaw) {
+            G711Codec::MuLawDecode(src, count, out);
+        } else if (encoding == WaveAudioFormatIeeeFloat) {
+            if (sampleBytes == 4) {
+                FloatToInt16((const float*)src, count, out);
+            } else {
+                for (size_t i = 0; i < count; i++) {
+                    double v;
+                    memcpy(&v, src + i * 8, sizeof(v));
+                    float f = (float)v;
+                    FloatToInt16(&f, 1, out + i);
+                }
+            }
+        } else {
+            // 整数 PCM 取高 16 位
+            switch (sampleBytes) {
+                case 1:
+                    for (size_t i = 0; i < count; i++) {
+                        out[i] = (uint16_t)((src[i] ^ 0x80) << 8);
+                    }
+                    break;
+                case 2:
+                    memcpy(out, src, count * 2);
+                    break;
+                default:
+                    for (size_t i = 0; i < count; i++) {
+                        const uint8_t* p = src + i * sampleBytes + sampleBytes - 2;
+                        out[i] = (uint16_t)(p[0] | (p[1] << 8));
+                    }
+                    break;
+            }
+        }
+    }
+
+    // 解码 count 个采样为浮点数
+    static void Decode(const uint8_t* src, size_t count, uint16_t encoding, uint32_t sampleBytes, float* out) {
+        if (encoding == WaveAudioFormatALaw || encoding == WaveAudioFormatMuLaw) {
+            const float* table = encoding == WaveAudioFormatALaw ? GetG711FloatTables().alaw : GetG711FloatTables().ulaw;
+            for (size_t i = 0; i < count; i++) {
+                out[i] = table[src[i]];
+            }
+        } else {
+            PCMCodec::SamplesToFloat(src, count, sampleBytes, encoding == WaveAudioFormatIeeeFloat, out);
+        }
+    }
+
+    // 输出格式与原始数据相同时可以直接读入输出
+    static bool IsDirect(uint16_t encoding, uint32_t sampleBytes, const uint16_t*) {
+        return encoding == WaveAudioFormatPCM && sampleBytes == 2;
+    }
+
+    static bool IsDirect(uint16_t encoding, uint32_t sampleBytes, const float*) {
+        return encoding == WaveAudioFormatIeeeFloat && sampleBytes == 4;
+    }
+
+    ///////////////////////////////////////////////////
+    // AudioFileReader
+    AudioFileReader::AudioFileReader() {}
+
+    AudioFileReader::~AudioFileReader() {
+        Close();
+    }
+
+    bool AudioFileReader::Open(const std::string& filePath) {
+        Close();
+
+        // 按文件开头的标识识别容器
+        uint8_t head[12] = {0};
+        int fd = AsyncIO::OpenFileForRead(filePath);
+        if (fd < 0) {
+            printf("open file failed, %s\n", filePath.c_str());
+            return false;
+        }
+        int64_t nRead = AsyncIO::ReadFileAt(fd, head, sizeof(head), 0);
+        AsyncIO::CloseFile(fd);
+        if (nRead != (int64_t)sizeof(head)) {
+            printf("file too short, %s\n", filePath.c_str());
+            return false;
+        }
+
+        if ((memcmp(head, "RIFF", 4) == 0 || memcmp(head, "RIFX", 4) == 0 || memcmp(head, "RF64", 4) == 0) && memcmp(head + 8, "WAVE", 4) == 0) {
+            WaveCodec::WaveHeader header;
+            uint64_t dataOffset = 0;
+            if (!m_riff.Open(filePath) || !m_riff.GetWaveHeader(header, dataOffset, m_dataSize)) {
+                printf("invalid wave file, %s\n", filePath.c_str());
+                Close();
+                return false;
+            }
+            m_dataIndex = m_riff.FindChunk("data");
+            m_info.container = ContainerWave;
+            m_info.encoding = header.riff.fmt.audio_format;
+            m_info.bigEndian = m_riff.IsBigEndian();
+
+            // WAVE_FORMAT_EXTENSIBLE 的实际格式在 fmt 块偏移 24 处 sub_format GUID 的前两个字节
+            if (m_info.encoding == WaveAudioFormatExtensible) {
+                const std::vector<uint8_t>* fmt = m_riff.LoadChunk(m_riff.FindChunk("fmt "));
+                m_info.encoding = WaveAudioFormatUnknown;
+                if (fmt && fmt->size() >= 26) {
+                    m_info.encoding = m_info.bigEndian ? (uint16_t)(((*fmt)[24] << 8) | (*fmt)[25]) : (uint16_t)((*fmt)[24] | ((*fmt)[25] << 8));
+                }
+            }
+            m_info.sampleRate = header.riff.fmt.sample_rate;
+            m_info.channels = header.riff.fmt.channels;
+            m_info.bitsPerSample = header.riff.fmt.bits_per_sample;
+
+            // 压缩格式按块读取，由 CheckEncoding 检查
+            m_blockAlign = header.riff.fmt.block_align;
+            m_info.totalFrames = header.riff.fact.samples;
+        } else if (memcmp(head, "FORM", 4) == 0 && (memcmp(head + 8, "AIFF", 4) == 0 || memcmp(head + 8, "AIFC", 4) == 0)) {
+            // AiffFileReader 读出的数据已经是本机字节序，8bit 已转换为无符号
+            WaveCodec::WaveHeader header;
+            m_aiff.reset(new WaveCodec::AiffFileReader());
+            if (!m_aiff->Open(filePath) || !m_aiff->ReadWaveHeader(header)) {
+                Close();
+                return false;
+            }
+            m_info.container = ContainerAiff;
+            m_info.encoding = header.riff.fmt.audio_format;
+            m_info.sampleRate = header.riff.fmt.sample_rate;
+            m_info.channels = header.riff.fmt.channels;
+            m_info.bitsPerSample = header.riff.fmt.bits_per_sample;
+            m_dataSize = header.riff.data.header.size;
+        } else {
+            printf("unknown container, use OpenRaw for raw audio data, %s\n", filePath.c_str());
+            return false;
+        }
+
+        if (!CheckEncoding()) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool AudioFileReader::OpenRaw(const std::string& filePath, uint16_t encoding, uint32_t sampleRate, uint16_t bitsPerSample, uint16_t channels) {
+        Close();
+
+        m_fd = AsyncIO::OpenFileForRead(filePath);
+        int64_t fileSize = m_fd >= 0 ? AsyncIO::GetFileSize(m_fd) : -1;
+        if (fileSize < 0) {
+            printf("open file failed, %s\n", filePath.c_str());
+            Close();
+            return false;
+        }
+
+        m_info.container = ContainerRaw;
+        m_info.encoding = encoding;
+        m_info.sampleRate = sampleRate;
+        m_info.channels = channels;
+        m_info.bitsPerSample = bitsPerSample;
+        m_dataSize = (uint64_t)fileSize;
+        if (!CheckEncoding()) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool AudioFileReader::CheckEncoding() {
+        const uint16_t channels = m_info.channels;
+        const bool adpcmContainer = (m_info.container == ContainerWave || m_info.container == ContainerRaw);
+        if (m_info.encoding == WaveAudioFormatGSM && m_info.container == ContainerWave && channels == 1 && m_blockAlign == 65 &&
+            m_info.sampleRate != 0) {
+            m_blockFrames = 320;
+            m_gsm.reset(new G711Codec::GSMDecoder(G711Codec::GSMPackingWav49));
+        } else if (m_info.encoding == WaveAudioFormatG721 && adpcmContainer && channels != 0 && m_info.sampleRate != 0 &&
+                   m_info.bitsPerSample >= G711Codec::G726Rate16k && m_info.bitsPerSample <= G711Codec::G726Rate40k) {
+            // 码字按帧交错紧密排列，每 8 帧正好是 channels * bits 个字节
+            m_blockAlign = channels * m_info.bitsPerSample;
+            m_blockFrames = 8;
+            m_g726.assign(channels, G711Codec::G726Decoder((G711Codec::G726Rate)m_info.bitsPerSample));
+        } else if (m_info.encoding == WaveAudioFormatG722 && adpcmContainer && channels != 0 && m_info.sampleRate != 0) {
+            // 每个声道每个字节 2 帧，文件中没有记录模式，按最常用的 64k 解码
+            m_blockAlign = channels;
+            m_blockFrames = 2;
+            m_g722.assign(channels, G711Codec::G722Decoder(G711Codec::G722Mode64k));
+        }
+        if (m_blockFrames) {
+            // fact 中的采样数可能不包含最后一块补的静音，以较小的为准
+            uint64_t frames = m_dataSize / m_blockAlign * m_blockFrames;
+            m_info.totalFrames = m_info.totalFrames ? std::min<uint64_t>(m_info.totalFrames, frames) : frames;
+            m_io.resize((kIOFrames / m_blockFrames) * m_blockAlign);
+            return true;
+        }
+
+        m_sampleBytes = m_info.bitsPerSample / 8;
+        bool ok = false;
+        switch (m_info.encoding) {
+            case WaveAudioFormatPCM:       ok = (m_sampleBytes >= 1 && m_sampleBytes <= 4); break;
+            case WaveAudioFormatIeeeFloat: ok = (m_sampleBytes == 4 || m_sampleBytes == 8); break;
+            case WaveAudioFormatALaw:
+            case WaveAudioFormatMuLaw:     ok = (m_sampleBytes == 1); break;
+            default: break;
+        }
+        if (!ok || m_info.channels == 0 || m_info.sampleRate == 0 || m_info.bitsPerSample % 8 != 0) {
+            printf("unsupported audio format, encoding:%s(%d), sample_bits:%d, channels:%d\n", GetEncodingName(m_info.encoding), m_info.encoding,
+                   m_info.bitsPerSample, m_info.channels);
+            return false;
+        }
+
+        m_blockAlign = m_sampleBytes * m_info.channels;
+        m_info.totalFrames = m_dataSize / m_blockAlign;
+        m_io.resize(kIOFrames * m_blockAlign);
+        return true;
+    }
+
+    size_t AudioFileReader::ReadRaw(uint8_t* dst, size_t bytes) {
+        uint64_t left = m_dataSize - m_dataOffset;
+        size_t toRead = (size_t)std::min<uint64_t>(bytes, left) / m_blockAlign * m_blockAlign;
+        if (toRead == 0) return 0;
+
+        int64_t nRead = 0;
+        switch (m_info.container) {
+            case ContainerWave:
+                nRead = m_riff.ReadChunk(m_dataIndex, m_dataOffset, dst, toRead);
+                break;
+            case ContainerAiff:
+                nRead = (int64_t)m_aiff->ReadBytes((uint32_t)toRead, dst);
+                break;
+            case ContainerRaw:
+                nRead = AsyncIO::ReadFileAt(m_fd, dst, toRead, m_dataOffset);
+                break;
+            default:
+                return 0;
+        }
+        if (nRead <= 0) {
+            m_dataOffset = m_dataSize;
+            return 0;
+        }
+        m_dataOffset += (uint64_t)nRead;
+        return (size_t)nRead / m_blockAlign * m_blockAlign; // 文件末尾不完整的帧被丢弃
+    }
+
+    void AudioFileReader::DecodeBlocks(size_t bytes) {
+        const uint16_t channels = m_info.channels;
+        const size_t blocks = bytes / m_blockAlign;
+        const size_t frames = blocks * m_blockFrames;
+        m_decoded.resize(frames * channels);
+        m_decodedPos = 0;
+
+        if (m_gsm) {
+            m_gsm->Decode(&m_io[0], blocks, &m_decoded[0]);
+            return;
+        }
+
+        // G.726 先拆成每个字节一个码字，G.722 本身就是每个字节一个码字，都按帧交错
+        const uint8_t* codes = &m_io[0];
+        if (!m_g726.empty()) {
+            m_codes.resize(frames * channels);
+            G711Codec::G726UnpackCodes(&m_io[0], bytes, m_info.bitsPerSample, &m_codes[0]);
+            codes = &m_codes[0];
+        }
+        const size_t codeCount = m_g726.empty() ? blocks : frames; // 每个声道的码字数
+        if (channels == 1) {
+            if (!m_g726.empty()) m_g726[0].Decode(codes, codeCount, &m_decoded[0]);
+            else m_g722[0].Decode(codes, codeCount, &m_decoded[0]);
+            return;
+        }
+
+        // 多声道逐个声道解码后交错
+        m_channelCodes.resize(codeCount);
+        m_channelPcm.resize(frames);
+        for (uint16_t ch = 0; ch < channels; ch++) {
+            for (size_t i = 0; i < codeCount; i++) {
+                m_channelCodes[i] = codes[i * channels + ch];
+            }
+            if (!m_g726.empty()) m_g726[ch].Decode(&m_channelCodes[0], codeCount, &m_channelPcm[0]);
+            else m_g722[ch].Decode(&m_channelCodes[0], codeCount, &m_channelPcm[0]);
+            for (size_t i = 0; i < frames; i++) {
+                m_decoded[i * channels + ch] = m_channelPcm[i];
+            }
+        }
+    }
+
+    template <typename T>
+    size_t AudioFileReader::ReadBlockFrames(size_t frames, T* out) {
+        const uint16_t channels = m_info.channels;
+        size_t done = 0;
+        while (done < frames && m_position + done < m_info.totalFrames) {
+            if (m_decodedPos * channels == m_decoded.size()) {
+                // 按需要的帧数读入整块，一次最多一个 IO 缓冲区
+                size_t blocks = std::min((frames - done + m_blockFrames - 1) / m_blockFrames, m_io.size() / m_blockAlign);
+                size_t bytes = ReadRaw(&m_io[0], blocks * m_blockAlign);
+                if (bytes == 0) break;
+                DecodeBlocks(bytes);
+            }
+
+            size_t n = std::min(frames - done, m_decoded.size() / channels - m_decodedPos);
+            n = (size_t)std::min<uint64_t>(n, m_info.totalFrames - (m_position + done));
+            Decode((const uint8_t*)&m_decoded[m_decodedPos * channels], n * channels, WaveAudioFormatPCM, 2, out + done * channels);
+            m_decodedPos += n;
+            done += n;
+        }
+        m_position += done;
+        return done;
+    }
+
+    template <typename T>
+    size_t AudioFileReader::ReadFramesT(size_t frames, T* out) {
+        if (m_blockAlign == 0 || !out) return 0;
+        if (m_blockFrames) return ReadBlockFrames(frames, out);
+
+        const uint16_t channels = m_info.channels;
+        const bool direct = IsDirect(m_info.encoding, m_sampleBytes, out);
+        size_t done = 0;
+        while (done < frames) {
+            // 直接读入输出时一次读完，否则每次读入一个 IO 缓冲区
+            size_t n = direct ? frames - done : std::min(frames - done, kIOFrames);
+            T* dst = out + done * channels;
+            uint8_t* raw = direct ? (uint8_t*)dst : &m_io[0];
+
+            size_t bytes = ReadRaw(raw, n * m_blockAlign);
+            size_t got = bytes / m_blockAlign;
+            if (got == 0) break;
+
+            if (m_info.bigEndian && m_sampleBytes > 1) {
+                WaveCodec::ByteSwapSamples(raw, bytes, m_sampleBytes);
+            }
+            if (!direct) {
+                Decode(raw, got * channels, m_info.encoding, m_sampleBytes, dst);
+            }
+            done += got;
+            if (got < n) break;
+        }
+        m_position += done;
+        return done;
+    }
+
+    size_t AudioFileReader::ReadFrames(size_t frames, uint16_t* out) {
+        return ReadFramesT(frames, out);
+    }
+
+    size_t AudioFileReader::ReadFrames(size_t frames, float* out) {
+        return ReadFramesT(frames, out);
+    }
+
+    size_t AudioFileReader::ReadDuration(uint32_t durationMs, std::vector<uint16_t>& out) {
+        size_t frames = (size_t)((uint64_t)m_info.sampleRate * durationMs / 1000);
+        out.resize(frames * m_info.channels);
+        size_t got = frames ? ReadFrames(frames, &out[0]) : 0;
+        out.resize(got * m_info.channels);
+        return got;
+    }
+
+    size_t AudioFileReader::ReadDuration(uint32_t durationMs, std::vector<float>& out) {
+        size_t frames = (size_t)((uint64_t)m_info.sampleRate * durationMs / 1000);
+        out.resize(frames * m_info.channels);
+        size_t got = frames ? ReadFrames(frames, &out[0]) : 0;
+        out.resize(got * m_info.channels);
+        return got;
+    }
+
+    void AudioFileReader::Close() {
+        m_riff.Close();
+        m_dataIndex = -1;
+        if (m_aiff) {
+            m_aiff->Close();
+            m_aiff.reset();
+        }
+        if (m_fd >= 0) {
+            AsyncIO::CloseFile(m_fd);
+            m_fd = -1;
+        }
+        m_info = AudioStreamInfo();
+        m_gsm.reset();
+        m_g726.clear();
+        m_g722.clear();
+        m_blockFrames = 0;
+        m_decoded.clear();
+        m_decodedPos = 0;
+        m_blockAlign = 0;
+        m_sampleBytes = 0;
+        m_dataOffset = 0;
+        m_dataSize = 0;
+        m_position = 0;
+    }
+}
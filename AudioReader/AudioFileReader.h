@@ -0,0 +1,137 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef AUDIO_FILE_READER_H
+#define AUDIO_FILE_READER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "WaveCodec/WaveFile.h"
+#include "WaveCodec/WaveChunks.h"
+#include "WaveCodec/AiffFile.h"
+#include "G711Codec/GSMCodec.h"
+#include "G711Codec/G726Codec.h"
+#include "G711Codec/G722Codec.h"
+
+namespace AudioReader {
+
+    // 容器类型
+    enum AudioContainer {
+        ContainerUnknown = 0,
+        ContainerRaw     = 1, // 没有文件头的 PCM/G.711 数据，由调用者指定格式
+        ContainerWave    = 2, // RIFF/RIFX/RF64 Wave
+        ContainerAiff    = 3, // AIFF/AIFC
+    };
+
+    // AudioStreamInfo: 文件中音频的原始格式
+    struct AudioStreamInfo {
+        AudioContainer container = ContainerUnknown;
+        uint16_t encoding      = WaveAudioFormatUnknown; // WaveAudioFormatPCM/IeeeFloat/ALaw/MuLaw/GSM/G721/G722，Extensible 已替换为实际格式
+        uint32_t sampleRate    = 0;
+        uint16_t channels      = 0;
+        uint16_t bitsPerSample = 0;  // 每个采样占用的位数，整字节；GSM 为 0，G.726 为码字位数(2~5)，G.722 为 4
+        bool     bigEndian     = false; // 数据是否为大端(RIFX)
+        uint64_t totalFrames   = 0;  // 总帧数，流式写入的文件未知时为 0
+    };
+
+    // GetEncodingName: 编码名称，用于打印
+    const char* GetEncodingName(uint16_t encoding);
+
+    /*example code
+
+        AudioFileReader reader;
+        if(!reader.Open("any.wav")) return;   // Wave/AIFF 自动识别，裸数据用 OpenRaw
+        const AudioStreamInfo& info = reader.GetInfo();
+
+        std::vector<float> frames(1024 * info.channels);
+        size_t n;
+        while((n = reader.ReadFrames(1024, frames.data())) > 0){
+            // n 帧交错的 [-1, 1) 浮点采样
+        }
+    */
+
+    // AudioFileReader: 与格式无关的音频读取类，按内容识别容器和编码，输出调用者需要的采样格式
+    // 支持 8/16/24/32bit PCM、32/64bit 浮点、A-law、mu-law，大端数据自动转换；
+    // 压缩格式按块解码，解码后未读取的采样留到下一次读取：Wave 中的 GSM 06.10(WAV49) 每 65 字节一块，
+    // G.726(WaveAudioFormatG721，G726EncodeWaveFile 的输出)每 8 帧一块，G.722(按 64k 模式解码)每个字节 2 帧；
+    // MS ADPCM 等其他压缩格式暂不支持，Open 时返回失败
+    // 数据按块读入 IO 缓冲区后直接解码到输出，不经过中间缓冲；16bit PCM 读为 16bit、32bit 浮点读为浮点时直接读入输出
+    class AudioFileReader {
+    public:
+        AudioFileReader();
+        ~AudioFileReader();
+
+        // Open: 打开 Wave/AIFF 文件，根据文件开头的标识识别容器
+        bool Open(const std::string& filePath);
+
+        // OpenRaw: 打开没有文件头的音频数据
+        // * encoding : WaveAudioFormatPCM/WaveAudioFormatIeeeFloat/WaveAudioFormatALaw/WaveAudioFormatMuLaw，小端
+        bool OpenRaw(const std::string& filePath, uint16_t encoding, uint32_t sampleRate, uint16_t bitsPerSample, uint16_t channels);
+
+        const AudioStreamInfo& GetInfo() const { return m_info; }
+
+        // ReadFrames: 读取 frames 帧，转换为 16bit PCM 交错数据
+        // * out    : 输出，frames * channels 个采样
+        // * 返回值  : 实际读取的帧数，0 表示结束或出错
+        size_t ReadFrames(size_t frames, uint16_t* out);
+
+        // ReadFrames: 读取 frames 帧，转换为 [-1, 1) 的浮点交错数据
+        size_t ReadFrames(size_t frames, float* out);
+
+        // ReadDuration: 读取指定时长(毫秒)的数据，帧数按采样率计算，输出同 ReadFrames
+        size_t ReadDuration(uint32_t durationMs, std::vector<uint16_t>& out);
+        size_t ReadDuration(uint32_t durationMs, std::vector<float>& out);
+
+        // GetFramePosition: 已读取的帧数
+        uint64_t GetFramePosition() const { return m_position; }
+
+        void Close();
+
+    private:
+        AudioFileReader(const AudioFileReader&);
+        AudioFileReader& operator=(const AudioFileReader&);
+
+        bool CheckEncoding();
+
+        // ReadRaw: 从文件中读取最多 bytes 字节的原始数据，返回实际读取的字节数，按整帧截断
+        size_t ReadRaw(uint8_t* dst, size_t bytes);
+
+        template <typename T> size_t ReadFramesT(size_t frames, T* out);
+        template <typename T> size_t ReadBlockFrames(size_t frames, T* out);
+
+        // DecodeBlocks: 将 m_io 中 bytes 字节的整块压缩数据解码到 m_decoded
+        void DecodeBlocks(size_t bytes);
+
+        AudioStreamInfo m_info;
+        uint32_t m_blockAlign = 0;
+        uint32_t m_sampleBytes = 0;
+
+        // 数据来源，按容器只使用其中一个
+        WaveCodec::RiffChunkDirectory m_riff;
+        int m_dataIndex = -1;
+        std::unique_ptr<WaveCodec::AiffFileReader> m_aiff;
+        int m_fd = -1;
+
+        uint64_t m_dataOffset = 0;   // 已读取的原始数据长度
+        uint64_t m_dataSize = 0;     // 原始数据总长度，UINT64_MAX 表示读到文件末尾
+        uint64_t m_position = 0;
+        std::vector<uint8_t> m_io;   // IO 缓冲区
+
+        // 压缩格式解码，m_blockAlign 为一块的字节数，只使用其中一种解码器
+        std::unique_ptr<G711Codec::GSMDecoder> m_gsm;
+        std::vector<G711Codec::G726Decoder> m_g726; // 每个声道一个
+        std::vector<G711Codec::G722Decoder> m_g722; // 每个声道一个
+        uint32_t m_blockFrames = 0;      // 每块的帧数，不是压缩格式时为 0
+        std::vector<uint8_t>  m_codes;        // G.726 拆开的码字，每个字节一个
+        std::vector<uint8_t>  m_channelCodes; // 多声道时一个声道的码字和解码结果
+        std::vector<uint16_t> m_channelPcm;
+        std::vector<uint16_t> m_decoded; // 已解码的交错采样
+        size_t m_decodedPos = 0;         // m_decoded 中已读取的帧数
+    };
+};
+
+#endif //AUDIO_FILE_READER_H
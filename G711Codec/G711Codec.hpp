@@ -5,6 +5,144 @@
 #ifndef AUDIO_CODEC_G711CODEC_HPP
 #define AUDIO_CODEC_G711CODEC_HPP
 
-// TODO
+#include <cstdint>
+#include <cstddef>
+
+// G.711 编解码(ITU-T G.711)，每个采样独立编码，没有状态
+// - A-law : 13bit 线性 PCM 压扩为 8bit，欧洲和其它地区使用
+// - mu-law: 14bit 线性 PCM 压扩为 8bit，北美和日本使用
+// 16bit PCM 按有符号数处理，与项目中其它模块一样使用 uint16_t 存储
+
+namespace G711Codec {
+
+    // LinearToALaw/ALawToLinear: 单个采样的 A-law 编解码
+    inline uint8_t LinearToALaw(int16_t pcm){
+        static const int16_t segEnd[8] = {0x1F, 0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF};
+
+        int value = pcm >> 3;
+        uint8_t mask = 0xD5;
+        if (value < 0) {
+            mask = 0x55;
+            value = -value - 1;
+        }
+
+        int seg = 0;
+        while (seg < 8 && value > segEnd[seg]) seg++;
+        if (seg >= 8) return (uint8_t)(0x7F ^ mask);
+
+        uint8_t aval = (uint8_t)(seg << 4);
+        aval |= (seg < 2) ? ((value >> 1) & 0x0F) : ((value >> seg) & 0x0F);
+        return (uint8_t)(aval ^ mask);
+    }
+
+    inline int16_t ALawToLinear(uint8_t alaw){
+        alaw ^= 0x55;
+        int t = (alaw & 0x0F) << 4;
+        int seg = (alaw & 0x70) >> 4;
+        if (seg == 0) {
+            t += 8;
+        } else {
+            t += 0x108;
+            if (seg > 1) t <<= seg - 1;
+        }
+        return (int16_t)((alaw & 0x80) ? t : -t);
+    }
+
+    // LinearToMuLaw/MuLawToLinear: 单个采样的 mu-law 编解码
+    inline uint8_t LinearToMuLaw(int16_t pcm){
+        static const int16_t segEnd[8] = {0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF, 0x1FFF};
+        const int kBias = 0x84;
+        const int kClip = 8159;
+
+        int value = pcm >> 2;
+        uint8_t mask = 0xFF;
+        if (value < 0) {
+            value = -value;
+            mask = 0x7F;
+        }
+        if (value > kClip) value = kClip;
+        value += (kBias >> 2);
+
+        int seg = 0;
+        while (seg < 8 && value > segEnd[seg]) seg++;
+        if (seg >= 8) return (uint8_t)(0x7F ^ mask);
+
+        uint8_t uval = (uint8_t)((seg << 4) | ((value >> (seg + 1)) & 0x0F));
+        return (uint8_t)(uval ^ mask);
+    }
+
+    inline int16_t MuLawToLinear(uint8_t ulaw){
+        const int kBias = 0x84;
+
+        ulaw = (uint8_t)~ulaw;
+        int t = ((ulaw & 0x0F) << 3) + kBias;
+        t <<= (ulaw & 0x70) >> 4;
+        return (int16_t)((ulaw & 0x80) ? (kBias - t) : (t - kBias));
+    }
+
+    // G711Tables: 查表实现
+    // A-law 只使用 16bit 采样的高 13bit，mu-law 只使用高 14bit，因此编码表覆盖了全部输入
+    struct G711Tables {
+        uint8_t alawEncode[1 << 13];
+        uint8_t ulawEncode[1 << 14];
+        int16_t alawDecode[256];
+        int16_t ulawDecode[256];
+
+        G711Tables(){
+            for (int i = 0; i < (1 << 13); i++) {
+                alawEncode[i] = LinearToALaw((int16_t)(i << 3));
+            }
+            for (int i = 0; i < (1 << 14); i++) {
+                ulawEncode[i] = LinearToMuLaw((int16_t)(i << 2));
+            }
+            for (int i = 0; i < 256; i++) {
+                alawDecode[i] = ALawToLinear((uint8_t)i);
+                ulawDecode[i] = MuLawToLinear((uint8_t)i);
+            }
+        }
+    };
+
+    // GetG711Tables: 编解码表，第一次使用时生成
+    inline const G711Tables& GetG711Tables(){
+        static const G711Tables tables;
+        return tables;
+    }
+
+    // ALawEncode/MuLawEncode: 编码一段 16bit PCM 数据
+    // * pcm   : PCM 采样
+    // * count : 采样个数
+    // * out   : 输出，count 个字节
+    inline void ALawEncode(const uint16_t* pcm, size_t count, uint8_t* out){
+        const uint8_t* table = GetG711Tables().alawEncode;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = table[pcm[i] >> 3];
+        }
+    }
+
+    inline void MuLawEncode(const uint16_t* pcm, size_t count, uint8_t* out){
+        const uint8_t* table = GetG711Tables().ulawEncode;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = table[pcm[i] >> 2];
+        }
+    }
+
+    // ALawDecode/MuLawDecode: 解码一段 G.711 数据为 16bit PCM
+    // * data  : G.711 数据
+    // * count : 采样个数(字节数)
+    // * out   : 输出，count 个采样
+    inline void ALawDecode(const uint8_t* data, size_t count, uint16_t* out){
+        const int16_t* table = GetG711Tables().alawDecode;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = (uint16_t)table[data[i]];
+        }
+    }
+
+    inline void MuLawDecode(const uint8_t* data, size_t count, uint16_t* out){
+        const int16_t* table = GetG711Tables().ulawDecode;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = (uint16_t)table[data[i]];
+        }
+    }
+}
 
 #endif //AUDIO_CODEC_G711CODEC_HPP
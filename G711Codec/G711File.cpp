@@ -0,0 +1,222 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "G711File.h"
+#include "WaveCodec/ByteSwap.h"
+#include "WaveCodec/WaveChunks.h"
+#include "AsyncIO/AsyncIO.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace G711Codec {
+
+    // 每段的帧数，16bit 单声道时每段读取 512KB
+    static const uint64_t kRangeFrames = 256 * 1024;
+
+    // TranscodeJob: 把 src 文件中的一段连续采样转换后写入 dst 文件
+    struct TranscodeJob {
+        int      srcFd     = -1;
+        uint64_t srcOffset = 0;     // 输入采样在 src 文件中的偏移
+        int      dstFd     = -1;
+        uint64_t dstOffset = 0;     // 输出采样在 dst 文件中的偏移
+        uint64_t samples   = 0;     // 采样个数(所有声道)
+        uint16_t channels  = 1;
+        uint16_t audio_format = WaveAudioFormatALaw;
+        bool     encode    = true;  // true: 16bit PCM -> G.711，false: G.711 -> 16bit PCM
+        bool     swapInput = false; // 输入的 16bit PCM 是否需要交换字节序
+    };
+
+    // 转换 [first, first + count) 个采样
+    static bool TranscodeRange(const TranscodeJob& job, uint64_t first, uint64_t count){
+        static thread_local std::vector<uint8_t> input;
+        static thread_local std::vector<uint8_t> output;
+
+        const uint32_t inBytes  = job.encode ? 2 : 1;
+        const uint32_t outBytes = job.encode ? 1 : 2;
+        input.resize((size_t)(count * inBytes));
+        output.resize((size_t)(count * outBytes));
+
+        int64_t nRead = AsyncIO::ReadFileAt(job.srcFd, &input[0], input.size(), job.srcOffset + first * inBytes);
+        if (nRead != (int64_t)input.size()) return false;
+
+        if (job.encode) {
+            uint16_t* pcm = (uint16_t*)&input[0];
+            if (job.swapInput) {
+                WaveCodec::ByteSwapSamples(&input[0], input.size(), 2);
+            }
+            if (job.audio_format == WaveAudioFormatALaw) {
+                ALawEncode(pcm, (size_t)count, &output[0]);
+            } else {
+                MuLawEncode(pcm, (size_t)count, &output[0]);
+            }
+        } else {
+            uint16_t* pcm = (uint16_t*)&output[0];
+            if (job.audio_format == WaveAudioFormatALaw) {
+                ALawDecode(&input[0], (size_t)count, pcm);
+            } else {
+                MuLawDecode(&input[0], (size_t)count, pcm);
+            }
+        }
+
+        int64_t nWrite = AsyncIO::WriteFileAt(job.dstFd, &output[0], output.size(), job.dstOffset + first * outBytes);
+        return nWrite == (int64_t)output.size();
+    }
+
+    // 把 job 按帧对齐切分为若干段，在线程池中并行转换
+    static bool RunTranscode(const TranscodeJob& job, AsyncIO::ThreadPool* pool){
+        std::unique_ptr<AsyncIO::ThreadPool> ownPool;
+        if (!pool) {
+            ownPool.reset(new AsyncIO::ThreadPool());
+            pool = ownPool.get();
+        }
+
+        const uint64_t rangeSamples = kRangeFrames * job.channels;
+        std::atomic<bool> failed(false);
+        for (uint64_t first = 0; first < job.samples; first += rangeSamples) {
+            uint64_t count = std::min(rangeSamples, job.samples - first);
+            pool->Submit([&job, &failed, first, count]{
+                if (failed) return;
+                if (!TranscodeRange(job, first, count)) failed = true;
+            });
+        }
+        pool->Wait();
+        return !failed;
+    }
+
+    // 预先分配输出文件，转换数据，最后写入文件头
+    static bool TranscodeFile(const TranscodeJob& job, const std::vector<uint8_t>& dstHeader, AsyncIO::ThreadPool* pool){
+        uint64_t dstSize = job.dstOffset + job.samples * (job.encode ? 1 : 2);
+        if (!AsyncIO::SetFileSize(job.dstFd, dstSize)) {
+            printf("allocate output file failed\n");
+            return false;
+        }
+
+        if (!RunTranscode(job, pool)) {
+            printf("g711 transcode failed\n");
+            return false;
+        }
+
+        if (!dstHeader.empty() && AsyncIO::WriteFileAt(job.dstFd, &dstHeader[0], dstHeader.size(), 0) != (int64_t)dstHeader.size()) {
+            printf("write header failed\n");
+            return false;
+        }
+        return true;
+    }
+
+    static bool IsG711Format(uint16_t audio_format){
+        return audio_format == WaveAudioFormatALaw || audio_format == WaveAudioFormatMuLaw;
+    }
+
+    // 转换 Wave 文件
+    static bool TranscodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, bool encode, uint16_t audio_format,
+                                  AsyncIO::ThreadPool* pool){
+        WaveCodec::WaveHeader header;
+        uint64_t dataOffset = 0;
+        uint64_t dataSize = 0;
+        {
+            WaveCodec::RiffChunkDirectory dir;
+            if (!dir.Open(srcWaveFilePath) || !dir.GetWaveHeader(header, dataOffset, dataSize)) {
+                printf("invalid wave file, %s\n", srcWaveFilePath.c_str());
+                return false;
+            }
+        }
+
+        const WaveCodec::SubChunkFmt& fmt = header.riff.fmt;
+        if (encode && (fmt.audio_format != WaveAudioFormatPCM || fmt.bits_per_sample != 16)) {
+            printf("only 16bit pcm wave file can be encoded, audio_format:%d, sample_bits:%d\n", fmt.audio_format, fmt.bits_per_sample);
+            return false;
+        }
+        if (!encode && (!IsG711Format(fmt.audio_format) || fmt.bits_per_sample != 8)) {
+            printf("not a g711 wave file, audio_format:%d, sample_bits:%d\n", fmt.audio_format, fmt.bits_per_sample);
+            return false;
+        }
+        if (fmt.channels == 0) return false;
+
+        TranscodeJob job;
+        job.srcFd = AsyncIO::OpenFileForRead(srcWaveFilePath);
+        job.dstFd = AsyncIO::OpenFileForWrite(dstWaveFilePath);
+        if (job.srcFd < 0 || job.dstFd < 0) {
+            printf("open file failed\n");
+            AsyncIO::CloseFile(job.srcFd);
+            AsyncIO::CloseFile(job.dstFd);
+            return false;
+        }
+
+        // data 子块的大小已按文件实际大小截断，丢弃末尾不完整的帧
+        uint64_t samples = encode ? dataSize / 2 : dataSize;
+        samples -= samples % fmt.channels;
+
+        job.srcOffset = dataOffset;
+        job.samples = samples;
+        job.channels = fmt.channels;
+        job.audio_format = encode ? audio_format : fmt.audio_format;
+        job.encode = encode;
+        job.swapInput = encode && (header.IsBigEndian() == WaveCodec::IsLittleEndianHost());
+
+        WaveCodec::WaveHeader dstHeader;
+        if (encode) {
+            dstHeader.FormatG711WaveHeader(audio_format, fmt.sample_rate, 8, fmt.channels, (uint32_t)samples);
+        } else {
+            dstHeader.FormatPCMWaveHeader(fmt.sample_rate, 16, fmt.channels, (uint32_t)(samples * 2));
+        }
+        std::vector<uint8_t> headerBuffer;
+        dstHeader.ToBuffer(headerBuffer);
+        job.dstOffset = headerBuffer.size();
+
+        bool ret = TranscodeFile(job, headerBuffer, pool);
+        AsyncIO::CloseFile(job.srcFd);
+        AsyncIO::CloseFile(job.dstFd);
+        return ret;
+    }
+
+    // 转换裸数据文件
+    static bool TranscodeRawFile(const std::string& srcFilePath, const std::string& dstFilePath, bool encode, uint16_t audio_format,
+                                 uint16_t channels, AsyncIO::ThreadPool* pool){
+        if (!IsG711Format(audio_format) || channels == 0) return false;
+
+        TranscodeJob job;
+        job.srcFd = AsyncIO::OpenFileForRead(srcFilePath);
+        job.dstFd = AsyncIO::OpenFileForWrite(dstFilePath);
+        if (job.srcFd < 0 || job.dstFd < 0) {
+            printf("open file failed\n");
+            AsyncIO::CloseFile(job.srcFd);
+            AsyncIO::CloseFile(job.dstFd);
+            return false;
+        }
+
+        int64_t srcFileSize = AsyncIO::GetFileSize(job.srcFd);
+        job.samples = srcFileSize > 0 ? (uint64_t)srcFileSize / (encode ? 2 : 1) : 0;
+        job.samples -= job.samples % channels;
+        job.channels = channels;
+        job.audio_format = audio_format;
+        job.encode = encode;
+
+        bool ret = TranscodeFile(job, std::vector<uint8_t>(), pool);
+        AsyncIO::CloseFile(job.srcFd);
+        AsyncIO::CloseFile(job.dstFd);
+        return ret;
+    }
+
+    bool G711EncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, uint16_t audio_format, AsyncIO::ThreadPool* pool){
+        if (!IsG711Format(audio_format)) return false;
+        return TranscodeWaveFile(srcWaveFilePath, dstWaveFilePath, true, audio_format, pool);
+    }
+
+    bool G711DecodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, AsyncIO::ThreadPool* pool){
+        return TranscodeWaveFile(srcWaveFilePath, dstWaveFilePath, false, WaveAudioFormatUnknown, pool);
+    }
+
+    bool G711EncodePCMFile(const std::string& srcPCMFilePath, const std::string& dstG711FilePath, uint16_t audio_format, uint16_t channels,
+                           AsyncIO::ThreadPool* pool){
+        return TranscodeRawFile(srcPCMFilePath, dstG711FilePath, true, audio_format, channels, pool);
+    }
+
+    bool G711DecodePCMFile(const std::string& srcG711FilePath, const std::string& dstPCMFilePath, uint16_t audio_format, uint16_t channels,
+                           AsyncIO::ThreadPool* pool){
+        return TranscodeRawFile(srcG711FilePath, dstPCMFilePath, false, audio_format, channels, pool);
+    }
+}
@@ -0,0 +1,42 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef G711_FILE_H_
+#define G711_FILE_H_
+
+#include <string>
+#include <cstdint>
+
+#include "G711Codec.hpp"
+#include "WaveCodec/WaveFile.h"
+#include "AsyncIO/ThreadPool.h"
+
+namespace G711Codec {
+
+    // 文件级的 G.711 编解码
+    // G.711 每个采样独立编码，输入被切分为若干段(按帧对齐)，每段在线程池中独立地按偏移读取、转换、写入预先分配好的输出文件
+    // 各段之间没有依赖，处理速度随线程数线性增长；输出的 Wave Header 在所有段完成后一次写入
+
+    // G711EncodeWaveFile: 将 16bit PCM Wave 文件编码为 G.711 Wave 文件
+    // * srcWaveFilePath : 源 Wave 文件，16bit PCM，支持 RIFX
+    // * dstWaveFilePath : 输出 Wave 文件
+    // * audio_format    : WaveAudioFormatALaw 或 WaveAudioFormatMuLaw
+    // * pool            : 线程池，为空时内部按 CPU 核数创建一个；批量处理多个文件时可复用同一个线程池
+    bool G711EncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, uint16_t audio_format,
+                            AsyncIO::ThreadPool* pool = nullptr);
+
+    // G711DecodeWaveFile: 将 G.711 Wave 文件解码为 16bit PCM Wave 文件
+    bool G711DecodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, AsyncIO::ThreadPool* pool = nullptr);
+
+    // G711EncodePCMFile: 将 16bit PCM 文件编码为 G.711 裸数据文件
+    // * channels : 声道数，用于按帧切分
+    bool G711EncodePCMFile(const std::string& srcPCMFilePath, const std::string& dstG711FilePath, uint16_t audio_format, uint16_t channels,
+                           AsyncIO::ThreadPool* pool = nullptr);
+
+    // G711DecodePCMFile: 将 G.711 裸数据文件解码为 16bit PCM 文件
+    bool G711DecodePCMFile(const std::string& srcG711FilePath, const std::string& dstPCMFilePath, uint16_t audio_format, uint16_t channels,
+                           AsyncIO::ThreadPool* pool = nullptr);
+}
+
+#endif //G711_FILE_H_
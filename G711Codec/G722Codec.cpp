@@ -0,0 +1,514 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "G722Codec.h"
+#include "WaveCodec/WaveFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace G711Codec {
+
+    // 每次 QMF 滤波处理的字节数，对应 20ms
+    static const size_t kBlockCodes = 160;
+
+    // QMF 滤波器系数 h[0..11]，24 阶滤波器对称
+    static const int16_t kQmfCoeffs[12] = {3, -11, 12, 32, -210, 951, 3876, -805, 362, -156, 53, -11};
+
+    // 按 24 个交错的历史采样 x[0..23] 排列的系数，x[2i] 乘 h[i]，x[2i+1] 乘 h[11-i]
+    // 分析: xlow = sum(x * kAnalysisLow) >> 14, xhigh = sum(x * kAnalysisHigh) >> 14
+    // 合成: xout1 = sum(x * kSynthesisOdd) >> 11, xout2 = sum(x * kSynthesisEven) >> 11
+    struct QmfTables {
+        int16_t analysisLow[24];
+        int16_t analysisHigh[24];
+        int16_t synthesisOdd[24];
+        int16_t synthesisEven[24];
+
+        QmfTables() {
+            for (int i = 0; i < 12; i++) {
+                analysisLow[2 * i] = kQmfCoeffs[i];
+                analysisLow[2 * i + 1] = kQmfCoeffs[11 - i];
+                analysisHigh[2 * i] = -kQmfCoeffs[i];
+                analysisHigh[2 * i + 1] = kQmfCoeffs[11 - i];
+                synthesisOdd[2 * i] = 0;
+                synthesisOdd[2 * i + 1] = kQmfCoeffs[11 - i];
+                synthesisEven[2 * i] = kQmfCoeffs[i];
+                synthesisEven[2 * i + 1] = 0;
+            }
+        }
+    };
+    static const QmfTables kQmf;
+
+    // 低子带 6bit 量化的判决门限
+    static const int16_t kQ6[32] = {
+        0,    35,   72,   110,  150,  190,  233,  276,  323,  370,  422,  473,  530,  587,  650,  714,
+        786,  858,  940,  1023, 1121, 1219, 1339, 1458, 1612, 1765, 1980, 2195, 2557, 2919, 0,    0,
+    };
+    // 判决区间 -> 码字
+    static const int8_t kILN[32] = {
+        0,  63, 62, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19,
+        18, 17, 16, 15, 14, 13, 12, 11, 10, 9,  8,  7,  6,  5,  4,  0,
+    };
+    static const int8_t kILP[32] = {
+        0,  61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47,
+        46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 0,
+    };
+    // 低子带步长自适应
+    static const int16_t kWL[8] = {-60, -30, 58, 172, 334, 538, 1198, 3042};
+    static const int8_t kRL42[16] = {0, 7, 6, 5, 4, 3, 2, 1, 7, 6, 5, 4, 3, 2, 1, 0};
+    // 2^(i/32) 的反对数表
+    static const int16_t kILB[32] = {
+        2048, 2093, 2139, 2186, 2233, 2282, 2332, 2383, 2435, 2489, 2543, 2599, 2656, 2714, 2774, 2834,
+        2896, 2960, 3025, 3091, 3158, 3228, 3298, 3371, 3444, 3520, 3597, 3676, 3756, 3838, 3922, 4008,
+    };
+    // 逆量化表，按低子带 4/5/6bit 码字索引
+    static const int16_t kQM4[16] = {
+        0,     -20456, -12896, -8968, -6288, -4240, -2584, -1200,
+        20456, 12896,  8968,   6288,  4240,  2584,  1200,  0,
+    };
+    static const int16_t kQM5[32] = {
+        -280,  -280,  -23352, -17560, -14120, -11664, -9752, -8184,
+        -6864, -5712, -4696,  -3784,  -2960,  -2208,  -1520, -880,
+        23352, 17560, 14120,  11664,  9752,   8184,   6864,  5712,
+        4696,  3784,  2960,   2208,   1520,   880,    280,   -280,
+    };
+    static const int16_t kQM6[64] = {
+        -136,   -136,   -136,   -136,   -24808, -21904, -19008, -16704,
+        -14984, -13512, -12280, -11192, -10232, -9360,  -8576,  -7856,
+        -7192,  -6576,  -6000,  -5456,  -4944,  -4464,  -4008,  -3576,
+        -3168,  -2776,  -2400,  -2032,  -1688,  -1360,  -1040,  -728,
+        24808,  21904,  19008,  16704,  14984,  13512,  12280,  11192,
+        10232,  9360,   8576,   7856,   7192,   6576,   6000,   5456,
+        4944,   4464,   4008,   3576,   3168,   2776,   2400,   2032,
+        1688,   1360,   1040,   728,    432,    136,    -432,   -136,
+    };
+    // 高子带 2bit 量化
+    static const int8_t kIHN[3] = {0, 1, 0};
+    static const int8_t kIHP[3] = {0, 3, 2};
+    static const int16_t kWH[3] = {0, -214, 798};
+    static const int8_t kRH2[4] = {2, 1, 2, 1};
+    static const int16_t kQM2[4] = {-7408, -1616, 7408, 1616};
+
+    static inline int16_t Saturate(int32_t v) {
+        if (v > 32767) return 32767;
+        if (v < -32768) return -32768;
+        return (int16_t)v;
+    }
+
+    static void ResetBand(G722Band& band, int16_t det) {
+        memset(&band, 0, sizeof(band));
+        band.det = det;
+    }
+
+    // 由对数步长 nb 计算步长 det，shift 低子带为 8，高子带为 10
+    static inline int16_t ScaleFactor(int16_t nb, int shift) {
+        int wd1 = (nb >> 6) & 31;
+        int wd2 = shift - (nb >> 11);
+        int wd3 = (wd2 < 0) ? (kILB[wd1] << -wd2) : (kILB[wd1] >> wd2);
+        return (int16_t)(wd3 << 2);
+    }
+
+    // 用量化差值 d 更新子带的自适应预测器(RECONS/PARREC/UPPOL2/UPPOL1/UPZERO/DELAYA/FILTEP/FILTEZ/PREDIC)
+    static void UpdatePredictor(G722Band& band, int16_t d) {
+        int wd1, wd2, wd3;
+
+        // RECONS/PARREC
+        band.d[0] = d;
+        band.r[0] = Saturate(band.s + d);
+        band.p[0] = Saturate(band.sz + d);
+
+        // UPPOL2
+        int sg0 = band.p[0] >> 15, sg1 = band.p[1] >> 15, sg2 = band.p[2] >> 15;
+        wd1 = Saturate(band.a[1] * 4);
+        wd2 = (sg0 == sg1) ? -wd1 : wd1;
+        if (wd2 > 32767) wd2 = 32767;
+        wd3 = (wd2 >> 7) + ((sg0 == sg2) ? 128 : -128);
+        wd3 += (band.a[2] * 32512) >> 15;
+        if (wd3 > 12288) wd3 = 12288;
+        else if (wd3 < -12288) wd3 = -12288;
+        int16_t ap2 = (int16_t)wd3;
+
+        // UPPOL1
+        wd1 = (sg0 == sg1) ? 192 : -192;
+        wd2 = (band.a[1] * 32640) >> 15;
+        int ap1 = Saturate(wd1 + wd2);
+        wd3 = Saturate(15360 - ap2);
+        if (ap1 > wd3) ap1 = wd3;
+        else if (ap1 < -wd3) ap1 = -wd3;
+
+        // UPZERO/DELAYA
+        wd1 = (d == 0) ? 0 : 128;
+        int sgd = d >> 15;
+        for (int i = 6; i > 0; i--) {
+            wd2 = ((band.d[i] >> 15) == sgd) ? wd1 : -wd1;
+            wd3 = (band.b[i] * 32640) >> 15;
+            band.b[i] = Saturate(wd2 + wd3);
+            band.d[i] = band.d[i - 1];
+        }
+        band.r[2] = band.r[1];
+        band.r[1] = band.r[0];
+        band.p[2] = band.p[1];
+        band.p[1] = band.p[0];
+        band.a[2] = ap2;
+        band.a[1] = (int16_t)ap1;
+
+        // FILTEP
+        wd1 = (band.a[1] * Saturate(band.r[1] * 2)) >> 15;
+        wd2 = (band.a[2] * Saturate(band.r[2] * 2)) >> 15;
+        int sp = Saturate(wd1 + wd2);
+
+        // FILTEZ
+        int sz = 0;
+        for (int i = 6; i > 0; i--) {
+            sz += (band.b[i] * Saturate(band.d[i] * 2)) >> 15;
+        }
+        band.sz = Saturate(sz);
+
+        // PREDIC
+        band.s = Saturate(sp + band.sz);
+    }
+
+    // 低子带步长自适应(LOGSCL/SCALEL)，ril 为 4bit 码字
+    static inline void AdaptLow(G722Band& band, int ril) {
+        int nb = ((band.nb * 127) >> 7) + kWL[kRL42[ril]];
+        band.nb = (int16_t)std::min(std::max(nb, 0), 18432);
+        band.det = ScaleFactor(band.nb, 8);
+    }
+
+    // 高子带步长自适应(LOGSCH/SCALEH)
+    static inline void AdaptHigh(G722Band& band, int ihigh) {
+        int nb = ((band.nb * 127) >> 7) + kWH[kRH2[ihigh]];
+        band.nb = (int16_t)std::min(std::max(nb, 0), 22528);
+        band.det = ScaleFactor(band.nb, 10);
+    }
+
+    // 24 个交错采样 x 分别与两组系数的点积
+    static inline void QmfDot(const int16_t* x, const int16_t* k1, const int16_t* k2, int32_t& r1, int32_t& r2) {
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128i x0 = _mm_loadu_si128((const __m128i*)x);
+        __m128i x1 = _mm_loadu_si128((const __m128i*)(x + 8));
+        __m128i x2 = _mm_loadu_si128((const __m128i*)(x + 16));
+        __m128i a = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(x0, _mm_loadu_si128((const __m128i*)k1)),
+                                                _mm_madd_epi16(x1, _mm_loadu_si128((const __m128i*)(k1 + 8)))),
+                                  _mm_madd_epi16(x2, _mm_loadu_si128((const __m128i*)(k1 + 16))));
+        __m128i b = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(x0, _mm_loadu_si128((const __m128i*)k2)),
+                                                _mm_madd_epi16(x1, _mm_loadu_si128((const __m128i*)(k2 + 8)))),
+                                  _mm_madd_epi16(x2, _mm_loadu_si128((const __m128i*)(k2 + 16))));
+        // [a0+a2, b0+b2, a1+a3, b1+b3] -> [a, b, ...]
+        __m128i t = _mm_add_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+        t = _mm_add_epi32(t, _mm_srli_si128(t, 8));
+        r1 = _mm_cvtsi128_si32(t);
+        r2 = _mm_cvtsi128_si32(_mm_srli_si128(t, 4));
+#elif defined(__ARM_NEON)
+        int32x4_t a = vdupq_n_s32(0), b = vdupq_n_s32(0);
+        for (int i = 0; i < 24; i += 8) {
+            int16x8_t v = vld1q_s16(x + i);
+            int16x8_t c1 = vld1q_s16(k1 + i);
+            int16x8_t c2 = vld1q_s16(k2 + i);
+            a = vmlal_s16(a, vget_low_s16(v), vget_low_s16(c1));
+            a = vmlal_s16(a, vget_high_s16(v), vget_high_s16(c1));
+            b = vmlal_s16(b, vget_low_s16(v), vget_low_s16(c2));
+            b = vmlal_s16(b, vget_high_s16(v), vget_high_s16(c2));
+        }
+        int32x2_t s = vpadd_s32(vadd_s32(vget_low_s32(a), vget_high_s32(a)), vadd_s32(vget_low_s32(b), vget_high_s32(b)));
+        r1 = vget_lane_s32(s, 0);
+        r2 = vget_lane_s32(s, 1);
+#else
+        int32_t s1 = 0, s2 = 0;
+        for (int i = 0; i < 24; i++) {
+            s1 += x[i] * k1[i];
+            s2 += x[i] * k2[i];
+        }
+        r1 = s1;
+        r2 = s2;
+#endif
+    }
+
+    ///////////////////////////////////////////////////
+    // G722Encoder
+    G722Encoder::G722Encoder(G722Mode mode) : m_mode(mode) {
+        Reset();
+    }
+
+    void G722Encoder::Reset() {
+        ResetBand(m_band[0], 32);
+        ResetBand(m_band[1], 8);
+        memset(m_qmf, 0, sizeof(m_qmf));
+        m_pending = 0;
+        m_hasPending = false;
+    }
+
+    uint8_t G722Encoder::EncodeSample(int16_t xlow, int16_t xhigh) {
+        // 低子带 SUBTRA/QUANTL
+        G722Band& low = m_band[0];
+        int el = Saturate(xlow - low.s);
+        int wd = (el >= 0) ? el : -(el + 1);
+        int i = 1;
+        for (; i < 30; i++) {
+            if (wd < ((kQ6[i] * low.det) >> 12)) break;
+        }
+        int ilow = (el < 0) ? kILN[i] : kILP[i];
+
+        // 预测器只使用 4bit 码字，三种模式的编码器状态相同
+        int ril = ilow >> 2;
+        int16_t dlow = (int16_t)((low.det * kQM4[ril]) >> 15);
+        AdaptLow(low, ril);
+        UpdatePredictor(low, dlow);
+
+        // 高子带 SUBTRA/QUANTH
+        G722Band& high = m_band[1];
+        int eh = Saturate(xhigh - high.s);
+        wd = (eh >= 0) ? eh : -(eh + 1);
+        int mih = (wd >= ((564 * high.det) >> 12)) ? 2 : 1;
+        int ihigh = (eh < 0) ? kIHN[mih] : kIHP[mih];
+
+        int16_t dhigh = (int16_t)((high.det * kQM2[ihigh]) >> 15);
+        AdaptHigh(high, ihigh);
+        UpdatePredictor(high, dhigh);
+
+        // 模式 2/3 的辅助数据位置 0
+        uint8_t auxMask = (uint8_t)((1 << (m_mode - 1)) - 1);
+        return (uint8_t)(((ihigh << 6) | ilow) & ~auxMask);
+    }
+
+    size_t G722Encoder::Encode(const uint16_t* pcm, size_t count, uint8_t* codes) {
+        if (!pcm || !codes) return 0;
+
+        // window: 22 个历史采样 + 本块的采样，第 k 个输出使用 window[2k .. 2k+24)
+        int16_t window[22 + kBlockCodes * 2];
+        size_t produced = 0;
+        size_t used = 0;
+        while (used < count) {
+            memcpy(window, m_qmf, sizeof(m_qmf));
+            size_t n = 22;
+            if (m_hasPending) {
+                window[n++] = m_pending;
+                m_hasPending = false;
+            }
+            size_t take = std::min(count - used, sizeof(window) / sizeof(window[0]) - n);
+            memcpy(window + n, pcm + used, take * sizeof(int16_t));
+            n += take;
+            used += take;
+
+            size_t pairs = (n - 22) / 2;
+            if ((n - 22) & 1) {
+                m_pending = window[n - 1];
+                m_hasPending = true;
+            }
+            if (pairs == 0) break;
+
+            // QMF 分析滤波，xlow = (sumeven + sumodd) >> 14, xhigh = (sumeven - sumodd) >> 14
+            for (size_t k = 0; k < pairs; k++) {
+                int32_t sumLow, sumHigh;
+                QmfDot(window + 2 * k, kQmf.analysisLow, kQmf.analysisHigh, sumLow, sumHigh);
+                codes[produced++] = EncodeSample((int16_t)(sumLow >> 14), (int16_t)(sumHigh >> 14));
+            }
+            memcpy(m_qmf, window + 2 * pairs, sizeof(m_qmf));
+        }
+        return produced;
+    }
+
+    ///////////////////////////////////////////////////
+    // G722Decoder
+    G722Decoder::G722Decoder(G722Mode mode) : m_mode(mode) {
+        Reset();
+    }
+
+    void G722Decoder::Reset() {
+        ResetBand(m_band[0], 32);
+        ResetBand(m_band[1], 8);
+        memset(m_qmf, 0, sizeof(m_qmf));
+    }
+
+    void G722Decoder::DecodeSample(uint8_t code, int16_t& rlow, int16_t& rhigh) {
+        // 按模式选择低子带的逆量化表，ril 为预测器使用的 4bit 码字
+        int ilow = code & 0x3F;
+        int ihigh = code >> 6;
+        int ril = ilow >> 2;
+        int wd2;
+        if (m_mode == G722Mode64k) {
+            wd2 = kQM6[ilow];
+        } else if (m_mode == G722Mode56k) {
+            wd2 = kQM5[ilow >> 1];
+        } else {
+            wd2 = kQM4[ril];
+        }
+
+        // 低子带 INVQBL/RECONS/LIMIT
+        G722Band& low = m_band[0];
+        int r = low.s + ((low.det * wd2) >> 15);
+        rlow = (int16_t)std::min(std::max(r, -16384), 16383);
+
+        int16_t dlow = (int16_t)((low.det * kQM4[ril]) >> 15);
+        AdaptLow(low, ril);
+        UpdatePredictor(low, dlow);
+
+        // 高子带 INVQAH/RECONS/LIMIT
+        G722Band& high = m_band[1];
+        int16_t dhigh = (int16_t)((high.det * kQM2[ihigh]) >> 15);
+        r = high.s + dhigh;
+        rhigh = (int16_t)std::min(std::max(r, -16384), 16383);
+
+        AdaptHigh(high, ihigh);
+        UpdatePredictor(high, dhigh);
+    }
+
+    size_t G722Decoder::Decode(const uint8_t* codes, size_t count, uint16_t* pcm) {
+        if (!codes || !pcm) return 0;
+
+        int16_t window[22 + kBlockCodes * 2];
+        size_t produced = 0;
+        for (size_t first = 0; first < count; first += kBlockCodes) {
+            size_t n = std::min(kBlockCodes, count - first);
+            memcpy(window, m_qmf, sizeof(m_qmf));
+            for (size_t k = 0; k < n; k++) {
+                int16_t rlow, rhigh;
+                DecodeSample(codes[first + k], rlow, rhigh);
+                window[22 + 2 * k] = (int16_t)(rlow + rhigh);
+                window[23 + 2 * k] = (int16_t)(rlow - rhigh);
+            }
+
+            // QMF 合成滤波，每个字节输出 2 个采样
+            for (size_t k = 0; k < n; k++) {
+                int32_t xout1, xout2;
+                QmfDot(window + 2 * k, kQmf.synthesisOdd, kQmf.synthesisEven, xout1, xout2);
+                pcm[produced++] = (uint16_t)Saturate(xout1 >> 11);
+                pcm[produced++] = (uint16_t)Saturate(xout2 >> 11);
+            }
+            memcpy(m_qmf, window + 2 * n, sizeof(m_qmf));
+        }
+        return produced;
+    }
+
+    ///////////////////////////////////////////////////
+    // 文件
+    static const uint32_t kFileBlockCodes = 4096; // 每个声道每次处理的字节数
+
+    bool G722EncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, G722Mode mode) {
+        WaveCodec::WaveFileReader reader;
+        WaveCodec::WaveHeader header;
+        if (!reader.Open(srcWaveFilePath) || !reader.ReadWaveHeader(header)) {
+            printf("invalid wave file, %s\n", srcWaveFilePath.c_str());
+            return false;
+        }
+        const WaveCodec::SubChunkFmt& fmt = header.riff.fmt;
+        if (fmt.audio_format != WaveAudioFormatPCM || fmt.bits_per_sample != 16 || fmt.sample_rate != 16000 || fmt.channels == 0) {
+            printf("only 16kHz 16bit pcm wave file can be encoded, audio_format:%d, sample_rate:%d, sample_bits:%d\n",
+                   fmt.audio_format, fmt.sample_rate, fmt.bits_per_sample);
+            return false;
+        }
+
+        WaveCodec::WaveFileWriter writer;
+        if (!writer.Open(dstWaveFilePath, WaveAudioFormatG722, fmt.sample_rate, 4, fmt.channels)) {
+            printf("open output file failed, %s\n", dstWaveFilePath.c_str());
+            return false;
+        }
+
+        const uint16_t channels = fmt.channels;
+        std::vector<G722Encoder> encoders(channels, G722Encoder(mode));
+
+        // 只读取 data 子块中完整的帧对，流式写入的文件 data 大小可能为 0，此时读到文件末尾
+        uint64_t shortsLeft = header.riff.data.header.size / 2;
+        if (shortsLeft == 0) shortsLeft = UINT64_MAX;
+        shortsLeft -= shortsLeft % (channels * 2);
+
+        std::vector<uint16_t> samples;
+        std::vector<uint16_t> channel(kFileBlockCodes * 2);
+        std::vector<uint8_t> codes(kFileBlockCodes);
+        std::vector<uint8_t> output;
+        while (shortsLeft > 0) {
+            uint32_t toRead = (uint32_t)std::min<uint64_t>((uint64_t)kFileBlockCodes * 2 * channels, shortsLeft);
+            size_t nRead = reader.ReadShorts(toRead, samples);
+            size_t frames = nRead / channels;
+            if (frames < 2) break;
+            frames -= frames % 2;
+            shortsLeft -= std::min<uint64_t>(nRead, shortsLeft);
+
+            if (channels == 1) {
+                writer.Write(codes.data(), (uint32_t)encoders[0].Encode(samples.data(), frames, codes.data()));
+                continue;
+            }
+
+            output.resize(frames / 2 * channels);
+            for (uint16_t ch = 0; ch < channels; ch++) {
+                for (size_t i = 0; i < frames; i++) {
+                    channel[i] = samples[i * channels + ch];
+                }
+                size_t n = encoders[ch].Encode(channel.data(), frames, codes.data());
+                for (size_t i = 0; i < n; i++) {
+                    output[i * channels + ch] = codes[i];
+                }
+            }
+            writer.Write(output);
+        }
+        writer.Close();
+        return true;
+    }
+
+    bool G722DecodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, G722Mode mode) {
+        WaveCodec::WaveFileReader reader;
+        WaveCodec::WaveHeader header;
+        if (!reader.Open(srcWaveFilePath) || !reader.ReadWaveHeader(header)) {
+            printf("invalid wave file, %s\n", srcWaveFilePath.c_str());
+            return false;
+        }
+        const WaveCodec::SubChunkFmt& fmt = header.riff.fmt;
+        if (fmt.audio_format != WaveAudioFormatG722 || fmt.channels == 0) {
+            printf("not a g722 wave file, audio_format:%d\n", fmt.audio_format);
+            return false;
+        }
+
+        WaveCodec::WaveFileWriter writer;
+        if (!writer.Open(dstWaveFilePath, WaveAudioFormatPCM, 16000, 16, fmt.channels)) {
+            printf("open output file failed, %s\n", dstWaveFilePath.c_str());
+            return false;
+        }
+
+        const uint16_t channels = fmt.channels;
+        std::vector<G722Decoder> decoders(channels, G722Decoder(mode));
+
+        uint64_t bytesLeft = header.riff.data.header.size;
+        if (bytesLeft == 0) bytesLeft = UINT64_MAX;
+        bytesLeft -= bytesLeft % channels;
+
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> codes(kFileBlockCodes);
+        std::vector<uint16_t> pcm(kFileBlockCodes * 2);
+        std::vector<uint16_t> output;
+        while (bytesLeft > 0) {
+            uint32_t toRead = (uint32_t)std::min<uint64_t>((uint64_t)kFileBlockCodes * channels, bytesLeft);
+            size_t nRead = reader.ReadBytes(toRead, input);
+            size_t n = nRead / channels;
+            if (n == 0) break;
+            bytesLeft -= std::min<uint64_t>(nRead, bytesLeft);
+
+            if (channels == 1) {
+                writer.Write(pcm.data(), (uint32_t)decoders[0].Decode(input.data(), n, pcm.data()));
+                continue;
+            }
+
+            output.resize(n * 2 * channels);
+            for (uint16_t ch = 0; ch < channels; ch++) {
+                for (size_t i = 0; i < n; i++) {
+                    codes[i] = input[i * channels + ch];
+                }
+                size_t samples = decoders[ch].Decode(codes.data(), n, pcm.data());
+                for (size_t i = 0; i < samples; i++) {
+                    output[i * channels + ch] = pcm[i];
+                }
+            }
+            writer.Write(output);
+        }
+        writer.Close();
+        return true;
+    }
+}
@@ -0,0 +1,116 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef G722_CODEC_H_
+#define G722_CODEC_H_
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace G711Codec {
+
+    // G722Mode: G.722 的三种工作模式，决定解码时低子带使用的比特数
+    // 码流格式相同，每 2 个 16kHz 采样对应 1 个字节: 高 2 位为高子带，低 6 位为低子带；
+    // 模式 2/3 中低子带的最低 1/2 位是辅助数据位，编码器写 0，解码器忽略
+    enum G722Mode {
+        G722Mode64k = 1, // 64kbit/s，低子带 6 bit
+        G722Mode56k = 2, // 56kbit/s，低子带 5 bit
+        G722Mode48k = 3, // 48kbit/s，低子带 4 bit
+    };
+
+    // G722Band: 一个子带的自适应预测器和量化步长状态，全部为 16bit
+    struct G722Band {
+        int16_t s;      // 预测值
+        int16_t sz;     // 零点部分的预测值
+        int16_t r[3];   // 重建信号 r[0] 当前，r[1]/r[2] 延迟
+        int16_t a[3];   // 极点系数 a[1]/a[2]
+        int16_t p[3];   // 部分重建信号
+        int16_t d[7];   // 量化差值 d[0] 当前，d[1..6] 延迟
+        int16_t b[7];   // 零点系数 b[1..6]
+        int16_t nb;     // 对数量化步长
+        int16_t det;    // 量化步长
+    };
+
+    /*example code
+
+        G722Encoder encoder;
+        G722Decoder decoder;
+        uint16_t pcm[320];            // 20ms, 16kHz
+        uint8_t codes[160];
+        size_t n = encoder.Encode(pcm, 320, codes);
+        decoder.Decode(codes, n, pcm);
+    */
+
+    // G722Encoder: G.722 编码器(ITU-T G.722，16kHz 16bit 单声道)
+    // 24 阶 QMF 分析滤波按块计算，每个输出用 3 次 16bit 乘加(SSE2 _mm_madd_epi16 / NEON vmlal)完成，
+    // 再逐个采样做两个子带的 ADPCM；状态只有两个子带和 22 个 QMF 历史采样(约 160 字节)，可以同时保存大量的流
+    // 分块调用与一次性编码的结果相同，奇数个采样时最后一个采样留到下一次调用
+    class G722Encoder {
+    public:
+        explicit G722Encoder(G722Mode mode = G722Mode64k);
+
+        // Encode: 编码一段 16bit PCM
+        // * pcm     : 16kHz 单声道采样
+        // * count   : 采样个数
+        // * codes   : 输出，至少 (count + 1) / 2 个字节
+        // * 返回值   : 输出的字节数
+        size_t Encode(const uint16_t* pcm, size_t count, uint8_t* codes);
+
+        G722Mode GetMode() const { return m_mode; }
+
+        // Reset: 恢复初始状态，开始编码新的音频
+        void Reset();
+
+    private:
+        uint8_t EncodeSample(int16_t xlow, int16_t xhigh);
+
+        G722Mode m_mode;
+        G722Band m_band[2];     // 低子带、高子带
+        int16_t m_qmf[22];      // QMF 最近的 22 个输入采样，m_qmf[21] 最新
+        int16_t m_pending;      // 未成对的输入采样
+        bool m_hasPending;
+    };
+
+    // G722Decoder: G.722 解码器，输出 16kHz 16bit 单声道
+    // 先逐个字节做两个子带的 ADPCM 解码，再按块做 24 阶 QMF 合成滤波(SIMD)
+    class G722Decoder {
+    public:
+        explicit G722Decoder(G722Mode mode = G722Mode64k);
+
+        // Decode: 解码一段 G.722 码流
+        // * codes   : 码流
+        // * count   : 字节数
+        // * pcm     : 输出，count * 2 个采样
+        // * 返回值   : 输出的采样个数
+        size_t Decode(const uint8_t* codes, size_t count, uint16_t* pcm);
+
+        G722Mode GetMode() const { return m_mode; }
+
+        // Reset: 恢复初始状态，开始解码新的码流
+        void Reset();
+
+    private:
+        void DecodeSample(uint8_t code, int16_t& rlow, int16_t& rhigh);
+
+        G722Mode m_mode;
+        G722Band m_band[2];
+        int16_t m_qmf[22];
+    };
+
+    // 文件级的 G.722 编解码，通过 WaveFileReader/WaveFileWriter 读写
+    // ADPCM 的状态依赖前面所有的采样，不能像 G.711 一样切分并行，每个声道使用独立的编解码器顺序处理
+    // 多声道时码流按字节交错，每个字节对应一个声道的 2 个采样
+
+    // G722EncodeWaveFile: 将 16kHz 16bit PCM Wave 文件编码为 G.722 Wave 文件
+    // * srcWaveFilePath : 源 Wave 文件，16kHz 16bit PCM，支持 RIFX
+    // * dstWaveFilePath : 输出 Wave 文件，audio_format 为 WaveAudioFormatG722
+    // * mode            : 工作模式
+    bool G722EncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, G722Mode mode = G722Mode64k);
+
+    // G722DecodeWaveFile: 将 G.722 Wave 文件解码为 16kHz 16bit PCM Wave 文件
+    bool G722DecodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, G722Mode mode = G722Mode64k);
+}
+
+#endif //G722_CODEC_H_
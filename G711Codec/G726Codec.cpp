@@ -0,0 +1,523 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "G726Codec.h"
+#include "WaveCodec/WaveFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace G711Codec {
+
+    // 各码率的量化判决表、逆量化表(对数域)、步长自适应因子 W(I) 和速度控制因子 F(I)
+    struct G726Tables {
+        const int16_t* quant;   // 判决门限
+        int            levels;  // 判决门限个数
+        const int16_t* dqln;
+        const int32_t* wi;
+        const int16_t* fi;
+        int16_t        dqMask;  // 重建时取 dq 幅度的掩码
+    };
+
+    static const int16_t kQuant16[1] = {261};
+    static const int16_t kDqln16[4] = {116, 365, 365, 116};
+    static const int32_t kWi16[4] = {-704, 14048, 14048, -704};
+    static const int16_t kFi16[4] = {0, 0xE00, 0xE00, 0};
+
+    static const int16_t kQuant24[3] = {8, 218, 331};
+    static const int16_t kDqln24[8] = {-2048, 135, 273, 373, 373, 273, 135, -2048};
+    static const int32_t kWi24[8] = {-128, 960, 4384, 18624, 18624, 4384, 960, -128};
+    static const int16_t kFi24[8] = {0, 0x200, 0x400, 0xE00, 0xE00, 0x400, 0x200, 0};
+
+    static const int16_t kQuant32[7] = {-124, 80, 178, 246, 300, 349, 400};
+    static const int16_t kDqln32[16] = {-2048, 4, 135, 213, 273, 323, 373, 425, 425, 373, 323, 273, 213, 135, 4, -2048};
+    static const int32_t kWi32[16] = {
+        -384,  576,   1312, 2048, 3584, 6336, 11360, 35904,
+        35904, 11360, 6336, 3584, 2048, 1312, 576,   -384,
+    };
+    static const int16_t kFi32[16] = {0, 0, 0, 0x200, 0x200, 0x200, 0x600, 0xE00, 0xE00, 0x600, 0x200, 0x200, 0x200, 0, 0, 0};
+
+    static const int16_t kQuant40[15] = {-122, -16, 68, 139, 198, 250, 298, 339, 378, 413, 445, 475, 502, 528, 553};
+    static const int16_t kDqln40[32] = {
+        -2048, -66, 28,  104, 169, 224, 274, 318, 358, 395, 429, 459, 488, 514, 539, 566,
+        566,   539, 514, 488, 459, 429, 395, 358, 318, 274, 224, 169, 104, 28,  -66, -2048,
+    };
+    static const int32_t kWi40[32] = {
+        448,   448,   768,   1248,  1280,  1312,  1856,  3200,  4512,  5728, 7008, 8960, 11456, 14080, 16928, 22272,
+        22272, 16928, 14080, 11456, 8960,  7008,  5728,  4512,  3200,  1856, 1312, 1280, 1248,  768,   448,   448,
+    };
+    static const int16_t kFi40[32] = {
+        0,     0,     0,     0,     0,     0x200, 0x200, 0x200, 0x200, 0x200, 0x400, 0x600, 0x800, 0xA00, 0xC00, 0xC00,
+        0xC00, 0xC00, 0xA00, 0x800, 0x600, 0x400, 0x200, 0x200, 0x200, 0x200, 0x200, 0,     0,     0,     0,     0,
+    };
+
+    static const G726Tables kTables[4] = {
+        {kQuant16, 1, kDqln16, kWi16, kFi16, 0x3FFF},
+        {kQuant24, 3, kDqln24, kWi24, kFi24, 0x3FFF},
+        {kQuant32, 7, kDqln32, kWi32, kFi32, 0x3FFF},
+        {kQuant40, 15, kDqln40, kWi40, kFi40, 0x7FFF},
+    };
+
+    static inline const G726Tables& GetTables(G726Rate rate) {
+        return kTables[rate - G726Rate16k];
+    }
+
+    // 以 2 为底的对数的整数部分 + 1，最大为 15，即参考实现中的 quan(val, power2, 15)
+    static inline int Log2Index(int val) {
+        int i = 0;
+        while (i < 15 && val >= (1 << i)) i++;
+        return i;
+    }
+
+    // val 在 table 中的判决区间
+    static inline int Quan(int val, const int16_t* table, int size) {
+        int i = 0;
+        while (i < size && val >= table[i]) i++;
+        return i;
+    }
+
+    // 线性值 an 与浮点格式的 srn 相乘
+    static int FMult(int an, int srn) {
+        int anmag = (an > 0) ? an : ((-an) & 0x1FFF);
+        int anexp = Log2Index(anmag) - 6;
+        int anmant = (anmag == 0) ? 32 : (anexp >= 0) ? (anmag >> anexp) : (anmag << -anexp);
+        int wanexp = anexp + ((srn >> 6) & 0xF) - 13;
+        int wanmant = (anmant * (srn & 077) + 0x30) >> 4;
+        int retval = (wanexp >= 0) ? ((wanmant << wanexp) & 0x7FFF) : (wanmant >> -wanexp);
+        return ((an ^ srn) < 0) ? -retval : retval;
+    }
+
+    // 线性值转换为 4bit 指数 + 6bit 尾数的浮点格式
+    static inline int16_t ToFloat(int mag, bool negative) {
+        int exp = Log2Index(mag);
+        int v = (exp << 6) + ((mag << 6) >> exp);
+        return (int16_t)(negative ? v - 0x400 : v);
+    }
+
+    static void ResetState(G726State& s) {
+        memset(&s, 0, sizeof(s));
+        s.yl = 34816;
+        s.yu = 544;
+        s.sr[0] = s.sr[1] = 32;
+        for (int i = 0; i < 6; i++) s.dq[i] = 32;
+    }
+
+    // 量化步长 y，由快速和慢速步长按速度控制参数混合
+    static int StepSize(const G726State& s) {
+        if (s.ap >= 256) return s.yu;
+        int y = s.yl >> 6;
+        int dif = s.yu - y;
+        int al = s.ap >> 2;
+        if (dif > 0) y += (dif * al) >> 6;
+        else if (dif < 0) y += (dif * al + 0x3F) >> 6;
+        return y;
+    }
+
+    // 在对数域量化差值 d，返回码字
+    static int Quantize(int d, int y, const G726Tables& t) {
+        int dqm = d < 0 ? -d : d;
+        int exp = Log2Index(dqm >> 1);
+        int mant = ((dqm << 7) >> exp) & 0x7F;
+        int dl = (exp << 7) + mant;
+        int dln = (int16_t)(dl - (y >> 2));
+
+        int i = Quan(dln, t.quant, t.levels);
+        if (d < 0) return (t.levels << 1) + 1 - i;
+        if (i == 0 && t.levels > 1) return (t.levels << 1) + 1; // 16k 有 4 个量化级，0 是合法码字
+        return i;
+    }
+
+    // 由对数域的逆量化值重建差值，负数时最高位为符号位
+    static int Reconstruct(bool sign, int dqln, int y) {
+        int dql = (int16_t)(dqln + (y >> 2));
+        if (dql < 0) return sign ? -0x8000 : 0;
+        int dex = (dql >> 7) & 15;
+        int dqt = 128 + (dql & 127);
+        int dq = (int16_t)((dqt << 7) >> (14 - dex));
+        return sign ? (dq - 0x8000) : dq;
+    }
+
+    // 更新量化器和预测器状态
+    static void Update(G726State& s, G726Rate rate, int y, int wi, int fi, int dq, int sr, int dqsez) {
+        int pk0 = (dqsez < 0) ? 1 : 0;
+        int mag = dq & 0x7FFF;
+
+        // TRANS: 检测调制解调器信号
+        int ylint = s.yl >> 15;
+        int ylfrac = (s.yl >> 10) & 0x1F;
+        int thr1 = (32 + ylfrac) << ylint;
+        int thr2 = (ylint > 9) ? (31 << 10) : thr1;
+        int dqthr = (thr2 + (thr2 >> 1)) >> 1;
+        bool tr = s.td != 0 && mag > dqthr;
+
+        // 量化步长自适应
+        int yu = y + ((wi - y) >> 5);
+        s.yu = (int16_t)std::min(std::max(yu, 544), 5120);
+        s.yl += s.yu + ((-s.yl) >> 6);
+
+        // 预测器系数
+        int a2p = 0;
+        if (tr) {
+            memset(s.a, 0, sizeof(s.a));
+            memset(s.b, 0, sizeof(s.b));
+        } else {
+            int pks1 = pk0 ^ s.pk[0];
+
+            // UPA2
+            a2p = s.a[1] - (s.a[1] >> 7);
+            if (dqsez != 0) {
+                int fa1 = pks1 ? s.a[0] : -s.a[0];
+                if (fa1 < -8191) a2p -= 0x100;
+                else if (fa1 > 8191) a2p += 0xFF;
+                else a2p += fa1 >> 5;
+
+                if (pk0 ^ s.pk[1]) {
+                    if (a2p <= -12160) a2p = -12288;
+                    else if (a2p >= 12416) a2p = 12288;
+                    else a2p -= 0x80;
+                } else if (a2p <= -12416) {
+                    a2p = -12288;
+                } else if (a2p >= 12160) {
+                    a2p = 12288;
+                } else {
+                    a2p += 0x80;
+                }
+            }
+            s.a[1] = (int16_t)a2p;
+
+            // UPA1/LIMD
+            int a1 = s.a[0] - (s.a[0] >> 8);
+            if (dqsez != 0) a1 += pks1 ? -192 : 192;
+            int a1ul = 15360 - a2p;
+            s.a[0] = (int16_t)std::min(std::max(a1, -a1ul), a1ul);
+
+            // UPB
+            int shift = (rate == G726Rate40k) ? 9 : 8;
+            for (int i = 0; i < 6; i++) {
+                int b = s.b[i] - (s.b[i] >> shift);
+                if (mag) b += ((dq ^ s.dq[i]) >= 0) ? 128 : -128;
+                s.b[i] = (int16_t)b;
+            }
+        }
+
+        // FLOAT A/FLOAT B
+        for (int i = 5; i > 0; i--) s.dq[i] = s.dq[i - 1];
+        if (mag == 0) {
+            s.dq[0] = (int16_t)((dq >= 0) ? 0x20 : 0xFC20);
+        } else {
+            s.dq[0] = ToFloat(mag, dq < 0);
+        }
+
+        s.sr[1] = s.sr[0];
+        if (sr == 0) {
+            s.sr[0] = 0x20;
+        } else if (sr > 0) {
+            s.sr[0] = ToFloat(sr, false);
+        } else if (sr > -32768) {
+            s.sr[0] = ToFloat(-sr, true);
+        } else {
+            s.sr[0] = (int16_t)0xFC20;
+        }
+
+        s.pk[1] = s.pk[0];
+        s.pk[0] = (int16_t)pk0;
+
+        // TONE
+        if (tr) s.td = 0;
+        else s.td = (a2p < -11776) ? 1 : 0;
+
+        // 速度控制
+        s.dms += (fi - s.dms) >> 5;
+        s.dml += ((fi << 2) - s.dml) >> 7;
+        if (tr) {
+            s.ap = 256;
+        } else if (y < 1536 || s.td == 1 || std::abs((s.dms << 2) - s.dml) >= (s.dml >> 3)) {
+            s.ap += (0x200 - s.ap) >> 4;
+        } else {
+            s.ap += (-s.ap) >> 4;
+        }
+    }
+
+    // 预测值，sez 为零点部分，返回 se
+    static inline int Predict(const G726State& s, int& sez) {
+        int sezi = 0;
+        for (int i = 0; i < 6; i++) {
+            sezi += FMult(s.b[i] >> 2, s.dq[i]);
+        }
+        sezi = (int16_t)sezi;
+        sez = sezi >> 1;
+        int sei = sezi + FMult(s.a[1] >> 2, s.sr[1]) + FMult(s.a[0] >> 2, s.sr[0]);
+        return (int16_t)sei >> 1;
+    }
+
+    // 编码/解码共用的重建和状态更新，返回重建信号 sr
+    static inline int ReconstructAndUpdate(G726State& s, G726Rate rate, int code, int se, int sez, int y) {
+        const G726Tables& t = GetTables(rate);
+        int dq = Reconstruct(((code >> (rate - 1)) & 1) != 0, t.dqln[code], y);
+        int sr = (int16_t)((dq < 0) ? se - (dq & t.dqMask) : se + dq);
+        int dqsez = (int16_t)(sr + sez - se);
+        Update(s, rate, y, t.wi[code], t.fi[code], dq, sr, dqsez);
+        return sr;
+    }
+
+    static inline int EncodeSample(G726State& s, G726Rate rate, int16_t sample) {
+        int sl = sample >> 2; // 14bit
+        int sez;
+        int se = Predict(s, sez);
+        int d = (int16_t)(sl - se);
+        int y = StepSize(s);
+        int code = Quantize(d, y, GetTables(rate));
+        ReconstructAndUpdate(s, rate, code, se, sez, y);
+        return code;
+    }
+
+    static inline int16_t DecodeSample(G726State& s, G726Rate rate, int code) {
+        int sez;
+        int se = Predict(s, sez);
+        int y = StepSize(s);
+        int sr = ReconstructAndUpdate(s, rate, code & ((1 << rate) - 1), se, sez, y);
+        return (int16_t)std::min(std::max(sr * 4, -32768), 32767);
+    }
+
+    size_t G726PackCodes(const uint8_t* codes, size_t count, int bits, uint8_t* packed) {
+        uint32_t acc = 0;
+        int accBits = 0;
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++) {
+            acc |= (uint32_t)(codes[i] & ((1 << bits) - 1)) << accBits;
+            accBits += bits;
+            if (accBits >= 8) {
+                packed[n++] = (uint8_t)acc;
+                acc >>= 8;
+                accBits -= 8;
+            }
+        }
+        if (accBits > 0) packed[n++] = (uint8_t)acc;
+        return n;
+    }
+
+    size_t G726UnpackCodes(const uint8_t* packed, size_t bytes, int bits, uint8_t* codes) {
+        uint32_t acc = 0;
+        int accBits = 0;
+        size_t n = 0;
+        const uint32_t mask = (1u << bits) - 1;
+        for (size_t i = 0; i < bytes; i++) {
+            acc |= (uint32_t)packed[i] << accBits;
+            accBits += 8;
+            while (accBits >= bits) {
+                codes[n++] = (uint8_t)(acc & mask);
+                acc >>= bits;
+                accBits -= bits;
+            }
+        }
+        return n;
+    }
+
+    ///////////////////////////////////////////////////
+    // G726Encoder
+    G726Encoder::G726Encoder(G726Rate rate) : m_rate(rate) {
+        Reset();
+    }
+
+    void G726Encoder::Reset() {
+        ResetState(m_state);
+    }
+
+    size_t G726Encoder::Encode(const uint16_t* pcm, size_t count, uint8_t* codes) {
+        if (!pcm || !codes) return 0;
+        for (size_t i = 0; i < count; i++) {
+            codes[i] = (uint8_t)EncodeSample(m_state, m_rate, (int16_t)pcm[i]);
+        }
+        return count;
+    }
+
+    size_t G726Encoder::EncodeFrame(const uint16_t* pcm, size_t count, uint8_t* packed) {
+        if (!pcm || !packed) return 0;
+
+        // 按 64 个采样一组编码后排列，不需要额外的缓冲区
+        uint8_t codes[64];
+        size_t n = 0;
+        uint32_t acc = 0;
+        int accBits = 0;
+        for (size_t first = 0; first < count; first += 64) {
+            size_t k = std::min<size_t>(64, count - first);
+            Encode(pcm + first, k, codes);
+            for (size_t i = 0; i < k; i++) {
+                acc |= (uint32_t)codes[i] << accBits;
+                accBits += m_rate;
+                if (accBits >= 8) {
+                    packed[n++] = (uint8_t)acc;
+                    acc >>= 8;
+                    accBits -= 8;
+                }
+            }
+        }
+        if (accBits > 0) packed[n++] = (uint8_t)acc;
+        return n;
+    }
+
+    ///////////////////////////////////////////////////
+    // G726Decoder
+    G726Decoder::G726Decoder(G726Rate rate) : m_rate(rate) {
+        Reset();
+    }
+
+    void G726Decoder::Reset() {
+        ResetState(m_state);
+    }
+
+    size_t G726Decoder::Decode(const uint8_t* codes, size_t count, uint16_t* pcm) {
+        if (!codes || !pcm) return 0;
+        for (size_t i = 0; i < count; i++) {
+            pcm[i] = (uint16_t)DecodeSample(m_state, m_rate, codes[i]);
+        }
+        return count;
+    }
+
+    size_t G726Decoder::DecodeFrame(const uint8_t* packed, size_t bytes, uint16_t* pcm) {
+        if (!packed || !pcm) return 0;
+
+        uint32_t acc = 0;
+        int accBits = 0;
+        size_t n = 0;
+        const uint32_t mask = (1u << m_rate) - 1;
+        for (size_t i = 0; i < bytes; i++) {
+            acc |= (uint32_t)packed[i] << accBits;
+            accBits += 8;
+            while (accBits >= m_rate) {
+                pcm[n++] = (uint16_t)DecodeSample(m_state, m_rate, acc & mask);
+                acc >>= m_rate;
+                accBits -= m_rate;
+            }
+        }
+        return n;
+    }
+
+    ///////////////////////////////////////////////////
+    // 文件
+    static const uint32_t kFileBlockFrames = 4096; // 每次处理的帧数，8 的整数倍
+
+    bool G726EncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, G726Rate rate) {
+        WaveCodec::WaveFileReader reader;
+        WaveCodec::WaveHeader header;
+        if (!reader.Open(srcWaveFilePath) || !reader.ReadWaveHeader(header)) {
+            printf("invalid wave file, %s\n", srcWaveFilePath.c_str());
+            return false;
+        }
+        const WaveCodec::SubChunkFmt& fmt = header.riff.fmt;
+        if (fmt.audio_format != WaveAudioFormatPCM || fmt.bits_per_sample != 16 || fmt.channels == 0) {
+            printf("only 16bit pcm wave file can be encoded, audio_format:%d, sample_bits:%d\n", fmt.audio_format, fmt.bits_per_sample);
+            return false;
+        }
+        if (rate < G726Rate16k || rate > G726Rate40k) return false;
+
+        WaveCodec::WaveFileWriter writer;
+        if (!writer.Open(dstWaveFilePath, WaveAudioFormatG721, fmt.sample_rate, (uint16_t)rate, fmt.channels)) {
+            printf("open output file failed, %s\n", dstWaveFilePath.c_str());
+            return false;
+        }
+
+        const uint16_t channels = fmt.channels;
+        std::vector<G726State> states(channels);
+        for (uint16_t ch = 0; ch < channels; ch++) ResetState(states[ch]);
+
+        // 只读取 data 子块中完整的帧，流式写入的文件 data 大小可能为 0，此时读到文件末尾
+        uint64_t shortsLeft = header.riff.data.header.size / 2;
+        if (shortsLeft == 0) shortsLeft = UINT64_MAX;
+        shortsLeft -= shortsLeft % channels;
+
+        std::vector<uint16_t> samples;
+        std::vector<uint8_t> codes;
+        std::vector<uint8_t> packed;
+        uint64_t frames = 0;
+        while (shortsLeft > 0) {
+            uint32_t toRead = (uint32_t)std::min<uint64_t>((uint64_t)kFileBlockFrames * channels, shortsLeft);
+            size_t nRead = reader.ReadShorts(toRead, samples);
+            nRead -= nRead % channels;
+            if (nRead == 0) break;
+            shortsLeft -= std::min<uint64_t>(nRead, shortsLeft);
+            frames += nRead / channels;
+
+            // 末尾不足 8 帧时补静音，实际的帧数记录在 fact 中
+            size_t count = (nRead + channels * 8 - 1) / (channels * 8) * (channels * 8);
+            samples.resize(count, 0);
+
+            // 交错的采样按顺序编码，第 i 个采样属于第 i % channels 个声道
+            codes.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                codes[i] = (uint8_t)EncodeSample(states[i % channels], rate, (int16_t)samples[i]);
+            }
+            packed.resize(count * rate / 8);
+            G726PackCodes(codes.data(), count, rate, packed.data());
+            writer.Write(packed);
+        }
+        writer.SetFactSamples((uint32_t)std::min<uint64_t>(frames, UINT32_MAX));
+        writer.Close();
+        return true;
+    }
+
+    bool G726DecodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath) {
+        WaveCodec::WaveFileReader reader;
+        WaveCodec::WaveHeader header;
+        if (!reader.Open(srcWaveFilePath) || !reader.ReadWaveHeader(header)) {
+            printf("invalid wave file, %s\n", srcWaveFilePath.c_str());
+            return false;
+        }
+        const WaveCodec::SubChunkFmt& fmt = header.riff.fmt;
+        if (fmt.audio_format != WaveAudioFormatG721 || fmt.bits_per_sample < G726Rate16k || fmt.bits_per_sample > G726Rate40k ||
+            fmt.channels == 0) {
+            printf("not a g726 wave file, audio_format:%d, sample_bits:%d\n", fmt.audio_format, fmt.bits_per_sample);
+            return false;
+        }
+
+        WaveCodec::WaveFileWriter writer;
+        if (!writer.Open(dstWaveFilePath, WaveAudioFormatPCM, fmt.sample_rate, 16, fmt.channels)) {
+            printf("open output file failed, %s\n", dstWaveFilePath.c_str());
+            return false;
+        }
+
+        const G726Rate rate = (G726Rate)fmt.bits_per_sample;
+        const uint16_t channels = fmt.channels;
+        std::vector<G726State> states(channels);
+        for (uint16_t ch = 0; ch < channels; ch++) ResetState(states[ch]);
+
+        // 每 8 帧为 channels * rate 个字节
+        const uint32_t blockBytes = channels * rate;
+        uint64_t bytesLeft = header.riff.data.header.size;
+        if (bytesLeft == 0) bytesLeft = UINT64_MAX;
+        bytesLeft -= bytesLeft % blockBytes;
+
+        // fact 中的采样数小于块数 * 8 时(编码时最后一块补了静音)以 fact 为准
+        uint64_t samplesLeft = UINT64_MAX;
+        if (header.riff.fact.header.fourcc == MAKE_FOURCC('f', 'a', 'c', 't') && header.riff.fact.samples > 0) {
+            samplesLeft = (uint64_t)header.riff.fact.samples * channels;
+        }
+
+        std::vector<uint8_t> packed;
+        std::vector<uint8_t> codes;
+        std::vector<uint16_t> samples;
+        while (bytesLeft > 0 && samplesLeft > 0) {
+            uint32_t toRead = (uint32_t)std::min<uint64_t>((uint64_t)kFileBlockFrames / 8 * blockBytes, bytesLeft);
+            size_t nRead = reader.ReadBytes(toRead, packed);
+            nRead -= nRead % blockBytes;
+            if (nRead == 0) break;
+            bytesLeft -= std::min<uint64_t>(nRead, bytesLeft);
+
+            codes.resize(nRead * 8 / rate);
+            size_t count = G726UnpackCodes(packed.data(), nRead, rate, codes.data());
+            count = (size_t)std::min<uint64_t>(count, samplesLeft);
+            samplesLeft -= count;
+            samples.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                samples[i] = (uint16_t)DecodeSample(states[i % channels], rate, codes[i]);
+            }
+            writer.Write(samples);
+        }
+        writer.Close();
+        return true;
+    }
+}
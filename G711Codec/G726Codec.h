@@ -0,0 +1,125 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef G726_CODEC_H_
+#define G726_CODEC_H_
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace G711Codec {
+
+    // G726Rate: G.726 的码率，数值为每个码字的位数
+    // 32k 即 G.721，24k/40k 即 G.723
+    enum G726Rate {
+        G726Rate16k = 2,
+        G726Rate24k = 3,
+        G726Rate32k = 4,
+        G726Rate40k = 5,
+    };
+
+    // G726State: 一路 G.726 的自适应量化器和预测器状态，约 50 字节
+    struct G726State {
+        int32_t yl;     // 慢速量化步长
+        int16_t yu;     // 快速量化步长
+        int16_t dms;    // 短时平均幅度
+        int16_t dml;    // 长时平均幅度
+        int16_t ap;     // 速度控制参数
+        int16_t a[2];   // 极点系数
+        int16_t b[6];   // 零点系数
+        int16_t pk[2];  // 部分重建信号的符号
+        int16_t dq[6];  // 量化差值，4bit 指数 + 6bit 尾数的浮点格式
+        int16_t sr[2];  // 重建信号，格式同 dq
+        int8_t  td;     // 单音检测
+    };
+
+    // G726PackCodes: 将码字按 bits 位紧密排列，第一个码字在第一个字节的最低位
+    // * codes   : 码字，每个字节一个
+    // * count   : 码字个数
+    // * bits    : 码字位数，2~5
+    // * packed  : 输出，(count * bits + 7) / 8 个字节，末尾不足一个字节时补 0
+    // * 返回值   : 输出的字节数
+    size_t G726PackCodes(const uint8_t* codes, size_t count, int bits, uint8_t* packed);
+
+    // G726UnpackCodes: G726PackCodes 的逆过程
+    // * 返回值   : 输出的码字个数，bytes * 8 / bits
+    size_t G726UnpackCodes(const uint8_t* packed, size_t bytes, int bits, uint8_t* codes);
+
+    /*example code
+
+        G726Encoder encoder(G726Rate32k);
+        G726Decoder decoder(G726Rate32k);
+        uint16_t pcm[160];            // 20ms, 8kHz
+        uint8_t frame[80];
+        size_t bytes = encoder.EncodeFrame(pcm, 160, frame);
+        decoder.DecodeFrame(frame, bytes, pcm);
+    */
+
+    // G726Encoder: G.726 ADPCM 编码器，16bit 线性 PCM 输入(取高 14 位)，按 ITU-T G.726 参考实现的定点运算
+    // 每个采样依赖上一个采样更新后的状态，逐个采样串行处理；状态为 G726State，可以同时保存大量的流
+    class G726Encoder {
+    public:
+        explicit G726Encoder(G726Rate rate = G726Rate32k);
+
+        // Encode: 编码一段采样，每个码字输出到一个字节的低位
+        // * 返回值 : 码字个数，与 count 相同
+        size_t Encode(const uint16_t* pcm, size_t count, uint8_t* codes);
+
+        // EncodeFrame: 编码一帧并紧密排列，适合 RTP/文件
+        // * count  : 采样个数，为 8 的整数倍时输出正好是整字节
+        // * packed : 输出，(count * rate + 7) / 8 个字节
+        // * 返回值  : 输出的字节数
+        size_t EncodeFrame(const uint16_t* pcm, size_t count, uint8_t* packed);
+
+        G726Rate GetRate() const { return m_rate; }
+
+        void Reset();
+
+    private:
+        G726Rate m_rate;
+        G726State m_state;
+    };
+
+    // G726Decoder: G.726 ADPCM 解码器，输出 16bit 线性 PCM
+    class G726Decoder {
+    public:
+        explicit G726Decoder(G726Rate rate = G726Rate32k);
+
+        // Decode: 解码一段码字，每个字节一个码字(只使用低 rate 位)
+        // * 返回值 : 采样个数，与 count 相同
+        size_t Decode(const uint8_t* codes, size_t count, uint16_t* pcm);
+
+        // DecodeFrame: 解码一帧紧密排列的码流
+        // * bytes  : 字节数
+        // * pcm    : 输出，bytes * 8 / rate 个采样
+        // * 返回值  : 输出的采样个数
+        size_t DecodeFrame(const uint8_t* packed, size_t bytes, uint16_t* pcm);
+
+        G726Rate GetRate() const { return m_rate; }
+
+        void Reset();
+
+    private:
+        G726Rate m_rate;
+        G726State m_state;
+    };
+
+    // 文件级的 G.726 编解码，通过 WaveFileReader/WaveFileWriter 读写
+    // Wave 文件的 audio_format 为 WaveAudioFormatG721，bits_per_sample 为码字位数(2~5)，
+    // 码字按采样帧交错(第 1 帧各声道、第 2 帧各声道 ...)后紧密排列，每 8 帧为一个 block_align
+
+    // G726EncodeWaveFile: 将 16bit PCM Wave 文件编码为 G.726 Wave 文件
+    // * srcWaveFilePath : 源 Wave 文件，16bit PCM(通常为 8kHz)，支持 RIFX
+    // * dstWaveFilePath : 输出 Wave 文件
+    // * rate            : 码率
+    // 末尾不足 8 帧时补静音，保证输出按 block_align 对齐，fact 中记录实际的帧数
+    bool G726EncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath, G726Rate rate = G726Rate32k);
+
+    // G726DecodeWaveFile: 将 G.726 Wave 文件解码为 16bit PCM Wave 文件，码率由 bits_per_sample 决定
+    // fact 中的帧数小于块数 * 8 时去掉末尾补的静音
+    bool G726DecodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath);
+}
+
+#endif //G726_CODEC_H_
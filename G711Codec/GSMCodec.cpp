@@ -0,0 +1,957 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "GSMCodec.h"
+#include "WaveCodec/WaveFile.h"
+#include "AsyncIO/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// GSM 06.10 全速率编解码，算法和定点运算按 ETSI GSM 06.10 参考实现(与 libgsm 逐位一致)
+// 编码: 预处理 -> LPC 分析(8 阶) -> 短时分析滤波 -> 每 40 个采样的子帧: 长时预测 -> RPE 编码
+// 解码: 每个子帧: RPE 解码 -> 长时合成 -> 短时合成滤波 -> 后处理
+
+namespace G711Codec {
+
+    static const int16_t kMinWord = -32768;
+    static const int16_t kMaxWord = 32767;
+
+    ///////////////////////////////////////////////////
+    // 基本运算，与参考实现的 add.c 相同
+
+    static inline int16_t Saturate(int32_t v) {
+        return (int16_t)(v < kMinWord ? kMinWord : (v > kMaxWord ? kMaxWord : v));
+    }
+
+    static inline int16_t Add(int16_t a, int16_t b) {
+        return Saturate((int32_t)a + b);
+    }
+
+    static inline int16_t Sub(int16_t a, int16_t b) {
+        return Saturate((int32_t)a - b);
+    }
+
+    static inline int16_t Abs(int16_t a) {
+        return a < 0 ? (a == kMinWord ? kMaxWord : (int16_t)-a) : a;
+    }
+
+    static inline int16_t Mult(int16_t a, int16_t b) {
+        if (a == kMinWord && b == kMinWord) return kMaxWord;
+        return (int16_t)(((int32_t)a * b) >> 15);
+    }
+
+    static inline int16_t MultR(int16_t a, int16_t b) {
+        if (a == kMinWord && b == kMinWord) return kMaxWord;
+        return (int16_t)(((int32_t)a * b + 16384) >> 15);
+    }
+
+    static inline int32_t LAdd(int32_t a, int32_t b) {
+        int64_t v = (int64_t)a + b;
+        return (int32_t)(v < INT32_MIN ? INT32_MIN : (v > INT32_MAX ? INT32_MAX : v));
+    }
+
+    // Norm: 32bit 数归一化需要左移的位数，调用者保证 a 不为 0
+    // 与 libgsm 的 gsm_norm 一样，0 和 -1 没有意义，返回 31，避免下面的循环不结束
+    static int16_t Norm(int32_t a) {
+        if (a == 0 || a == -1) return 31;
+        if (a < 0) {
+            if (a <= -1073741824) return 0;
+            a = ~a;
+        }
+        int16_t n = 0;
+        while (a < 0x40000000) {
+            a <<= 1;
+            n++;
+        }
+        return n;
+    }
+
+    // Div: num / denum 的 15bit 小数，0 <= num <= denum
+    static int16_t Div(int16_t num, int16_t denum) {
+        if (num == 0) return 0;
+        int32_t L_num = num;
+        int16_t div = 0;
+        for (int k = 0; k < 15; k++) {
+            div <<= 1;
+            L_num <<= 1;
+            if (L_num >= denum) {
+                L_num -= denum;
+                div++;
+            }
+        }
+        return div;
+    }
+
+    static inline int16_t Asr(int16_t a, int n) {
+        if (n >= 16) return (int16_t)-(a < 0);
+        if (n <= -16) return 0;
+        if (n < 0) return (int16_t)(a * (1 << -n));
+        return (int16_t)(a >> n);
+    }
+
+    static inline int16_t Asl(int16_t a, int n) {
+        if (n >= 16) return 0;
+        if (n <= -16) return (int16_t)-(a < 0);
+        if (n < 0) return Asr(a, -n);
+        return (int16_t)(a * (1 << n));
+    }
+
+    ///////////////////////////////////////////////////
+    // SIMD 内核
+
+    // Dot: 16bit 点积，count 为 8 的整数倍，调用者保证和不溢出 32bit
+#if defined(__SSE2__) || defined(_M_X64)
+    static inline int32_t Dot(const int16_t* a, const int16_t* b, int count) {
+        __m128i acc = _mm_setzero_si128();
+        for (int i = 0; i < count; i += 8) {
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i))));
+        }
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(acc);
+    }
+#elif defined(__ARM_NEON)
+    static inline int32_t Dot(const int16_t* a, const int16_t* b, int count) {
+        int32x4_t acc = vdupq_n_s32(0);
+        for (int i = 0; i < count; i += 8) {
+            int16x8_t va = vld1q_s16(a + i);
+            int16x8_t vb = vld1q_s16(b + i);
+            acc = vmlal_s16(acc, vget_low_s16(va), vget_low_s16(vb));
+            acc = vmlal_s16(acc, vget_high_s16(va), vget_high_s16(vb));
+        }
+        int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+        return vget_lane_s32(vpadd_s32(sum, sum), 0);
+    }
+#else
+    static inline int32_t Dot(const int16_t* a, const int16_t* b, int count) {
+        int32_t acc = 0;
+        for (int i = 0; i < count; i++) {
+            acc += (int32_t)a[i] * b[i];
+        }
+        return acc;
+    }
+#endif
+
+    // PredictAdd: out[k] = op(x[k], MultR(gain, past[k]))，k = 0..39，op 为饱和加(add = true)或饱和减
+    // 长时预测的延迟不小于 40，past 与 out 不重叠，可以按块计算；gain 不为 -32768
+    static void PredictAdd(const int16_t* x, const int16_t* past, int16_t gain, bool add, int16_t* out, int16_t* prediction) {
+        int k = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128i g = _mm_set1_epi16(gain);
+        const __m128i round = _mm_set1_epi32(16384);
+        for (; k < 40; k += 8) {
+            __m128i p = _mm_loadu_si128((const __m128i*)(past + k));
+            __m128i lo = _mm_mullo_epi16(p, g);
+            __m128i hi = _mm_mulhi_epi16(p, g);
+            __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+            __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+            __m128i pred = _mm_packs_epi32(p0, p1);
+            __m128i v = _mm_loadu_si128((const __m128i*)(x + k));
+            v = add ? _mm_adds_epi16(v, pred) : _mm_subs_epi16(v, pred);
+            if (prediction) _mm_storeu_si128((__m128i*)(prediction + k), pred);
+            _mm_storeu_si128((__m128i*)(out + k), v);
+        }
+#elif defined(__ARM_NEON)
+        const int16x8_t g = vdupq_n_s16(gain);
+        for (; k < 40; k += 8) {
+            int16x8_t pred = vqrdmulhq_s16(vld1q_s16(past + k), g); // (a * b + 2^14) >> 15，与 MultR 相同
+            int16x8_t v = vld1q_s16(x + k);
+            v = add ? vqaddq_s16(v, pred) : vqsubq_s16(v, pred);
+            if (prediction) vst1q_s16(prediction + k, pred);
+            vst1q_s16(out + k, v);
+        }
+#endif
+        for (; k < 40; k++) {
+            int16_t pred = MultR(gain, past[k]);
+            if (prediction) prediction[k] = pred;
+            out[k] = add ? Add(x[k], pred) : Sub(x[k], pred);
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // 表
+
+    static const int16_t kDLB[4] = {6554, 16384, 26214, 32767};    // 长时预测增益的判决门限
+    static const int16_t kQLB[4] = {3277, 11469, 21299, 32767};    // 长时预测增益的量化值
+    static const int16_t kNRFAC[8] = {29128, 26215, 23832, 21846, 20165, 18725, 17476, 16384};
+    static const int16_t kFAC[8] = {18431, 20479, 22527, 24575, 26623, 28671, 30719, 32767};
+
+    // LAR 量化: A * 1024, B * 512, 编码的最大/最小值，解码的 INVA = 32768 * 8 / A
+    static const int16_t kLarA[8] = {20480, 20480, 20480, 20480, 13964, 15360, 8534, 9036};
+    static const int16_t kLarB[8] = {0, 0, 2048, -2560, 94, -1792, -341, -1144};
+    static const int16_t kLarMac[8] = {31, 31, 15, 15, 7, 7, 3, 3};
+    static const int16_t kLarMic[8] = {-32, -32, -16, -16, -8, -8, -4, -4};
+    static const int16_t kLarInvA[8] = {13107, 13107, 13107, 13107, 19223, 17476, 31454, 29708};
+
+    // RPE 加权滤波器的冲激响应，补 0 到 16 个以便按 8 个一组做点积
+    static const int16_t kWeighting[16] = {-134, -374, 0, 2054, 5741, 8192, 5741, 2054, 0, -374, -134, 0, 0, 0, 0, 0};
+
+    static void ResetState(GSMState& S) {
+        memset(&S, 0, sizeof(S));
+        S.nrp = 40;
+    }
+
+    ///////////////////////////////////////////////////
+    // 编码
+
+    // Preprocess: 缩放、去直流、预加重
+    static void Preprocess(GSMState& S, const int16_t* s, int16_t* so) {
+        int16_t z1 = S.z1;
+        int32_t L_z2 = S.L_z2;
+        int16_t mp = S.mp;
+
+        for (int k = 0; k < 160; k++) {
+            int16_t SO = (int16_t)((s[k] >> 3) * 4);
+
+            int16_t s1 = (int16_t)(SO - z1);
+            z1 = SO;
+
+            // 31bit x 16bit 的乘法拆为高低两部分
+            int32_t L_s2 = (int32_t)s1 * 32768;
+            int16_t msp = (int16_t)(L_z2 >> 15);
+            int16_t lsp = (int16_t)(L_z2 - (int32_t)msp * 32768);
+            L_s2 += MultR(lsp, 32735);
+            L_z2 = LAdd((int32_t)msp * 32735, L_s2);
+
+            int32_t L_temp = LAdd(L_z2, 16384);
+            msp = MultR(mp, -28180);
+            mp = (int16_t)(L_temp >> 15);
+            so[k] = Add(mp, msp);
+        }
+
+        S.z1 = z1;
+        S.L_z2 = L_z2;
+        S.mp = mp;
+    }
+
+    // Autocorrelation: 9 个延迟的自相关，s 先缩放到 12bit 以内保证 32bit 不溢出，计算后按参考实现缩放回去(低位被舍入)
+    static void Autocorrelation(int16_t* s, int32_t* L_ACF) {
+        int16_t smax = 0;
+        for (int k = 0; k < 160; k++) {
+            smax = std::max(smax, Abs(s[k]));
+        }
+        int16_t scalauto = smax == 0 ? 0 : (int16_t)(4 - Norm((int32_t)smax << 16));
+        if (scalauto > 0) {
+            const int16_t factor = (int16_t)(16384 >> (scalauto - 1));
+            for (int k = 0; k < 160; k++) {
+                s[k] = MultR(s[k], factor);
+            }
+        }
+
+        // L_ACF[k] = 2 * sum(s[i] * s[i + k])，末尾补 0 后每个延迟都是 160 点的点积
+        int16_t padded[160 + 16] = {0};
+        memcpy(padded, s, 160 * sizeof(int16_t));
+        for (int k = 0; k <= 8; k++) {
+            L_ACF[k] = Dot(padded, padded + k, 160) * 2;
+        }
+
+        if (scalauto > 0) {
+            for (int k = 0; k < 160; k++) {
+                s[k] = (int16_t)(s[k] * (1 << scalauto));
+            }
+        }
+    }
+
+    // ReflectionCoefficients: Schur 递推，16bit 运算
+    static void ReflectionCoefficients(const int32_t* L_ACF, int16_t* r) {
+        if (L_ACF[0] == 0) {
+            memset(r, 0, 8 * sizeof(int16_t));
+            return;
+        }
+
+        int16_t temp = Norm(L_ACF[0]);
+        int16_t P[9], K[9];
+        for (int i = 0; i <= 8; i++) {
+            P[i] = (int16_t)(((int64_t)L_ACF[i] * ((int64_t)1 << temp)) >> 16);
+        }
+        for (int i = 1; i <= 7; i++) {
+            K[i] = P[i];
+        }
+
+        for (int n = 1; n <= 8; n++, r++) {
+            temp = Abs(P[1]);
+            if (P[0] < temp) {
+                for (int i = n; i <= 8; i++) *r++ = 0;
+                return;
+            }
+            *r = Div(temp, P[0]);
+            if (P[1] > 0) *r = (int16_t)-*r;
+            if (n == 8) return;
+
+            P[0] = Add(P[0], MultR(P[1], *r));
+            for (int m = 1; m <= 8 - n; m++) {
+                P[m] = Add(P[m + 1], MultR(K[m], *r));
+                K[m] = Add(K[m], MultR(P[m + 1], *r));
+            }
+        }
+    }
+
+    // LPCAnalysis: 由预处理后的 160 个采样得到量化编码后的 LARc[0..7]
+    static void LPCAnalysis(int16_t* s, int16_t* LARc) {
+        int32_t L_ACF[9];
+        Autocorrelation(s, L_ACF);
+
+        int16_t* r = LARc;
+        ReflectionCoefficients(L_ACF, r);
+
+        // 反射系数 -> 对数面积比(分段线性近似)
+        for (int i = 0; i < 8; i++) {
+            int16_t temp = Abs(r[i]);
+            if (temp < 22118) {
+                temp >>= 1;
+            } else if (temp < 31130) {
+                temp -= 11059;
+            } else {
+                temp = (int16_t)((temp - 26112) * 4);
+            }
+            r[i] = r[i] < 0 ? (int16_t)-temp : temp;
+        }
+
+        // 量化编码
+        for (int i = 0; i < 8; i++) {
+            int16_t temp = Mult(kLarA[i], LARc[i]);
+            temp = Add(temp, kLarB[i]);
+            temp = Add(temp, 256);
+            temp = (int16_t)(temp >> 9);
+            LARc[i] = temp > kLarMac[i] ? (int16_t)(kLarMac[i] - kLarMic[i]) : (temp < kLarMic[i] ? (int16_t)0 : (int16_t)(temp - kLarMic[i]));
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // 短时滤波，编解码共用
+
+    // ShortTermCoefficients: 解码 LARc，与上一帧插值得到 4 段的反射系数 rp
+    // 4 段分别为采样 0~12、13~26、27~39、40~159
+    static void ShortTermCoefficients(GSMState& S, const int16_t* LARc, int16_t rp[4][8]) {
+        int16_t* LARpp_j = S.LARpp[S.j];
+        S.j ^= 1;
+        const int16_t* LARpp_j_1 = S.LARpp[S.j];
+
+        for (int i = 0; i < 8; i++) {
+            int16_t temp1 = (int16_t)(Add(LARc[i], kLarMic[i]) * 1024);
+            temp1 = Sub(temp1, (int16_t)(kLarB[i] * 2));
+            temp1 = MultR(kLarInvA[i], temp1);
+            LARpp_j[i] = Add(temp1, temp1);
+        }
+
+        for (int i = 0; i < 8; i++) {
+            int16_t prev = LARpp_j_1[i], cur = LARpp_j[i];
+            rp[0][i] = Add(Add((int16_t)(prev >> 2), (int16_t)(cur >> 2)), (int16_t)(prev >> 1));
+            rp[1][i] = Add((int16_t)(prev >> 1), (int16_t)(cur >> 1));
+            rp[2][i] = Add(Add((int16_t)(prev >> 2), (int16_t)(cur >> 2)), (int16_t)(cur >> 1));
+            rp[3][i] = cur;
+        }
+
+        // 对数面积比 -> 反射系数
+        for (int n = 0; n < 4; n++) {
+            for (int i = 0; i < 8; i++) {
+                int16_t v = rp[n][i];
+                int16_t temp = Abs(v);
+                temp = temp < 11059 ? (int16_t)(temp << 1) : (temp < 20070 ? (int16_t)(temp + 11059) : Add((int16_t)(temp >> 2), 26112));
+                rp[n][i] = v < 0 ? (int16_t)-temp : temp;
+            }
+        }
+    }
+
+    static const int kSegmentStart[5] = {0, 13, 27, 40, 160};
+
+    // ShortTermAnalysisFilter: 8 阶格型分析滤波，原地将 s 替换为短时残差
+    static void ShortTermAnalysisFilter(GSMState& S, const int16_t* LARc, int16_t* s) {
+        int16_t rp[4][8];
+        ShortTermCoefficients(S, LARc, rp);
+
+        int16_t* u = S.u;
+        for (int n = 0; n < 4; n++) {
+            const int16_t* rpn = rp[n];
+            for (int k = kSegmentStart[n]; k < kSegmentStart[n + 1]; k++) {
+                int16_t di = s[k], sav = s[k];
+                for (int i = 0; i < 8; i++) {
+                    int16_t ui = u[i];
+                    u[i] = sav;
+                    sav = Add(ui, MultR(rpn[i], di));
+                    di = Add(di, MultR(rpn[i], ui));
+                }
+                s[k] = di;
+            }
+        }
+    }
+
+    // ShortTermSynthesisFilter: 8 阶格型合成滤波
+    static void ShortTermSynthesisFilter(GSMState& S, const int16_t* LARc, const int16_t* wt, int16_t* s) {
+        int16_t rp[4][8];
+        ShortTermCoefficients(S, LARc, rp);
+
+        int16_t* v = S.v;
+        for (int n = 0; n < 4; n++) {
+            const int16_t* rpn = rp[n];
+            for (int k = kSegmentStart[n]; k < kSegmentStart[n + 1]; k++) {
+                int16_t sri = wt[k];
+                for (int i = 7; i >= 0; i--) {
+                    sri = Sub(sri, MultR(rpn[i], v[i]));
+                    v[i + 1] = Add(v[i], MultR(rpn[i], sri));
+                }
+                s[k] = v[0] = sri;
+            }
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // 长时预测
+
+    // LTPParameters: 在 dp[-120..-1] 中搜索与 d[0..39] 互相关最大的延迟 Nc(40~120)，并量化增益 bc
+    static void LTPParameters(const int16_t* d, const int16_t* dp, int16_t& bc_out, int16_t& Nc_out) {
+        int16_t dmax = 0;
+        for (int k = 0; k < 40; k++) {
+            dmax = std::max(dmax, Abs(d[k]));
+        }
+        int16_t temp = dmax == 0 ? 0 : Norm((int32_t)dmax << 16);
+        int16_t scal = temp > 6 ? 0 : (int16_t)(6 - temp);
+
+        // wt 缩放到 9bit 以内，40 点的点积不会溢出 32bit
+        int16_t wt[40];
+        for (int k = 0; k < 40; k++) {
+            wt[k] = (int16_t)(d[k] >> scal);
+        }
+
+        int32_t L_max = 0;
+        int16_t Nc = 40;
+        for (int lambda = 40; lambda <= 120; lambda++) {
+            int32_t L_result = Dot(wt, dp - lambda, 40);
+            if (L_result > L_max) {
+                Nc = (int16_t)lambda;
+                L_max = L_result;
+            }
+        }
+        Nc_out = Nc;
+
+        L_max = (L_max * 2) >> (6 - scal);
+
+        int32_t L_power = 0;
+        for (int k = 0; k < 40; k++) {
+            int32_t L_temp = dp[k - Nc] >> 3;
+            L_power += L_temp * L_temp;
+        }
+        L_power *= 2;
+
+        if (L_max <= 0) {
+            bc_out = 0;
+            return;
+        }
+        if (L_max >= L_power) {
+            bc_out = 3;
+            return;
+        }
+
+        temp = Norm(L_power);
+        int16_t R = (int16_t)(((int64_t)L_max << temp) >> 16);
+        int16_t S = (int16_t)(((int64_t)L_power << temp) >> 16);
+
+        int16_t bc = 0;
+        for (; bc <= 2; bc++) {
+            if (R <= Mult(S, kDLB[bc])) break;
+        }
+        bc_out = bc;
+    }
+
+    // LTSynthesis: 由 RPE 残差 erp 和历史 drp[-120..-1] 重建 drp[0..39]，然后历史前移 40 个采样
+    static void LTSynthesis(GSMState& S, int16_t Ncr, int16_t bcr, const int16_t* erp, int16_t* drp) {
+        int16_t Nr = (Ncr < 40 || Ncr > 120) ? S.nrp : Ncr;
+        S.nrp = Nr;
+
+        PredictAdd(erp, drp - Nr, kQLB[bcr & 3], true, drp, nullptr);
+        memmove(drp - 120, drp - 80, 120 * sizeof(int16_t));
+    }
+
+    ///////////////////////////////////////////////////
+    // RPE
+
+    // WeightingFilter: 11 阶 FIR，e[-5..-1] 和 e[40..] 为 0
+    static void WeightingFilter(const int16_t* e, int16_t* x) {
+        for (int k = 0; k < 40; k++) {
+            int32_t L_result = 4096 + Dot(e + k - 5, kWeighting, 16);
+            x[k] = Saturate(L_result >> 13);
+        }
+    }
+
+    // GridSelection: 4 种抽取网格中选择能量最大的一种
+    static void GridSelection(const int16_t* x, int16_t* xM, int16_t& Mc_out) {
+        int32_t EM = 0;
+        int16_t Mc = 0;
+        for (int m = 0; m < 4; m++) {
+            int32_t L_result = 0;
+            for (int i = 0; i < 13; i++) {
+                int32_t L_temp = x[m + 3 * i] >> 2;
+                L_result += L_temp * L_temp;
+            }
+            L_result *= 2;
+            if (m == 0 || L_result > EM) {
+                Mc = (int16_t)m;
+                EM = L_result;
+            }
+        }
+        for (int i = 0; i < 13; i++) {
+            xM[i] = x[Mc + 3 * i];
+        }
+        Mc_out = Mc;
+    }
+
+    // XmaxcToExpMant: 由 xmaxc 得到解码时使用的指数和尾数
+    static void XmaxcToExpMant(int16_t xmaxc, int16_t& exp_out, int16_t& mant_out) {
+        int16_t exp = 0;
+        if (xmaxc > 15) exp = (int16_t)((xmaxc >> 3) - 1);
+        int16_t mant = (int16_t)(xmaxc - exp * 8);
+
+        if (mant == 0) {
+            exp = -4;
+            mant = 7;
+        } else {
+            while (mant <= 7) {
+                mant = (int16_t)(mant << 1 | 1);
+                exp--;
+            }
+            mant -= 8;
+        }
+        exp_out = exp;
+        mant_out = mant;
+    }
+
+    // APCMQuantization: 块最大值按对数量化为 xmaxc，13 个脉冲用尾数的倒数归一化后量化为 3 bit
+    static void APCMQuantization(const int16_t* xM, int16_t* xMc, int16_t& mant_out, int16_t& exp_out, int16_t& xmaxc_out) {
+        int16_t xmax = 0;
+        for (int i = 0; i < 13; i++) {
+            xmax = std::max(xmax, Abs(xM[i]));
+        }
+
+        int16_t exp = 0;
+        int16_t temp = (int16_t)(xmax >> 9);
+        bool itest = false;
+        for (int i = 0; i <= 5; i++) {
+            itest |= (temp <= 0);
+            temp = (int16_t)(temp >> 1);
+            if (!itest) exp++;
+        }
+
+        temp = (int16_t)(exp + 5);
+        int16_t xmaxc = Add((int16_t)(xmax >> temp), (int16_t)(exp << 3));
+
+        int16_t mant;
+        XmaxcToExpMant(xmaxc, exp, mant);
+
+        const int16_t temp1 = (int16_t)(6 - exp);
+        const int16_t temp2 = kNRFAC[mant];
+        for (int i = 0; i < 13; i++) {
+            temp = (int16_t)(xM[i] * (1 << temp1));
+            temp = Mult(temp, temp2);
+            xMc[i] = (int16_t)((temp >> 12) + 4);
+        }
+
+        mant_out = mant;
+        exp_out = exp;
+        xmaxc_out = xmaxc;
+    }
+
+    static void APCMInverseQuantization(const int16_t* xMc, int16_t mant, int16_t exp, int16_t* xMp) {
+        const int16_t temp1 = kFAC[mant];
+        const int16_t temp2 = Sub(6, exp);
+        const int16_t temp3 = Asl(1, Sub(temp2, 1));
+
+        for (int i = 0; i < 13; i++) {
+            int16_t temp = (int16_t)(((xMc[i] & 7) << 1) - 7);
+            temp = (int16_t)(temp * 4096);
+            temp = MultR(temp1, temp);
+            temp = Add(temp, temp3);
+            xMp[i] = Asr(temp, temp2);
+        }
+    }
+
+    // GridPositioning: 脉冲放回所选网格，其他位置为 0
+    static void GridPositioning(int16_t Mc, const int16_t* xMp, int16_t* ep) {
+        memset(ep, 0, 40 * sizeof(int16_t));
+        for (int i = 0; i < 13; i++) {
+            ep[(Mc & 3) + 3 * i] = xMp[i];
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // 打包
+
+    // 每帧 76 个参数按固定顺序排列: LARc[0..7]，然后每个子帧 Nc、bc、Mc、xmaxc、xMc[0..12]
+    static const int kFieldCount = 76;
+    static const uint8_t kLarBits[8] = {6, 6, 5, 5, 4, 4, 3, 3};
+
+    static inline int FieldBits(int f) {
+        if (f < 8) return kLarBits[f];
+        switch ((f - 8) % 17) {
+            case 0:  return 7;
+            case 1:  return 2;
+            case 2:  return 2;
+            case 3:  return 6;
+            default: return 3;
+        }
+    }
+
+    static inline int16_t* FieldPtr(GSMFrameParams& p, int f) {
+        if (f < 8) return &p.LARc[f];
+        int sub = (f - 8) / 17, idx = (f - 8) % 17;
+        switch (idx) {
+            case 0:  return &p.Nc[sub];
+            case 1:  return &p.bc[sub];
+            case 2:  return &p.Mc[sub];
+            case 3:  return &p.xmaxc[sub];
+            default: return &p.xMc[sub * 13 + idx - 4];
+        }
+    }
+
+    void GSMPackFrame(const GSMFrameParams& params, uint8_t* frame) {
+        GSMFrameParams& p = const_cast<GSMFrameParams&>(params);
+        uint32_t acc = 0xD; // 高位在前
+        int accBits = 4;
+        for (int f = 0; f < kFieldCount; f++) {
+            int bits = FieldBits(f);
+            acc = (acc << bits) | ((uint32_t)*FieldPtr(p, f) & ((1u << bits) - 1));
+            accBits += bits;
+            while (accBits >= 8) {
+                accBits -= 8;
+                *frame++ = (uint8_t)(acc >> accBits);
+            }
+        }
+    }
+
+    bool GSMUnpackFrame(const uint8_t* frame, GSMFrameParams& params) {
+        if ((frame[0] >> 4) != 0xD) return false;
+        uint32_t acc = frame[0] & 0xF;
+        int accBits = 4;
+        frame++;
+        for (int f = 0; f < kFieldCount; f++) {
+            int bits = FieldBits(f);
+            while (accBits < bits) {
+                acc = (acc << 8) | *frame++;
+                accBits += 8;
+            }
+            accBits -= bits;
+            *FieldPtr(params, f) = (int16_t)((acc >> accBits) & ((1u << bits) - 1));
+        }
+        return true;
+    }
+
+    // WAV49 低位在前，第一个参数在第一个字节的最低位
+    struct LsbBitWriter {
+        uint8_t* out;
+        uint32_t acc;
+        int accBits;
+
+        void Put(uint32_t value, int bits) {
+            acc |= (value & ((1u << bits) - 1)) << accBits;
+            accBits += bits;
+            while (accBits >= 8) {
+                *out++ = (uint8_t)acc;
+                acc >>= 8;
+                accBits -= 8;
+            }
+        }
+    };
+
+    struct LsbBitReader {
+        const uint8_t* in;
+        uint32_t acc;
+        int accBits;
+
+        uint32_t Get(int bits) {
+            while (accBits < bits) {
+                acc |= (uint32_t)*in++ << accBits;
+                accBits += 8;
+            }
+            uint32_t v = acc & ((1u << bits) - 1);
+            acc >>= bits;
+            accBits -= bits;
+            return v;
+        }
+    };
+
+    void GSMPackWav49(const GSMFrameParams& first, const GSMFrameParams& second, uint8_t* block) {
+        LsbBitWriter w = {block, 0, 0};
+        for (int n = 0; n < 2; n++) {
+            GSMFrameParams& p = const_cast<GSMFrameParams&>(n == 0 ? first : second);
+            for (int f = 0; f < kFieldCount; f++) {
+                w.Put((uint32_t)*FieldPtr(p, f), FieldBits(f));
+            }
+        }
+    }
+
+    void GSMUnpackWav49(const uint8_t* block, GSMFrameParams& first, GSMFrameParams& second) {
+        LsbBitReader r = {block, 0, 0};
+        for (int n = 0; n < 2; n++) {
+            GSMFrameParams& p = n == 0 ? first : second;
+            for (int f = 0; f < kFieldCount; f++) {
+                *FieldPtr(p, f) = (int16_t)r.Get(FieldBits(f));
+            }
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // GSMEncoder
+    GSMEncoder::GSMEncoder(GSMPacking packing) : m_packing(packing) {
+        Reset();
+    }
+
+    void GSMEncoder::Reset() {
+        ResetState(m_state);
+    }
+
+    void GSMEncoder::EncodeFrame(const int16_t* pcm, GSMFrameParams& params) {
+        GSMState& S = m_state;
+
+        int16_t so[160];
+        Preprocess(S, pcm, so);
+        LPCAnalysis(so, params.LARc);
+        ShortTermAnalysisFilter(S, params.LARc, so);
+
+        // e[5..44] 为当前子帧的长时残差，前后各留 0 供加权滤波使用
+        int16_t e[64] = {0};
+        int16_t* dp = S.dp0 + 120;
+        for (int k = 0; k < 4; k++, dp += 40) {
+            const int16_t* d = so + k * 40;
+
+            // 长时预测: dp[0..39] 先存放预测值 dpp，e 为预测残差
+            LTPParameters(d, dp, params.bc[k], params.Nc[k]);
+            PredictAdd(d, dp - params.Nc[k], kQLB[params.bc[k]], false, e + 5, dp);
+
+            // RPE 编码，e 被替换为量化后的残差
+            int16_t x[40], xM[13], xMp[13], mant, exp;
+            WeightingFilter(e + 5, x);
+            GridSelection(x, xM, params.Mc[k]);
+            APCMQuantization(xM, params.xMc + k * 13, mant, exp, params.xmaxc[k]);
+            APCMInverseQuantization(params.xMc + k * 13, mant, exp, xMp);
+            GridPositioning(params.Mc[k], xMp, e + 5);
+
+            // 重建短时残差，作为后续子帧的历史
+            int i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            for (; i < 40; i += 8) {
+                __m128i v = _mm_adds_epi16(_mm_loadu_si128((const __m128i*)(e + 5 + i)), _mm_loadu_si128((const __m128i*)(dp + i)));
+                _mm_storeu_si128((__m128i*)(dp + i), v);
+            }
+#elif defined(__ARM_NEON)
+            for (; i < 40; i += 8) {
+                vst1q_s16(dp + i, vqaddq_s16(vld1q_s16(e + 5 + i), vld1q_s16(dp + i)));
+            }
+#endif
+            for (; i < 40; i++) {
+                dp[i] = Add(e[5 + i], dp[i]);
+            }
+        }
+        memmove(S.dp0, S.dp0 + 160, 120 * sizeof(int16_t));
+    }
+
+    size_t GSMEncoder::Encode(const uint16_t* pcm, size_t blocks, uint8_t* out) {
+        if (!pcm || !out) return 0;
+
+        GSMFrameParams params[2];
+        const int16_t* s = (const int16_t*)pcm;
+        for (size_t b = 0; b < blocks; b++) {
+            if (m_packing == GSMPackingWav49) {
+                EncodeFrame(s, params[0]);
+                EncodeFrame(s + 160, params[1]);
+                GSMPackWav49(params[0], params[1], out);
+                s += 320;
+                out += 65;
+            } else {
+                EncodeFrame(s, params[0]);
+                GSMPackFrame(params[0], out);
+                s += 160;
+                out += 33;
+            }
+        }
+        return blocks * GetBlockBytes();
+    }
+
+    ///////////////////////////////////////////////////
+    // GSMDecoder
+    GSMDecoder::GSMDecoder(GSMPacking packing) : m_packing(packing) {
+        Reset();
+    }
+
+    void GSMDecoder::Reset() {
+        ResetState(m_state);
+    }
+
+    void GSMDecoder::DecodeFrame(const GSMFrameParams& params, int16_t* pcm) {
+        GSMState& S = m_state;
+
+        int16_t wt[160];
+        int16_t* drp = S.dp0 + 120;
+        for (int j = 0; j < 4; j++) {
+            int16_t exp, mant, xMp[13], erp[40];
+            XmaxcToExpMant(params.xmaxc[j] & 63, exp, mant);
+            APCMInverseQuantization(params.xMc + j * 13, mant, exp, xMp);
+            GridPositioning(params.Mc[j], xMp, erp);
+
+            LTSynthesis(S, params.Nc[j], params.bc[j], erp, drp);
+            memcpy(wt + j * 40, drp - 40, 40 * sizeof(int16_t)); // 历史已前移，本子帧位于 drp[-40..-1]
+        }
+
+        ShortTermSynthesisFilter(S, params.LARc, wt, pcm);
+
+        // 后处理: 去加重，截断为 13bit 后放大
+        int16_t msr = S.msr;
+        for (int k = 0; k < 160; k++) {
+            msr = Add(pcm[k], MultR(msr, 28180));
+            pcm[k] = (int16_t)(Add(msr, msr) & 0xFFF8);
+        }
+        S.msr = msr;
+    }
+
+    size_t GSMDecoder::Decode(const uint8_t* data, size_t blocks, uint16_t* pcm) {
+        if (!data || !pcm) return 0;
+
+        GSMFrameParams params[2];
+        int16_t* s = (int16_t*)pcm;
+        for (size_t b = 0; b < blocks; b++) {
+            if (m_packing == GSMPackingWav49) {
+                GSMUnpackWav49(data, params[0], params[1]);
+                DecodeFrame(params[0], s);
+                DecodeFrame(params[1], s + 160);
+                s += 320;
+                data += 65;
+            } else {
+                if (GSMUnpackFrame(data, params[0])) {
+                    DecodeFrame(params[0], s);
+                } else {
+                    memset(s, 0, 160 * sizeof(int16_t));
+                }
+                s += 160;
+                data += 33;
+            }
+        }
+        return blocks * GetBlockSamples();
+    }
+
+    ///////////////////////////////////////////////////
+    // 文件
+    static const uint32_t kFileBlocks = 50; // 每次处理的 WAV49 块数，2 秒
+
+    bool GSMEncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath) {
+        WaveCodec::WaveFileReader reader;
+        WaveCodec::WaveHeader header;
+        if (!reader.Open(srcWaveFilePath) || !reader.ReadWaveHeader(header)) {
+            printf("invalid wave file, %s\n", srcWaveFilePath.c_str());
+            return false;
+        }
+        const WaveCodec::SubChunkFmt& fmt = header.riff.fmt;
+        if (fmt.audio_format != WaveAudioFormatPCM || fmt.bits_per_sample != 16 || fmt.channels != 1 || fmt.sample_rate != 8000) {
+            printf("only 8kHz 16bit mono pcm wave file can be encoded, audio_format:%d, sample_rate:%d, sample_bits:%d, channels:%d\n",
+                   fmt.audio_format, fmt.sample_rate, fmt.bits_per_sample, fmt.channels);
+            return false;
+        }
+
+        WaveCodec::WaveFileWriter writer;
+        if (!writer.Open(dstWaveFilePath, WaveAudioFormatGSM, fmt.sample_rate, 0, 1)) {
+            printf("open output file failed, %s\n", dstWaveFilePath.c_str());
+            return false;
+        }
+
+        // 流式写入的文件 data 大小可能为 0，此时读到文件末尾
+        uint64_t shortsLeft = header.riff.data.header.size / 2;
+        if (shortsLeft == 0) shortsLeft = UINT64_MAX;
+
+        GSMEncoder encoder(GSMPackingWav49);
+        std::vector<uint16_t> samples;
+        std::vector<uint8_t> blocks(kFileBlocks * 65);
+        uint64_t totalSamples = 0;
+        while (shortsLeft > 0) {
+            uint32_t toRead = (uint32_t)std::min<uint64_t>(kFileBlocks * 320, shortsLeft);
+            size_t nRead = reader.ReadShorts(toRead, samples);
+            if (nRead == 0) break;
+            shortsLeft -= std::min<uint64_t>(nRead, shortsLeft);
+            totalSamples += nRead;
+
+            size_t count = (nRead + 319) / 320;
+            samples.resize(count * 320, 0);
+            size_t bytes = encoder.Encode(samples.data(), count, blocks.data());
+            writer.Write(blocks, bytes);
+            if (nRead < toRead) break;
+        }
+        // 最后一块补的静音不计入 fact，解码时去掉
+        writer.SetFactSamples((uint32_t)std::min<uint64_t>(totalSamples, UINT32_MAX));
+        writer.Close();
+        return true;
+    }
+
+    bool GSMDecodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath) {
+        WaveCodec::WaveFileReader reader;
+        WaveCodec::WaveHeader header;
+        if (!reader.Open(srcWaveFilePath) || !reader.ReadWaveHeader(header)) {
+            printf("invalid wave file, %s\n", srcWaveFilePath.c_str());
+            return false;
+        }
+        const WaveCodec::SubChunkFmt& fmt = header.riff.fmt;
+        if (fmt.audio_format != WaveAudioFormatGSM || fmt.channels != 1 || fmt.block_align != 65) {
+            printf("not a gsm(wav49) wave file, audio_format:%d, channels:%d, block_align:%d\n", fmt.audio_format, fmt.channels, fmt.block_align);
+            return false;
+        }
+
+        WaveCodec::WaveFileWriter writer;
+        if (!writer.Open(dstWaveFilePath, WaveAudioFormatPCM, fmt.sample_rate, 16, 1)) {
+            printf("open output file failed, %s\n", dstWaveFilePath.c_str());
+            return false;
+        }
+
+        uint64_t bytesLeft = header.riff.data.header.size;
+        if (bytesLeft == 0) bytesLeft = UINT64_MAX;
+        bytesLeft -= bytesLeft % 65;
+
+        // fact 中的采样数小于块数 * 320 时(其他编码器去掉了最后一块补的静音)以 fact 为准
+        uint64_t samplesLeft = UINT64_MAX;
+        if (header.riff.fact.header.fourcc == MAKE_FOURCC('f', 'a', 'c', 't') && header.riff.fact.samples > 0) {
+            samplesLeft = header.riff.fact.samples;
+        }
+
+        GSMDecoder decoder(GSMPackingWav49);
+        std::vector<uint8_t> data;
+        std::vector<uint16_t> samples(kFileBlocks * 320);
+        while (bytesLeft > 0 && samplesLeft > 0) {
+            uint32_t toRead = (uint32_t)std::min<uint64_t>(kFileBlocks * 65, bytesLeft);
+            size_t nRead = reader.ReadBytes(toRead, data);
+            nRead -= nRead % 65;
+            if (nRead == 0) break;
+            bytesLeft -= std::min<uint64_t>(nRead, bytesLeft);
+
+            size_t count = decoder.Decode(data.data(), nRead / 65, samples.data());
+            count = (size_t)std::min<uint64_t>(count, samplesLeft);
+            samplesLeft -= count;
+            writer.Write(samples, count);
+        }
+        writer.Close();
+        return true;
+    }
+
+    size_t GSMDecodeWaveFiles(const std::vector<std::string>& srcWaveFilePaths, const std::vector<std::string>& dstWaveFilePaths,
+                              AsyncIO::ThreadPool* pool) {
+        size_t count = std::min(srcWaveFilePaths.size(), dstWaveFilePaths.size());
+        std::unique_ptr<AsyncIO::ThreadPool> ownPool;
+        if (!pool) {
+            ownPool.reset(new AsyncIO::ThreadPool());
+            pool = ownPool.get();
+        }
+
+        std::atomic<size_t> succeeded(0);
+        for (size_t i = 0; i < count; i++) {
+            pool->Submit([&srcWaveFilePaths, &dstWaveFilePaths, &succeeded, i]() {
+                if (GSMDecodeWaveFile(srcWaveFilePaths[i], dstWaveFilePaths[i])) succeeded++;
+            });
+        }
+        pool->Wait();
+        return succeeded;
+    }
+}
@@ -0,0 +1,143 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef GSM_CODEC_H_
+#define GSM_CODEC_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace AsyncIO {
+    class ThreadPool;
+}
+
+namespace G711Codec {
+
+    // GSMPacking: GSM 06.10 码流的打包方式，两种方式的参数和音质完全相同
+    enum GSMPacking {
+        GSMPackingStandard = 0, // 每帧 160 个采样打包为 33 字节，高位在前，第一个字节的高 4 位为标志 0xD(.gsm 文件/RTP)
+        GSMPackingWav49    = 1, // Microsoft WAV49: 每 2 帧 320 个采样打包为 65 字节，低位在前，没有标志位(Wave 文件)
+    };
+
+    // GSMFrameParams: 一帧(20ms)的编码参数，共 260 bit
+    struct GSMFrameParams {
+        int16_t LARc[8];    // 对数面积比，6/6/5/5/4/4/3/3 bit
+        int16_t Nc[4];      // 每个子帧的长时预测延迟，7 bit(40~120)
+        int16_t bc[4];      // 长时预测增益，2 bit
+        int16_t Mc[4];      // RPE 网格位置，2 bit
+        int16_t xmaxc[4];   // RPE 最大幅度，6 bit
+        int16_t xMc[52];    // 每个子帧 13 个 RPE 脉冲，3 bit
+    };
+
+    // GSMState: 一路 GSM 06.10 的编解码状态，按 ETSI 参考实现的 16/32bit 定点运算
+    struct GSMState {
+        int16_t dp0[280];       // 重建的短时残差，前 120 个为历史
+        int16_t z1;             // 预处理: 去直流滤波
+        int32_t L_z2;
+        int16_t mp;             // 预处理: 预加重
+        int16_t u[8];           // 短时分析滤波器状态
+        int16_t LARpp[2][8];    // 当前帧和上一帧解码后的 LAR，用于插值
+        int16_t j;              // LARpp 中当前帧的下标
+        int16_t nrp;            // 上一个有效的长时预测延迟
+        int16_t v[9];           // 短时合成滤波器状态
+        int16_t msr;            // 后处理: 去加重
+    };
+
+    // GSMPackFrame/GSMUnpackFrame: 标准打包，一帧 33 字节
+    // * 返回值 : GSMUnpackFrame 在标志位不是 0xD 时返回 false
+    void GSMPackFrame(const GSMFrameParams& params, uint8_t* frame);
+    bool GSMUnpackFrame(const uint8_t* frame, GSMFrameParams& params);
+
+    // GSMPackWav49/GSMUnpackWav49: WAV49 打包，两帧 65 字节，第二帧从第 33 个字节的高 4 位开始
+    void GSMPackWav49(const GSMFrameParams& first, const GSMFrameParams& second, uint8_t* block);
+    void GSMUnpackWav49(const uint8_t* block, GSMFrameParams& first, GSMFrameParams& second);
+
+    /*example code
+
+        GSMEncoder encoder(GSMPackingWav49);
+        GSMDecoder decoder(GSMPackingWav49);
+        uint16_t pcm[320];            // 40ms, 8kHz，一个 WAV49 块
+        uint8_t block[65];
+        encoder.Encode(pcm, 1, block);
+        decoder.Decode(block, 1, pcm);
+    */
+
+    // GSMEncoder: GSM 06.10 全速率编码器，8kHz 16bit 单声道输入(取高 13 位)，输出与 ETSI/libgsm 参考实现逐位一致
+    // 自相关、长时预测的互相关搜索、RPE 加权滤波和长时预测滤波按块计算，使用 SSE2 _mm_madd_epi16 / NEON vmlal；
+    // 预处理和短时格型滤波器每个采样依赖上一个采样，逐个采样计算
+    class GSMEncoder {
+    public:
+        explicit GSMEncoder(GSMPacking packing = GSMPackingStandard);
+
+        // Encode: 编码若干个块
+        // * pcm     : GetBlockSamples() * blocks 个采样
+        // * blocks  : 块数，标准打包一块为一帧，WAV49 一块为两帧
+        // * out     : 输出，GetBlockBytes() * blocks 个字节
+        // * 返回值   : 输出的字节数
+        size_t Encode(const uint16_t* pcm, size_t blocks, uint8_t* out);
+
+        // EncodeFrame: 编码一帧 160 个采样，输出编码参数，用于自定义打包
+        void EncodeFrame(const int16_t* pcm, GSMFrameParams& params);
+
+        uint32_t GetBlockSamples() const { return m_packing == GSMPackingWav49 ? 320 : 160; }
+        uint32_t GetBlockBytes() const { return m_packing == GSMPackingWav49 ? 65 : 33; }
+        GSMPacking GetPacking() const { return m_packing; }
+
+        // Reset: 恢复初始状态，开始编码新的音频
+        void Reset();
+
+    private:
+        GSMPacking m_packing;
+        GSMState m_state;
+    };
+
+    // GSMDecoder: GSM 06.10 全速率解码器，输出 8kHz 16bit 单声道
+    // 残差重建和长时预测合成按子帧做 SIMD，短时合成滤波器逐个采样计算
+    class GSMDecoder {
+    public:
+        explicit GSMDecoder(GSMPacking packing = GSMPackingStandard);
+
+        // Decode: 解码若干个块
+        // * data    : GetBlockBytes() * blocks 个字节
+        // * pcm     : 输出，GetBlockSamples() * blocks 个采样
+        // * 返回值   : 输出的采样个数；标准打包中标志位错误的帧输出静音，不更新状态
+        size_t Decode(const uint8_t* data, size_t blocks, uint16_t* pcm);
+
+        // DecodeFrame: 由编码参数解码一帧 160 个采样
+        void DecodeFrame(const GSMFrameParams& params, int16_t* pcm);
+
+        uint32_t GetBlockSamples() const { return m_packing == GSMPackingWav49 ? 320 : 160; }
+        uint32_t GetBlockBytes() const { return m_packing == GSMPackingWav49 ? 65 : 33; }
+        GSMPacking GetPacking() const { return m_packing; }
+
+        // Reset: 恢复初始状态，开始解码新的码流
+        void Reset();
+
+    private:
+        GSMPacking m_packing;
+        GSMState m_state;
+    };
+
+    // 文件级的 GSM 编解码，Wave 文件的 audio_format 为 WaveAudioFormatGSM，使用 WAV49 打包:
+    // block_align 为 65，fmt 扩展区的 wSamplesPerBlock 为 320，只支持 8kHz 单声道
+
+    // GSMEncodeWaveFile: 将 8kHz 16bit 单声道 PCM Wave 文件编码为 GSM Wave 文件
+    // 末尾不足 320 个采样时补静音，fact 中记录实际的采样数
+    bool GSMEncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath);
+
+    // GSMDecodeWaveFile: 将 GSM(WAV49) Wave 文件解码为 8kHz 16bit PCM Wave 文件
+    bool GSMDecodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstWaveFilePath);
+
+    // GSMDecodeWaveFiles: 批量解码，每个文件的状态依赖前面所有的帧，不能切分，按文件在线程池中并行
+    // * srcWaveFilePaths : 源文件列表
+    // * dstWaveFilePaths : 输出文件列表，与源文件一一对应
+    // * pool             : 线程池，为空时内部按 CPU 核数创建一个
+    // * 返回值            : 解码成功的文件数
+    size_t GSMDecodeWaveFiles(const std::vector<std::string>& srcWaveFilePaths, const std::vector<std::string>& dstWaveFilePaths,
+                              AsyncIO::ThreadPool* pool = nullptr);
+}
+
+#endif //GSM_CODEC_H_
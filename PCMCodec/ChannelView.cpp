@@ -0,0 +1,78 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "ChannelView.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CHANNEL_VIEW_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CHANNEL_VIEW_NEON
+#endif
+
+namespace PCMCodec {
+
+    // 双声道时，从 base 开始取偶数位置的数据即为该声道
+    // SIMD 每次读取 2*N 个数据，最后一个是另一个声道的，因此循环要留出至少一帧给标量处理，避免越界
+
+    void GatherChannel(const uint8_t* base, uint32_t stride, size_t frames, uint8_t* out){
+        size_t i = 0;
+        if (stride == 1) {
+            for (; i < frames; i++) out[i] = base[i];
+            return;
+        }
+
+        if (stride == 2) {
+#if defined(CHANNEL_VIEW_SSE2)
+            const __m128i mask = _mm_set1_epi16(0x00FF);
+            for (; i + 16 < frames; i += 16) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(base + 2 * i));
+                __m128i b = _mm_loadu_si128((const __m128i*)(base + 2 * i + 16));
+                __m128i r = _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+                _mm_storeu_si128((__m128i*)(out + i), r);
+            }
+#elif defined(CHANNEL_VIEW_NEON)
+            for (; i + 16 < frames; i += 16) {
+                uint8x16x2_t v = vld2q_u8(base + 2 * i);
+                vst1q_u8(out + i, v.val[0]);
+            }
+#endif
+        }
+
+        for (; i < frames; i++) {
+            out[i] = base[i * stride];
+        }
+    }
+
+    void GatherChannel(const uint16_t* base, uint32_t stride, size_t frames, uint16_t* out){
+        size_t i = 0;
+        if (stride == 1) {
+            for (; i < frames; i++) out[i] = base[i];
+            return;
+        }
+
+        if (stride == 2) {
+#if defined(CHANNEL_VIEW_SSE2)
+            for (; i + 8 < frames; i += 8) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(base + 2 * i));
+                __m128i b = _mm_loadu_si128((const __m128i*)(base + 2 * i + 8));
+                // 取每个 32bit 的低 16bit，符号扩展后用有符号饱和打包，结果不变
+                a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+                b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+                _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(a, b));
+            }
+#elif defined(CHANNEL_VIEW_NEON)
+            for (; i + 8 < frames; i += 8) {
+                uint16x8x2_t v = vld2q_u16(base + 2 * i);
+                vst1q_u16(out + i, v.val[0]);
+            }
+#endif
+        }
+
+        for (; i < frames; i++) {
+            out[i] = base[i * stride];
+        }
+    }
+}
@@ -0,0 +1,127 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef CHANNEL_VIEW_H
+#define CHANNEL_VIEW_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstddef>
+#include <iterator>
+
+namespace PCMCodec {
+
+    // GatherChannel: 从交错存放的数据中收集某个声道的采样到连续内存
+    // 16bit 双声道等常见情况使用 SIMD
+    // * base   : 该声道第一个采样的地址
+    // * stride : 相邻两个采样之间的距离(以采样为单位)，即声道数
+    // * frames : 采样个数
+    // * out    : 输出，至少 frames 个
+    void GatherChannel(const uint8_t* base, uint32_t stride, size_t frames, uint8_t* out);
+    void GatherChannel(const uint16_t* base, uint32_t stride, size_t frames, uint16_t* out);
+
+    // ChannelView: 交错存放的多声道数据中某一个声道的只读视图，不拥有、不复制数据
+    // 只处理一个声道时，不需要把其它声道分离出来
+    template <typename T>
+    class ChannelView {
+    public:
+        class Iterator {
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const T* pointer;
+            typedef const T& reference;
+
+            Iterator() {}
+            Iterator(const T* p, uint32_t stride) : m_p(p), m_stride(stride) {}
+
+            const T& operator*() const { return *m_p; }
+            const T& operator[](std::ptrdiff_t n) const { return m_p[n * (std::ptrdiff_t)m_stride]; }
+            Iterator& operator++() { m_p += m_stride; return *this; }
+            Iterator operator++(int) { Iterator it = *this; m_p += m_stride; return it; }
+            Iterator& operator--() { m_p -= m_stride; return *this; }
+            Iterator operator--(int) { Iterator it = *this; m_p -= m_stride; return it; }
+            Iterator& operator+=(std::ptrdiff_t n) { m_p += n * (std::ptrdiff_t)m_stride; return *this; }
+            Iterator& operator-=(std::ptrdiff_t n) { m_p -= n * (std::ptrdiff_t)m_stride; return *this; }
+            Iterator operator+(std::ptrdiff_t n) const { Iterator it = *this; it += n; return it; }
+            Iterator operator-(std::ptrdiff_t n) const { Iterator it = *this; it -= n; return it; }
+            std::ptrdiff_t operator-(const Iterator& other) const { return (m_p - other.m_p) / (std::ptrdiff_t)m_stride; }
+            bool operator==(const Iterator& other) const { return m_p == other.m_p; }
+            bool operator!=(const Iterator& other) const { return m_p != other.m_p; }
+            bool operator<(const Iterator& other) const { return m_p < other.m_p; }
+            bool operator>(const Iterator& other) const { return m_p > other.m_p; }
+            bool operator<=(const Iterator& other) const { return m_p <= other.m_p; }
+            bool operator>=(const Iterator& other) const { return m_p >= other.m_p; }
+
+        private:
+            const T* m_p = nullptr;
+            uint32_t m_stride = 1;
+        };
+
+        ChannelView() {}
+
+        // * base   : 该声道第一个采样的地址
+        // * stride : 相邻两个采样之间的距离(以采样为单位)，即声道数
+        // * frames : 采样个数
+        ChannelView(const T* base, uint32_t stride, size_t frames) : m_base(base), m_stride(stride), m_frames(frames) {}
+
+        // FromInterleaved: 从交错数据构造某个声道的视图，末尾不完整的帧被忽略
+        // * interleaved : 交错存放的数据
+        // * count       : 数据个数(所有声道的总数)
+        // * channels    : 声道数
+        // * channel     : 声道下标，0 为左声道
+        static ChannelView FromInterleaved(const T* interleaved, size_t count, uint16_t channels, uint16_t channel){
+            if (!interleaved || channels == 0 || channel >= channels) return ChannelView();
+            return ChannelView(interleaved + channel, channels, count / channels);
+        }
+
+        static ChannelView FromInterleaved(const std::vector<T>& interleaved, uint16_t channels, uint16_t channel){
+            if (interleaved.empty()) return ChannelView();
+            return FromInterleaved(&interleaved[0], interleaved.size(), channels, channel);
+        }
+
+        const T* GetBase() const { return m_base; }
+        uint32_t GetStride() const { return m_stride; }
+        size_t size() const { return m_frames; }
+        bool empty() const { return m_frames == 0; }
+
+        const T& operator[](size_t i) const { return m_base[i * m_stride]; }
+        Iterator begin() const { return Iterator(m_base, m_stride); }
+        Iterator end() const { return Iterator(m_base + m_frames * m_stride, m_stride); }
+
+        // SubView: [offset, offset+frames) 的子视图，超出范围的部分被截掉
+        ChannelView SubView(size_t offset, size_t frames) const {
+            if (offset >= m_frames) return ChannelView();
+            if (frames > m_frames - offset) frames = m_frames - offset;
+            return ChannelView(m_base + offset * m_stride, m_stride, frames);
+        }
+
+        // IsContiguous: 数据是否连续存放(单声道)，连续时可以直接使用 GetBase
+        bool IsContiguous() const { return m_stride == 1; }
+
+        // Gather: 将数据收集到连续内存中
+        void Gather(T* out) const {
+            if (m_frames == 0 || !out) return;
+            GatherChannel(m_base, m_stride, m_frames, out);
+        }
+
+        void Gather(std::vector<T>& out) const {
+            out.resize(m_frames);
+            if (m_frames > 0) Gather(&out[0]);
+        }
+
+    private:
+        const T* m_base = nullptr;
+        uint32_t m_stride = 1;
+        size_t m_frames = 0;
+    };
+
+    typedef ChannelView<uint8_t>  ChannelView8;
+    typedef ChannelView<uint16_t> ChannelView16;
+};
+
+#endif //CHANNEL_VIEW_H
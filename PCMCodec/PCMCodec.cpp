@@ -5,6 +5,12 @@
 
 #include "PCMCodec.h"
 
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 namespace PCMCodec {
     void AbstractChannel(const uint8_t *pcmBuffer, uint32_t pcmBufferSize, std::vector<uint8_t>& leftChannelOut, std::vector<uint8_t>& rightChannelOut) {
         bool leftFlag = true;
@@ -62,6 +68,7 @@ namespace PCMCodec {
             fpLeft = fopen(leftPCMFilePath.c_str(), "wb");
             if(!fpLeft){
                 printf("open left pcm file failed\n");
+                fclose(fpSrc);
                 return false;
             }
         }
@@ -71,6 +78,8 @@ namespace PCMCodec {
             fpRight = fopen(rightPCMFilePath.c_str(), "wb");
             if(!fpRight){
                 printf("open right pcm file failed\n");
+                fclose(fpSrc);
+                if(fpLeft) fclose(fpLeft);
                 return false;
             }
         }
@@ -81,23 +90,25 @@ namespace PCMCodec {
             return true;
         }
 
-        std::vector<uint8_t> leftChannel;
-        std::vector<uint8_t> rightChannel;
+        // 只收集需要保存的声道，另一个声道不会被复制
+        uint16_t buff[1024];
+        uint16_t channelBuff[512];
         while(true){
-            uint8_t buff[2048] = {0};
-            int read_cnt = fread(buff, sizeof(uint8_t), 2048, fpSrc);
-            if (read_cnt <= 0) {
+            size_t read_cnt = fread(buff, sizeof(uint16_t), 1024, fpSrc);
+            if (read_cnt == 0) {
                 break;
             }
 
-            leftChannel.clear();
-            leftChannel.reserve(1024);
-            rightChannel.clear();
-            rightChannel.reserve(1024);
-            AbstractChannel(buff, read_cnt, leftChannel, rightChannel);
-
-            if(fpLeft) fwrite((const uint8_t*) &leftChannel[0], sizeof(uint8_t), leftChannel.size(), fpLeft);
-            if(fpRight) fwrite((const uint8_t*) &rightChannel[0], sizeof(uint8_t), rightChannel.size(), fpRight);
+            if(fpLeft){
+                ChannelView16 left = ChannelView16::FromInterleaved(buff, read_cnt, 2, 0);
+                left.Gather(channelBuff);
+                fwrite(channelBuff, sizeof(uint16_t), left.size(), fpLeft);
+            }
+            if(fpRight){
+                ChannelView16 right = ChannelView16::FromInterleaved(buff, read_cnt, 2, 1);
+                right.Gather(channelBuff);
+                fwrite(channelBuff, sizeof(uint16_t), right.size(), fpRight);
+            }
         }
 
         fclose(fpSrc);
@@ -106,4 +117,31 @@ namespace PCMCodec {
 
         return true;
     }
+
+    void Mixing(const ChannelView16& first, const ChannelView16& second, std::vector<uint16_t>& out){
+        size_t common = std::min(first.size(), second.size());
+        out.resize(std::max(first.size(), second.size()));
+        if(out.empty()) return;
+
+        size_t i = 0;
+        int16_t* dst = (int16_t*)&out[0];
+#if defined(__SSE2__) || defined(_M_X64)
+        if(first.IsContiguous() && second.IsContiguous()){
+            for(; i + 8 <= common; i += 8){
+                __m128i a = _mm_loadu_si128((const __m128i*)(first.GetBase() + i));
+                __m128i b = _mm_loadu_si128((const __m128i*)(second.GetBase() + i));
+                _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epi16(a, b));
+            }
+        }
+#endif
+        for(; i < common; i++){
+            int32_t v = (int32_t)(int16_t)first[i] + (int32_t)(int16_t)second[i];
+            dst[i] = (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+        }
+
+        const ChannelView16& longer = first.size() > second.size() ? first : second;
+        for(; i < longer.size(); i++){
+            out[i] = longer[i];
+        }
+    }
 }
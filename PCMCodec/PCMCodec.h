@@ -8,6 +8,9 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstdio>
+
+#include "ChannelView.h"
 
 namespace PCMCodec {
     // AbstractChannel: 从 16bits 双声道的PCM数据中，分离出左右声道数据。
@@ -27,8 +30,12 @@ namespace PCMCodec {
     // * rightPCMFilePath : 分离出的右声道数据要保存到的文件路径，空表示不保存右声道
     bool AbstractChannel2File(const std::string& srcPCMFilePath, const std::string& leftPCMFilePath, const std::string& rightPCMFilePath);
 
-    // 混音，TODO
-    int Mixing();
+    // Mixing: 将两个 16bit 声道混音(有符号饱和相加)，声道可以是交错数据中的某一个声道，不需要先分离
+    // 两个声道长度不同时，较长部分直接复制
+    // * first  : 第一个声道
+    // * second : 第二个声道
+    // * out    : 混音结果，长度为两个声道中较长的一个
+    void Mixing(const ChannelView16& first, const ChannelView16& second, std::vector<uint16_t>& out);
 
     // 降采样，TODO
     int DownSampling();
@@ -0,0 +1,62 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "PCMCrop.h"
+
+#include <cstdio>
+
+#include "AsyncIO/AsyncIO.h"
+
+namespace PCMCodec {
+
+    bool GetCropRange(uint32_t sampleRate, uint32_t blockAlign, uint64_t dataSize, uint32_t startMs, uint32_t endMs,
+                      uint64_t& offset, uint64_t& length){
+        if (sampleRate == 0 || blockAlign == 0 || startMs >= endMs) return false;
+
+        uint64_t totalFrames = dataSize / blockAlign;
+        uint64_t startFrame = (uint64_t)startMs * sampleRate / 1000;
+        uint64_t endFrame = (uint64_t)endMs * sampleRate / 1000;
+        if (startFrame > totalFrames) startFrame = totalFrames;
+        if (endFrame > totalFrames) endFrame = totalFrames;
+
+        offset = startFrame * blockAlign;
+        length = (endFrame - startFrame) * blockAlign;
+        return true;
+    }
+
+    bool CropPCMFile(const std::string& srcPCMFilePath, const std::string& dstPCMFilePath, uint32_t sampleRate, uint16_t sampleBits,
+                     uint16_t channels, uint32_t startMs, uint32_t endMs){
+        if (AsyncIO::IsSameFile(srcPCMFilePath, dstPCMFilePath)) {
+            printf("output file is also the input file, %s\n", dstPCMFilePath.c_str());
+            return false;
+        }
+
+        int srcFd = AsyncIO::OpenFileForRead(srcPCMFilePath);
+        if (srcFd < 0) {
+            printf("open file failed, %s\n", srcPCMFilePath.c_str());
+            return false;
+        }
+
+        uint64_t offset = 0, length = 0;
+        int64_t fileSize = AsyncIO::GetFileSize(srcFd);
+        if (fileSize < 0 || !GetCropRange(sampleRate, (uint32_t)sampleBits / 8 * channels, (uint64_t)fileSize, startMs, endMs, offset, length)) {
+            printf("invalid crop params, sampleRate:%d, sampleBits:%d, channels:%d, startMs:%d, endMs:%d\n",
+                   sampleRate, sampleBits, channels, startMs, endMs);
+            AsyncIO::CloseFile(srcFd);
+            return false;
+        }
+
+        int dstFd = AsyncIO::OpenFileForWrite(dstPCMFilePath);
+        if (dstFd < 0) {
+            printf("open file failed, %s\n", dstPCMFilePath.c_str());
+            AsyncIO::CloseFile(srcFd);
+            return false;
+        }
+
+        bool ret = AsyncIO::CopyFileRange(srcFd, offset, dstFd, 0, length) == (int64_t)length;
+        AsyncIO::CloseFile(srcFd);
+        AsyncIO::CloseFile(dstFd);
+        return ret;
+    }
+};
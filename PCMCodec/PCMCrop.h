@@ -0,0 +1,41 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef PCM_CROP_H
+#define PCM_CROP_H
+
+#include <string>
+#include <cstdint>
+
+namespace PCMCodec {
+
+    // GetCropRange: 计算时间段 [startMs, endMs) 对应的字节范围
+    // 时间先换算为帧序号 ms * sampleRate / 1000 (向下取整)，再乘以 blockAlign，因此不会切在帧中间，也不会随时长累积误差
+    // 超出 dataSize 的部分被截掉
+    // * sampleRate : 采样率
+    // * blockAlign : 每帧字节数，即 sampleBits / 8 * channels
+    // * dataSize   : 音频数据的总长度
+    // * startMs    : 开始时间
+    // * endMs      : 结束时间，必须大于 startMs
+    // * offset     : 输出，相对音频数据开头的偏移
+    // * length     : 输出，长度，开始时间超过音频时长时为 0
+    // * 返回值      : 参数是否合法
+    bool GetCropRange(uint32_t sampleRate, uint32_t blockAlign, uint64_t dataSize, uint32_t startMs, uint32_t endMs,
+                      uint64_t& offset, uint64_t& length);
+
+    // CropPCMFile: 截取 PCM 文件中 [startMs, endMs) 的数据保存到新文件
+    // 数据通过 AsyncIO::CopyFileRange 复制，Linux 上在内核中完成，内存占用与截取长度无关
+    // * srcPCMFilePath : 原始 PCM 文件
+    // * dstPCMFilePath : 输出 PCM 文件，不能与 srcPCMFilePath 相同
+    // * sampleRate     : 采样率
+    // * sampleBits     : 采样位深
+    // * channels       : 声道数
+    // * startMs        : 开始时间
+    // * endMs          : 结束时间
+    // * 返回值          : 是否成功
+    bool CropPCMFile(const std::string& srcPCMFilePath, const std::string& dstPCMFilePath, uint32_t sampleRate, uint16_t sampleBits,
+                     uint16_t channels, uint32_t startMs, uint32_t endMs);
+};
+
+#endif //PCM_CROP_H
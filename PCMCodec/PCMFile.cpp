@@ -81,8 +81,9 @@ namespace PCMCodec {
     }
 
     void PCMFileReader::SeekToTime(uint32_t tmMs){
-        long bytesPerMs = (m_sampleRate * m_sampleBits/8 * m_channelCnt) / 1000; // 每 ms 的字节数
-        long bytesAll = bytesPerMs * tmMs; // tmMs 时刻的字节数
+        // 先换算为帧序号再乘以每帧字节数，避免每 ms 字节数取整带来的累积误差和切在帧中间
+        long bytesPerFrame = m_sampleBits/8 * m_channelCnt;
+        long bytesAll = (long)((uint64_t)tmMs * m_sampleRate / 1000) * bytesPerFrame; // tmMs 时刻的字节数
         if(bytesAll >= m_fileSize){
             fseek(m_fp, 0, SEEK_END); // 超过了文件时长，直接移动到末尾
         }else{
@@ -159,6 +160,39 @@ namespace PCMCodec {
         Write(&data[0], len);
     }
 
+    // 收集声道数据时使用的栈上缓冲区大小
+    static const size_t kGatherFrames = 1024;
+
+    void PCMFileWriter::Write(const ChannelView8& view){
+        if(!m_fp) return;
+        if(view.IsContiguous()){
+            Write(view.GetBase(), (uint32_t)view.size());
+            return;
+        }
+
+        uint8_t buffer[kGatherFrames];
+        for(size_t offset = 0; offset < view.size(); offset += kGatherFrames){
+            ChannelView8 part = view.SubView(offset, kGatherFrames);
+            part.Gather(buffer);
+            fwrite(buffer, sizeof(uint8_t), part.size(), m_fp);
+        }
+    }
+
+    void PCMFileWriter::Write(const ChannelView16& view){
+        if(!m_fp) return;
+        if(view.IsContiguous()){
+            Write(view.GetBase(), (uint32_t)view.size());
+            return;
+        }
+
+        uint16_t buffer[kGatherFrames];
+        for(size_t offset = 0; offset < view.size(); offset += kGatherFrames){
+            ChannelView16 part = view.SubView(offset, kGatherFrames);
+            part.Gather(buffer);
+            fwrite(buffer, sizeof(uint16_t), part.size(), m_fp);
+        }
+    }
+
     void PCMFileWriter::Close(){
         if(m_fp){
             fclose(m_fp);
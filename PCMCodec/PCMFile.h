@@ -8,6 +8,9 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstdio>
+
+#include "ChannelView.h"
 
 namespace PCMCodec {
 
@@ -95,6 +98,10 @@ namespace PCMCodec {
         void Write(const std::vector<uint16_t>& data);
         void Write(const std::vector<uint16_t>& data, size_t len);
 
+        // Write: 写入某一个声道的数据，分段收集到连续内存后写入，不需要先分离声道
+        void Write(const ChannelView8& view);
+        void Write(const ChannelView16& view);
+
         // Close: 关闭PCM文件
         void Close();
     private:
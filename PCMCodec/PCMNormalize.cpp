@@ -0,0 +1,364 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "PCMNormalize.h"
+#include "PCMFile.h"
+#include "AsyncIO/AsyncIO.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sys/stat.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace PCMCodec {
+
+    static const char* kCacheMagic = "pcm_loudness v1";
+
+    double LoudnessAnalysis::GetPeakDb() const {
+        if (peak == 0) return -HUGE_VAL;
+        return 20.0 * log10(peak / 32768.0);
+    }
+
+    double LoudnessAnalysis::GetRMSDb() const {
+        uint64_t count = frames * channels;
+        if (count == 0 || sumSquares <= 0) return -HUGE_VAL;
+        return 10.0 * log10(sumSquares / count);
+    }
+
+    ///////////////////////////////////////////////////
+    // LoudnessAnalyzer
+    LoudnessAnalyzer::LoudnessAnalyzer(uint32_t sampleRate, uint16_t channels)
+        : m_sampleRate(sampleRate), m_channels(channels) {
+        // K 加权滤波器系数，按采样率计算 (ITU-R BS.1770-4，48kHz 下与标准给出的系数一致)
+        double rate = sampleRate > 0 ? sampleRate : 48000;
+        double f0 = 1681.974450955533;
+        double G  = 3.999843853973347;
+        double Q  = 0.7071752369554196;
+        double K  = tan(M_PI * f0 / rate);
+        double Vh = pow(10.0, G / 20.0);
+        double Vb = pow(Vh, 0.4996667741545416);
+        double a0 = 1.0 + K / Q + K * K;
+        m_shelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+        m_shelf.b1 = 2.0 * (K * K - Vh) / a0;
+        m_shelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+        m_shelf.a1 = 2.0 * (K * K - 1.0) / a0;
+        m_shelf.a2 = (1.0 - K / Q + K * K) / a0;
+
+        f0 = 38.13547087602444;
+        Q  = 0.5003270373238773;
+        K  = tan(M_PI * f0 / rate);
+        a0 = 1.0 + K / Q + K * K;
+        m_highPass.b0 = 1.0;
+        m_highPass.b1 = -2.0;
+        m_highPass.b2 = 1.0;
+        m_highPass.a1 = 2.0 * (K * K - 1.0) / a0;
+        m_highPass.a2 = (1.0 - K / Q + K * K) / a0;
+
+        m_subBlockFrames = std::max(1u, sampleRate / 10);
+        Reset();
+    }
+
+    void LoudnessAnalyzer::Reset(){
+        m_state.assign((size_t)m_channels * 4, 0.0);
+        m_partial.clear();
+        m_subBlockPos = 0;
+        m_subBlockEnergy = 0;
+        memset(m_subBlocks, 0, sizeof(m_subBlocks));
+        m_subBlockCnt = 0;
+        m_histogram.assign(kHistogramBins, 0);
+        m_histogramEnergy.assign(kHistogramBins, 0.0);
+        m_frames = 0;
+        m_peak = 0;
+        m_sumSquares = 0;
+    }
+
+    void LoudnessAnalyzer::FinishSubBlock(){
+        m_subBlocks[m_subBlockCnt % 4] = m_subBlockEnergy;
+        m_subBlockCnt++;
+        m_subBlockEnergy = 0;
+        m_subBlockPos = 0;
+        if (m_subBlockCnt < 4) return;
+
+        // 400ms 块的响度，记录到直方图；低于绝对门限 -70 LUFS 的块丢弃
+        double energy = (m_subBlocks[0] + m_subBlocks[1] + m_subBlocks[2] + m_subBlocks[3]) / (4.0 * m_subBlockFrames);
+        if (energy <= 0) return;
+        double loudness = -0.691 + 10.0 * log10(energy);
+        if (loudness < -70.0) return;
+        int bin = std::min((int)((loudness + 70.0) * 10.0), kHistogramBins - 1);
+        m_histogram[bin]++;
+        m_histogramEnergy[bin] += energy;
+    }
+
+    void LoudnessAnalyzer::Process(const uint16_t* samples, size_t count){
+        if (m_channels == 0 || !samples) return;
+
+        // 先补齐上次剩下的不完整帧
+        if (!m_partial.empty()) {
+            size_t need = m_channels - m_partial.size();
+            size_t n = std::min(need, count);
+            m_partial.insert(m_partial.end(), samples, samples + n);
+            samples += n;
+            count -= n;
+            if (m_partial.size() < m_channels) return;
+            std::vector<uint16_t> frame;
+            frame.swap(m_partial);
+            Process(&frame[0], frame.size());
+        }
+
+        size_t frames = count / m_channels;
+        ProcessFrames(samples, frames, m_channels);
+
+        size_t rest = count - frames * m_channels;
+        if (rest > 0) {
+            m_partial.assign(samples + frames * m_channels, samples + count);
+        }
+    }
+
+    void LoudnessAnalyzer::Process(const std::vector<uint16_t>& samples){
+        if (samples.empty()) return;
+        Process(&samples[0], samples.size());
+    }
+
+    bool LoudnessAnalyzer::Process(const ChannelView16& view){
+        if (m_channels != 1) {
+            printf("channel view can only be analyzed by a mono analyzer, channels:%d\n", m_channels);
+            return false;
+        }
+        if (!view.empty()) {
+            ProcessFrames(view.GetBase(), view.size(), view.GetStride());
+        }
+        return true;
+    }
+
+    void LoudnessAnalyzer::ProcessFrames(const uint16_t* samples, size_t frames, uint32_t frameStride){
+        for (size_t f = 0; f < frames; f++) {
+            const int16_t* frame = (const int16_t*)samples + f * frameStride;
+            for (uint16_t c = 0; c < m_channels; c++) {
+                int32_t s = frame[c];
+                uint32_t a = (uint32_t)(s < 0 ? -s : s);
+                if (a > m_peak) m_peak = a;
+
+                double x = s / 32768.0;
+                m_sumSquares += x * x;
+
+                // 两级 biquad (Direct Form II transposed)
+                double* st = &m_state[(size_t)c * 4];
+                double y = m_shelf.b0 * x + st[0];
+                st[0] = m_shelf.b1 * x - m_shelf.a1 * y + st[1];
+                st[1] = m_shelf.b2 * x - m_shelf.a2 * y;
+                double z = m_highPass.b0 * y + st[2];
+                st[2] = m_highPass.b1 * y - m_highPass.a1 * z + st[3];
+                st[3] = m_highPass.b2 * y - m_highPass.a2 * z;
+
+                m_subBlockEnergy += z * z; // 声道权重：前置声道均为 1.0
+            }
+
+            if (++m_subBlockPos == m_subBlockFrames) {
+                FinishSubBlock();
+            }
+        }
+        m_frames += frames;
+    }
+
+    void LoudnessAnalyzer::GetResult(LoudnessAnalysis& result) const {
+        result.frames = m_frames;
+        result.peak = m_peak;
+        result.sumSquares = m_sumSquares;
+        result.channels = m_channels;
+        result.loudness = -HUGE_VAL;
+
+        // 相对门限：绝对门限之上所有块的平均响度 - 10 LU
+        // 门限按 bin 判断(0.1 dB 精度)，能量使用每个块的实际值
+        double sum = 0;
+        uint64_t cnt = 0;
+        for (int i = 0; i < kHistogramBins; i++) {
+            sum += m_histogramEnergy[i];
+            cnt += m_histogram[i];
+        }
+        if (cnt == 0) return;
+
+        double relativeGate = -0.691 + 10.0 * log10(sum / cnt) - 10.0;
+        int startBin = std::max(0, (int)((relativeGate + 70.0) * 10.0));
+        sum = 0;
+        cnt = 0;
+        for (int i = startBin; i < kHistogramBins; i++) {
+            sum += m_histogramEnergy[i];
+            cnt += m_histogram[i];
+        }
+        if (cnt == 0) return;
+        result.loudness = -0.691 + 10.0 * log10(sum / cnt);
+    }
+
+    ///////////////////////////////////////////////////
+    // 增益
+    double CalcNormalizeGain(const LoudnessAnalysis& analysis, NormalizeMode mode, double targetDb, double peakLimitDb){
+        double currentDb;
+        if (mode == NormalizePeak) currentDb = analysis.GetPeakDb();
+        else if (mode == NormalizeRMS) currentDb = analysis.GetRMSDb();
+        else currentDb = analysis.loudness;
+
+        if (currentDb == -HUGE_VAL) return 1.0; // 静音
+
+        double gainDb = targetDb - currentDb;
+        if (mode != NormalizePeak && analysis.peak > 0) {
+            gainDb = std::min(gainDb, peakLimitDb - analysis.GetPeakDb());
+        }
+        return pow(10.0, gainDb / 20.0);
+    }
+
+    void ApplyGain(uint16_t* samples, size_t count, double gain){
+        if (!samples) return;
+
+        // Q16 定点增益，整数乘法 + 饱和，便于编译器向量化
+        int64_t gainQ16 = (int64_t)(gain * 65536.0 + 0.5);
+        if (gainQ16 == 65536) return;
+
+        int16_t* p = (int16_t*)samples;
+        for (size_t i = 0; i < count; i++) {
+            int64_t v = (p[i] * gainQ16 + 32768) >> 16;
+            v = v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+            p[i] = (int16_t)v;
+        }
+    }
+
+    void ApplyGain(std::vector<uint16_t>& samples, double gain){
+        if (samples.empty()) return;
+        ApplyGain(&samples[0], samples.size(), gain);
+    }
+
+    ///////////////////////////////////////////////////
+    // 分析结果缓存
+    static bool GetFileStamp(const std::string& filePath, uint64_t& fileSize, int64_t& mtime){
+        struct stat st;
+        if (stat(filePath.c_str(), &st) != 0) return false;
+        fileSize = (uint64_t)st.st_size;
+#if defined(__linux__)
+        mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+        mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+        mtime = (int64_t)st.st_mtime * 1000000000LL;
+#endif
+        return true;
+    }
+
+    bool LoadLoudnessCache(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, LoudnessAnalysis& analysis){
+        uint64_t fileSize = 0;
+        int64_t mtime = 0;
+        if (!GetFileStamp(pcmFilePath, fileSize, mtime)) return false;
+
+        FILE* fp = fopen((pcmFilePath + ".loudness").c_str(), "r");
+        if (!fp) return false;
+
+        char magic[32] = {0};
+        unsigned long long cacheFileSize = 0, frames = 0;
+        long long cacheMtime = 0;
+        unsigned int cacheSampleRate = 0, cacheChannels = 0, peak = 0;
+        double sumSquares = 0, loudness = 0;
+        int hasLoudness = 0;
+        int n = fscanf(fp, "%31[^\n]\nfile_size=%llu\nmtime=%lld\nsample_rate=%u\nchannels=%u\nframes=%llu\npeak=%u\nsum_squares=%lf\nhas_loudness=%d\nloudness=%lf",
+                       magic, &cacheFileSize, &cacheMtime, &cacheSampleRate, &cacheChannels, &frames, &peak, &sumSquares, &hasLoudness, &loudness);
+        fclose(fp);
+
+        if (n != 10 || strcmp(magic, kCacheMagic) != 0) return false;
+        if (cacheFileSize != fileSize || cacheMtime != mtime || cacheSampleRate != sampleRate || cacheChannels != channels) {
+            return false; // 文件已修改，或者按不同的采样参数分析
+        }
+
+        analysis.frames = frames;
+        analysis.peak = peak;
+        analysis.sumSquares = sumSquares;
+        analysis.channels = channels;
+        analysis.loudness = hasLoudness ? loudness : -HUGE_VAL;
+        return true;
+    }
+
+    bool SaveLoudnessCache(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, const LoudnessAnalysis& analysis){
+        uint64_t fileSize = 0;
+        int64_t mtime = 0;
+        if (!GetFileStamp(pcmFilePath, fileSize, mtime)) return false;
+
+        FILE* fp = fopen((pcmFilePath + ".loudness").c_str(), "w");
+        if (!fp) return false;
+
+        bool hasLoudness = analysis.loudness != -HUGE_VAL;
+        fprintf(fp, "%s\nfile_size=%llu\nmtime=%lld\nsample_rate=%u\nchannels=%u\nframes=%llu\npeak=%u\nsum_squares=%.17g\nhas_loudness=%d\nloudness=%.17g\n",
+                kCacheMagic, (unsigned long long)fileSize, (long long)mtime, sampleRate, (unsigned int)channels,
+                (unsigned long long)analysis.frames, analysis.peak, analysis.sumSquares, hasLoudness ? 1 : 0, hasLoudness ? analysis.loudness : 0.0);
+        return fclose(fp) == 0;
+    }
+
+    ///////////////////////////////////////////////////
+    // 文件
+    static const uint32_t kShortsPerRead = 8192;
+
+    bool AnalyzePCMFile(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, LoudnessAnalysis& analysis, bool useCache){
+        if (useCache && LoadLoudnessCache(pcmFilePath, sampleRate, channels, analysis)) {
+            return true;
+        }
+
+        PCMFileReader reader;
+        if (!reader.Open(pcmFilePath, sampleRate, 16, channels)) {
+            return false;
+        }
+
+        LoudnessAnalyzer analyzer(sampleRate, channels);
+        std::vector<uint16_t> buffer;
+        while (reader.ReadShorts(kShortsPerRead, buffer) > 0) {
+            analyzer.Process(buffer);
+        }
+        reader.Close();
+        analyzer.GetResult(analysis);
+
+        if (useCache) {
+            SaveLoudnessCache(pcmFilePath, sampleRate, channels, analysis);
+        }
+        return true;
+    }
+
+    bool NormalizePCMFile(const std::string& srcPCMFilePath, const std::string& dstPCMFilePath, uint32_t sampleRate, uint16_t channels,
+                          NormalizeMode mode, double targetDb, double peakLimitDb, bool useCache){
+        // 第二遍读取源文件时输出文件已被清空
+        if (AsyncIO::IsSameFile(srcPCMFilePath, dstPCMFilePath)) {
+            printf("output file is also the input file, %s\n", dstPCMFilePath.c_str());
+            return false;
+        }
+
+        LoudnessAnalysis analysis;
+        if (!AnalyzePCMFile(srcPCMFilePath, sampleRate, channels, analysis, useCache)) {
+            return false;
+        }
+        double gain = CalcNormalizeGain(analysis, mode, targetDb, peakLimitDb);
+
+        PCMFileReader reader;
+        if (!reader.Open(srcPCMFilePath, sampleRate, 16, channels)) {
+            return false;
+        }
+        PCMFileWriter writer;
+        if (!writer.Open(dstPCMFilePath)) {
+            return false;
+        }
+
+        // 施加增益的同时分析输出，得到输出文件准确的分析结果(包括饱和的影响)
+        LoudnessAnalyzer outAnalyzer(sampleRate, channels);
+        std::vector<uint16_t> buffer;
+        while (reader.ReadShorts(kShortsPerRead, buffer) > 0) {
+            ApplyGain(buffer, gain);
+            outAnalyzer.Process(buffer);
+            writer.Write(buffer);
+        }
+        reader.Close();
+        writer.Close();
+
+        if (useCache) {
+            LoudnessAnalysis outAnalysis;
+            outAnalyzer.GetResult(outAnalysis);
+            SaveLoudnessCache(dstPCMFilePath, sampleRate, channels, outAnalysis);
+        }
+        return true;
+    }
+}
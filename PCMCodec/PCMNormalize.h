@@ -0,0 +1,129 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef PCM_NORMALIZE_H
+#define PCM_NORMALIZE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+
+#include "ChannelView.h"
+
+namespace PCMCodec {
+
+    // NormalizeMode: 归一化的依据
+    enum NormalizeMode {
+        NormalizePeak     = 0, // 采样峰值，targetDb 单位 dBFS
+        NormalizeRMS      = 1, // 均方根电平，targetDb 单位 dBFS
+        NormalizeLoudness = 2, // ITU-R BS.1770 积分响度(K 加权 + 门限)，targetDb 单位 LUFS
+    };
+
+    // LoudnessAnalysis: 16bit PCM 数据的电平分析结果
+    struct LoudnessAnalysis {
+        uint64_t frames = 0;        // 分析的帧数(每声道采样数)
+        uint32_t peak = 0;          // 采样绝对值的最大值，0 ~ 32768
+        double   sumSquares = 0;    // 所有采样平方和(归一化到 [-1, 1))
+        uint16_t channels = 0;
+        double   loudness = -HUGE_VAL; // 积分响度，LUFS；没有超过门限的块时为 -HUGE_VAL
+
+        // GetPeakDb: 峰值电平，dBFS
+        double GetPeakDb() const;
+        // GetRMSDb: 均方根电平，dBFS
+        double GetRMSDb() const;
+    };
+
+    // LoudnessAnalyzer: 流式分析 16bit PCM 的峰值、均方根和积分响度
+    // 可多次调用 Process，内存占用固定，与数据长度无关
+    class LoudnessAnalyzer {
+    public:
+        LoudnessAnalyzer(uint32_t sampleRate, uint16_t channels);
+
+        // Process: 分析一段交错存放的 16bit PCM 数据，按有符号数处理
+        // * samples : PCM 采样
+        // * count   : 采样个数(所有声道的总数)，不足一帧的部分留到下一次
+        void Process(const uint16_t* samples, size_t count);
+        void Process(const std::vector<uint16_t>& samples);
+
+        // Process: 分析多声道数据中的某一个声道，不需要先分离声道
+        // 仅用于单声道的 LoudnessAnalyzer (channels 为 1)，多声道时不做分析，返回 false
+        bool Process(const ChannelView16& view);
+
+        // GetResult: 获取到目前为止的分析结果
+        void GetResult(LoudnessAnalysis& result) const;
+
+        void Reset();
+
+    private:
+        struct Biquad {
+            double b0, b1, b2, a1, a2;
+        };
+
+        // 400ms 的块，步长 100ms(75% 重叠)，块响度记录在直方图中
+        static const int kHistogramBins = 1000; // -70 LUFS ~ +30 LUFS，0.1 dB 一个 bin
+
+        void FinishSubBlock();
+
+        // 分析 frames 帧，第 f 帧第 c 个声道的采样位于 samples[f * frameStride + c]
+        void ProcessFrames(const uint16_t* samples, size_t frames, uint32_t frameStride);
+
+        uint32_t m_sampleRate = 0;
+        uint16_t m_channels = 0;
+        Biquad m_shelf;                         // K 加权：高架滤波
+        Biquad m_highPass;                      // K 加权：高通滤波
+        std::vector<double> m_state;            // 每声道 4 个滤波器状态
+        std::vector<uint16_t> m_partial;        // 不足一帧的剩余采样
+
+        uint32_t m_subBlockFrames = 0;          // 100ms 的帧数
+        uint32_t m_subBlockPos = 0;
+        double   m_subBlockEnergy = 0;
+        double   m_subBlocks[4] = {0, 0, 0, 0}; // 最近 4 个子块的能量
+        uint64_t m_subBlockCnt = 0;
+        std::vector<uint32_t> m_histogram;      // 每个 bin 的块数
+        std::vector<double> m_histogramEnergy;  // 每个 bin 的块能量之和
+
+        uint64_t m_frames = 0;
+        uint32_t m_peak = 0;
+        double   m_sumSquares = 0;
+    };
+
+    // CalcNormalizeGain: 计算归一化到 targetDb 所需的线性增益
+    // * analysis    : 分析结果
+    // * mode        : 归一化的依据
+    // * targetDb    : 目标电平，单位见 NormalizeMode
+    // * peakLimitDb : 峰值上限(dBFS)，增益不会使峰值超过该值，NormalizePeak 时不使用
+    // * 返回值       : 线性增益，静音时返回 1.0
+    double CalcNormalizeGain(const LoudnessAnalysis& analysis, NormalizeMode mode, double targetDb, double peakLimitDb = 0.0);
+
+    // ApplyGain: 对 16bit PCM 数据原地施加线性增益，超出范围的采样饱和处理
+    void ApplyGain(uint16_t* samples, size_t count, double gain);
+    void ApplyGain(std::vector<uint16_t>& samples, double gain);
+
+    // LoadLoudnessCache/SaveLoudnessCache: 读写分析结果的缓存文件(pcmFilePath + ".loudness")
+    // 缓存中记录了文件大小、修改时间和采样参数，任何一项不一致时视为无效
+    bool LoadLoudnessCache(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, LoudnessAnalysis& analysis);
+    bool SaveLoudnessCache(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, const LoudnessAnalysis& analysis);
+
+    // AnalyzePCMFile: 分析 16bit PCM 文件
+    // * useCache : 为 true 时优先使用有效的缓存，并把新的分析结果写入缓存
+    bool AnalyzePCMFile(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, LoudnessAnalysis& analysis, bool useCache = true);
+
+    // NormalizePCMFile: 将 16bit PCM 文件归一化到目标电平
+    // 源文件的分析结果有缓存时，只需读一遍源文件；输出文件在写入的同时被分析，结果写入输出文件的缓存
+    // 因此对同一个文件反复按不同目标归一化，不需要重复扫描
+    // * srcPCMFilePath : 源 PCM 文件
+    // * dstPCMFilePath : 输出 PCM 文件，不能与 srcPCMFilePath 相同
+    // * sampleRate     : 采样率
+    // * channels       : 声道数
+    // * mode           : 归一化的依据
+    // * targetDb       : 目标电平
+    // * peakLimitDb    : 峰值上限，详见 CalcNormalizeGain
+    // * useCache       : 是否读写分析结果的缓存
+    bool NormalizePCMFile(const std::string& srcPCMFilePath, const std::string& dstPCMFilePath, uint32_t sampleRate, uint16_t channels,
+                          NormalizeMode mode, double targetDb, double peakLimitDb = 0.0, bool useCache = true);
+};
+
+#endif //PCM_NORMALIZE_H
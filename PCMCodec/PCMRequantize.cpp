@@ -0,0 +1,258 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "PCMRequantize.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace PCMCodec {
+
+    bool SamplesToFloat(const uint8_t* data, size_t count, uint32_t sampleBytes, bool isFloat, float* out){
+        if (count == 0) return true;
+        if (!data || !out) return false;
+
+        if (isFloat) {
+            if (sampleBytes == 4) {
+                memcpy(out, data, count * sizeof(float));
+            } else if (sampleBytes == 8) {
+                for (size_t i = 0; i < count; i++) {
+                    double v;
+                    memcpy(&v, data + i * 8, sizeof(v));
+                    out[i] = (float)v;
+                }
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        switch (sampleBytes) {
+            case 1:
+                for (size_t i = 0; i < count; i++) {
+                    out[i] = ((int)data[i] - 128) * (1.0f / 128);
+                }
+                break;
+            case 2: {
+                size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+                const __m128 scale = _mm_set1_ps(1.0f / 32768);
+                for (; i + 8 <= count; i += 8) {
+                    __m128i v = _mm_loadu_si128((const __m128i*)(data + i * 2));
+                    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+                    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+                    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+                    _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+                }
+#elif defined(__ARM_NEON)
+                for (; i + 8 <= count; i += 8) {
+                    int16x8_t v = vreinterpretq_s16_u8(vld1q_u8(data + i * 2));
+                    vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), 1.0f / 32768));
+                    vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), 1.0f / 32768));
+                }
+#endif
+                for (; i < count; i++) {
+                    int16_t v;
+                    memcpy(&v, data + i * 2, sizeof(v));
+                    out[i] = v * (1.0f / 32768);
+                }
+                break;
+            }
+            case 3:
+                for (size_t i = 0; i < count; i++) {
+                    const uint8_t* p = data + i * 3;
+                    int32_t v = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+                    out[i] = v * (1.0f / 8388608);
+                }
+                break;
+            case 4:
+                for (size_t i = 0; i < count; i++) {
+                    int32_t v;
+                    memcpy(&v, data + i * 4, sizeof(v));
+                    out[i] = (float)(v * (1.0 / 2147483648.0));
+                }
+                break;
+            default:
+                return false;
+        }
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // Requantizer
+    Requantizer::Requantizer(uint16_t channels, uint16_t targetBits, DitherMode mode, uint32_t seed)
+        : m_channels(channels), m_targetBits(targetBits), m_mode(mode), m_seed(seed) {
+        Reset();
+    }
+
+    void Requantizer::Reset() {
+        // 由种子派生 8 个互不相同的非零状态
+        uint32_t s = m_seed ? m_seed : 1;
+        for (int i = 0; i < 8; i++) {
+            s = s * 1664525u + 1013904223u;
+            m_rng[i] = (s ^ (s >> 16)) | 1;
+        }
+        m_spareCnt = 0;
+        m_error.assign((size_t)m_channels * 2, 0.0f);
+    }
+
+    // 4 路 xorshift32，生成 4 个 [-1, 1) 的 TPDF 抖动(两个均匀分布之差)
+    static inline void DitherBlock(uint32_t* rng, float* out) {
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128i a = _mm_loadu_si128((const __m128i*)rng);
+        __m128i b = _mm_loadu_si128((const __m128i*)(rng + 4));
+        a = _mm_xor_si128(a, _mm_slli_epi32(a, 13));
+        a = _mm_xor_si128(a, _mm_srli_epi32(a, 17));
+        a = _mm_xor_si128(a, _mm_slli_epi32(a, 5));
+        b = _mm_xor_si128(b, _mm_slli_epi32(b, 13));
+        b = _mm_xor_si128(b, _mm_srli_epi32(b, 17));
+        b = _mm_xor_si128(b, _mm_slli_epi32(b, 5));
+        _mm_storeu_si128((__m128i*)rng, a);
+        _mm_storeu_si128((__m128i*)(rng + 4), b);
+
+        // 高 24 位转换为 [0, 1)
+        const __m128 scale = _mm_set1_ps(1.0f / 16777216);
+        __m128 ua = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(a, 8)), scale);
+        __m128 ub = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(b, 8)), scale);
+        _mm_storeu_ps(out, _mm_sub_ps(ua, ub));
+#elif defined(__ARM_NEON)
+        uint32x4_t a = vld1q_u32(rng);
+        uint32x4_t b = vld1q_u32(rng + 4);
+        a = veorq_u32(a, vshlq_n_u32(a, 13));
+        a = veorq_u32(a, vshrq_n_u32(a, 17));
+        a = veorq_u32(a, vshlq_n_u32(a, 5));
+        b = veorq_u32(b, vshlq_n_u32(b, 13));
+        b = veorq_u32(b, vshrq_n_u32(b, 17));
+        b = veorq_u32(b, vshlq_n_u32(b, 5));
+        vst1q_u32(rng, a);
+        vst1q_u32(rng + 4, b);
+
+        float32x4_t ua = vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(a, 8)), 1.0f / 16777216);
+        float32x4_t ub = vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(b, 8)), 1.0f / 16777216);
+        vst1q_f32(out, vsubq_f32(ua, ub));
+#else
+        for (int i = 0; i < 8; i++) {
+            uint32_t x = rng[i];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            rng[i] = x;
+        }
+        for (int i = 0; i < 4; i++) {
+            out[i] = (rng[i] >> 8) * (1.0f / 16777216) - (rng[i + 4] >> 8) * (1.0f / 16777216);
+        }
+#endif
+    }
+
+    void Requantizer::GenerateDither(float* dither, size_t count) {
+        size_t i = 0;
+
+        // 上一次剩下的
+        while (i < count && m_spareCnt > 0) {
+            dither[i++] = m_spare[4 - m_spareCnt];
+            m_spareCnt--;
+        }
+
+        for (; i + 4 <= count; i += 4) {
+            DitherBlock(m_rng, dither + i);
+        }
+
+        if (i < count) {
+            DitherBlock(m_rng, m_spare);
+            m_spareCnt = 4;
+            while (i < count) {
+                dither[i++] = m_spare[4 - m_spareCnt];
+                m_spareCnt--;
+            }
+        }
+    }
+
+    void Requantizer::Process(const float* samples, size_t count, uint8_t* out) {
+        if (!IsValid() || !samples || !out || count == 0) return;
+
+        const float scale = (float)(1 << (m_targetBits - 1));
+        const float lo = -scale, hi = scale - 1;
+
+        m_dither.resize(count);
+        m_quantized.resize(count);
+        if (m_mode == DitherNone) {
+            memset(&m_dither[0], 0, count * sizeof(float));
+        } else {
+            GenerateDither(&m_dither[0], count);
+        }
+        const float* dither = &m_dither[0];
+        int32_t* q = &m_quantized[0];
+
+        if (m_mode == DitherShaped) {
+            // 误差反馈 v = x - 2*e[n-1] + e[n-2]，输出 y = x + e - 2*e[n-1] + e[n-2]
+            for (size_t i = 0; i < count; i++) {
+                float* e = &m_error[(i % m_channels) * 2];
+                float v = samples[i] * scale - 2 * e[0] + e[1];
+                float y = std::nearbyint(v + dither[i]);
+                if (!(y >= lo)) y = lo; // 同时处理 NaN
+                if (y > hi) y = hi;
+
+                // 饱和时误差会很大，限制反馈量避免不稳定
+                float err = y - v;
+                if (!(err <= 2)) err = 2;
+                if (err < -2) err = -2;
+                e[1] = e[0];
+                e[0] = err;
+                q[i] = (int32_t)y;
+            }
+        } else {
+            size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128 vscale = _mm_set1_ps(scale), vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+            for (; i + 4 <= count; i += 4) {
+                __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(samples + i), vscale), _mm_loadu_ps(dither + i));
+                v = _mm_min_ps(_mm_max_ps(v, vlo), vhi);
+                _mm_storeu_si128((__m128i*)(q + i), _mm_cvtps_epi32(v)); // 四舍六入五成双
+            }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+            const float32x4_t vlo = vdupq_n_f32(lo), vhi = vdupq_n_f32(hi);
+            for (; i + 4 <= count; i += 4) {
+                float32x4_t v = vmlaq_n_f32(vld1q_f32(dither + i), vld1q_f32(samples + i), scale);
+                v = vminq_f32(vmaxq_f32(v, vlo), vhi);
+                vst1q_s32(q + i, vcvtnq_s32_f32(v));
+            }
+#endif
+            for (; i < count; i++) {
+                float v = samples[i] * scale + dither[i];
+                if (!(v >= lo)) v = lo; // 同时处理 NaN
+                if (v > hi) v = hi;
+                q[i] = (int32_t)std::nearbyint(v);
+            }
+        }
+
+        // 按输出位深存储
+        switch (m_targetBits) {
+            case 8:
+                for (size_t i = 0; i < count; i++) {
+                    out[i] = (uint8_t)(q[i] + 128);
+                }
+                break;
+            case 16:
+                for (size_t i = 0; i < count; i++) {
+                    int16_t v = (int16_t)q[i];
+                    memcpy(out + i * 2, &v, sizeof(v));
+                }
+                break;
+            default:
+                for (size_t i = 0; i < count; i++) {
+                    uint32_t v = (uint32_t)q[i];
+                    out[i * 3] = (uint8_t)v;
+                    out[i * 3 + 1] = (uint8_t)(v >> 8);
+                    out[i * 3 + 2] = (uint8_t)(v >> 16);
+                }
+                break;
+        }
+    }
+};
@@ -0,0 +1,82 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef PCM_REQUANTIZE_H
+#define PCM_REQUANTIZE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace PCMCodec {
+
+    // DitherMode: 降低位深时的处理方式
+    enum DitherMode {
+        DitherNone   = 0, // 直接四舍五入
+        DitherTPDF   = 1, // 加三角分布(TPDF)抖动，量化误差与信号无关
+        DitherShaped = 2, // TPDF 抖动 + 二阶噪声整形，噪声传递函数 (1 - z^-1)^2，量化噪声移向高频
+    };
+
+    // SamplesToFloat: 将 PCM 采样转换为 [-1, 1) 的浮点数
+    // * data        : 小端存储的采样
+    // * count       : 采样个数
+    // * sampleBytes : 每个采样的字节数，整数为 1(无符号)/2/3/4，浮点为 4/8
+    // * isFloat     : 是否为 IEEE 浮点采样
+    // * out         : 输出，count 个
+    // * 返回值       : 格式是否支持
+    bool SamplesToFloat(const uint8_t* data, size_t count, uint32_t sampleBytes, bool isFloat, float* out);
+
+    /*example code
+
+        Requantizer requantizer(2, 16, DitherShaped);
+        std::vector<float> samples;   // [-1, 1) 的交错采样
+        std::vector<uint8_t> out(samples.size() * requantizer.GetSampleBytes());
+        requantizer.Process(samples.data(), samples.size(), out.data());
+    */
+
+    // Requantizer: 将浮点采样量化为 8/16/24bit PCM
+    // 抖动使用 4 路并行的 xorshift32 伪随机数发生器，与量化一起按 4 个采样一组用 SSE2/NEON 处理；
+    // 噪声整形的误差反馈在采样之间串行，每个声道单独保存误差状态
+    // 随机数状态和误差状态在多次 Process 之间保留，分块处理与一次性处理的结果相同
+    class Requantizer {
+    public:
+        // * channels   : 声道数
+        // * targetBits : 输出位深，8/16/24
+        // * mode       : 抖动方式
+        // * seed       : 随机数种子，相同的种子得到相同的输出
+        Requantizer(uint16_t channels, uint16_t targetBits, DitherMode mode, uint32_t seed = 1);
+
+        // IsValid: 参数是否合法
+        bool IsValid() const { return m_channels > 0 && (m_targetBits == 8 || m_targetBits == 16 || m_targetBits == 24); }
+
+        // GetSampleBytes: 输出每个采样的字节数
+        uint32_t GetSampleBytes() const { return m_targetBits / 8; }
+
+        // Process: 量化一段交错采样
+        // * samples : [-1, 1) 的浮点采样，超出范围的饱和处理
+        // * count   : 采样个数，应为声道数的整数倍
+        // * out     : 输出，count * GetSampleBytes() 字节，小端存储，8bit 为无符号数(与 Wave 文件相同)
+        void Process(const float* samples, size_t count, uint8_t* out);
+
+        // Reset: 清除误差状态，随机数重新从种子开始
+        void Reset();
+
+    private:
+        // 生成 count 个 [-1, 1) 的 TPDF 抖动，单位为输出的 1 LSB
+        void GenerateDither(float* dither, size_t count);
+
+        uint16_t m_channels = 0;
+        uint16_t m_targetBits = 16;
+        DitherMode m_mode = DitherTPDF;
+        uint32_t m_seed = 1;
+        uint32_t m_rng[8];               // 两组 4 路 xorshift32 的状态
+        float m_spare[4];                // 上一次生成但未使用的抖动
+        uint32_t m_spareCnt = 0;
+        std::vector<float> m_error;      // 每个声道最近两次的量化误差 e[n-1], e[n-2]
+        std::vector<float> m_dither;
+        std::vector<int32_t> m_quantized;
+    };
+};
+
+#endif //PCM_REQUANTIZE_H
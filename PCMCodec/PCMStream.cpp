@@ -0,0 +1,244 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "PCMStream.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <io.h>
+#include <fcntl.h>
+#define STREAM_FILENO _fileno
+#else
+#include <fcntl.h>
+#define STREAM_FILENO fileno
+#endif
+
+namespace PCMCodec {
+
+    // 流的缓冲区大小，管道默认的缓冲只有一页
+    static const size_t kStreamBufferSize = 64 * 1024;
+
+    FILE* OpenStreamFile(const std::string& path, bool write, bool& ownsFile){
+        ownsFile = false;
+        if (path.size() == 0) return nullptr;
+
+        FILE* fp = nullptr;
+        if (path == "-") {
+            fp = write ? stdout : stdin;
+#ifdef WIN32
+            _setmode(_fileno(fp), _O_BINARY);
+#endif
+        } else {
+            fp = fopen(path.c_str(), write ? "wb" : "rb");
+            if (!fp) {
+                fprintf(stderr, "open file failed, %s\n", path.c_str());
+                return nullptr;
+            }
+            ownsFile = true;
+        }
+
+        setvbuf(fp, nullptr, _IOFBF, kStreamBufferSize);
+        return fp;
+    }
+
+    bool IsSeekableStream(FILE* fp){
+        if (!fp) return false;
+
+        struct stat st;
+        if (fstat(STREAM_FILENO(fp), &st) != 0) return false;
+        if ((st.st_mode & S_IFMT) != S_IFREG) return false;
+#ifndef WIN32
+        // 追加方式打开时(如 >> 重定向)，定位后的写入仍然落在文件末尾
+        int flags = fcntl(STREAM_FILENO(fp), F_GETFL);
+        if (flags < 0 || (flags & O_APPEND)) return false;
+#endif
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // PCMStreamReader
+    PCMStreamReader::PCMStreamReader() {}
+
+    PCMStreamReader::~PCMStreamReader() {
+        Close();
+    }
+
+    bool PCMStreamReader::Open(const std::string& pcmFilePath){
+        if (m_fp) return false;
+
+        bool ownsFile = false;
+        FILE* fp = OpenStreamFile(pcmFilePath, false, ownsFile);
+        if (!fp) return false;
+        return Attach(fp, ownsFile);
+    }
+
+    bool PCMStreamReader::Open(const std::string& pcmFilePath, uint32_t sampleRate, uint32_t sampleBits, uint16_t channelCnt){
+        if (!Open(pcmFilePath)) {
+            return false;
+        }
+
+        SetFormat(sampleRate, sampleBits, channelCnt);
+        return true;
+    }
+
+    bool PCMStreamReader::Attach(FILE* fp, bool ownsFile){
+        if (!fp || m_fp) return false;
+
+        m_fp = fp;
+        m_ownsFile = ownsFile;
+        m_bytesRead = 0;
+        return true;
+    }
+
+    void PCMStreamReader::SetFormat(uint32_t sampleRate, uint32_t sampleBits, uint16_t channelCnt){
+        m_sampleRate = sampleRate;
+        m_sampleBits = sampleBits;
+        m_channelCnt = channelCnt;
+    }
+
+    size_t PCMStreamReader::ReadBytes(uint32_t bytes2Read, uint8_t* bytes){
+        if (!m_fp) return 0;
+        if (bytes2Read == 0 || bytes == nullptr) return 0;
+
+        size_t nRead = fread(bytes, sizeof(uint8_t), bytes2Read, m_fp);
+        m_bytesRead += nRead;
+        return nRead;
+    }
+
+    size_t PCMStreamReader::ReadBytes(uint32_t bytes2Read, std::vector<uint8_t>& bytes){
+        if (!m_fp) return 0;
+
+        bytes.resize(bytes2Read);
+        size_t nRead = ReadBytes(bytes2Read, bytes.data());
+        bytes.resize(nRead);
+        return nRead;
+    }
+
+    size_t PCMStreamReader::ReadShorts(uint32_t shorts2Read, uint16_t* shorts){
+        if (!m_fp) return 0;
+        if (shorts2Read == 0 || shorts == nullptr) return 0;
+
+        size_t nRead = fread(shorts, sizeof(uint16_t), shorts2Read, m_fp);
+        m_bytesRead += nRead * sizeof(uint16_t);
+        return nRead;
+    }
+
+    size_t PCMStreamReader::ReadShorts(uint32_t shorts2Read, std::vector<uint16_t>& shorts){
+        if (!m_fp) return 0;
+
+        shorts.resize(shorts2Read);
+        size_t nRead = ReadShorts(shorts2Read, shorts.data());
+        shorts.resize(nRead);
+        return nRead;
+    }
+
+    size_t PCMStreamReader::ReadDuration(uint32_t durationMs, std::vector<uint8_t>& data){
+        if (!m_fp) return 0;
+        if (m_sampleRate == 0 || m_sampleBits == 0 || m_channelCnt == 0) return 0;
+
+        uint32_t bytesPerMs = (m_sampleRate * m_sampleBits/8 * m_channelCnt) / 1000; // 每 ms 的字节数
+        return ReadBytes(bytesPerMs * durationMs, data);
+    }
+
+    size_t PCMStreamReader::ReadDuration(uint32_t durationMs, std::vector<uint16_t>& data){
+        if (!m_fp) return 0;
+        if (m_sampleRate == 0 || m_sampleBits == 0 || m_channelCnt == 0) return 0;
+
+        uint32_t shortsPerMs = (m_sampleRate * m_sampleBits/16 * m_channelCnt) / 1000; // 每 ms 的 short 个数
+        return ReadShorts(shortsPerMs * durationMs, data);
+    }
+
+    void PCMStreamReader::Close(){
+        if (m_fp) {
+            if (m_ownsFile) {
+                fclose(m_fp);
+            }
+            m_fp = nullptr;
+            m_ownsFile = false;
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // PCMStreamWriter
+    PCMStreamWriter::PCMStreamWriter() {}
+
+    PCMStreamWriter::~PCMStreamWriter() {
+        Close();
+    }
+
+    bool PCMStreamWriter::Open(const std::string& pcmFilePath){
+        if (m_fp) return false;
+
+        bool ownsFile = false;
+        FILE* fp = OpenStreamFile(pcmFilePath, true, ownsFile);
+        if (!fp) return false;
+        return Attach(fp, ownsFile);
+    }
+
+    bool PCMStreamWriter::Attach(FILE* fp, bool ownsFile){
+        if (!fp || m_fp) return false;
+
+        m_fp = fp;
+        m_ownsFile = ownsFile;
+        m_error = false;
+        m_bytesWritten = 0;
+        return true;
+    }
+
+    void PCMStreamWriter::Write(const uint8_t* data, uint32_t len){
+        if (!m_fp || m_error) return;
+        if (!data || len == 0) return;
+
+        size_t nWrite = fwrite(data, sizeof(uint8_t), len, m_fp);
+        m_bytesWritten += nWrite;
+        if (nWrite < len) {
+            m_error = true;
+        }
+    }
+
+    void PCMStreamWriter::Write(const uint16_t* data, uint32_t len){
+        Write((const uint8_t*)data, len * 2);
+    }
+
+    void PCMStreamWriter::Write(const std::vector<uint8_t>& data){
+        if (data.size() == 0) return;
+        Write(&data[0], data.size());
+    }
+
+    void PCMStreamWriter::Write(const std::vector<uint8_t>& data, size_t len){
+        if (data.size() == 0) return;
+        Write(&data[0], len);
+    }
+
+    void PCMStreamWriter::Write(const std::vector<uint16_t>& data){
+        if (data.size() == 0) return;
+        Write(&data[0], data.size());
+    }
+
+    void PCMStreamWriter::Write(const std::vector<uint16_t>& data, size_t len){
+        if (data.size() == 0) return;
+        Write(&data[0], len);
+    }
+
+    bool PCMStreamWriter::Flush(){
+        if (!m_fp) return false;
+        if (fflush(m_fp) != 0) {
+            m_error = true;
+        }
+        return !m_error;
+    }
+
+    void PCMStreamWriter::Close(){
+        if (m_fp) {
+            Flush();
+            if (m_ownsFile) {
+                fclose(m_fp);
+            }
+            m_fp = nullptr;
+            m_ownsFile = false;
+        }
+    }
+}
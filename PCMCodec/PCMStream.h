@@ -0,0 +1,130 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef PCM_STREAM_H
+#define PCM_STREAM_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+
+namespace PCMCodec {
+
+    // OpenStreamFile: 打开流式读写的文件，路径为 "-" 时返回 stdin(读)/stdout(写)，Windows 上切换为二进制模式
+    // 打开后设置 64KB 的缓冲，减少管道上的系统调用次数，因此 "-" 需要在对 stdin/stdout 做任何读写之前打开
+    // * path     : 文件路径，或 "-"
+    // * write    : true 为写(截断已有文件)，false 为读
+    // * ownsFile : [输出] 是否需要调用者 fclose，stdin/stdout 为 false
+    // * 返回值    : 失败时返回 nullptr
+    FILE* OpenStreamFile(const std::string& path, bool write, bool& ownsFile);
+
+    // IsSeekableStream: 是否为可以定位并改写已写入数据的普通文件，管道、终端、套接字以及以追加方式(O_APPEND)打开的文件返回 false
+    bool IsSeekableStream(FILE* fp);
+
+    /*example code
+
+        // cat in.pcm | ./app | aplay -f S16_LE -r 8000
+        PCMStreamReader reader;
+        PCMStreamWriter writer;
+        reader.Open("-", 8000, 16, 1);
+        writer.Open("-");
+        std::vector<uint16_t> frame;
+        while(reader.ReadDuration(20, frame) > 0){
+            // process frame as you want
+            writer.Write(frame);
+        }
+        writer.Close();
+        reader.Close();
+    */
+
+    // PCMStreamReader: 顺序读取 PCM 数据，不定位，不获取文件大小，可用于 stdin、管道、套接字(fdopen)
+    // 接口与 PCMFileReader 相同，但没有 SeekToTime/GetFileSize；读到流结束时返回的长度为 0
+    class PCMStreamReader{
+    public:
+        PCMStreamReader();
+        ~PCMStreamReader();
+
+        // Open: 打开文件，"-" 为标准输入
+        bool Open(const std::string& pcmFilePath);
+
+        // Open: 打开文件，同时指定PCM的采样参数，只有指定了采样参数，才能使用 ReadDuration 函数
+        bool Open(const std::string& pcmFilePath, uint32_t sampleRate, uint32_t sampleBits, uint16_t channelCnt);
+
+        // Attach: 使用已经打开的流，如 popen/fdopen 的返回值
+        // * ownsFile : Close 时是否 fclose
+        bool Attach(FILE* fp, bool ownsFile = false);
+
+        // SetFormat: 指定PCM的采样参数，用于 Attach 的流
+        void SetFormat(uint32_t sampleRate, uint32_t sampleBits, uint16_t channelCnt);
+
+        // ReadBytes/ReadShorts: 读取指定数量的数据，管道中数据不足时阻塞等待，直到读满或者流结束
+        // * 返回值 : 实际读取到的个数，为 0 表示流已结束
+        size_t ReadBytes(uint32_t bytes2Read, uint8_t* bytes);
+        size_t ReadBytes(uint32_t bytes2Read, std::vector<uint8_t>& bytes);
+        size_t ReadShorts(uint32_t shorts2Read, uint16_t* shorts);
+        size_t ReadShorts(uint32_t shorts2Read, std::vector<uint16_t>& shorts);
+
+        // ReadDuration: 读取指定时长的音频数据，必须已指定采样参数
+        size_t ReadDuration(uint32_t durationMs, std::vector<uint8_t>& data);
+        size_t ReadDuration(uint32_t durationMs, std::vector<uint16_t>& data);
+
+        // GetBytesRead: 已读取的字节数
+        uint64_t GetBytesRead() const { return m_bytesRead; }
+
+        // HasError: 是否发生读错误(区别于正常的流结束)
+        bool HasError() const { return m_fp != nullptr && ferror(m_fp) != 0; }
+
+        // Close: 关闭文件，stdin 和 Attach 时 ownsFile 为 false 的流不会被关闭
+        void Close();
+    private:
+        FILE* m_fp = nullptr;
+        bool m_ownsFile = false;
+        uint64_t m_bytesRead = 0;
+        uint32_t m_sampleRate = 0;
+        uint32_t m_sampleBits = 0;
+        uint16_t m_channelCnt = 0;
+    };
+
+    // PCMStreamWriter: 顺序写 PCM 数据，不定位，可用于 stdout、管道、套接字(fdopen)
+    class PCMStreamWriter{
+    public:
+        PCMStreamWriter();
+        ~PCMStreamWriter();
+
+        // Open: 打开文件，"-" 为标准输出
+        bool Open(const std::string& pcmFilePath);
+
+        // Attach: 使用已经打开的流
+        // * ownsFile : Close 时是否 fclose
+        bool Attach(FILE* fp, bool ownsFile = false);
+
+        // Write: 写入数据，写失败(如管道的读端已关闭)后 HasError 返回 true
+        // 向已关闭的管道写入时默认会收到 SIGPIPE 而退出，需要由调用者忽略 SIGPIPE(signal(SIGPIPE, SIG_IGN))才能得到写失败
+        void Write(const uint8_t* data, uint32_t len);
+        void Write(const uint16_t* data, uint32_t len);
+        void Write(const std::vector<uint8_t>& data);
+        void Write(const std::vector<uint8_t>& data, size_t len);
+        void Write(const std::vector<uint16_t>& data);
+        void Write(const std::vector<uint16_t>& data, size_t len);
+
+        // Flush: 将缓冲的数据写到流中，实时处理时每帧之后调用，降低下游的延迟
+        bool Flush();
+
+        // GetBytesWritten: 已写入的字节数
+        uint64_t GetBytesWritten() const { return m_bytesWritten; }
+
+        bool HasError() const { return m_error; }
+
+        // Close: 刷新并关闭文件，stdout 和 Attach 时 ownsFile 为 false 的流只刷新不关闭
+        void Close();
+    private:
+        FILE* m_fp = nullptr;
+        bool m_ownsFile = false;
+        bool m_error = false;
+        uint64_t m_bytesWritten = 0;
+    };
+};
+
+#endif //PCM_STREAM_H
@@ -0,0 +1,232 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "Pipeline.h"
+
+#include <thread>
+
+namespace Pipeline {
+
+    ///////////////////////////////////////////////////
+    // FramePool
+    FramePool::FramePool() {}
+
+    FramePool::~FramePool() {}
+
+    AudioFrame* FramePool::Acquire() {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (!m_free.empty()) {
+            AudioFrame* frame = m_free.back();
+            m_free.pop_back();
+            return frame;
+        }
+
+        m_frames.push_back(std::unique_ptr<AudioFrame>(new AudioFrame()));
+        return m_frames.back().get();
+    }
+
+    void FramePool::Release(AudioFrame* frame) {
+        if (!frame) return;
+        frame->data.clear(); // 保留容量
+        frame->sequence = 0;
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_free.push_back(frame);
+    }
+
+    size_t FramePool::GetAllocatedCount() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_frames.size();
+    }
+
+    ///////////////////////////////////////////////////
+    // FrameQueue
+    FrameQueue::FrameQueue(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+    bool FrameQueue::Push(AudioFrame* frame) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [&]{ return m_aborted || m_frames.size() < m_capacity; });
+        if (m_aborted) return false;
+
+        m_frames.push_back(frame);
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    AudioFrame* FrameQueue::Pop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [&]{ return m_aborted || m_closed || !m_frames.empty(); });
+        if (m_aborted || m_frames.empty()) return nullptr;
+
+        AudioFrame* frame = m_frames.front();
+        m_frames.pop_front();
+        m_notFull.notify_one();
+        return frame;
+    }
+
+    void FrameQueue::Close() {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_closed = true;
+        m_notEmpty.notify_all();
+    }
+
+    void FrameQueue::Abort() {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_aborted = true;
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+    ///////////////////////////////////////////////////
+    // Pipeline
+    Pipeline::Pipeline(uint32_t frameMs, uint32_t queueDepth) : m_frameMs(frameMs > 0 ? frameMs : 1), m_queueDepth(queueDepth), m_failed(false) {}
+
+    Pipeline::~Pipeline() {}
+
+    void Pipeline::SetSource(std::unique_ptr<PipelineSource> source) {
+        m_source = std::move(source);
+    }
+
+    void Pipeline::AddStage(std::unique_ptr<PipelineStage> stage, bool newThread) {
+        if (!stage) return;
+        m_stages.push_back(std::move(stage));
+        m_newThread.push_back(newThread);
+    }
+
+    void Pipeline::SetSink(std::unique_ptr<PipelineSink> sink, bool newThread) {
+        m_sink = std::move(sink);
+        m_sinkNewThread = newThread;
+    }
+
+    void Pipeline::Fail() {
+        m_failed = true;
+        for (size_t i = 0; i < m_queues.size(); i++) {
+            m_queues[i]->Abort();
+        }
+    }
+
+    bool Pipeline::ProcessFrom(const Segment& segment, size_t stage, AudioFrame* frame) {
+        for (size_t i = stage; i < segment.lastStage && frame; i++) {
+            if (!m_stages[i]->Process(frame, m_pool)) {
+                printf("pipeline stage %s failed\n", m_stages[i]->GetName());
+                m_pool.Release(frame);
+                return false;
+            }
+        }
+        if (!frame) return true;
+
+        if (segment.output) {
+            if (!segment.output->Push(frame)) {
+                m_pool.Release(frame);
+                return false;
+            }
+            return true;
+        }
+
+        bool ret = m_sink->Write(*frame);
+        m_pool.Release(frame);
+        if (!ret) printf("pipeline sink write failed\n");
+        return ret;
+    }
+
+    void Pipeline::RunSegment(const Segment& segment) {
+        while (!m_failed) {
+            AudioFrame* frame = nullptr;
+            if (segment.input) {
+                frame = segment.input->Pop();
+                if (!frame) break;
+            } else {
+                frame = m_pool.Acquire();
+                frame->sequence = m_frameCount;
+                if (!m_source->Read(*frame, m_frameMs) || frame->data.empty()) {
+                    m_pool.Release(frame);
+                    break;
+                }
+                m_frameCount++;
+            }
+
+            if (!ProcessFrom(segment, segment.firstStage, frame)) {
+                Fail();
+                return;
+            }
+        }
+        if (m_failed) return;
+
+        // 输入结束，依次取出各个环节中缓存的数据
+        for (size_t i = segment.firstStage; i < segment.lastStage; i++) {
+            AudioFrame* frame = m_stages[i]->Flush(m_pool);
+            if (frame && !ProcessFrom(segment, i + 1, frame)) {
+                Fail();
+                return;
+            }
+        }
+
+        if (segment.output) segment.output->Close();
+    }
+
+    bool Pipeline::Run() {
+        if (!m_source || !m_sink) return false;
+        m_failed = false;
+        m_frameCount = 0;
+
+        // 格式协商
+        AudioFormat format;
+        if (!m_source->GetFormat(format)) {
+            printf("pipeline source format unavailable\n");
+            return false;
+        }
+        for (size_t i = 0; i < m_stages.size(); i++) {
+            AudioFormat out;
+            if (!m_stages[i]->Init(format, out)) {
+                printf("pipeline stage %s does not support input format, audio_format:%d, sample_rate:%d, sample_bits:%d, channels:%d\n",
+                       m_stages[i]->GetName(), format.audio_format, format.sample_rate, format.sample_bits, format.channels);
+                return false;
+            }
+            format = out;
+        }
+        if (!m_sink->Open(format)) {
+            printf("pipeline sink open failed\n");
+            return false;
+        }
+        m_outputFormat = format;
+
+        // 按线程划分为若干段
+        std::vector<Segment> segments(1);
+        for (size_t i = 0; i < m_stages.size(); i++) {
+            if (m_newThread[i]) {
+                segments.back().lastStage = i;
+                segments.push_back(Segment());
+                segments.back().firstStage = i;
+            }
+        }
+        segments.back().lastStage = m_stages.size();
+        if (m_sinkNewThread) {
+            segments.push_back(Segment());
+            segments.back().firstStage = m_stages.size();
+            segments.back().lastStage = m_stages.size();
+        }
+
+        m_queues.clear();
+        for (size_t i = 1; i < segments.size(); i++) {
+            m_queues.push_back(std::unique_ptr<FrameQueue>(new FrameQueue(m_queueDepth)));
+            segments[i - 1].output = m_queues.back().get();
+            segments[i].input = m_queues.back().get();
+        }
+
+        // 最后一段在当前线程中运行
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i + 1 < segments.size(); i++) {
+            threads.push_back(std::thread(&Pipeline::RunSegment, this, segments[i]));
+        }
+        RunSegment(segments.back());
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+
+        // 出错时队列中可能还有未处理的帧
+        bool ret = !m_failed;
+        m_queues.clear();
+        return m_sink->Close() && ret;
+    }
+}
@@ -0,0 +1,211 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "WaveCodec/WaveFile.h"
+
+namespace Pipeline {
+
+    // AudioFormat: 流经 pipeline 的音频格式
+    struct AudioFormat {
+        uint16_t audio_format = WaveAudioFormatPCM; // WaveAudioFormatPCM/WaveAudioFormatALaw/WaveAudioFormatMuLaw
+        uint32_t sample_rate  = 0;
+        uint16_t sample_bits  = 0;
+        uint16_t channels     = 0;
+
+        // GetBlockAlign: 每帧(所有声道各一个采样)的字节数
+        uint32_t GetBlockAlign() const { return (uint32_t)channels * sample_bits / 8; }
+
+        bool IsPCM16() const { return audio_format == WaveAudioFormatPCM && sample_bits == 16; }
+    };
+
+    // AudioFrame: 一段交错存放的音频数据
+    // 帧由 FramePool 分配和回收，data 的容量在回收后保留，稳定运行时不再分配内存
+    struct AudioFrame {
+        std::vector<uint8_t> data;
+        uint64_t sequence = 0; // 源读出的第几帧
+
+        uint16_t* GetShorts() { return (uint16_t*)data.data(); }
+        const uint16_t* GetShorts() const { return (const uint16_t*)data.data(); }
+        size_t GetShortCount() const { return data.size() / 2; }
+    };
+
+    // FramePool: 可在多个线程之间使用的帧缓冲池
+    class FramePool {
+    public:
+        FramePool();
+        ~FramePool();
+
+        // Acquire: 取一个空闲的帧，没有空闲帧时新分配一个
+        AudioFrame* Acquire();
+
+        // Release: 回收一个帧
+        void Release(AudioFrame* frame);
+
+        // GetAllocatedCount: 总共分配过的帧数，反映了同时在途的最大帧数
+        size_t GetAllocatedCount() const;
+
+    private:
+        FramePool(const FramePool&);
+        FramePool& operator=(const FramePool&);
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<AudioFrame> > m_frames;
+        std::vector<AudioFrame*> m_free;
+    };
+
+    // FrameQueue: 有界阻塞队列，连接运行在不同线程上的两段 pipeline
+    class FrameQueue {
+    public:
+        explicit FrameQueue(size_t capacity);
+
+        // Push: 放入一帧，队列满时阻塞；队列被中止时返回 false
+        bool Push(AudioFrame* frame);
+
+        // Pop: 取出一帧，队列空时阻塞；生产者已结束且队列为空，或队列被中止时返回 nullptr
+        AudioFrame* Pop();
+
+        // Close: 生产者结束
+        void Close();
+
+        // Abort: 出错时中止，唤醒所有等待的线程
+        void Abort();
+
+    private:
+        size_t m_capacity = 0;
+        bool m_closed = false;
+        bool m_aborted = false;
+        std::deque<AudioFrame*> m_frames;
+        std::mutex m_mutex;
+        std::condition_variable m_notEmpty;
+        std::condition_variable m_notFull;
+    };
+
+    // PipelineSource: 音频源
+    class PipelineSource {
+    public:
+        virtual ~PipelineSource() {}
+
+        // GetFormat: 输出的音频格式，在 Read 之前调用
+        virtual bool GetFormat(AudioFormat& format) = 0;
+
+        // Read: 读取 frameMs 时长的数据到 frame.data，没有更多数据时返回 false
+        virtual bool Read(AudioFrame& frame, uint32_t frameMs) = 0;
+    };
+
+    // PipelineStage: 处理环节
+    class PipelineStage {
+    public:
+        virtual ~PipelineStage() {}
+
+        virtual const char* GetName() const = 0;
+
+        // Init: 根据输入格式确定输出格式，不支持输入格式时返回 false
+        virtual bool Init(const AudioFormat& in, AudioFormat& out) = 0;
+
+        // Process: 处理一帧
+        // 可以原地修改 frame；也可以从 pool 取一个新帧写入结果，回收输入帧，并把 frame 指向新帧
+        // 把 frame 置为 nullptr (并回收输入帧) 表示这一帧没有输出
+        virtual bool Process(AudioFrame*& frame, FramePool& pool) = 0;
+
+        // Flush: 输入结束时调用，返回内部缓存的最后一帧，没有时返回 nullptr
+        virtual AudioFrame* Flush(FramePool& /*pool*/) { return nullptr; }
+    };
+
+    // PipelineSink: 输出
+    class PipelineSink {
+    public:
+        virtual ~PipelineSink() {}
+
+        virtual bool Open(const AudioFormat& format) = 0;
+        virtual bool Write(const AudioFrame& frame) = 0;
+        virtual bool Close() = 0;
+    };
+
+    /*example code
+
+        Pipeline pipeline(100);
+        pipeline.SetSource(std::unique_ptr<PipelineSource>(new WaveFileSource("in.wav")));
+        pipeline.AddStage(std::unique_ptr<PipelineStage>(new ChannelSelectStage(0)));
+        pipeline.AddStage(std::unique_ptr<PipelineStage>(new ResampleStage(8000)), true); // 在新线程中运行
+        pipeline.AddStage(std::unique_ptr<PipelineStage>(new G711EncodeStage(WaveAudioFormatALaw)));
+        pipeline.SetSink(std::unique_ptr<PipelineSink>(new WaveFileSink("out.wav")));
+        pipeline.Run();
+    */
+
+    // Pipeline: 源 -> 若干处理环节 -> 输出，数据只流过一遍，不需要中间文件
+    // 默认所有环节在调用 Run 的线程中依次执行；AddStage/SetSink 时指定 newThread，
+    // 则从该环节开始在新线程中运行，与前一段之间通过有界队列连接
+    class Pipeline {
+    public:
+        // * frameMs    : 源每次读取的时长
+        // * queueDepth : 线程之间队列的容量(帧数)
+        explicit Pipeline(uint32_t frameMs = 100, uint32_t queueDepth = 4);
+        ~Pipeline();
+
+        void SetSource(std::unique_ptr<PipelineSource> source);
+        void AddStage(std::unique_ptr<PipelineStage> stage, bool newThread = false);
+        void SetSink(std::unique_ptr<PipelineSink> sink, bool newThread = false);
+
+        // Run: 运行直到源中的数据全部处理完
+        // * 返回值 : 是否成功
+        bool Run();
+
+        // GetOutputFormat: Run 之后，输出的音频格式
+        const AudioFormat& GetOutputFormat() const { return m_outputFormat; }
+
+        // GetFrameCount: Run 之后，源读出的帧数
+        uint64_t GetFrameCount() const { return m_frameCount; }
+
+        // GetAllocatedFrames: Run 之后，分配过的帧数
+        size_t GetAllocatedFrames() const { return m_pool.GetAllocatedCount(); }
+
+    private:
+        Pipeline(const Pipeline&);
+        Pipeline& operator=(const Pipeline&);
+
+        // Segment: 在同一个线程中运行的一段
+        struct Segment {
+            size_t firstStage = 0; // [firstStage, lastStage)
+            size_t lastStage  = 0;
+            FrameQueue* input  = nullptr; // 为空时从源读取
+            FrameQueue* output = nullptr; // 为空时写入 sink
+        };
+
+        void RunSegment(const Segment& segment);
+
+        // 让 frame 依次经过 [stage, segment.lastStage) 环节，然后输出
+        bool ProcessFrom(const Segment& segment, size_t stage, AudioFrame* frame);
+
+        void Fail();
+
+        uint32_t m_frameMs = 0;
+        uint32_t m_queueDepth = 0;
+        std::unique_ptr<PipelineSource> m_source;
+        std::vector<std::unique_ptr<PipelineStage> > m_stages;
+        std::vector<bool> m_newThread;   // 每个环节是否开始一个新线程
+        std::unique_ptr<PipelineSink> m_sink;
+        bool m_sinkNewThread = false;
+
+        FramePool m_pool;
+        std::vector<std::unique_ptr<FrameQueue> > m_queues;
+        AudioFormat m_outputFormat;
+        uint64_t m_frameCount = 0;
+        std::atomic<bool> m_failed;
+    };
+};
+
+#endif //PIPELINE_H
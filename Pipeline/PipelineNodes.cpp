@@ -0,0 +1,364 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "PipelineNodes.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "G711Codec/G711Codec.hpp"
+#include "PCMCodec/PCMCodec.h"
+#include "PCMCodec/PCMNormalize.h"
+
+namespace Pipeline {
+
+    // 每次读取的字节数，取整到完整的帧，至少一帧
+    static uint32_t GetFrameBytes(const AudioFormat& format, uint32_t frameMs) {
+        uint32_t blockAlign = format.GetBlockAlign();
+        uint64_t frames = (uint64_t)format.sample_rate * frameMs / 1000;
+        if (frames == 0) frames = 1;
+        return (uint32_t)(frames * blockAlign);
+    }
+
+    static bool IsG711(uint16_t audio_format) {
+        return audio_format == WaveAudioFormatALaw || audio_format == WaveAudioFormatMuLaw;
+    }
+
+    ///////////////////////////////////////////////////
+    // WaveFileSource
+    WaveFileSource::WaveFileSource(const std::string& waveFilePath) : m_path(waveFilePath) {}
+
+    bool WaveFileSource::GetFormat(AudioFormat& format) {
+        if (!m_opened) {
+            if (!m_reader.Open(m_path)) {
+                printf("open wave file failed, %s\n", m_path.c_str());
+                return false;
+            }
+
+            WaveCodec::WaveHeader header;
+            if (!m_reader.ReadWaveHeader(header)) {
+                printf("read wave header failed, %s\n", m_path.c_str());
+                return false;
+            }
+
+            m_format.audio_format = header.riff.fmt.audio_format;
+            m_format.sample_rate = header.riff.fmt.sample_rate;
+            m_format.sample_bits = header.riff.fmt.bits_per_sample;
+            m_format.channels = header.riff.fmt.channels;
+            if (m_format.audio_format != WaveAudioFormatPCM && !IsG711(m_format.audio_format)) {
+                printf("unsupported wave audio format: %s\n", WaveCodec::GetWaveAudioFormatString(m_format.audio_format).c_str());
+                return false;
+            }
+            if (m_format.GetBlockAlign() == 0 || m_format.sample_rate == 0) {
+                printf("invalid wave header, %s\n", m_path.c_str());
+                return false;
+            }
+
+            // 流式写入的文件 data 大小可能为 0，此时读到文件末尾
+            m_dataLeft = header.riff.data.header.size;
+            if (m_dataLeft == 0) m_dataLeft = UINT64_MAX;
+            m_opened = true;
+        }
+
+        format = m_format;
+        return true;
+    }
+
+    bool WaveFileSource::Read(AudioFrame& frame, uint32_t frameMs) {
+        if (!m_opened || m_dataLeft == 0) return false;
+
+        uint32_t blockAlign = m_format.GetBlockAlign();
+        uint64_t toRead = std::min<uint64_t>(GetFrameBytes(m_format, frameMs), m_dataLeft);
+        toRead -= toRead % blockAlign;
+        if (toRead == 0) return false;
+
+        size_t nRead = m_reader.ReadBytes((uint32_t)toRead, frame.data);
+        frame.data.resize(nRead - nRead % blockAlign);
+        m_dataLeft = nRead < toRead ? 0 : m_dataLeft - nRead;
+        return !frame.data.empty();
+    }
+
+    ///////////////////////////////////////////////////
+    // PCMFileSource
+    PCMFileSource::PCMFileSource(const std::string& pcmFilePath, const AudioFormat& format) : m_path(pcmFilePath), m_format(format) {}
+
+    bool PCMFileSource::GetFormat(AudioFormat& format) {
+        if (m_format.GetBlockAlign() == 0 || m_format.sample_rate == 0) {
+            printf("invalid pcm format, sample_rate:%d, sample_bits:%d, channels:%d\n", m_format.sample_rate, m_format.sample_bits, m_format.channels);
+            return false;
+        }
+
+        if (!m_opened) {
+            if (!m_reader.Open(m_path, m_format.sample_rate, m_format.sample_bits, m_format.channels)) {
+                printf("open pcm file failed, %s\n", m_path.c_str());
+                return false;
+            }
+            m_opened = true;
+        }
+
+        format = m_format;
+        return true;
+    }
+
+    bool PCMFileSource::Read(AudioFrame& frame, uint32_t frameMs) {
+        if (!m_opened) return false;
+
+        uint32_t blockAlign = m_format.GetBlockAlign();
+        size_t nRead = m_reader.ReadBytes(GetFrameBytes(m_format, frameMs), frame.data);
+        frame.data.resize(nRead - nRead % blockAlign); // 末尾不完整的帧被丢弃
+        return !frame.data.empty();
+    }
+
+    ///////////////////////////////////////////////////
+    // GainStage
+    bool GainStage::Init(const AudioFormat& in, AudioFormat& out) {
+        if (!in.IsPCM16()) return false;
+        out = in;
+        return true;
+    }
+
+    bool GainStage::Process(AudioFrame*& frame, FramePool& /*pool*/) {
+        PCMCodec::ApplyGain(frame->GetShorts(), frame->GetShortCount(), m_gain);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // ChannelSelectStage
+    bool ChannelSelectStage::Init(const AudioFormat& in, AudioFormat& out) {
+        if (in.sample_bits != 8 && in.sample_bits != 16) return false;
+        if (m_channel >= in.channels) return false;
+
+        m_in = in;
+        out = in;
+        out.channels = 1;
+        return true;
+    }
+
+    bool ChannelSelectStage::Process(AudioFrame*& frame, FramePool& pool) {
+        if (m_in.channels == 1) return true;
+
+        AudioFrame* out = pool.Acquire();
+        out->sequence = frame->sequence;
+        if (m_in.sample_bits == 8) {
+            PCMCodec::ChannelView8 view = PCMCodec::ChannelView8::FromInterleaved(frame->data, m_in.channels, m_channel);
+            out->data.resize(view.size());
+            if (!view.empty()) view.Gather(out->data.data());
+        } else {
+            PCMCodec::ChannelView16 view = PCMCodec::ChannelView16::FromInterleaved(frame->GetShorts(), frame->GetShortCount(), m_in.channels, m_channel);
+            out->data.resize(view.size() * 2);
+            if (!view.empty()) view.Gather(out->GetShorts());
+        }
+
+        pool.Release(frame);
+        frame = out;
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // MixStage
+    bool MixStage::Init(const AudioFormat& in, AudioFormat& out) {
+        if (!in.IsPCM16() || in.channels != 2) return false;
+        out = in;
+        out.channels = 1;
+        return true;
+    }
+
+    bool MixStage::Process(AudioFrame*& frame, FramePool& /*pool*/) {
+        const uint16_t* samples = frame->GetShorts();
+        size_t count = frame->GetShortCount();
+        PCMCodec::Mixing(PCMCodec::ChannelView16::FromInterleaved(samples, count, 2, 0),
+                         PCMCodec::ChannelView16::FromInterleaved(samples, count, 2, 1), m_mixed);
+
+        // 单声道数据不会超过原数据长度，原地写回
+        frame->data.resize(m_mixed.size() * 2);
+        if (!m_mixed.empty()) memcpy(frame->data.data(), m_mixed.data(), m_mixed.size() * 2);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // ResampleStage
+    bool ResampleStage::Init(const AudioFormat& in, AudioFormat& out) {
+        if (!in.IsPCM16() || in.channels == 0 || m_outRate == 0) return false;
+
+        m_inRate = in.sample_rate;
+        m_channels = in.channels;
+        m_inBase = 0;
+        m_outIndex = 0;
+        m_prev.assign(m_channels, 0);
+
+        out = in;
+        out.sample_rate = m_outRate;
+        return true;
+    }
+
+    void ResampleStage::Interpolate(const uint16_t* samples, uint64_t inEnd, bool flush, AudioFrame& out) {
+        while (true) {
+            // 第 m_outIndex 个输出位于输入的 i + frac/m_outRate 处
+            uint64_t t = m_outIndex * m_inRate;
+            uint64_t i = t / m_outRate;
+            int64_t frac = (int64_t)(t % m_outRate);
+            if (flush ? i >= inEnd : i + 1 >= inEnd) break;
+
+            // i 最小为 m_inBase - 1，即上一段的最后一帧；结束时 i + 1 超出范围，保持最后一个采样
+            uint64_t j = flush ? i : i + 1;
+            size_t pos = out.data.size();
+            out.data.resize(pos + m_channels * 2);
+            uint16_t* dst = (uint16_t*)&out.data[pos];
+            for (uint16_t ch = 0; ch < m_channels; ch++) {
+                int64_t a = i < m_inBase ? m_prev[ch] : (int16_t)samples[(i - m_inBase) * m_channels + ch];
+                int64_t b = j < m_inBase ? m_prev[ch] : (int16_t)samples[(j - m_inBase) * m_channels + ch];
+                dst[ch] = (uint16_t)(int16_t)(a + (b - a) * frac / (int64_t)m_outRate);
+            }
+            m_outIndex++;
+        }
+    }
+
+    bool ResampleStage::Process(AudioFrame*& frame, FramePool& pool) {
+        if (m_inRate == m_outRate) return true;
+
+        size_t frames = frame->GetShortCount() / m_channels;
+        if (frames == 0) return true;
+
+        AudioFrame* out = pool.Acquire();
+        out->sequence = frame->sequence;
+        out->data.reserve((frames * m_outRate / m_inRate + 2) * m_channels * 2);
+
+        const uint16_t* samples = frame->GetShorts();
+        Interpolate(samples, m_inBase + frames, false, *out);
+
+        for (uint16_t ch = 0; ch < m_channels; ch++) {
+            m_prev[ch] = (int16_t)samples[(frames - 1) * m_channels + ch];
+        }
+        m_inBase += frames;
+
+        pool.Release(frame);
+        frame = out;
+        if (frame->data.empty()) {
+            pool.Release(frame);
+            frame = nullptr;
+        }
+        return true;
+    }
+
+    AudioFrame* ResampleStage::Flush(FramePool& pool) {
+        if (m_inRate == m_outRate || m_inBase == 0) return nullptr;
+
+        AudioFrame* out = pool.Acquire();
+        Interpolate(nullptr, m_inBase, true, *out);
+        if (out->data.empty()) {
+            pool.Release(out);
+            return nullptr;
+        }
+        return out;
+    }
+
+    ///////////////////////////////////////////////////
+    // G711EncodeStage
+    bool G711EncodeStage::Init(const AudioFormat& in, AudioFormat& out) {
+        if (!in.IsPCM16() || !IsG711(m_format)) return false;
+        out = in;
+        out.audio_format = m_format;
+        out.sample_bits = 8;
+        return true;
+    }
+
+    bool G711EncodeStage::Process(AudioFrame*& frame, FramePool& pool) {
+        AudioFrame* out = pool.Acquire();
+        out->sequence = frame->sequence;
+        size_t count = frame->GetShortCount();
+        out->data.resize(count);
+        if (count > 0) {
+            if (m_format == WaveAudioFormatALaw) {
+                G711Codec::ALawEncode(frame->GetShorts(), count, out->data.data());
+            } else {
+                G711Codec::MuLawEncode(frame->GetShorts(), count, out->data.data());
+            }
+        }
+
+        pool.Release(frame);
+        frame = out;
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // G711DecodeStage
+    bool G711DecodeStage::Init(const AudioFormat& in, AudioFormat& out) {
+        if (!IsG711(in.audio_format) || in.sample_bits != 8) return false;
+        m_format = in.audio_format;
+        out = in;
+        out.audio_format = WaveAudioFormatPCM;
+        out.sample_bits = 16;
+        return true;
+    }
+
+    bool G711DecodeStage::Process(AudioFrame*& frame, FramePool& pool) {
+        AudioFrame* out = pool.Acquire();
+        out->sequence = frame->sequence;
+        size_t count = frame->data.size();
+        out->data.resize(count * 2);
+        if (count > 0) {
+            if (m_format == WaveAudioFormatALaw) {
+                G711Codec::ALawDecode(frame->data.data(), count, out->GetShorts());
+            } else {
+                G711Codec::MuLawDecode(frame->data.data(), count, out->GetShorts());
+            }
+        }
+
+        pool.Release(frame);
+        frame = out;
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // WaveFileSink
+    bool WaveFileSink::Open(const AudioFormat& format) {
+        if (format.audio_format != WaveAudioFormatPCM && !IsG711(format.audio_format)) {
+            printf("wave sink unsupported audio format: %s\n", WaveCodec::GetWaveAudioFormatString(format.audio_format).c_str());
+            return false;
+        }
+        if (!m_writer.Open(m_path, format.audio_format, format.sample_rate, format.sample_bits, format.channels)) {
+            printf("open wave file failed, %s\n", m_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool WaveFileSink::Write(const AudioFrame& frame) {
+        if (!frame.data.empty()) m_writer.Write(frame.data.data(), (uint32_t)frame.data.size());
+        return !m_writer.HasError();
+    }
+
+    bool WaveFileSink::Close() {
+        m_writer.Close();
+        if (m_writer.HasError()) {
+            printf("write wave file failed, %s\n", m_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // PCMFileSink
+    bool PCMFileSink::Open(const AudioFormat& /*format*/) {
+        if (!m_writer.Open(m_path)) {
+            printf("open pcm file failed, %s\n", m_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool PCMFileSink::Write(const AudioFrame& frame) {
+        if (!frame.data.empty()) m_writer.Write(frame.data.data(), (uint32_t)frame.data.size());
+        return !m_writer.HasError();
+    }
+
+    bool PCMFileSink::Close() {
+        m_writer.Close();
+        if (m_writer.HasError()) {
+            printf("write pcm file failed, %s\n", m_path.c_str());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,173 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef PIPELINE_NODES_H
+#define PIPELINE_NODES_H
+
+#include "Pipeline.h"
+#include "PCMCodec/PCMFile.h"
+#include "PCMCodec/PCMStream.h"
+#include "WaveCodec/WaveFile.h"
+#include "WaveCodec/WaveStream.h"
+
+namespace Pipeline {
+
+    ///////////////////////////////////////////////////
+    // 源
+
+    // WaveFileSource: 读取 Wave 文件，支持 PCM/ALaw/MuLaw，只读取 data 子块中的数据
+    class WaveFileSource : public PipelineSource {
+    public:
+        explicit WaveFileSource(const std::string& waveFilePath);
+
+        bool GetFormat(AudioFormat& format) override;
+        bool Read(AudioFrame& frame, uint32_t frameMs) override;
+
+    private:
+        std::string m_path;
+        WaveCodec::WaveFileReader m_reader;
+        AudioFormat m_format;
+        uint64_t m_dataLeft = 0;
+        bool m_opened = false;
+    };
+
+    // PCMFileSource: 读取 PCM 文件，采样参数由调用者指定
+    class PCMFileSource : public PipelineSource {
+    public:
+        PCMFileSource(const std::string& pcmFilePath, const AudioFormat& format);
+
+        bool GetFormat(AudioFormat& format) override;
+        bool Read(AudioFrame& frame, uint32_t frameMs) override;
+
+    private:
+        std::string m_path;
+        PCMCodec::PCMFileReader m_reader;
+        AudioFormat m_format;
+        bool m_opened = false;
+    };
+
+    ///////////////////////////////////////////////////
+    // 处理环节
+
+    // GainStage: 对 16bit PCM 原地施加线性增益
+    class GainStage : public PipelineStage {
+    public:
+        explicit GainStage(double gain) : m_gain(gain) {}
+
+        const char* GetName() const override { return "gain"; }
+        bool Init(const AudioFormat& in, AudioFormat& out) override;
+        bool Process(AudioFrame*& frame, FramePool& pool) override;
+
+    private:
+        double m_gain = 1.0;
+    };
+
+    // ChannelSelectStage: 从多声道数据中取出一个声道，支持 8/16bit
+    class ChannelSelectStage : public PipelineStage {
+    public:
+        // * channel : 声道下标，0 为左声道
+        explicit ChannelSelectStage(uint16_t channel) : m_channel(channel) {}
+
+        const char* GetName() const override { return "channel"; }
+        bool Init(const AudioFormat& in, AudioFormat& out) override;
+        bool Process(AudioFrame*& frame, FramePool& pool) override;
+
+    private:
+        uint16_t m_channel = 0;
+        AudioFormat m_in;
+    };
+
+    // MixStage: 16bit 双声道混音为单声道
+    class MixStage : public PipelineStage {
+    public:
+        const char* GetName() const override { return "mix"; }
+        bool Init(const AudioFormat& in, AudioFormat& out) override;
+        bool Process(AudioFrame*& frame, FramePool& pool) override;
+
+    private:
+        std::vector<uint16_t> m_mixed;
+    };
+
+    // ResampleStage: 16bit PCM 重采样，线性插值，支持任意声道数
+    // 帧与帧之间的采样位置连续，输出与整段数据一次性重采样的结果相同
+    class ResampleStage : public PipelineStage {
+    public:
+        explicit ResampleStage(uint32_t sampleRate) : m_outRate(sampleRate) {}
+
+        const char* GetName() const override { return "resample"; }
+        bool Init(const AudioFormat& in, AudioFormat& out) override;
+        bool Process(AudioFrame*& frame, FramePool& pool) override;
+        AudioFrame* Flush(FramePool& pool) override;
+
+    private:
+        // 生成输入位置不超过 inEnd 的输出，samples 为 [m_inBase, m_inBase + frames) 的输入
+        void Interpolate(const uint16_t* samples, uint64_t inEnd, bool flush, AudioFrame& out);
+
+        uint32_t m_inRate = 0;
+        uint32_t m_outRate = 0;
+        uint16_t m_channels = 0;
+        uint64_t m_inBase = 0;   // 已处理的输入帧数
+        uint64_t m_outIndex = 0; // 已输出的帧数
+        std::vector<int16_t> m_prev; // 上一段输入的最后一帧
+    };
+
+    // G711EncodeStage: 16bit PCM 编码为 A-law/mu-law
+    class G711EncodeStage : public PipelineStage {
+    public:
+        // * audio_format : WaveAudioFormatALaw 或 WaveAudioFormatMuLaw
+        explicit G711EncodeStage(uint16_t audio_format) : m_format(audio_format) {}
+
+        const char* GetName() const override { return "g711enc"; }
+        bool Init(const AudioFormat& in, AudioFormat& out) override;
+        bool Process(AudioFrame*& frame, FramePool& pool) override;
+
+    private:
+        uint16_t m_format = WaveAudioFormatALaw;
+    };
+
+    // G711DecodeStage: A-law/mu-law 解码为 16bit PCM
+    class G711DecodeStage : public PipelineStage {
+    public:
+        const char* GetName() const override { return "g711dec"; }
+        bool Init(const AudioFormat& in, AudioFormat& out) override;
+        bool Process(AudioFrame*& frame, FramePool& pool) override;
+
+    private:
+        uint16_t m_format = WaveAudioFormatALaw;
+    };
+
+    ///////////////////////////////////////////////////
+    // 输出
+
+    // WaveFileSink: 写 Wave 文件，支持 PCM/ALaw/MuLaw
+    // 通过 WaveStreamWriter 顺序写入，Close 时回填大小；写失败(如磁盘已满)时 Write/Close 返回 false，流水线停止
+    class WaveFileSink : public PipelineSink {
+    public:
+        explicit WaveFileSink(const std::string& waveFilePath) : m_path(waveFilePath) {}
+
+        bool Open(const AudioFormat& format) override;
+        bool Write(const AudioFrame& frame) override;
+        bool Close() override;
+
+    private:
+        std::string m_path;
+        WaveCodec::WaveStreamWriter m_writer;
+    };
+
+    // PCMFileSink: 写 PCM 文件(没有文件头)，写失败时 Write/Close 返回 false
+    class PCMFileSink : public PipelineSink {
+    public:
+        explicit PCMFileSink(const std::string& pcmFilePath) : m_path(pcmFilePath) {}
+
+        bool Open(const AudioFormat& format) override;
+        bool Write(const AudioFrame& frame) override;
+        bool Close() override;
+
+    private:
+        std::string m_path;
+        PCMCodec::PCMStreamWriter m_writer;
+    };
+};
+
+#endif //PIPELINE_NODES_H
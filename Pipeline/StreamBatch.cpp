@@ -0,0 +1,394 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "StreamBatch.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "G711Codec/G711Codec.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Pipeline {
+
+    namespace {
+
+        const int16_t kUnityGain = 4096;    // Q12
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+        // Pow2: 每个 16bit 通道计算 2^n，n 为 0~14，借用 float 的指数位
+        inline __m128i Pow2(__m128i n){
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i bias = _mm_set1_epi32(127 << 23);
+            __m128i lo = _mm_add_epi32(_mm_slli_epi32(_mm_unpacklo_epi16(n, zero), 23), bias);
+            __m128i hi = _mm_add_epi32(_mm_slli_epi32(_mm_unpackhi_epi16(n, zero), 23), bias);
+            lo = _mm_cvttps_epi32(_mm_castsi128_ps(lo));
+            hi = _mm_cvttps_epi32(_mm_castsi128_ps(hi));
+            return _mm_packs_epi32(lo, hi);
+        }
+
+        // FloatBits19: 8 个非负 16bit 整数转为 float，返回 float 的位右移 19 位: (指数 + 127) << 4 | 尾数的高 4 位
+        // 即最高位的位置和其后 4 位，正好是 G.711 的段号和段内码
+        inline __m128i FloatBits19(__m128i v){
+            const __m128i zero = _mm_setzero_si128();
+            __m128i lo = _mm_castps_si128(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)));
+            __m128i hi = _mm_castps_si128(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)));
+            return _mm_packs_epi32(_mm_srli_epi32(lo, 19), _mm_srli_epi32(hi, 19));
+        }
+
+        // ALawEncode8: 8 个采样编码为 A-law，结果在每个 16bit 通道的低 8 位
+        inline __m128i ALawEncode8(__m128i pcm){
+            __m128i v = _mm_srai_epi16(pcm, 3);
+            __m128i neg = _mm_srai_epi16(v, 15);
+            v = _mm_xor_si128(v, neg);                                  // 负数为 -v - 1，0~4095
+
+            // v >= 32: 段号为最高位位置 - 4，段内码为最高位之后的 4 位；v < 32: 段号 0，段内码 v >> 1
+            __m128i code = _mm_sub_epi16(FloatBits19(v), _mm_set1_epi16((127 + 4) << 4));
+            __m128i small = _mm_cmplt_epi16(v, _mm_set1_epi16(32));
+            code = _mm_or_si128(_mm_and_si128(small, _mm_srli_epi16(v, 1)), _mm_andnot_si128(small, code));
+
+            __m128i mask = _mm_xor_si128(_mm_set1_epi16(0xD5), _mm_and_si128(neg, _mm_set1_epi16(0x80)));
+            return _mm_xor_si128(code, mask);
+        }
+
+        // MuLawEncode8: 8 个采样编码为 mu-law
+        inline __m128i MuLawEncode8(__m128i pcm){
+            __m128i v = _mm_srai_epi16(pcm, 2);
+            __m128i neg = _mm_srai_epi16(v, 15);
+            v = _mm_sub_epi16(_mm_xor_si128(v, neg), neg);
+            v = _mm_add_epi16(_mm_min_epi16(v, _mm_set1_epi16(8159)), _mm_set1_epi16(33));    // 33~8192
+
+            // 段号为最高位位置 - 5，8192 超出第 7 段，限制为 0x7F
+            __m128i code = _mm_sub_epi16(FloatBits19(v), _mm_set1_epi16((127 + 5) << 4));
+            code = _mm_min_epi16(code, _mm_set1_epi16(0x7F));
+
+            __m128i mask = _mm_xor_si128(_mm_set1_epi16(0xFF), _mm_and_si128(neg, _mm_set1_epi16(0x80)));
+            return _mm_xor_si128(code, mask);
+        }
+
+        // ALawDecode8/MuLawDecode8: 8 个码字(每个 16bit 通道一个)解码为 PCM
+        inline __m128i ALawDecode8(__m128i code){
+            __m128i a = _mm_xor_si128(code, _mm_set1_epi16(0x55));
+            __m128i seg = _mm_and_si128(_mm_srli_epi16(a, 4), _mm_set1_epi16(7));
+            __m128i t = _mm_add_epi16(_mm_slli_epi16(_mm_and_si128(a, _mm_set1_epi16(0x0F)), 4), _mm_set1_epi16(8));
+
+            // seg > 0: t += 0x100，再左移 seg - 1 位
+            __m128i seg0 = _mm_cmpeq_epi16(seg, _mm_setzero_si128());
+            t = _mm_add_epi16(t, _mm_andnot_si128(seg0, _mm_set1_epi16(0x100)));
+            __m128i shift = _mm_andnot_si128(seg0, _mm_sub_epi16(seg, _mm_set1_epi16(1)));
+            t = _mm_mullo_epi16(t, Pow2(shift));
+
+            __m128i negative = _mm_cmpeq_epi16(_mm_and_si128(a, _mm_set1_epi16(0x80)), _mm_setzero_si128());
+            return _mm_sub_epi16(_mm_xor_si128(t, negative), negative);
+        }
+
+        inline __m128i MuLawDecode8(__m128i code){
+            __m128i u = _mm_xor_si128(code, _mm_set1_epi16(0xFF));
+            __m128i seg = _mm_and_si128(_mm_srli_epi16(u, 4), _mm_set1_epi16(7));
+            __m128i t = _mm_add_epi16(_mm_slli_epi16(_mm_and_si128(u, _mm_set1_epi16(0x0F)), 3), _mm_set1_epi16(0x84));
+            t = _mm_sub_epi16(_mm_mullo_epi16(t, Pow2(seg)), _mm_set1_epi16(0x84));
+
+            __m128i negative = _mm_cmpeq_epi16(_mm_and_si128(u, _mm_set1_epi16(0x80)), _mm_set1_epi16(0x80));
+            return _mm_sub_epi16(_mm_xor_si128(t, negative), negative);
+        }
+
+        // ApplyGain8: Q12 增益，四舍五入，饱和
+        inline __m128i ApplyGain8(__m128i pcm, __m128i gain){
+            __m128i lo = _mm_mullo_epi16(pcm, gain);
+            __m128i hi = _mm_mulhi_epi16(pcm, gain);
+            const __m128i round = _mm_set1_epi32(1 << 11);
+            __m128i a = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 12);
+            __m128i b = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 12);
+            return _mm_packs_epi32(a, b);
+        }
+
+#elif defined(__ARM_NEON)
+
+        // NEON 有按通道的移位和 clz，直接求段号
+        inline int16x8_t ALawEncode8(int16x8_t pcm){
+            int16x8_t v = vshrq_n_s16(pcm, 3);
+            int16x8_t neg = vshrq_n_s16(v, 15);
+            v = veorq_s16(v, neg);
+
+            int16x8_t top = vsubq_s16(vdupq_n_s16(15), vclzq_s16(v));           // 最高位位置，v 为 0 时为 -1
+            int16x8_t seg = vmaxq_s16(vsubq_s16(top, vdupq_n_s16(4)), vdupq_n_s16(0));
+            int16x8_t shift = vmaxq_s16(seg, vdupq_n_s16(1));
+            int16x8_t mant = vandq_s16(vshlq_s16(v, vnegq_s16(shift)), vdupq_n_s16(0x0F));
+            int16x8_t code = vorrq_s16(vshlq_n_s16(seg, 4), mant);
+
+            int16x8_t mask = veorq_s16(vdupq_n_s16(0xD5), vandq_s16(neg, vdupq_n_s16(0x80)));
+            return veorq_s16(code, mask);
+        }
+
+        inline int16x8_t MuLawEncode8(int16x8_t pcm){
+            int16x8_t v = vshrq_n_s16(pcm, 2);
+            int16x8_t neg = vshrq_n_s16(v, 15);
+            v = vsubq_s16(veorq_s16(v, neg), neg);
+            v = vaddq_s16(vminq_s16(v, vdupq_n_s16(8159)), vdupq_n_s16(33));
+
+            int16x8_t seg = vsubq_s16(vdupq_n_s16(15 - 5), vclzq_s16(v));
+            int16x8_t mant = vandq_s16(vshlq_s16(v, vnegq_s16(vaddq_s16(seg, vdupq_n_s16(1)))), vdupq_n_s16(0x0F));
+            int16x8_t code = vminq_s16(vorrq_s16(vshlq_n_s16(seg, 4), mant), vdupq_n_s16(0x7F));
+
+            int16x8_t mask = veorq_s16(vdupq_n_s16(0xFF), vandq_s16(neg, vdupq_n_s16(0x80)));
+            return veorq_s16(code, mask);
+        }
+
+        inline int16x8_t ALawDecode8(int16x8_t code){
+            int16x8_t a = veorq_s16(code, vdupq_n_s16(0x55));
+            int16x8_t seg = vandq_s16(vshrq_n_s16(a, 4), vdupq_n_s16(7));
+            int16x8_t t = vaddq_s16(vshlq_n_s16(vandq_s16(a, vdupq_n_s16(0x0F)), 4), vdupq_n_s16(8));
+
+            uint16x8_t nonzero = vtstq_s16(seg, seg);
+            t = vaddq_s16(t, vandq_s16(vreinterpretq_s16_u16(nonzero), vdupq_n_s16(0x100)));
+            t = vshlq_s16(t, vmaxq_s16(vsubq_s16(seg, vdupq_n_s16(1)), vdupq_n_s16(0)));
+
+            uint16x8_t positive = vtstq_s16(a, vdupq_n_s16(0x80));
+            return vbslq_s16(positive, t, vnegq_s16(t));
+        }
+
+        inline int16x8_t MuLawDecode8(int16x8_t code){
+            int16x8_t u = veorq_s16(code, vdupq_n_s16(0xFF));
+            int16x8_t seg = vandq_s16(vshrq_n_s16(u, 4), vdupq_n_s16(7));
+            int16x8_t t = vaddq_s16(vshlq_n_s16(vandq_s16(u, vdupq_n_s16(0x0F)), 3), vdupq_n_s16(0x84));
+            t = vsubq_s16(vshlq_s16(t, seg), vdupq_n_s16(0x84));
+
+            uint16x8_t negative = vtstq_s16(u, vdupq_n_s16(0x80));
+            return vbslq_s16(negative, vnegq_s16(t), t);
+        }
+
+        inline int16x8_t ApplyGain8(int16x8_t pcm, int16x4_t gain){
+            int32x4_t a = vmull_s16(vget_low_s16(pcm), gain);
+            int32x4_t b = vmull_s16(vget_high_s16(pcm), gain);
+            return vcombine_s16(vqrshrn_n_s32(a, 12), vqrshrn_n_s32(b, 12));
+        }
+
+#endif
+
+        inline int16_t Saturate(int32_t v){
+            return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+        }
+
+        // DecodeRow: 解码一行并乘以增益
+        void DecodeRow(uint16_t format, const uint8_t* in, int16_t gain, uint32_t n, int16_t* pcm){
+            uint32_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i g = _mm_set1_epi16(gain);
+            for (; i + 8 <= n; i += 8) {
+                __m128i x;
+                if (format == WaveAudioFormatPCM) {
+                    x = _mm_loadu_si128((const __m128i*)(in + i * 2));
+                } else {
+                    x = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(in + i)), zero);
+                    x = (format == WaveAudioFormatALaw) ? ALawDecode8(x) : MuLawDecode8(x);
+                }
+                if (gain != kUnityGain) x = ApplyGain8(x, g);
+                _mm_storeu_si128((__m128i*)(pcm + i), x);
+            }
+#elif defined(__ARM_NEON)
+            const int16x4_t g = vdup_n_s16(gain);
+            for (; i + 8 <= n; i += 8) {
+                int16x8_t x;
+                if (format == WaveAudioFormatPCM) {
+                    x = vld1q_s16((const int16_t*)(in + i * 2));
+                } else {
+                    x = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(in + i)));
+                    x = (format == WaveAudioFormatALaw) ? ALawDecode8(x) : MuLawDecode8(x);
+                }
+                if (gain != kUnityGain) x = ApplyGain8(x, g);
+                vst1q_s16(pcm + i, x);
+            }
+#endif
+            const G711Codec::G711Tables& tables = G711Codec::GetG711Tables();
+            for (; i < n; i++) {
+                int32_t v;
+                if (format == WaveAudioFormatPCM) {
+                    int16_t s;
+                    memcpy(&s, in + i * 2, 2);
+                    v = s;
+                } else {
+                    v = (format == WaveAudioFormatALaw) ? tables.alawDecode[in[i]] : tables.ulawDecode[in[i]];
+                }
+                if (gain != kUnityGain) v = (v * gain + (1 << 11)) >> 12;
+                pcm[i] = Saturate(v);
+            }
+        }
+
+        // EncodeRow: 编码一行
+        void EncodeRow(uint16_t format, const int16_t* pcm, uint32_t n, uint8_t* out){
+            if (format == WaveAudioFormatPCM) {
+                memcpy(out, pcm, n * 2);
+                return;
+            }
+            uint32_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            for (; i + 16 <= n; i += 16) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(pcm + i));
+                __m128i b = _mm_loadu_si128((const __m128i*)(pcm + i + 8));
+                if (format == WaveAudioFormatALaw) {
+                    a = ALawEncode8(a);
+                    b = ALawEncode8(b);
+                } else {
+                    a = MuLawEncode8(a);
+                    b = MuLawEncode8(b);
+                }
+                _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(a, b));
+            }
+#elif defined(__ARM_NEON)
+            for (; i + 8 <= n; i += 8) {
+                int16x8_t x = vld1q_s16(pcm + i);
+                x = (format == WaveAudioFormatALaw) ? ALawEncode8(x) : MuLawEncode8(x);
+                vst1_u8(out + i, vmovn_u16(vreinterpretq_u16_s16(x)));
+            }
+#endif
+            for (; i < n; i++) {
+                out[i] = (format == WaveAudioFormatALaw) ? G711Codec::LinearToALaw(pcm[i]) : G711Codec::LinearToMuLaw(pcm[i]);
+            }
+        }
+
+        // AccumulateRow: sum += pcm
+        void AccumulateRow(const int16_t* pcm, uint32_t n, int32_t* sum){
+            uint32_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            for (; i + 8 <= n; i += 8) {
+                __m128i x = _mm_loadu_si128((const __m128i*)(pcm + i));
+                __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+                __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+                _mm_storeu_si128((__m128i*)(sum + i), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(sum + i)), lo));
+                _mm_storeu_si128((__m128i*)(sum + i + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(sum + i + 4)), hi));
+            }
+#elif defined(__ARM_NEON)
+            for (; i + 8 <= n; i += 8) {
+                int16x8_t x = vld1q_s16(pcm + i);
+                vst1q_s32(sum + i, vaddw_s16(vld1q_s32(sum + i), vget_low_s16(x)));
+                vst1q_s32(sum + i + 4, vaddw_s16(vld1q_s32(sum + i + 4), vget_high_s16(x)));
+            }
+#endif
+            for (; i < n; i++) sum[i] += pcm[i];
+        }
+
+        // MixMinusRow: out = saturate(sum - pcm)
+        void MixMinusRow(const int32_t* sum, const int16_t* pcm, uint32_t n, int16_t* out){
+            uint32_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            for (; i + 8 <= n; i += 8) {
+                __m128i x = _mm_loadu_si128((const __m128i*)(pcm + i));
+                __m128i lo = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(sum + i)), _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+                __m128i hi = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(sum + i + 4)), _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+                _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+            }
+#elif defined(__ARM_NEON)
+            for (; i + 8 <= n; i += 8) {
+                int16x8_t x = vld1q_s16(pcm + i);
+                int32x4_t lo = vsubw_s16(vld1q_s32(sum + i), vget_low_s16(x));
+                int32x4_t hi = vsubw_s16(vld1q_s32(sum + i + 4), vget_high_s16(x));
+                vst1q_s16(out + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+            }
+#endif
+            for (; i < n; i++) out[i] = Saturate(sum[i] - pcm[i]);
+        }
+    }
+
+    StreamBatch::StreamBatch(uint32_t maxStreams, uint32_t frameSamples) {
+        if (maxStreams == 0 || frameSamples == 0 || frameSamples % 8 != 0) {
+            printf("StreamBatch: invalid streams %u or frame samples %u\n", maxStreams, frameSamples);
+            return;
+        }
+        m_streams = maxStreams;
+        m_frameSamples = frameSamples;
+
+        m_enabled.assign(maxStreams, 0);
+        m_inFormat.assign(maxStreams, WaveAudioFormatPCM);
+        m_outFormat.assign(maxStreams, WaveAudioFormatPCM);
+        m_gain.assign(maxStreams, kUnityGain);
+        m_group.assign(maxStreams, -1);
+
+        size_t samples = (size_t)maxStreams * frameSamples;
+        m_input.assign(samples * 2, 0);
+        m_pcm.assign(samples, 0);
+        m_mixed.assign(frameSamples, 0);
+        m_output.assign(samples * 2, 0);
+    }
+
+    void StreamBatch::SetEnabled(uint32_t stream, bool enabled) {
+        if (stream < m_streams) m_enabled[stream] = enabled ? 1 : 0;
+    }
+
+    bool StreamBatch::SetCodec(uint32_t stream, uint16_t inFormat, uint16_t outFormat) {
+        if (stream >= m_streams) return false;
+        for (uint16_t f : {inFormat, outFormat}) {
+            if (f != WaveAudioFormatPCM && f != WaveAudioFormatALaw && f != WaveAudioFormatMuLaw) {
+                printf("StreamBatch: unsupported audio format %u\n", f);
+                return false;
+            }
+        }
+        m_inFormat[stream] = inFormat;
+        m_outFormat[stream] = outFormat;
+        return true;
+    }
+
+    void StreamBatch::SetGain(uint32_t stream, float gain) {
+        if (stream >= m_streams) return;
+        float q = gain * kUnityGain + 0.5f;
+        m_gain[stream] = (int16_t)std::min(std::max(q, 0.0f), 32767.0f);
+    }
+
+    bool StreamBatch::SetMixGroup(uint32_t stream, int32_t group) {
+        if (stream >= m_streams) return false;
+        if (group >= 0 && (uint32_t)group >= m_streams) {
+            printf("StreamBatch: mix group %d out of range, streams:%u\n", group, m_streams);
+            return false;
+        }
+        m_group[stream] = group < 0 ? -1 : group;
+        size_t groups = group < 0 ? 0 : (size_t)group + 1;
+        if (groups * m_frameSamples > m_groupSum.size()) {
+            m_groupSum.resize(groups * m_frameSamples, 0);
+            m_groupTick.resize(groups, 0);
+        }
+        return true;
+    }
+
+    void StreamBatch::Process() {
+        const uint32_t n = m_frameSamples;
+        const uint8_t* enabled = m_enabled.data();
+
+        // 1. 解码 + 增益
+        for (uint32_t s = 0; s < m_streams; s++) {
+            if (!enabled[s]) continue;
+            DecodeRow(m_inFormat[s], &m_input[(size_t)s * n * 2], m_gain[s], n, &m_pcm[(size_t)s * n]);
+        }
+
+        // 2. 混音: 先累加每个组，再给每个成员减去自己
+        m_tick++;
+        for (uint32_t s = 0; s < m_streams; s++) {
+            int32_t group = m_group[s];
+            if (!enabled[s] || group < 0) continue;
+            int32_t* sum = &m_groupSum[(size_t)group * n];
+            if (m_groupTick[group] != m_tick) {
+                m_groupTick[group] = m_tick;
+                memset(sum, 0, n * sizeof(int32_t));
+            }
+            AccumulateRow(&m_pcm[(size_t)s * n], n, sum);
+        }
+
+        // 3. 编码，不混音的流直接编码自己的 PCM
+        for (uint32_t s = 0; s < m_streams; s++) {
+            if (!enabled[s]) continue;
+            const int16_t* pcm = &m_pcm[(size_t)s * n];
+            if (m_group[s] >= 0) {
+                MixMinusRow(&m_groupSum[(size_t)m_group[s] * n], pcm, n, m_mixed.data());
+                pcm = m_mixed.data();
+            }
+            EncodeRow(m_outFormat[s], pcm, n, &m_output[(size_t)s * n * 2]);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef STREAM_BATCH_H
+#define STREAM_BATCH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "WaveCodec/WaveFile.h"
+
+namespace Pipeline {
+
+    /*example code
+
+        StreamBatch batch(4000);                    // 4000 路 8kHz 流，每帧 160 个采样
+        for(uint32_t i = 0; i < 4000; i++){
+            batch.SetCodec(i, WaveAudioFormatALaw, WaveAudioFormatALaw);
+            batch.SetMixGroup(i, i / 3);            // 每 3 路一个会议，每路听到另外两路
+            batch.SetEnabled(i, true);
+        }
+        batch.SetGain(5, 0.5f);
+
+        // 每 20ms
+        for(uint32_t i = 0; i < 4000; i++){
+            memcpy(batch.GetInput(i), packets[i], 160);  // 收到的 A-law 数据
+        }
+        batch.Process();
+        for(uint32_t i = 0; i < 4000; i++){
+            send(batch.GetOutput(i), batch.GetOutputSize(i));
+        }
+    */
+
+    // StreamBatch: 一次调用处理大量流的一帧，用于单机承载上千路 8kHz 通话
+    // 数据按 SoA 组织: 每个流的输入/PCM/输出帧是大块连续缓冲区中的一行，启用标志、增益、编解码格式、混音组各自是一个数组；
+    // Process 依次对所有启用的流做 解码 + 增益、按组混音、编码 三遍扫描，每一遍都是在连续内存上的 SIMD 循环(SSE2/NEON)，
+    // G.711 的压扩用算术实现(浮点指数/clz 求段号)，不查表，结果与 G711Codec 的查表实现逐位一致
+    class StreamBatch {
+    public:
+        // * maxStreams   : 流的个数
+        // * frameSamples : 每帧采样数，8 的整数倍，默认 160(8kHz 20ms)
+        explicit StreamBatch(uint32_t maxStreams, uint32_t frameSamples = 160);
+
+        // IsValid: 参数是否有效
+        bool IsValid() const { return m_frameSamples > 0; }
+
+        uint32_t GetStreamCount() const { return m_streams; }
+        uint32_t GetFrameSamples() const { return m_frameSamples; }
+
+        // SetEnabled: 启用/禁用一路流，禁用的流不参与任何处理和混音，输出保持上一次的内容
+        void SetEnabled(uint32_t stream, bool enabled);
+        bool IsEnabled(uint32_t stream) const { return stream < m_streams && m_enabled[stream] != 0; }
+
+        // GetEnableMask: 启用标志数组(每路一个字节，非 0 为启用)，可以直接批量修改
+        uint8_t* GetEnableMask() { return m_enabled.data(); }
+
+        // SetCodec: 设置输入和输出的格式
+        // * inFormat/outFormat : WaveAudioFormatPCM(16bit)/WaveAudioFormatALaw/WaveAudioFormatMuLaw
+        bool SetCodec(uint32_t stream, uint16_t inFormat, uint16_t outFormat);
+
+        // SetGain: 设置线性增益，[0, 8)，按 Q12 定点计算，结果饱和
+        void SetGain(uint32_t stream, float gain);
+
+        // SetMixGroup: 设置混音组
+        // * group : -1 表示不混音，输出自己的声音；>= 0 时同组的流互相听到，每路的输出为组内其它启用的流之和(mix-minus)
+        //           组号用作下标，必须小于流的个数(每组至少一路，组号不会多于流数)，超出时返回 false
+        bool SetMixGroup(uint32_t stream, int32_t group);
+
+        // GetInput: 一路流的输入帧，PCM 为 frameSamples 个 16bit 采样，G.711 为 frameSamples 个字节
+        uint8_t* GetInput(uint32_t stream) { return &m_input[(size_t)stream * m_frameSamples * 2]; }
+
+        // GetPCM: 解码、增益之后，混音之前的 16bit PCM
+        const int16_t* GetPCM(uint32_t stream) const { return &m_pcm[(size_t)stream * m_frameSamples]; }
+
+        // GetOutput/GetOutputSize: 一路流的输出帧
+        const uint8_t* GetOutput(uint32_t stream) const { return &m_output[(size_t)stream * m_frameSamples * 2]; }
+        uint32_t GetOutputSize(uint32_t stream) const { return m_outFormat[stream] == WaveAudioFormatPCM ? m_frameSamples * 2 : m_frameSamples; }
+
+        // Process: 处理所有启用的流的一帧
+        void Process();
+
+    private:
+        uint32_t m_streams = 0;
+        uint32_t m_frameSamples = 0;
+
+        // 每路流的状态，SoA
+        std::vector<uint8_t>  m_enabled;
+        std::vector<uint16_t> m_inFormat;
+        std::vector<uint16_t> m_outFormat;
+        std::vector<int16_t>  m_gain;      // Q12，4096 为 1.0
+        std::vector<int32_t>  m_group;
+
+        // 每路流的帧，第 i 路位于第 i 行
+        std::vector<uint8_t>  m_input;     // 每行 frameSamples * 2 字节
+        std::vector<int16_t>  m_pcm;       // 每行 frameSamples 个采样
+        std::vector<int16_t>  m_mixed;     // 一行混音结果，混音后马上编码，始终在 L1 中
+        std::vector<uint8_t>  m_output;    // 每行 frameSamples * 2 字节
+
+        // 混音组的 32bit 累加，按组号索引；m_groupTick 记录组在哪一次 Process 中清零过
+        std::vector<int32_t>  m_groupSum;
+        std::vector<uint32_t> m_groupTick;
+        uint32_t m_tick = 0;
+    };
+}
+
+#endif //STREAM_BATCH_H
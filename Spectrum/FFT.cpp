@@ -0,0 +1,192 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "FFT.h"
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Spectrum {
+
+    static const double kPi = 3.14159265358979323846;
+
+    const RealFFT* RealFFT::Get(uint32_t size) {
+        if (size < 4 || (size & (size - 1)) != 0) return nullptr;
+
+        static std::mutex s_mutex;
+        static std::map<uint32_t, std::unique_ptr<RealFFT> > s_plans;
+
+        std::lock_guard<std::mutex> guard(s_mutex);
+        std::unique_ptr<RealFFT>& plan = s_plans[size];
+        if (!plan) plan.reset(new RealFFT(size));
+        return plan.get();
+    }
+
+    RealFFT::RealFFT(uint32_t size) : m_size(size) {
+        uint32_t half = size / 2;
+
+        uint32_t bits = 0;
+        while ((1u << bits) < half) bits++;
+        m_bitReverse.resize(half);
+        for (uint32_t i = 0; i < half; i++) {
+            uint32_t r = 0;
+            for (uint32_t b = 0; b < bits; b++) {
+                if (i & (1u << b)) r |= 1u << (bits - 1 - b);
+            }
+            m_bitReverse[i] = r;
+        }
+
+        m_twiddleRe.resize(half);
+        m_twiddleIm.resize(half);
+        for (uint32_t h = 1; h < half; h <<= 1) {
+            for (uint32_t k = 0; k < h; k++) {
+                double angle = -kPi * k / h;
+                m_twiddleRe[h + k] = (float)cos(angle);
+                m_twiddleIm[h + k] = (float)sin(angle);
+            }
+        }
+
+        m_splitRe.resize(size / 4 + 1);
+        m_splitIm.resize(size / 4 + 1);
+        for (uint32_t k = 0; k <= size / 4; k++) {
+            double angle = -2.0 * kPi * k / size;
+            m_splitRe[k] = (float)cos(angle);
+            m_splitIm[k] = (float)sin(angle);
+        }
+    }
+
+    // 半长为 h 的一级中，一组蝶形 [0, h)，h 为 4 的倍数
+    static void Butterflies(float* re0, float* im0, float* re1, float* im1, const float* wr, const float* wi, uint32_t h) {
+        uint32_t k = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; k + 4 <= h; k += 4) {
+            __m128 xr = _mm_loadu_ps(re1 + k), xi = _mm_loadu_ps(im1 + k);
+            __m128 tr = _mm_loadu_ps(wr + k), ti = _mm_loadu_ps(wi + k);
+            __m128 vr = _mm_sub_ps(_mm_mul_ps(xr, tr), _mm_mul_ps(xi, ti));
+            __m128 vi = _mm_add_ps(_mm_mul_ps(xr, ti), _mm_mul_ps(xi, tr));
+            __m128 ur = _mm_loadu_ps(re0 + k), ui = _mm_loadu_ps(im0 + k);
+            _mm_storeu_ps(re0 + k, _mm_add_ps(ur, vr));
+            _mm_storeu_ps(im0 + k, _mm_add_ps(ui, vi));
+            _mm_storeu_ps(re1 + k, _mm_sub_ps(ur, vr));
+            _mm_storeu_ps(im1 + k, _mm_sub_ps(ui, vi));
+        }
+#elif defined(__ARM_NEON)
+        for (; k + 4 <= h; k += 4) {
+            float32x4_t xr = vld1q_f32(re1 + k), xi = vld1q_f32(im1 + k);
+            float32x4_t tr = vld1q_f32(wr + k), ti = vld1q_f32(wi + k);
+            float32x4_t vr = vmlsq_f32(vmulq_f32(xr, tr), xi, ti);
+            float32x4_t vi = vmlaq_f32(vmulq_f32(xr, ti), xi, tr);
+            float32x4_t ur = vld1q_f32(re0 + k), ui = vld1q_f32(im0 + k);
+            vst1q_f32(re0 + k, vaddq_f32(ur, vr));
+            vst1q_f32(im0 + k, vaddq_f32(ui, vi));
+            vst1q_f32(re1 + k, vsubq_f32(ur, vr));
+            vst1q_f32(im1 + k, vsubq_f32(ui, vi));
+        }
+#endif
+        for (; k < h; k++) {
+            float vr = re1[k] * wr[k] - im1[k] * wi[k];
+            float vi = re1[k] * wi[k] + im1[k] * wr[k];
+            float ur = re0[k], ui = im0[k];
+            re0[k] = ur + vr;
+            im0[k] = ui + vi;
+            re1[k] = ur - vr;
+            im1[k] = ui - vi;
+        }
+    }
+
+    void RealFFT::ComplexTransform(float* re, float* im) const {
+        uint32_t n = m_size / 2;
+        uint32_t h = 1;
+
+        if (n >= 4) {
+            // 第一级 radix-4，合并了半长为 1 和 2 的两级，旋转因子为 1 和 -i，不需要乘法
+            for (uint32_t s = 0; s < n; s += 4) {
+                float t0r = re[s] + re[s + 1], t0i = im[s] + im[s + 1];
+                float t1r = re[s] - re[s + 1], t1i = im[s] - im[s + 1];
+                float t2r = re[s + 2] + re[s + 3], t2i = im[s + 2] + im[s + 3];
+                float t3r = re[s + 2] - re[s + 3], t3i = im[s + 2] - im[s + 3];
+                re[s] = t0r + t2r;     im[s] = t0i + t2i;
+                re[s + 2] = t0r - t2r; im[s + 2] = t0i - t2i;
+                // -i * t3 = (t3i, -t3r)
+                re[s + 1] = t1r + t3i; im[s + 1] = t1i - t3r;
+                re[s + 3] = t1r - t3i; im[s + 3] = t1i + t3r;
+            }
+            h = 4;
+        }
+
+        for (; h < n; h <<= 1) {
+            const float* wr = &m_twiddleRe[h];
+            const float* wi = &m_twiddleIm[h];
+            for (uint32_t s = 0; s < n; s += 2 * h) {
+                Butterflies(re + s, im + s, re + s + h, im + s + h, wr, wi, h);
+            }
+        }
+    }
+
+    void RealFFT::Forward(const float* in, float* outRe, float* outIm) const {
+        uint32_t m = m_size / 2;
+
+        // 偶数下标作为实部，奇数下标作为虚部，按位反转顺序放入
+        for (uint32_t i = 0; i < m; i++) {
+            uint32_t r = m_bitReverse[i];
+            outRe[i] = in[2 * r];
+            outIm[i] = in[2 * r + 1];
+        }
+        ComplexTransform(outRe, outIm);
+
+        // 拆分: X[k] = E[k] + W^k * O[k]
+        // E[k] = (Z[k] + conj(Z[m-k])) / 2, O[k] = -i * (Z[k] - conj(Z[m-k])) / 2
+        // k 与 m-k 成对计算，W^(m-k) = -conj(W^k)
+        float z0r = outRe[0], z0i = outIm[0];
+        outRe[0] = z0r + z0i; outIm[0] = 0;
+        outRe[m] = z0r - z0i; outIm[m] = 0;
+
+        for (uint32_t k = 1; k <= m / 2; k++) {
+            uint32_t j = m - k;
+            float ar = outRe[k], ai = outIm[k];
+            float br = outRe[j], bi = outIm[j];
+            float wr = m_splitRe[k], wi = m_splitIm[k];
+
+            // X[k]，A = Z[k], B = conj(Z[j])
+            float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+            float or_ = 0.5f * (ai + bi), oi = -0.5f * (ar - br);
+            float xkr = er + wr * or_ - wi * oi;
+            float xki = ei + wr * oi + wi * or_;
+
+            // X[j]，A = Z[j], B = conj(Z[k])，E 和 O 都是上面的共轭
+            float xjr = er - wr * or_ + wi * oi;
+            float xji = -ei + wr * oi + wi * or_;
+
+            outRe[k] = xkr; outIm[k] = xki;
+            outRe[j] = xjr; outIm[j] = xji;
+        }
+    }
+
+    void RealFFT::PowerSpectrum(const float* re, const float* im, float* power) const {
+        uint32_t count = GetBinCount();
+        uint32_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; i + 4 <= count; i += 4) {
+            __m128 r = _mm_loadu_ps(re + i), m = _mm_loadu_ps(im + i);
+            _mm_storeu_ps(power + i, _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m)));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 4 <= count; i += 4) {
+            float32x4_t r = vld1q_f32(re + i), m = vld1q_f32(im + i);
+            vst1q_f32(power + i, vmlaq_f32(vmulq_f32(r, r), m, m));
+        }
+#endif
+        for (; i < count; i++) {
+            power[i] = re[i] * re[i] + im[i] * im[i];
+        }
+    }
+}
@@ -0,0 +1,65 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef SPECTRUM_FFT_H
+#define SPECTRUM_FFT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Spectrum {
+
+    /*example code
+
+        const RealFFT* fft = RealFFT::Get(512);
+        std::vector<float> re(fft->GetBinCount()), im(fft->GetBinCount());
+        fft->Forward(samples, re.data(), im.data());
+    */
+
+    // RealFFT: 实数序列的 FFT，长度为 2 的整数次幂(>= 4)
+    // 长度为 N 的实数序列按复数序列 N/2 做 FFT 后再拆分，复数 FFT 第一级为 radix-4，其余各级为 radix-2
+    // 实部和虚部分开存放，radix-2 蝶形一次处理 4 个(SSE2/NEON)
+    // 旋转因子和位反转表在创建时计算，同一长度的实例全局共享，创建后只读，可以在多个线程中同时使用
+    class RealFFT {
+    public:
+        // Get: 获取指定长度的 FFT，第一次使用时创建
+        // * size   : 长度，必须是 2 的整数次幂且不小于 4
+        // * 返回值  : 长度不合法时返回 nullptr
+        static const RealFFT* Get(uint32_t size);
+
+        uint32_t GetSize() const { return m_size; }
+
+        // GetBinCount: 输出的频点个数，size/2 + 1
+        uint32_t GetBinCount() const { return m_size / 2 + 1; }
+
+        // Forward: 正变换
+        // * in    : size 个实数
+        // * outRe : 实部，GetBinCount() 个
+        // * outIm : 虚部，GetBinCount() 个
+        void Forward(const float* in, float* outRe, float* outIm) const;
+
+        // PowerSpectrum: 功率谱 re*re + im*im
+        // * re/im : Forward 的输出
+        // * power : GetBinCount() 个，可以与 re 或 im 相同
+        void PowerSpectrum(const float* re, const float* im, float* power) const;
+
+    private:
+        explicit RealFFT(uint32_t size);
+        RealFFT(const RealFFT&);
+        RealFFT& operator=(const RealFFT&);
+
+        // 长度为 m_size/2 的复数 FFT，输入已经按位反转顺序排列
+        void ComplexTransform(float* re, float* im) const;
+
+        uint32_t m_size = 0;
+        std::vector<uint32_t> m_bitReverse; // m_size/2 个
+        std::vector<float> m_twiddleRe;     // 复数 FFT 各级的旋转因子，半长为 h 的一级存放在 [h, 2h)
+        std::vector<float> m_twiddleIm;
+        std::vector<float> m_splitRe;       // 拆分实数结果用的旋转因子 exp(-2*pi*i*k/N)，k 为 [0, N/4]
+        std::vector<float> m_splitIm;
+    };
+};
+
+#endif //SPECTRUM_FFT_H
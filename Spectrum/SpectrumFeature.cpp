@@ -0,0 +1,280 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "SpectrumFeature.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "PCMCodec/PCMFile.h"
+#include "WaveCodec/WaveFile.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Spectrum {
+
+    static const double kPi = 3.14159265358979323846;
+
+    // 逐个相乘 out[i] = a[i] * b[i]
+    static void Multiply(const float* a, const float* b, size_t count, float* out) {
+        size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 4 <= count; i += 4) {
+            vst1q_f32(out + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        }
+#endif
+        for (; i < count; i++) {
+            out[i] = a[i] * b[i];
+        }
+    }
+
+    static float DotProduct(const float* a, const float* b, size_t count) {
+        size_t i = 0;
+        float sum = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128 acc = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc);
+        sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__ARM_NEON)
+        float32x4_t acc = vdupq_n_f32(0);
+        for (; i + 4 <= count; i += 4) {
+            acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+        }
+        float lanes[4];
+        vst1q_f32(lanes, acc);
+        sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        for (; i < count; i++) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    ///////////////////////////////////////////////////
+    // MelFilterbank
+    float MelFilterbank::HzToMel(float hz) {
+        return 2595.0f * log10f(1.0f + hz / 700.0f);
+    }
+
+    float MelFilterbank::MelToHz(float mel) {
+        return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+    }
+
+    MelFilterbank::MelFilterbank(uint32_t sampleRate, uint32_t fftSize, uint32_t bands, float fMin, float fMax) {
+        if (sampleRate == 0 || fftSize == 0 || bands == 0) return;
+        if (fMax <= 0 || fMax > sampleRate / 2.0f) fMax = sampleRate / 2.0f;
+        if (fMin < 0 || fMin >= fMax) fMin = 0;
+
+        // bands + 2 个在 mel 刻度上等间隔的频率点，相邻三个点构成一个三角滤波器
+        float melMin = HzToMel(fMin), melMax = HzToMel(fMax);
+        std::vector<float> hz(bands + 2);
+        for (uint32_t i = 0; i < bands + 2; i++) {
+            hz[i] = MelToHz(melMin + (melMax - melMin) * i / (bands + 1));
+        }
+
+        uint32_t binCount = fftSize / 2 + 1;
+        float binHz = (float)sampleRate / fftSize;
+        m_bands.resize(bands);
+        for (uint32_t b = 0; b < bands; b++) {
+            float lower = hz[b], center = hz[b + 1], upper = hz[b + 2];
+            Band& band = m_bands[b];
+            for (uint32_t k = 0; k < binCount; k++) {
+                float f = k * binHz;
+                float w = 0;
+                if (f > lower && f <= center) {
+                    w = (f - lower) / (center - lower);
+                } else if (f > center && f < upper) {
+                    w = (upper - f) / (upper - center);
+                }
+
+                if (w > 0) {
+                    if (band.weights.empty()) band.firstBin = k;
+                    band.weights.resize(k - band.firstBin + 1, 0);
+                    band.weights.back() = w;
+                }
+            }
+        }
+    }
+
+    void MelFilterbank::Apply(const float* power, float* mel) const {
+        for (size_t b = 0; b < m_bands.size(); b++) {
+            const Band& band = m_bands[b];
+            mel[b] = band.weights.empty() ? 0 : DotProduct(power + band.firstBin, band.weights.data(), band.weights.size());
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // FeatureExtractor
+    FeatureExtractor::FeatureExtractor(uint32_t sampleRate, uint16_t channels, const FeatureConfig& config)
+        : m_config(config), m_channels(channels) {
+        m_fft = RealFFT::Get(config.fftSize);
+        if (!m_fft || sampleRate == 0 || channels == 0 || config.hopSize == 0 || config.hopSize > config.fftSize) {
+            printf("invalid feature config, fft size:%d, hop size:%d\n", config.fftSize, config.hopSize);
+            m_fft = nullptr;
+            return;
+        }
+
+        // 周期 Hann 窗
+        uint32_t n = config.fftSize;
+        m_window.resize(n);
+        for (uint32_t i = 0; i < n; i++) {
+            m_window[i] = (float)(0.5 - 0.5 * cos(2.0 * kPi * i / n));
+        }
+
+        m_buffer.resize(n);
+        m_frame.resize(n);
+        m_re.resize(m_fft->GetBinCount());
+        m_im.resize(m_fft->GetBinCount());
+
+        if (config.melBands > 0) {
+            m_mel.reset(new MelFilterbank(sampleRate, n, config.melBands, config.fMin, config.fMax));
+            m_rowSize = config.melBands;
+        } else {
+            m_rowSize = m_fft->GetBinCount();
+        }
+    }
+
+    void FeatureExtractor::Reset() {
+        m_filled = 0;
+        m_frameCount = 0;
+    }
+
+    void FeatureExtractor::ProcessFrame(std::vector<float>& features) {
+        Multiply(m_buffer.data(), m_window.data(), m_config.fftSize, m_frame.data());
+        m_fft->Forward(m_frame.data(), m_re.data(), m_im.data());
+        m_fft->PowerSpectrum(m_re.data(), m_im.data(), m_re.data());
+
+        size_t pos = features.size();
+        features.resize(pos + m_rowSize);
+        float* row = &features[pos];
+        if (m_mel) {
+            m_mel->Apply(m_re.data(), row);
+        } else {
+            memcpy(row, m_re.data(), m_rowSize * sizeof(float));
+        }
+
+        if (m_config.logScale) {
+            for (uint32_t i = 0; i < m_rowSize; i++) {
+                row[i] = 10.0f * log10f(std::max(row[i], 1e-10f));
+            }
+        }
+        m_frameCount++;
+    }
+
+    size_t FeatureExtractor::Process(const uint16_t* samples, size_t count, std::vector<float>& features) {
+        if (!m_fft || !samples) return 0;
+
+        const float scale = 1.0f / (32768.0f * m_channels);
+        size_t frames = count / m_channels;
+        size_t produced = 0;
+        size_t i = 0;
+        while (i < frames) {
+            // 补满窗口
+            size_t n = std::min<size_t>(m_config.fftSize - m_filled, frames - i);
+            float* dst = &m_buffer[m_filled];
+            const uint16_t* src = samples + i * m_channels;
+            if (m_channels == 1) {
+                for (size_t k = 0; k < n; k++) {
+                    dst[k] = (int16_t)src[k] * scale;
+                }
+            } else {
+                for (size_t k = 0; k < n; k++) {
+                    int32_t sum = 0;
+                    for (uint16_t ch = 0; ch < m_channels; ch++) {
+                        sum += (int16_t)src[k * m_channels + ch];
+                    }
+                    dst[k] = sum * scale;
+                }
+            }
+            m_filled += (uint32_t)n;
+            i += n;
+
+            if (m_filled == m_config.fftSize) {
+                ProcessFrame(features);
+                produced++;
+
+                // 保留重叠部分
+                uint32_t keep = m_config.fftSize - m_config.hopSize;
+                memmove(m_buffer.data(), &m_buffer[m_config.hopSize], keep * sizeof(float));
+                m_filled = keep;
+            }
+        }
+        return produced;
+    }
+
+    ///////////////////////////////////////////////////
+    // 文件
+    static const uint32_t kReadFrames = 8192;
+
+    bool ExtractWaveFileFeatures(const std::string& waveFilePath, const FeatureConfig& config, std::vector<float>& features, uint32_t& rowSize) {
+        WaveCodec::WaveFileReader reader;
+        if (!reader.Open(waveFilePath)) {
+            printf("open wave file failed, %s\n", waveFilePath.c_str());
+            return false;
+        }
+
+        WaveCodec::WaveHeader header;
+        if (!reader.ReadWaveHeader(header)) {
+            printf("read wave header failed, %s\n", waveFilePath.c_str());
+            return false;
+        }
+        if (header.riff.fmt.audio_format != WaveAudioFormatPCM || header.riff.fmt.bits_per_sample != 16 || header.riff.fmt.channels == 0) {
+            printf("only 16bit pcm wave file is supported\n");
+            return false;
+        }
+
+        uint16_t channels = header.riff.fmt.channels;
+        FeatureExtractor extractor(header.riff.fmt.sample_rate, channels, config);
+        rowSize = extractor.GetRowSize();
+        if (rowSize == 0) return false;
+
+        // 只读取 data 子块，流式写入的文件 data 大小可能为 0，此时读到文件末尾
+        uint64_t shortsLeft = header.riff.data.header.size / 2;
+        if (shortsLeft == 0) shortsLeft = UINT64_MAX;
+
+        std::vector<uint16_t> samples;
+        while (shortsLeft > 0) {
+            uint32_t toRead = (uint32_t)std::min<uint64_t>((uint64_t)kReadFrames * channels, shortsLeft);
+            size_t nRead = reader.ReadShorts(toRead, samples);
+            if (nRead == 0) break;
+            extractor.Process(samples.data(), nRead, features);
+            shortsLeft -= nRead;
+        }
+        return true;
+    }
+
+    bool ExtractPCMFileFeatures(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, const FeatureConfig& config,
+                                std::vector<float>& features, uint32_t& rowSize) {
+        PCMCodec::PCMFileReader reader;
+        if (!reader.Open(pcmFilePath)) {
+            printf("open pcm file failed, %s\n", pcmFilePath.c_str());
+            return false;
+        }
+
+        FeatureExtractor extractor(sampleRate, channels, config);
+        rowSize = extractor.GetRowSize();
+        if (rowSize == 0) return false;
+
+        std::vector<uint16_t> samples;
+        while (true) {
+            size_t nRead = reader.ReadShorts(kReadFrames * channels, samples);
+            if (nRead == 0) break;
+            extractor.Process(samples.data(), nRead, features);
+        }
+        return true;
+    }
+}
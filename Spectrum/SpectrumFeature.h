@@ -0,0 +1,118 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef SPECTRUM_FEATURE_H
+#define SPECTRUM_FEATURE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FFT.h"
+
+namespace Spectrum {
+
+    // FeatureConfig: 特征提取参数
+    struct FeatureConfig {
+        uint32_t fftSize  = 512;    // 窗长，2 的整数次幂
+        uint32_t hopSize  = 160;    // 相邻两帧之间的间隔(采样数)，1 ~ fftSize
+        uint32_t melBands = 40;     // mel 滤波器个数，为 0 时输出功率谱(fftSize/2 + 1 个频点)
+        float    fMin     = 0;      // mel 滤波器的最低频率(Hz)
+        float    fMax     = 0;      // mel 滤波器的最高频率(Hz)，为 0 时使用 sampleRate/2
+        bool     logScale = true;   // 是否输出 dB，10*log10(max(x, 1e-10))
+    };
+
+    // MelFilterbank: 三角 mel 滤波器组(HTK mel 刻度)，每个滤波器只保存非零的一段权重
+    class MelFilterbank {
+    public:
+        MelFilterbank(uint32_t sampleRate, uint32_t fftSize, uint32_t bands, float fMin, float fMax);
+
+        uint32_t GetBandCount() const { return (uint32_t)m_bands.size(); }
+
+        // Apply: 功率谱 -> mel 能量
+        // * power : fftSize/2 + 1 个频点
+        // * mel   : GetBandCount() 个
+        void Apply(const float* power, float* mel) const;
+
+        static float HzToMel(float hz);
+        static float MelToHz(float mel);
+
+    private:
+        struct Band {
+            uint32_t firstBin = 0;
+            std::vector<float> weights;
+        };
+        std::vector<Band> m_bands;
+    };
+
+    /*example code
+
+        FeatureConfig config;
+        FeatureExtractor extractor(16000, 1, config);
+        std::vector<uint16_t> samples;
+        std::vector<float> features;
+        while(reader.ReadShorts(4096, samples) > 0){
+            extractor.Process(samples.data(), samples.size(), features);
+        }
+        // features 中每 extractor.GetRowSize() 个数为一帧
+    */
+
+    // FeatureExtractor: 流式 STFT 功率谱/log-mel 特征提取
+    // 多声道数据先平均为单声道，每凑够 fftSize 个采样输出一帧，之后保留 fftSize - hopSize 个采样用于下一帧
+    // 分多次调用 Process 与一次性处理全部数据的结果相同，末尾不足一帧的数据不输出
+    class FeatureExtractor {
+    public:
+        // * sampleRate : 采样率
+        // * channels   : 声道数
+        // * config     : 特征参数，不合法时 GetRowSize() 为 0
+        FeatureExtractor(uint32_t sampleRate, uint16_t channels, const FeatureConfig& config);
+
+        // GetRowSize: 每帧特征的个数，mel 时为 melBands，否则为 fftSize/2 + 1
+        uint32_t GetRowSize() const { return m_rowSize; }
+
+        // Process: 处理一段 16bit PCM 交错数据，提取的特征追加到 features
+        // * samples  : 交错数据
+        // * count    : 采样个数(所有声道的总数)，应为声道数的整数倍
+        // * features : 输出，追加 返回值 * GetRowSize() 个数
+        // * 返回值    : 本次输出的帧数
+        size_t Process(const uint16_t* samples, size_t count, std::vector<float>& features);
+
+        // GetFrameCount: 已输出的总帧数
+        uint64_t GetFrameCount() const { return m_frameCount; }
+
+        // Reset: 清除保留的数据，开始处理新的音频
+        void Reset();
+
+    private:
+        void ProcessFrame(std::vector<float>& features);
+
+        FeatureConfig m_config;
+        uint16_t m_channels = 0;
+        uint32_t m_rowSize = 0;
+        const RealFFT* m_fft = nullptr;
+        std::unique_ptr<MelFilterbank> m_mel;
+
+        std::vector<float> m_window;
+        std::vector<float> m_buffer;   // fftSize 个，最近的采样
+        uint32_t m_filled = 0;         // m_buffer 中已有的采样数
+        std::vector<float> m_frame;    // 加窗后的数据
+        std::vector<float> m_re;
+        std::vector<float> m_im;
+        uint64_t m_frameCount = 0;
+    };
+
+    // ExtractWaveFileFeatures: 提取 16bit PCM Wave 文件的特征
+    // * waveFilePath : Wave 文件路径
+    // * config       : 特征参数
+    // * features     : 输出，每 rowSize 个数为一帧
+    // * rowSize      : 每帧特征的个数
+    bool ExtractWaveFileFeatures(const std::string& waveFilePath, const FeatureConfig& config, std::vector<float>& features, uint32_t& rowSize);
+
+    // ExtractPCMFileFeatures: 提取 16bit PCM 文件的特征
+    bool ExtractPCMFileFeatures(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, const FeatureConfig& config,
+                                std::vector<float>& features, uint32_t& rowSize);
+};
+
+#endif //SPECTRUM_FEATURE_H
@@ -0,0 +1,463 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "ToneDetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "PCMCodec/PCMFile.h"
+#include "WaveCodec/WaveFile.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Spectrum {
+
+    static const double kPi = 3.14159265358979323846;
+
+    // DTMF 的行频率(低频组)和列频率(高频组)
+    static const float kDTMFFrequencies[8] = {697, 770, 852, 941, 1209, 1336, 1477, 1633};
+    static const char kDTMFDigits[16] = {'1', '2', '3', 'A', '4', '5', '6', 'B', '7', '8', '9', 'C', '*', '0', '#', 'D'};
+    static const uint32_t kMaxTones = 24;
+
+    // 8kHz 下的块长，约 12.75ms，两块确认可以检测 40ms 的按键
+    static const uint32_t kBlockSamples8k = 102;
+
+    // 单音的块长为 4 个 DTMF 块(8kHz 下 408 个采样，约 50ms)，频率分辨率约 20Hz，可以分开 440/480Hz 的回铃音；
+    // 102 个采样的块分辨率只有约 78Hz，呼叫进程音之间会互相泄漏。块再长可以分开更近的频率，但允许的频率偏差随之变小
+    static const uint32_t kToneBlocks = 4;
+
+    // 判决门限(能量比)
+    static const float kNormalTwist   = 6.31f;  // 高频组比低频组最多高 8dB
+    static const float kReverseTwist  = 2.51f;  // 低频组比高频组最多高 4dB
+    static const float kRelativePeak  = 6.31f;  // 同一组中其它频率至少比峰值低 8dB
+    static const float kDTMFToTotal   = 0.7f;   // 两个 DTMF 频率的能量占总能量的最低比例
+    static const float kToneToTotal   = 0.3f;   // 单音的能量占总能量的最低比例，双频的拨号音每个频率约占一半
+
+    // Interleave: 把 4 路流的 n 个采样交错为 n 组，每组 4 个 float，同时累加每路的 sum(x^2) 到 energy
+    // SSE2 每次取每路 4 个采样转换为 float 后做 4x4 转置，NEON 用 vst4q 交错存储
+    static void Interleave(const uint16_t* const* src, uint32_t n, float* out, float* energy) {
+        const float scale = 1.0f / 32768;
+        uint32_t j = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128 vscale = _mm_set1_ps(scale);
+        __m128 acc = _mm_loadu_ps(energy);
+        for (; j + 4 <= n; j += 4) {
+            __m128 r[4];
+            for (int lane = 0; lane < 4; lane++) {
+                __m128i v = _mm_loadl_epi64((const __m128i*)(src[lane] + j));
+                r[lane] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), vscale);
+            }
+            _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+            for (int k = 0; k < 4; k++) {
+                _mm_storeu_ps(out + (j + k) * 4, r[k]);
+                acc = _mm_add_ps(acc, _mm_mul_ps(r[k], r[k]));
+            }
+        }
+        _mm_storeu_ps(energy, acc);
+#elif defined(__ARM_NEON)
+        // 每路流的 4 个采样在同一个向量中，每路一个累加器
+        float32x4_t acc[4] = {vdupq_n_f32(0), vdupq_n_f32(0), vdupq_n_f32(0), vdupq_n_f32(0)};
+        for (; j + 4 <= n; j += 4) {
+            float32x4x4_t r;
+            for (int lane = 0; lane < 4; lane++) {
+                r.val[lane] = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16((const int16_t*)src[lane] + j))), scale);
+                acc[lane] = vmlaq_f32(acc[lane], r.val[lane], r.val[lane]);
+            }
+            vst4q_f32(out + j * 4, r);
+        }
+        for (int lane = 0; lane < 4; lane++) {
+            float sums[4];
+            vst1q_f32(sums, acc[lane]);
+            energy[lane] += sums[0] + sums[1] + sums[2] + sums[3];
+        }
+#endif
+        for (; j < n; j++) {
+            for (uint32_t lane = 0; lane < 4; lane++) {
+                float x = (int16_t)src[lane][j] * scale;
+                out[j * 4 + lane] = x;
+                energy[lane] += x * x;
+            }
+        }
+    }
+
+    // RunGoertzel: 用交错的 n 个采样更新一组 4 路流所有频率的状态 s0 = c * s1 - s2 + x
+    // 按 (x - s2) + c * s1 计算，依赖链上只有一次乘和一次加；每次处理 4 个频率，4 条依赖链交错执行
+    // * state : freqCount * 8 个 float，频率 k 的 s1 在 [k * 8, k * 8 + 4)，s2 在 [k * 8 + 4, k * 8 + 8)
+    static void RunGoertzel(const float* in, uint32_t n, const float* coeff, uint32_t freqCount, float* state) {
+        for (uint32_t k = 0; k < freqCount; k += 4) {
+            float* st = state + k * 8;
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128 c0 = _mm_set1_ps(coeff[k]);
+            const __m128 c1 = _mm_set1_ps(coeff[k + 1]);
+            const __m128 c2 = _mm_set1_ps(coeff[k + 2]);
+            const __m128 c3 = _mm_set1_ps(coeff[k + 3]);
+            __m128 a0 = _mm_loadu_ps(st), b0 = _mm_loadu_ps(st + 4);
+            __m128 a1 = _mm_loadu_ps(st + 8), b1 = _mm_loadu_ps(st + 12);
+            __m128 a2 = _mm_loadu_ps(st + 16), b2 = _mm_loadu_ps(st + 20);
+            __m128 a3 = _mm_loadu_ps(st + 24), b3 = _mm_loadu_ps(st + 28);
+            for (uint32_t j = 0; j < n; j++) {
+                __m128 x = _mm_loadu_ps(in + j * 4);
+                __m128 t0 = _mm_add_ps(_mm_sub_ps(x, b0), _mm_mul_ps(c0, a0));
+                __m128 t1 = _mm_add_ps(_mm_sub_ps(x, b1), _mm_mul_ps(c1, a1));
+                __m128 t2 = _mm_add_ps(_mm_sub_ps(x, b2), _mm_mul_ps(c2, a2));
+                __m128 t3 = _mm_add_ps(_mm_sub_ps(x, b3), _mm_mul_ps(c3, a3));
+                b0 = a0; a0 = t0;
+                b1 = a1; a1 = t1;
+                b2 = a2; a2 = t2;
+                b3 = a3; a3 = t3;
+            }
+            _mm_storeu_ps(st, a0); _mm_storeu_ps(st + 4, b0);
+            _mm_storeu_ps(st + 8, a1); _mm_storeu_ps(st + 12, b1);
+            _mm_storeu_ps(st + 16, a2); _mm_storeu_ps(st + 20, b2);
+            _mm_storeu_ps(st + 24, a3); _mm_storeu_ps(st + 28, b3);
+#elif defined(__ARM_NEON)
+            const float32x4_t c0 = vdupq_n_f32(coeff[k]);
+            const float32x4_t c1 = vdupq_n_f32(coeff[k + 1]);
+            const float32x4_t c2 = vdupq_n_f32(coeff[k + 2]);
+            const float32x4_t c3 = vdupq_n_f32(coeff[k + 3]);
+            float32x4_t a0 = vld1q_f32(st), b0 = vld1q_f32(st + 4);
+            float32x4_t a1 = vld1q_f32(st + 8), b1 = vld1q_f32(st + 12);
+            float32x4_t a2 = vld1q_f32(st + 16), b2 = vld1q_f32(st + 20);
+            float32x4_t a3 = vld1q_f32(st + 24), b3 = vld1q_f32(st + 28);
+            for (uint32_t j = 0; j < n; j++) {
+                float32x4_t x = vld1q_f32(in + j * 4);
+                float32x4_t t0 = vmlaq_f32(vsubq_f32(x, b0), c0, a0);
+                float32x4_t t1 = vmlaq_f32(vsubq_f32(x, b1), c1, a1);
+                float32x4_t t2 = vmlaq_f32(vsubq_f32(x, b2), c2, a2);
+                float32x4_t t3 = vmlaq_f32(vsubq_f32(x, b3), c3, a3);
+                b0 = a0; a0 = t0;
+                b1 = a1; a1 = t1;
+                b2 = a2; a2 = t2;
+                b3 = a3; a3 = t3;
+            }
+            vst1q_f32(st, a0); vst1q_f32(st + 4, b0);
+            vst1q_f32(st + 8, a1); vst1q_f32(st + 12, b1);
+            vst1q_f32(st + 16, a2); vst1q_f32(st + 20, b2);
+            vst1q_f32(st + 24, a3); vst1q_f32(st + 28, b3);
+#else
+            for (uint32_t f = 0; f < 4; f++) {
+                float* s1 = st + f * 8;
+                float* s2 = s1 + 4;
+                for (uint32_t j = 0; j < n; j++) {
+                    for (uint32_t lane = 0; lane < 4; lane++) {
+                        float t = coeff[k + f] * s1[lane] - s2[lane] + in[j * 4 + lane];
+                        s2[lane] = s1[lane];
+                        s1[lane] = t;
+                    }
+                }
+            }
+#endif
+        }
+    }
+
+    ToneDetector::ToneDetector(uint32_t maxStreams, uint32_t sampleRate) {
+        if (maxStreams == 0 || sampleRate < 4000 || sampleRate > 48000) {
+            printf("ToneDetector: invalid params, streams:%u, sample_rate:%u\n", maxStreams, sampleRate);
+            return;
+        }
+
+        m_streams = maxStreams;
+        m_groups = (maxStreams + 3) / 4;
+        m_sampleRate = sampleRate;
+        m_blockSamples = (kBlockSamples8k * sampleRate + 4000) / 8000;
+        m_frequencies.assign(kDTMFFrequencies, kDTMFFrequencies + 8);
+        m_input.resize(m_blockSamples * 4);
+        m_silence.assign(m_blockSamples, 0);
+
+        m_enabled.assign(m_streams, 0);
+        m_digit.assign(m_streams, 0);
+        m_lastHit.assign(m_streams, 0);
+        m_toneMask.assign(m_streams, 0);
+        m_lastToneMask.assign(m_streams, 0);
+        SetMinLevel(-36.0f);
+        ResetState();
+    }
+
+    int32_t ToneDetector::AddTone(float frequency) {
+        if (!IsValid() || m_frequencies.size() >= 8 + kMaxTones || frequency <= 0 || frequency >= m_sampleRate / 2.0f) {
+            printf("ToneDetector: can not add tone %.1fHz\n", frequency);
+            return -1;
+        }
+        m_frequencies.push_back(frequency);
+        ResetState();
+        return (int32_t)m_frequencies.size() - 9;
+    }
+
+    void ToneDetector::SetMinLevel(float dbfs) {
+        // 峰值为 a 的正弦在一块内的能量为 N * a^2 / 2，与 EvaluateGroup 中归一化后的 Goertzel 能量对应
+        float amplitude = powf(10.0f, dbfs / 20.0f);
+        m_minEnergy = m_blockSamples * amplitude * amplitude / 2;
+    }
+
+    void ToneDetector::ResetState() {
+        m_freqCount = ((uint32_t)m_frequencies.size() + 3) / 4 * 4;
+        m_coeff.assign(m_freqCount, 0.0f);
+        for (size_t k = 0; k < m_frequencies.size(); k++) {
+            m_coeff[k] = (float)(2 * cos(2 * kPi * m_frequencies[k] / m_sampleRate));
+        }
+        // 相距不足两个频率分辨率的单音互相泄漏，判决时只保留其中能量最大的
+        const float resolution = (float)m_sampleRate / (m_blockSamples * kToneBlocks);
+        const uint32_t tones = (uint32_t)m_frequencies.size() - 8;
+        m_toneNeighbors.assign(tones, 0);
+        for (uint32_t t = 0; t < tones; t++) {
+            for (uint32_t u = 0; u < tones; u++) {
+                if (u != t && fabsf(m_frequencies[8 + t] - m_frequencies[8 + u]) < 2 * resolution) m_toneNeighbors[t] |= 1u << u;
+            }
+        }
+
+        m_state.assign((size_t)m_groups * m_freqCount * 8, 0.0f);
+        m_energy.assign((size_t)m_groups * 4, 0.0f);
+        m_toneEnergy.assign((size_t)m_groups * 4, 0.0f);
+        m_phase = 0;
+        m_toneBlock = 0;
+        for (uint32_t i = 0; i < m_streams; i++) {
+            m_digit[i] = 0;
+            m_lastHit[i] = 0;
+            m_toneMask[i] = 0;
+            m_lastToneMask[i] = 0;
+        }
+    }
+
+    void ToneDetector::ResetStream(uint32_t stream) {
+        uint32_t group = stream / 4;
+        uint32_t lane = stream % 4;
+        float* state = &m_state[(size_t)group * m_freqCount * 8];
+        for (uint32_t i = 0; i < m_freqCount * 2; i++) state[i * 4 + lane] = 0;
+        m_energy[stream] = 0;
+        m_toneEnergy[stream] = 0;
+        m_digit[stream] = 0;
+        m_lastHit[stream] = 0;
+        m_toneMask[stream] = 0;
+        m_lastToneMask[stream] = 0;
+    }
+
+    void ToneDetector::SetEnabled(uint32_t stream, bool enabled) {
+        if (stream >= m_streams) return;
+        m_enabled[stream] = enabled ? 1 : 0;
+        ResetStream(stream);
+    }
+
+    void ToneDetector::Reset(uint32_t stream) {
+        if (stream >= m_streams) return;
+        ResetStream(stream);
+    }
+
+    void ToneDetector::Process(const uint16_t* const* frames, uint32_t samples) {
+        m_events.clear();
+        if (!IsValid() || !frames) return;
+
+        uint32_t pos = 0;
+        while (pos < samples) {
+            uint32_t n = std::min(samples - pos, m_blockSamples - m_phase);
+            for (uint32_t g = 0; g < m_groups; g++) {
+                // 禁用或没有数据的流读取全 0 的一行
+                const uint16_t* src[4] = {m_silence.data(), m_silence.data(), m_silence.data(), m_silence.data()};
+                bool active = false;
+                for (uint32_t lane = 0; lane < 4; lane++) {
+                    uint32_t stream = g * 4 + lane;
+                    if (stream < m_streams && m_enabled[stream]) {
+                        active = true;
+                        if (frames[stream]) src[lane] = frames[stream] + pos;
+                    }
+                }
+                if (!active) continue;
+
+                Interleave(src, n, m_input.data(), &m_energy[g * 4]);
+                RunGoertzel(m_input.data(), n, m_coeff.data(), m_freqCount, &m_state[(size_t)g * m_freqCount * 8]);
+            }
+
+            pos += n;
+            m_phase += n;
+            m_position += n;
+            if (m_phase == m_blockSamples) {
+                bool tones = ++m_toneBlock == kToneBlocks;
+                for (uint32_t g = 0; g < m_groups; g++) EvaluateGroup(g, tones);
+                m_phase = 0;
+                if (tones) m_toneBlock = 0;
+            }
+        }
+    }
+
+    void ToneDetector::EvaluateGroup(uint32_t group, bool evaluateTones) {
+        float* state = &m_state[(size_t)group * m_freqCount * 8];
+        // |X(f)|^2 * 2 / N 为该频率成分在一块内的能量，与 sum(x^2) 可比
+        const float norm = 2.0f / m_blockSamples;
+        const float toneNorm = norm / kToneBlocks;
+        const uint32_t tones = evaluateTones ? (uint32_t)m_frequencies.size() - 8 : 0;
+
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            uint32_t stream = group * 4 + lane;
+            if (stream >= m_streams || !m_enabled[stream]) continue;
+
+            // 单音的状态跨越 kToneBlocks 个块，只在长块结束时计算
+            float e[8 + kMaxTones];
+            for (size_t k = 0; k < 8 + tones; k++) {
+                float s1 = state[k * 8 + lane];
+                float s2 = state[k * 8 + 4 + lane];
+                e[k] = (s1 * s1 + s2 * s2 - m_coeff[k] * s1 * s2) * (k < 8 ? norm : toneNorm);
+            }
+            float total = m_energy[stream];
+            m_toneEnergy[stream] += total;
+
+            // DTMF: 行列各取能量最大的频率
+            uint32_t row = 0, col = 4;
+            for (uint32_t k = 1; k < 4; k++) {
+                if (e[k] > e[row]) row = k;
+                if (e[k + 4] > e[col]) col = k + 4;
+            }
+            char hit = 0;
+            if (e[row] >= m_minEnergy && e[col] >= m_minEnergy && e[col] <= e[row] * kNormalTwist && e[row] <= e[col] * kReverseTwist &&
+                e[row] + e[col] >= kDTMFToTotal * total) {
+                bool peak = true;
+                for (uint32_t k = 0; k < 4; k++) {
+                    if (k != row && e[k] * kRelativePeak > e[row]) peak = false;
+                    if (k + 4 != col && e[k + 4] * kRelativePeak > e[col]) peak = false;
+                }
+                if (peak) hit = kDTMFDigits[row * 4 + col - 4];
+            }
+
+            // 连续两块结果相同才改变状态
+            if (hit == m_lastHit[stream] && hit != m_digit[stream]) {
+                ToneEvent event;
+                event.stream = stream;
+                event.position = m_position;
+                if (m_digit[stream]) {
+                    event.digit = m_digit[stream];
+                    event.on = false;
+                    m_events.push_back(event);
+                }
+                if (hit) {
+                    event.digit = hit;
+                    event.on = true;
+                    m_events.push_back(event);
+                }
+                m_digit[stream] = hit;
+            }
+            m_lastHit[stream] = hit;
+
+            // 单音，能量与长块的总能量比较
+            if (!evaluateTones) continue;
+            float toneTotal = m_toneEnergy[stream];
+            m_toneEnergy[stream] = 0;
+            uint32_t mask = 0;
+            for (uint32_t t = 0; t < tones; t++) {
+                if (e[8 + t] < m_minEnergy * kToneBlocks || e[8 + t] < kToneToTotal * toneTotal) continue;
+                bool peak = true;
+                for (uint32_t u = 0; u < tones; u++) {
+                    if ((m_toneNeighbors[t] >> u & 1) && e[8 + u] > e[8 + t]) peak = false;
+                }
+                if (peak) mask |= 1u << t;
+            }
+            uint32_t on = mask & m_lastToneMask[stream] & ~m_toneMask[stream];
+            uint32_t off = ~mask & ~m_lastToneMask[stream] & m_toneMask[stream];
+            for (uint32_t t = 0; (on | off) && t < tones; t++) {
+                if (((on | off) >> t & 1) == 0) continue;
+                ToneEvent event;
+                event.stream = stream;
+                event.tone = (int32_t)t;
+                event.on = (on >> t & 1) != 0;
+                event.position = m_position;
+                m_events.push_back(event);
+            }
+            m_toneMask[stream] = (m_toneMask[stream] | on) & ~off;
+            m_lastToneMask[stream] = mask;
+        }
+
+        // DTMF 的 8 个频率每块清零，单音在长块结束时清零
+        memset(state, 0, (evaluateTones ? m_freqCount : 8) * 8 * sizeof(float));
+        memset(&m_energy[group * 4], 0, 4 * sizeof(float));
+    }
+
+    // 每次读取的帧数
+    static const uint32_t kReadFrames = 8192;
+
+    // DetectInterleaved: 交错的多声道数据拆成每声道一路流，追加检测到的事件
+    static void DetectInterleaved(ToneDetector& detector, const uint16_t* samples, size_t frames, uint16_t channels,
+                                  std::vector<std::vector<uint16_t> >& planes, std::vector<ToneEvent>& events) {
+        std::vector<const uint16_t*> ptrs(channels);
+        for (uint16_t c = 0; c < channels; c++) {
+            planes[c].resize(frames);
+            for (size_t i = 0; i < frames; i++) planes[c][i] = samples[i * channels + c];
+            ptrs[c] = planes[c].data();
+        }
+        detector.Process(ptrs.data(), (uint32_t)frames);
+        events.insert(events.end(), detector.GetEvents().begin(), detector.GetEvents().end());
+    }
+
+    static bool CreateDetector(ToneDetector& detector, const std::vector<float>& tones) {
+        if (!detector.IsValid()) return false;
+        for (size_t i = 0; i < tones.size(); i++) {
+            if (detector.AddTone(tones[i]) < 0) return false;
+        }
+        for (uint32_t i = 0; i < detector.GetStreamCount(); i++) detector.SetEnabled(i, true);
+        return true;
+    }
+
+    bool DetectWaveFileTones(const std::string& waveFilePath, const std::vector<float>& tones, std::vector<ToneEvent>& events) {
+        events.clear();
+        WaveCodec::WaveFileReader reader;
+        if (!reader.Open(waveFilePath)) {
+            printf("open wave file failed, %s\n", waveFilePath.c_str());
+            return false;
+        }
+
+        WaveCodec::WaveHeader header;
+        if (!reader.ReadWaveHeader(header)) {
+            printf("read wave header failed, %s\n", waveFilePath.c_str());
+            return false;
+        }
+        if (header.riff.fmt.audio_format != WaveAudioFormatPCM || header.riff.fmt.bits_per_sample != 16 || header.riff.fmt.channels == 0) {
+            printf("only 16bit pcm wave file is supported\n");
+            return false;
+        }
+
+        uint16_t channels = header.riff.fmt.channels;
+        ToneDetector detector(channels, header.riff.fmt.sample_rate);
+        if (!CreateDetector(detector, tones)) return false;
+
+        // 只读取 data 子块，流式写入的文件 data 大小可能为 0，此时读到文件末尾
+        uint64_t shortsLeft = header.riff.data.header.size / 2;
+        if (shortsLeft == 0) shortsLeft = UINT64_MAX;
+
+        std::vector<uint16_t> samples;
+        std::vector<std::vector<uint16_t> > planes(channels);
+        while (shortsLeft > 0) {
+            uint32_t toRead = (uint32_t)std::min<uint64_t>((uint64_t)kReadFrames * channels, shortsLeft);
+            size_t nRead = reader.ReadShorts(toRead, samples);
+            if (nRead == 0) break;
+            DetectInterleaved(detector, samples.data(), nRead / channels, channels, planes, events);
+            shortsLeft -= nRead;
+        }
+        return true;
+    }
+
+    bool DetectPCMFileTones(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, const std::vector<float>& tones,
+                            std::vector<ToneEvent>& events) {
+        events.clear();
+        PCMCodec::PCMFileReader reader;
+        if (!reader.Open(pcmFilePath)) {
+            printf("open pcm file failed, %s\n", pcmFilePath.c_str());
+            return false;
+        }
+
+        ToneDetector detector(channels, sampleRate);
+        if (!CreateDetector(detector, tones)) return false;
+
+        std::vector<uint16_t> samples;
+        std::vector<std::vector<uint16_t> > planes(channels);
+        while (true) {
+            size_t nRead = reader.ReadShorts(kReadFrames * channels, samples);
+            if (nRead == 0) break;
+            DetectInterleaved(detector, samples.data(), nRead / channels, channels, planes, events);
+        }
+        return true;
+    }
+}
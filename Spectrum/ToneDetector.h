@@ -0,0 +1,133 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef SPECTRUM_TONE_DETECTOR_H
+#define SPECTRUM_TONE_DETECTOR_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Spectrum {
+
+    // ToneEvent: 一次检测结果的变化
+    struct ToneEvent {
+        uint32_t stream   = 0;
+        char     digit    = 0;      // DTMF 按键 0-9 * # A-D，为 0 时是 AddTone 增加的单音
+        int32_t  tone     = -1;     // AddTone 返回的编号，DTMF 事件为 -1
+        bool     on       = false;  // true 为开始，false 为结束
+        uint64_t position = 0;      // 确认事件时该流已处理的采样数
+    };
+
+    /*example code
+
+        ToneDetector detector(1000);                // 1000 路 8kHz 通话
+        int32_t busy = detector.AddTone(450);       // 额外检测 450Hz 忙音/拨号音，约 50ms 判决一次
+        for(uint32_t i = 0; i < 1000; i++) detector.SetEnabled(i, true);
+
+        // 每 20ms，frames[i] 为第 i 路解码后的 160 个采样(G.711 先用 G711Codec 解码)
+        detector.Process(frames, 160);
+        for(const ToneEvent& event : detector.GetEvents()){
+            if(event.digit && event.on) printf("stream %u: %c\n", event.stream, event.digit);
+        }
+    */
+
+    // ToneDetector: 多路流的 DTMF 和单音检测
+    // 每一块(8kHz 下 102 个采样)对 8 个 DTMF 频率做 Goertzel，然后按能量门限、行/列峰值比、twist 和占总能量的比例判断，
+    // 连续两块结果相同才确认开始/结束；AddTone 增加的频率按 4 块的长块(约 50ms，分辨率约 20Hz)判断，同样连续两个长块确认，
+    // 相距不足两个分辨率的单音(如 440/450Hz)只有能量最大的一个成立
+    // 所有流同步处理，每 4 路流为一组占 SIMD(SSE2/NEON) 的 4 个通道，每个频率一条独立的依赖链，4 个频率交错计算；
+    // 每路流的状态为每个频率 2 个 float 加十几个字节的判决状态
+    class ToneDetector {
+    public:
+        // * maxStreams : 流的个数
+        // * sampleRate : 采样率，4000~48000，块长按 8kHz 102 个采样等比例换算
+        explicit ToneDetector(uint32_t maxStreams, uint32_t sampleRate = 8000);
+
+        // IsValid: 参数是否有效
+        bool IsValid() const { return m_blockSamples > 0; }
+
+        uint32_t GetStreamCount() const { return m_streams; }
+        uint32_t GetBlockSamples() const { return m_blockSamples; }
+
+        // AddTone: 增加一个检测的单音频率(如 350/440/450/480/620Hz 的呼叫进程音)，最多 24 个，所有流的状态会被清除
+        // 相距 40Hz 以内的单音(如 440/450Hz)同时出现时只报告较强的一个，频率偏差超过约 1% 时可能漏检；开始/结束事件约有 100ms 的延迟
+        // * 返回值 : 单音编号，用于 ToneEvent::tone 和 GetToneMask，失败时返回 -1
+        int32_t AddTone(float frequency);
+
+        // SetMinLevel: 每个频率成分的最低电平(dBFS，正弦峰值相对满幅)，默认 -36
+        void SetMinLevel(float dbfs);
+
+        // SetEnabled: 启用/禁用一路流，状态被清除；4 路都禁用的组不做计算
+        void SetEnabled(uint32_t stream, bool enabled);
+        bool IsEnabled(uint32_t stream) const { return stream < m_streams && m_enabled[stream] != 0; }
+
+        // Reset: 清除一路流的检测状态，如新的呼叫开始时；进行中的按键/单音不产生结束事件
+        void Reset(uint32_t stream);
+
+        // Process: 所有流同步处理 samples 个采样，可以是任意长度，不足一块的部分留到下一次
+        // * frames : 每路流一个指针，指向 samples 个 16bit PCM 单声道采样(如 PCMFileReader::ReadShorts 的输出)，为空时按静音处理
+        void Process(const uint16_t* const* frames, uint32_t samples);
+
+        // GetEvents: 上一次 Process 产生的事件，按块的先后排列
+        const std::vector<ToneEvent>& GetEvents() const { return m_events; }
+
+        // GetDigit: 当前按下的 DTMF 键，没有时返回 0
+        char GetDigit(uint32_t stream) const { return stream < m_streams ? m_digit[stream] : 0; }
+
+        // GetToneMask: 当前存在的单音，第 i 位对应编号为 i 的单音
+        uint32_t GetToneMask(uint32_t stream) const { return stream < m_streams ? m_toneMask[stream] : 0; }
+
+    private:
+        void ResetState();
+        void ResetStream(uint32_t stream);
+
+        // EvaluateGroup: 一块结束时对一组 4 路流做判决
+        // * evaluateTones : 是否为单音长块的最后一块，此时同时判决单音
+        void EvaluateGroup(uint32_t group, bool evaluateTones);
+
+        uint32_t m_streams = 0;
+        uint32_t m_groups = 0;             // (m_streams + 3) / 4
+        uint32_t m_sampleRate = 0;
+        uint32_t m_blockSamples = 0;
+        uint32_t m_phase = 0;              // 当前块已处理的采样数
+        uint32_t m_toneBlock = 0;          // 当前单音长块已完成的块数
+        uint64_t m_position = 0;           // 已处理的采样数
+        float    m_minEnergy = 0;          // 每个频率成分一块内的最低能量
+
+        // 频率，前 8 个为 DTMF，补齐到 4 的倍数，补齐的系数为 0
+        std::vector<float> m_frequencies;
+        std::vector<float> m_coeff;        // 2 * cos(2 * pi * f / fs)
+        std::vector<uint32_t> m_toneNeighbors; // 每个单音频率相近(会互相泄漏)的其它单音，第 u 位对应编号为 u 的单音
+        uint32_t m_freqCount = 0;          // 补齐后的个数
+
+        // Goertzel 状态，组 g 频率 k 的 s1/s2 各 4 个 float 位于 ((g * m_freqCount + k) * 2 + 0/1) * 4
+        std::vector<float> m_state;
+        std::vector<float> m_energy;       // 每路流当前块的 sum(x^2)
+        std::vector<float> m_toneEnergy;   // 每路流当前单音长块的 sum(x^2)
+        std::vector<float> m_input;        // 一组 4 路流交错后的采样，每个采样 4 个 float
+        std::vector<uint16_t> m_silence;   // 一块长的静音，代替禁用或没有数据的流
+
+        // 每路流的判决状态
+        std::vector<uint8_t>  m_enabled;
+        std::vector<char>     m_digit;     // 已确认的按键
+        std::vector<char>     m_lastHit;   // 上一块的检测结果
+        std::vector<uint32_t> m_toneMask;
+        std::vector<uint32_t> m_lastToneMask;
+
+        std::vector<ToneEvent> m_events;
+    };
+
+    // DetectWaveFileTones: 检测 16bit PCM Wave 文件中的 DTMF 和单音，每个声道作为一路流
+    // * tones  : 额外检测的单音频率，编号为在数组中的位置
+    // * events : 输出，所有事件，position 按每声道的采样数计
+    bool DetectWaveFileTones(const std::string& waveFilePath, const std::vector<float>& tones, std::vector<ToneEvent>& events);
+
+    // DetectPCMFileTones: 检测 16bit PCM 文件中的 DTMF 和单音，每个声道作为一路流
+    bool DetectPCMFileTones(const std::string& pcmFilePath, uint32_t sampleRate, uint16_t channels, const std::vector<float>& tones,
+                            std::vector<ToneEvent>& events);
+};
+
+#endif //SPECTRUM_TONE_DETECTOR_H
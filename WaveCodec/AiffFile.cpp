@@ -0,0 +1,595 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "AiffFile.h"
+#include "ByteSwap.h"
+
+#include <cmath>
+
+#define READ_AND_CHECK(ptr, size, cnt, fp) { \
+      size_t read_cnt = fread(ptr, size, cnt, fp); \
+      if(read_cnt < cnt) {                \
+          return false;                                     \
+      }\
+}
+
+namespace WaveCodec {
+
+    // AIFF 头的长度：FORM(12) + COMM(8 + 18) + SSND(8 + 8)
+    static const uint32_t kAiffHeaderSize = 54;
+
+    // 写入时每次转换的数据长度，是 1/2/3/4/8 字节采样的公倍数
+    static const uint32_t kAiffWriteChunk = 12288;
+
+    static uint16_t GetBE16(const uint8_t* p){
+        return (uint16_t)((p[0] << 8) | p[1]);
+    }
+
+    static uint32_t GetBE32(const uint8_t* p){
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    }
+
+    static void PutBE16(uint8_t* p, uint16_t v){
+        p[0] = (uint8_t)(v >> 8);
+        p[1] = (uint8_t)v;
+    }
+
+    static void PutBE32(uint8_t* p, uint32_t v){
+        p[0] = (uint8_t)(v >> 24);
+        p[1] = (uint8_t)(v >> 16);
+        p[2] = (uint8_t)(v >> 8);
+        p[3] = (uint8_t)v;
+    }
+
+    // 80bit 扩展精度浮点数：1bit 符号 + 15bit 指数(偏移 16383) + 64bit 尾数(整数位显式存储)
+    static double GetExtended(const uint8_t* p){
+        int exponent = ((p[0] & 0x7F) << 8) | p[1];
+        uint64_t mantissa = ((uint64_t)GetBE32(p + 2) << 32) | GetBE32(p + 6);
+        if (exponent == 0 && mantissa == 0) return 0;
+
+        double value = ldexp((double)mantissa, exponent - 16383 - 63);
+        return (p[0] & 0x80) ? -value : value;
+    }
+
+    static void PutExtended(uint8_t* p, double value){
+        memset(p, 0, 10);
+        if (value <= 0) return;
+
+        int exponent = 0;
+        double fraction = frexp(value, &exponent); // value = fraction * 2^exponent, fraction in [0.5, 1)
+        uint64_t mantissa = (uint64_t)ldexp(fraction, 64);
+        exponent += 16382;
+
+        p[0] = (uint8_t)((exponent >> 8) & 0x7F);
+        p[1] = (uint8_t)exponent;
+        PutBE32(p + 2, (uint32_t)(mantissa >> 32));
+        PutBE32(p + 6, (uint32_t)mantissa);
+    }
+
+    // 8bit 采样在有符号(AIFF)和无符号(Wave)之间转换
+    static void FlipSign8(uint8_t* data, size_t size){
+        for (size_t i = 0; i < size; i++) {
+            data[i] ^= 0x80;
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // AiffFileReader
+    AiffFileReader::AiffFileReader() {
+
+    }
+
+    AiffFileReader::~AiffFileReader() {
+        Close();
+    }
+
+    bool AiffFileReader::Open(const std::string& aiffFilePath){
+        if (aiffFilePath.size() == 0) return false;
+        if (m_fp) return false;
+
+        m_fp = fopen(aiffFilePath.c_str(), "rb");
+        if(!m_fp){
+            printf("open file failed\n");
+            return false;
+        }
+
+        return true;
+    }
+
+#ifdef WIN32
+    bool AiffFileReader::OpenW(const std::wstring& aiffFilePath) {
+        if (aiffFilePath.size() == 0) return false;
+        if (m_fp) return false;
+
+        errno_t err = _wfopen_s(&m_fp, aiffFilePath.c_str(), L"rb");
+        if (err != 0) {
+            printf("open file failed\n");
+            return false;
+        }
+
+        return true;
+    }
+#endif
+
+    bool AiffFileReader::ReadWaveHeader(WaveHeader& header){
+        if(!m_fp) return false;
+        fseek(m_fp, 0L, SEEK_SET);
+
+        // FORM chunk
+        uint8_t form[12];
+        READ_AND_CHECK(form, sizeof(uint8_t), 12, m_fp);
+        if (memcmp(form, "FORM", 4) != 0) {
+            printf("invalid aiff file, form fourcc error\n");
+            return false;
+        }
+
+        bool aifc = false;
+        if (memcmp(form + 8, "AIFC", 4) == 0) {
+            aifc = true;
+        } else if (memcmp(form + 8, "AIFF", 4) != 0) {
+            printf("FORM not AIFF/AIFC, invalid aiff file\n");
+            return false;
+        }
+
+        // 查找 COMM 和 SSND 子块，两者顺序不固定
+        bool commFound = false;
+        uint16_t channels = 0;
+        uint32_t frames = 0;
+        uint16_t sample_bits = 0;
+        double sample_rate = 0;
+        uint32_t compression = AiffCompressionNone;
+
+        long dataPos = -1;
+        uint32_t dataSize = 0;
+
+        while (!commFound || dataPos < 0) {
+            uint8_t chunk[8];
+            if (fread(chunk, sizeof(uint8_t), 8, m_fp) < 8) break;
+            uint32_t chunk_size = GetBE32(chunk + 4);
+            long body = ftell(m_fp);
+
+            if (memcmp(chunk, "COMM", 4) == 0) {
+                if (chunk_size < 18) return false;
+                uint8_t comm[22];
+                uint32_t commSize = (aifc && chunk_size >= 22) ? 22 : 18;
+                READ_AND_CHECK(comm, sizeof(uint8_t), commSize, m_fp);
+
+                channels    = GetBE16(comm);
+                frames      = GetBE32(comm + 2);
+                sample_bits = GetBE16(comm + 6);
+                sample_rate = GetExtended(comm + 8);
+                if (commSize == 22) {
+                    compression = MAKE_FOURCC(comm[18], comm[19], comm[20], comm[21]);
+                }
+                commFound = true;
+            }
+            else if (memcmp(chunk, "SSND", 4) == 0) {
+                if (chunk_size < 8) return false;
+                uint8_t ssnd[8];
+                READ_AND_CHECK(ssnd, sizeof(uint8_t), 8, m_fp);
+
+                uint32_t offset = GetBE32(ssnd);
+                if (offset > chunk_size - 8) return false;
+                dataPos  = body + 8 + (long)offset;
+                dataSize = chunk_size - 8 - offset;
+            }
+
+            // 子块按 2 字节对齐
+            fseek(m_fp, body + (long)chunk_size + (long)(chunk_size & 1), SEEK_SET);
+        }
+
+        if (!commFound || dataPos < 0) {
+            printf("invalid aiff file, COMM or SSND not found\n");
+            return false;
+        }
+
+        // 压缩类型对应的 Wave 格式
+        uint16_t audio_format = WaveAudioFormatPCM;
+        uint32_t sampleBytes = (sample_bits + 7) / 8;
+        bool bigEndian = true;
+        m_signed8 = false;
+
+        if (compression == AiffCompressionNone || compression == MAKE_FOURCC('t', 'w', 'o', 's')) {
+            m_signed8 = (sampleBytes == 1);
+        } else if (compression == AiffCompressionSowt) {
+            m_signed8 = (sampleBytes == 1);
+            bigEndian = false;
+        } else if (compression == AiffCompressionFl32 || compression == MAKE_FOURCC('F', 'L', '3', '2')) {
+            audio_format = WaveAudioFormatIeeeFloat;
+            sampleBytes = 4;
+        } else if (compression == AiffCompressionFl64 || compression == MAKE_FOURCC('F', 'L', '6', '4')) {
+            audio_format = WaveAudioFormatIeeeFloat;
+            sampleBytes = 8;
+        } else if (compression == AiffCompressionALaw || compression == MAKE_FOURCC('A', 'L', 'A', 'W')) {
+            audio_format = WaveAudioFormatALaw;
+            sampleBytes = 1;
+        } else if (compression == AiffCompressionULaw || compression == MAKE_FOURCC('U', 'L', 'A', 'W')) {
+            audio_format = WaveAudioFormatMuLaw;
+            sampleBytes = 1;
+        } else {
+            printf("unsupported aifc compression type: %c%c%c%c\n", (char)(compression & 0xFF), (char)((compression >> 8) & 0xFF),
+                   (char)((compression >> 16) & 0xFF), (char)(compression >> 24));
+            return false;
+        }
+
+        if (channels == 0 || sampleBytes == 0) {
+            printf("invalid aiff file, channels:%d, sample_bits:%d\n", channels, sample_bits);
+            return false;
+        }
+
+        m_compression = compression;
+        m_sampleBytes = (sampleBytes > 1 && bigEndian == IsLittleEndianHost()) ? sampleBytes : 0;
+
+        // SSND 之后可能还有填充，以 COMM 中的帧数为准
+        uint32_t block_align = channels * sampleBytes;
+        if ((uint64_t)frames * block_align < dataSize) {
+            dataSize = frames * block_align;
+        }
+
+        // 转换为等价的 Wave Header
+        m_header = WaveHeader();
+        m_header.riff.header.fourcc = MAKE_FOURCC('R', 'I', 'F', 'F');
+        m_header.riff.form_type = MAKE_FOURCC('W', 'A', 'V', 'E');
+        m_header.riff.fmt.header.fourcc = MAKE_FOURCC('f', 'm', 't', ' ');
+        m_header.riff.fmt.header.size = (audio_format == WaveAudioFormatPCM) ? 16 : 18;
+        m_header.riff.fmt.audio_format = audio_format;
+        m_header.riff.fmt.channels = channels;
+        m_header.riff.fmt.sample_rate = (uint32_t)(sample_rate + 0.5);
+        m_header.riff.fmt.byte_rate = m_header.riff.fmt.sample_rate * block_align;
+        m_header.riff.fmt.block_align = (uint16_t)block_align;
+        m_header.riff.fmt.bits_per_sample = (uint16_t)(sampleBytes * 8);
+        if (audio_format != WaveAudioFormatPCM) {
+            m_header.riff.fact.header.fourcc = MAKE_FOURCC('f', 'a', 'c', 't');
+            m_header.riff.fact.header.size = 4;
+            m_header.riff.fact.samples = dataSize / block_align;
+        }
+        m_header.riff.data.header.fourcc = MAKE_FOURCC('d', 'a', 't', 'a');
+        m_header.riff.data.header.size = dataSize;
+        m_header.riff.header.size = m_header.GetHeaderSize() - 8 + dataSize;
+
+        printf("%s compression:%c%c%c%c, sample_rate:%d, sample_bits:%d, channels:%d\n", aifc ? "aifc" : "aiff",
+               (char)(compression & 0xFF), (char)((compression >> 8) & 0xFF), (char)((compression >> 16) & 0xFF), (char)(compression >> 24),
+               m_header.riff.fmt.sample_rate, sample_bits, channels);
+
+        // 定位到音频数据的开头
+        if (fseek(m_fp, dataPos, SEEK_SET) != 0) return false;
+        m_dataLeft = dataSize;
+
+        memcpy(&header, &m_header, sizeof(m_header));
+        return true;
+    }
+
+    size_t AiffFileReader::ReadData(uint8_t* data, size_t size) {
+        if (size > m_dataLeft) size = m_dataLeft;
+        if (size == 0) return 0;
+
+        size_t nRead = fread(data, sizeof(uint8_t), size, m_fp);
+        m_dataLeft -= (uint32_t)nRead;
+
+        if (m_sampleBytes > 1) {
+            ByteSwapSamples(data, nRead, m_sampleBytes);
+        } else if (m_signed8) {
+            FlipSign8(data, nRead);
+        }
+        return nRead;
+    }
+
+    bool AiffFileReader::SkipBytes(uint32_t bytes2Skip) {
+        if (!m_fp) return false;
+        if (bytes2Skip > m_dataLeft) bytes2Skip = m_dataLeft;
+        if (fseek(m_fp, bytes2Skip, SEEK_CUR) != 0) return false;
+        m_dataLeft -= bytes2Skip;
+        return true;
+    }
+
+    size_t AiffFileReader::ReadBytes(uint32_t bytes2Read, uint8_t* bytes) {
+        if (!m_fp) return 0;
+        if (bytes2Read == 0 || bytes == nullptr) return 0;
+
+        return ReadData(bytes, bytes2Read);
+    }
+
+    size_t AiffFileReader::ReadBytes(uint32_t bytes2Read, std::vector<uint8_t>& bytes){
+        if(!m_fp) return 0;
+        if(bytes2Read == 0) return 0;
+
+        bytes.resize(bytes2Read);
+        size_t nRead = ReadData(&bytes[0], bytes2Read);
+        if(nRead < bytes2Read){
+            bytes.resize(nRead);
+        }
+
+        return nRead;
+    }
+
+    size_t AiffFileReader::ReadShorts(uint32_t shorts2Read, uint16_t* shorts) {
+        if (!m_fp) return 0;
+        if (shorts2Read == 0 || shorts == nullptr) return 0;
+
+        return ReadData((uint8_t*)shorts, (size_t)shorts2Read * sizeof(uint16_t)) / sizeof(uint16_t);
+    }
+
+    size_t AiffFileReader::ReadShorts(uint32_t shorts2Read, std::vector<uint16_t>& shorts){
+        if(!m_fp) return 0;
+        if(shorts2Read == 0) return 0;
+
+        shorts.resize(shorts2Read);
+        size_t nRead = ReadShorts(shorts2Read, &shorts[0]);
+        if(nRead < shorts2Read){
+            shorts.resize(nRead);
+        }
+        return nRead;
+    }
+
+    size_t AiffFileReader::ReadDuration(uint32_t durationMs, uint8_t* data) {
+        if (!m_fp) return 0;
+        if (durationMs == 0 || data == nullptr) return 0;
+
+        if (m_header.riff.fmt.audio_format != WaveAudioFormatPCM
+            && m_header.riff.fmt.audio_format != WaveAudioFormatALaw
+            && m_header.riff.fmt.audio_format != WaveAudioFormatMuLaw) {
+            return 0;
+        }
+
+        uint32_t bytesPerMs = (m_header.riff.fmt.sample_rate * m_header.riff.fmt.bits_per_sample / 8 * m_header.riff.fmt.channels) / 1000; // 每 ms 的字节数
+        uint32_t bytesPerDuration = bytesPerMs * durationMs;
+        return ReadBytes(bytesPerDuration, data);
+    }
+
+    size_t AiffFileReader::ReadDuration(uint32_t durationMs, std::vector<uint8_t>& data){
+        if(!m_fp) return 0;
+        if (durationMs == 0) return 0;
+
+        if( m_header.riff.fmt.audio_format != WaveAudioFormatPCM
+            && m_header.riff.fmt.audio_format != WaveAudioFormatALaw
+            && m_header.riff.fmt.audio_format != WaveAudioFormatMuLaw){
+            return 0;
+        }
+
+        uint32_t bytesPerMs = (m_header.riff.fmt.sample_rate * m_header.riff.fmt.bits_per_sample/8 * m_header.riff.fmt.channels) / 1000; // 每 ms 的字节数
+        uint32_t bytesPerDuration = bytesPerMs * durationMs;
+        return ReadBytes(bytesPerDuration, data);
+    }
+
+    size_t AiffFileReader::ReadDuration(uint32_t durationMs, uint16_t* data) {
+        if (!m_fp) return 0;
+        if (durationMs == 0 || data == nullptr) return 0;
+
+        if (m_header.riff.fmt.audio_format != WaveAudioFormatPCM
+            && m_header.riff.fmt.audio_format != WaveAudioFormatALaw
+            && m_header.riff.fmt.audio_format != WaveAudioFormatMuLaw) {
+            return 0;
+        }
+
+        uint32_t shortsPerMs = (m_header.riff.fmt.sample_rate * m_header.riff.fmt.bits_per_sample / 16 * m_header.riff.fmt.channels) / 1000; // 每 ms 的 short 个数
+        uint32_t shortsPerDuration = shortsPerMs * durationMs;
+        return ReadShorts(shortsPerDuration, data);
+    }
+
+    size_t AiffFileReader::ReadDuration(uint32_t durationMs, std::vector<uint16_t>& data){
+        if(!m_fp) return 0;
+
+        if( m_header.riff.fmt.audio_format != WaveAudioFormatPCM
+            && m_header.riff.fmt.audio_format != WaveAudioFormatALaw
+            && m_header.riff.fmt.audio_format != WaveAudioFormatMuLaw){
+            return 0;
+        }
+
+        uint32_t shortsPerMs = (m_header.riff.fmt.sample_rate * m_header.riff.fmt.bits_per_sample/16 * m_header.riff.fmt.channels) / 1000; // 每 ms 的 short 个数
+        uint32_t shortsPerDuration = shortsPerMs * durationMs;
+        return ReadShorts(shortsPerDuration, data);
+    }
+
+    void AiffFileReader::Close(){
+        if(m_fp){
+            fclose(m_fp);
+            m_fp = nullptr;
+        }
+        m_dataLeft = 0;
+    }
+
+    ///////////////////////////////////////////////////
+    // AiffFileWriter
+    AiffFileWriter::AiffFileWriter(){}
+    AiffFileWriter::~AiffFileWriter(){
+        Close();
+    }
+
+    bool AiffFileWriter::Open(const std::string& aiffFilePath, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels){
+        if (aiffFilePath.size() == 0) return false;
+        if (m_fp) return false;
+
+        m_fp = fopen(aiffFilePath.c_str(), "wb");
+        if(!m_fp){
+            printf("open file failed\n");
+            return false;
+        }
+
+        return OnOpened(sample_rate, sample_bits, channels);
+    }
+
+#ifdef WIN32
+    bool AiffFileWriter::OpenW(const std::wstring& aiffFilePath, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels) {
+        if (aiffFilePath.size() == 0) return false;
+        if (m_fp) return false;
+
+        errno_t err = _wfopen_s(&m_fp, aiffFilePath.c_str(), L"wb");
+        if (err != 0 || m_fp == nullptr) {
+            printf("open file failed\n");
+            return false;
+        }
+
+        return OnOpened(sample_rate, sample_bits, channels);
+    }
+#endif
+
+    bool AiffFileWriter::OnOpened(uint32_t sample_rate, uint16_t sample_bits, uint16_t channels){
+        if ((sample_bits != 8 && sample_bits != 16 && sample_bits != 24 && sample_bits != 32) || channels == 0) {
+            printf("unsupported aiff format, sample_bits:%d, channels:%d\n", sample_bits, channels);
+            fclose(m_fp);
+            m_fp = nullptr;
+            return false;
+        }
+
+        m_sample_rate = sample_rate;
+        m_sample_bits = sample_bits;
+        m_channels = channels;
+        m_data_len = 0;
+
+        // 文件开头保留 header_size 字节，用于回填 aiff header
+        fseek(m_fp, kAiffHeaderSize, SEEK_SET);
+        return true;
+    }
+
+    void AiffFileWriter::Write(const uint8_t* data, uint32_t len){
+        if(!m_fp) return;
+        if(!data) return;
+
+        // 转换为大端有符号格式后写入
+        uint32_t sampleBytes = m_sample_bits / 8;
+        m_buffer.resize(kAiffWriteChunk);
+        for (uint32_t pos = 0; pos < len; pos += kAiffWriteChunk) {
+            uint32_t size = (len - pos < kAiffWriteChunk) ? (len - pos) : kAiffWriteChunk;
+            memcpy(&m_buffer[0], data + pos, size);
+
+            if (sampleBytes == 1) {
+                FlipSign8(&m_buffer[0], size);
+            } else if (IsLittleEndianHost()) {
+                ByteSwapSamples(&m_buffer[0], size, sampleBytes);
+            }
+            fwrite(&m_buffer[0], sizeof(uint8_t), size, m_fp);
+        }
+        m_data_len += len;
+    }
+
+    void AiffFileWriter::Write(const uint16_t* data, uint32_t len){
+        Write((const uint8_t*)data, len * 2);
+    }
+
+    void AiffFileWriter::Write(const std::vector<uint8_t>& data){
+        if(data.size() == 0) return;
+        Write(&data[0], data.size());
+    }
+
+    void AiffFileWriter::Write(const std::vector<uint8_t>& data, size_t len){
+        if(data.size() == 0) return;
+        Write(&data[0], len);
+    }
+
+    void AiffFileWriter::Write(const std::vector<uint16_t>& data){
+        if(data.size() == 0) return;
+        Write(&data[0], data.size());
+    }
+
+    void AiffFileWriter::Write(const std::vector<uint16_t>& data, size_t len){
+        if(data.size() == 0) return;
+        Write(&data[0], len);
+    }
+
+    void AiffFileWriter::Close(){
+        if(m_fp){
+            // SSND 子块按 2 字节对齐
+            uint32_t pad = m_data_len & 1;
+            if (pad) {
+                fputc(0, m_fp);
+            }
+
+            uint32_t block_align = m_channels * (m_sample_bits / 8);
+            uint8_t header[kAiffHeaderSize];
+
+            // FORM
+            memcpy(header, "FORM", 4);
+            PutBE32(header + 4, kAiffHeaderSize - 8 + m_data_len + pad);
+            memcpy(header + 8, "AIFF", 4);
+
+            // COMM
+            memcpy(header + 12, "COMM", 4);
+            PutBE32(header + 16, 18);
+            PutBE16(header + 20, m_channels);
+            PutBE32(header + 22, m_data_len / block_align);
+            PutBE16(header + 26, m_sample_bits);
+            PutExtended(header + 28, (double)m_sample_rate);
+
+            // SSND
+            memcpy(header + 38, "SSND", 4);
+            PutBE32(header + 42, 8 + m_data_len);
+            PutBE32(header + 46, 0); // offset
+            PutBE32(header + 50, 0); // block size
+
+            // 回填 aiff header 到文件开头
+            fseek(m_fp, 0, SEEK_SET);
+            fwrite(header, sizeof(uint8_t), kAiffHeaderSize, m_fp);
+
+            fclose(m_fp);
+            m_fp = nullptr;
+        }
+    }
+
+    // AIFF 文件转 PCM 文件，同时返回音频的编码参数
+    bool AIFF2PCMFile(const std::string& aiffFilePath, const std::string& pcmFilePath, uint32_t& sample_rate_out, uint16_t& sample_bits_out, uint16_t& channels_out){
+        AiffFileReader reader;
+        if(!reader.Open(aiffFilePath)){
+            return false;
+        }
+
+        WaveHeader header;
+        if(!reader.ReadWaveHeader(header)){
+            return false;
+        }
+
+        sample_rate_out = header.riff.fmt.sample_rate;
+        sample_bits_out = header.riff.fmt.bits_per_sample;
+        channels_out    = header.riff.fmt.channels;
+
+        FILE *fpPCM = fopen(pcmFilePath.c_str(), "wb");
+        if (!fpPCM) {
+            printf("open pcm file failed, %s\n", pcmFilePath.c_str());
+            return false;
+        }
+
+        // 每次读取整数个采样块
+        uint32_t block_align = header.riff.fmt.block_align;
+        uint32_t readSize = (kAiffWriteChunk + block_align - 1) / block_align * block_align;
+
+        std::vector<uint8_t> buffer;
+        while(true){
+            size_t read_cnt = reader.ReadBytes(readSize, buffer);
+            if(read_cnt > 0){
+                fwrite(&buffer[0], sizeof(uint8_t), read_cnt, fpPCM);
+            }else{
+                break;
+            }
+        }
+
+        fclose(fpPCM);
+        return true;
+    }
+
+    // PCM 文件转 AIFF 文件
+    bool PCM2AIFFFile(const std::string& pcmFilePath, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels, const std::string& aiffFilePath){
+        AiffFileWriter writer;
+        if(!writer.Open(aiffFilePath, sample_rate, sample_bits, channels)){
+            return false;
+        }
+
+        FILE* fpPCM = fopen(pcmFilePath.c_str(), "rb");
+        if(!fpPCM){
+            printf("open pcm file failed\n");
+            return false;
+        }
+
+        std::vector<uint8_t> buffer(kAiffWriteChunk);
+        while (true) {
+            size_t read_cnt = fread(&buffer[0], sizeof(uint8_t), buffer.size(), fpPCM);
+            if (read_cnt == 0) {
+                break;
+            }
+            writer.Write(&buffer[0], (uint32_t)read_cnt);
+        }
+
+        fclose(fpPCM);
+        writer.Close();
+        return true;
+    }
+}
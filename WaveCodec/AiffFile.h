@@ -0,0 +1,141 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef AIFF_FILE_H_
+#define AIFF_FILE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "WaveFile.h"
+
+namespace WaveCodec {
+
+    // AIFF/AIFC 文件由 "FORM" 块组成，所有整数和采样都是大端存储
+    // - COMM 子块: 声道数、帧数、位深、采样率(80bit 扩展精度浮点数)，AIFC 还有压缩类型
+    // - SSND 子块: 音频数据，前面有 offset 和 blockSize 两个字段
+    // 子块没有固定顺序，AIFF 的 SSND 之后也可能还有其它子块
+
+    // AIFC 压缩类型
+    #define AiffCompressionNone MAKE_FOURCC('N', 'O', 'N', 'E') // 大端 PCM
+    #define AiffCompressionSowt MAKE_FOURCC('s', 'o', 'w', 't') // 小端 PCM
+    #define AiffCompressionFl32 MAKE_FOURCC('f', 'l', '3', '2') // 32bit 浮点数
+    #define AiffCompressionFl64 MAKE_FOURCC('f', 'l', '6', '4') // 64bit 浮点数
+    #define AiffCompressionALaw MAKE_FOURCC('a', 'l', 'a', 'w') // G.711 A-law
+    #define AiffCompressionULaw MAKE_FOURCC('u', 'l', 'a', 'w') // G.711 mu-law
+
+    /*example code
+
+        AiffFileReader reader;
+        reader.Open("test.aiff");
+        WaveHeader header;
+        reader.ReadWaveHeader(header);
+        std::vector<uint8_t> buffer;
+        while(true){
+            size_t nRead = reader.ReadBytes(header.riff.fmt.block_align * 1024, buffer);
+            if(nRead == 0) {
+                break;
+            }
+            // process buffer as you want, samples are in host byte order
+        }
+        reader.Close();
+    */
+
+    // AiffFileReader: AIFF/AIFC 文件读取类，接口与 WaveFileReader 相同
+    // 读到的采样与 Wave 文件一致：本机字节序，8bit 为无符号数
+    // 每次读取的长度应为 block_align 的整数倍，否则跨越两次读取的采样无法正确转换
+    class AiffFileReader{
+    public:
+        AiffFileReader();
+        ~AiffFileReader();
+        bool Open(const std::string& aiffFilePath);
+
+#ifdef WIN32
+        bool OpenW(const std::wstring& aiffFilePath);
+#endif
+
+        // ReadWaveHeader: 解析 AIFF/AIFC 文件头，转换为等价的 Wave Header
+        // PCM 为 WaveAudioFormatPCM，fl32/fl64 为 WaveAudioFormatIeeeFloat，alaw/ulaw 为 WaveAudioFormatALaw/WaveAudioFormatMuLaw
+        // 位深不是 8 的倍数时，向上取整到整字节(数据在高位)
+        // 解析后文件流位于音频数据的开头
+        bool ReadWaveHeader(WaveHeader& header);
+
+        // GetCompressionType: 压缩类型，AIFF 文件为 AiffCompressionNone
+        uint32_t GetCompressionType() const { return m_compression; }
+
+        // SkipBytes: 从文件流的当前位置跳过指定的长度的数据
+        bool SkipBytes(uint32_t bytes2Skip);
+
+        // ReadBytes: 读取指定字节数的音频数据，返回实际读取到的字节数，不会读到 SSND 之后的子块
+        size_t ReadBytes(uint32_t bytes2Read, uint8_t* bytes);
+        size_t ReadBytes(uint32_t bytes2Read, std::vector<uint8_t>& bytes);
+
+        // ReadShorts: 读取指定数量的short类型音频数据，返回实际读取到的 short 个数
+        size_t ReadShorts(uint32_t shorts2Read, uint16_t* shorts);
+        size_t ReadShorts(uint32_t shorts2Read, std::vector<uint16_t>& shorts);
+
+        // ReadDuration: 读取指定时长(毫秒)的音频数据，仅支持 PCM/ALaw/ULaw 格式，返回实际读取到大小
+        size_t ReadDuration(uint32_t durationMs, uint8_t* data);
+        size_t ReadDuration(uint32_t durationMs, std::vector<uint8_t>& data);
+        size_t ReadDuration(uint32_t durationMs, uint16_t* data);
+        size_t ReadDuration(uint32_t durationMs, std::vector<uint16_t>& data);
+
+        // Close: 关闭文件
+        void Close();
+    private:
+        // 读取音频数据并转换为本机字节序
+        size_t ReadData(uint8_t* data, size_t size);
+
+        FILE* m_fp = nullptr;
+        WaveHeader m_header;
+        uint32_t m_compression = AiffCompressionNone;
+        uint32_t m_sampleBytes = 0;  // 需要交换字节序时每个采样的字节数，不需要时为 0
+        bool m_signed8 = false;      // 8bit 有符号采样，需要转换为无符号
+        uint32_t m_dataLeft = 0;     // SSND 中剩余的音频数据长度
+    };
+
+    // AiffFileWriter: AIFF 文件写入类，仅支持 PCM，接口与 WaveFileWriter 相同
+    // 写入的采样与 Wave 文件一致：本机字节序，8bit 为无符号数，写入时转换为 AIFF 的大端有符号格式
+    class AiffFileWriter{
+    public:
+        AiffFileWriter();
+        ~AiffFileWriter();
+
+        bool Open(const std::string& aiffFilePath, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels);
+
+#ifdef WIN32
+        bool OpenW(const std::wstring& aiffFilePath, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels);
+#endif
+
+        // Write: 将数据写入AIFF文件，长度应为 block_align 的整数倍
+        void Write(const uint8_t* data, uint32_t len);
+        void Write(const uint16_t* data, uint32_t len);
+        void Write(const std::vector<uint8_t>& data);
+        void Write(const std::vector<uint8_t>& data, size_t len);
+        void Write(const std::vector<uint16_t>& data);
+        void Write(const std::vector<uint16_t>& data, size_t len);
+
+        // Close: 回填文件头并关闭文件
+        void Close();
+    private:
+        bool OnOpened(uint32_t sample_rate, uint16_t sample_bits, uint16_t channels);
+
+        FILE* m_fp = nullptr;
+        uint32_t m_sample_rate = 0;
+        uint16_t m_sample_bits = 0;
+        uint16_t m_channels = 0;
+        uint32_t m_data_len = 0;
+        std::vector<uint8_t> m_buffer; // 转换字节序用的缓冲区
+    };
+
+    // AIFF 文件转 PCM 文件，同时返回音频的编码参数
+    bool AIFF2PCMFile(const std::string& aiffFilePath, const std::string& pcmFilePath, uint32_t& sample_rate_out, uint16_t& sample_bits_out, uint16_t& channels_out);
+
+    // PCM 文件转 AIFF 文件
+    bool PCM2AIFFFile(const std::string& pcmFilePath, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels, const std::string& aiffFilePath);
+}
+
+#endif //AIFF_FILE_H_
@@ -0,0 +1,184 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "ByteSwap.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BYTE_SWAP_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BYTE_SWAP_NEON
+#endif
+
+// pshufb 可以一条指令完成任意字节重排：编译时已开启 SSSE3 则直接使用，
+// 否则在 GCC/Clang 下编译一份 SSSE3 版本，运行时根据 CPU 选择
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define BYTE_SWAP_SSSE3
+#define BYTE_SWAP_SSSE3_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define BYTE_SWAP_SSSE3
+#define BYTE_SWAP_SSSE3_DISPATCH
+#define BYTE_SWAP_SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+
+namespace WaveCodec {
+
+    ///////////////////////////////////////////////////
+    // 标量实现，也用于处理 SIMD 剩下的尾部
+    static void Swap16Scalar(uint8_t* p, size_t begin, size_t count){
+        for (size_t i = begin; i < count; i++) {
+            uint8_t t = p[2 * i];
+            p[2 * i] = p[2 * i + 1];
+            p[2 * i + 1] = t;
+        }
+    }
+
+    static void Swap24Scalar(uint8_t* p, size_t begin, size_t count){
+        for (size_t i = begin; i < count; i++) {
+            uint8_t t = p[3 * i];
+            p[3 * i] = p[3 * i + 2];
+            p[3 * i + 2] = t;
+        }
+    }
+
+    static void Swap32Scalar(uint8_t* p, size_t begin, size_t count){
+        for (size_t i = begin; i < count; i++) {
+            uint32_t v;
+            memcpy(&v, p + 4 * i, 4);
+            v = ByteSwap32(v);
+            memcpy(p + 4 * i, &v, 4);
+        }
+    }
+
+    static void Swap64Scalar(uint8_t* p, size_t begin, size_t count){
+        for (size_t i = begin; i < count; i++) {
+            uint8_t* s = p + 8 * i;
+            for (int k = 0; k < 4; k++) {
+                uint8_t t = s[k];
+                s[k] = s[7 - k];
+                s[7 - k] = t;
+            }
+        }
+    }
+
+#ifdef BYTE_SWAP_SSSE3
+    ///////////////////////////////////////////////////
+    // SSSE3: pshufb
+    BYTE_SWAP_SSSE3_TARGET
+    static void SwapShuffleSSSE3(uint8_t* p, size_t count, uint32_t sampleBytes){
+        size_t i = 0;
+        if (sampleBytes == 3) {
+            // 每次处理 5 个采样(15 字节)，读写 16 字节，第 16 个字节原样写回
+            const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+            for (; i + 6 <= count; i += 5) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(p + 3 * i));
+                _mm_storeu_si128((__m128i*)(p + 3 * i), _mm_shuffle_epi8(v, shuffle));
+            }
+            Swap24Scalar(p, i, count);
+        } else if (sampleBytes == 4) {
+            const __m128i shuffle = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+            for (; i + 4 <= count; i += 4) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(p + 4 * i));
+                _mm_storeu_si128((__m128i*)(p + 4 * i), _mm_shuffle_epi8(v, shuffle));
+            }
+            Swap32Scalar(p, i, count);
+        } else if (sampleBytes == 8) {
+            const __m128i shuffle = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+            for (; i + 2 <= count; i += 2) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(p + 8 * i));
+                _mm_storeu_si128((__m128i*)(p + 8 * i), _mm_shuffle_epi8(v, shuffle));
+            }
+            Swap64Scalar(p, i, count);
+        }
+    }
+
+    static bool HasSSSE3(){
+#ifdef BYTE_SWAP_SSSE3_DISPATCH
+        static const bool has = __builtin_cpu_supports("ssse3") != 0;
+        return has;
+#else
+        return true;
+#endif
+    }
+#endif
+
+    ///////////////////////////////////////////////////
+    // SSE2/NEON
+    static void Swap16(uint8_t* p, size_t count){
+        size_t i = 0;
+#if defined(BYTE_SWAP_SSE2)
+        for (; i + 8 <= count; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(p + 2 * i));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128((__m128i*)(p + 2 * i), v);
+        }
+#elif defined(BYTE_SWAP_NEON)
+        for (; i + 8 <= count; i += 8) {
+            vst1q_u8(p + 2 * i, vrev16q_u8(vld1q_u8(p + 2 * i)));
+        }
+#endif
+        Swap16Scalar(p, i, count);
+    }
+
+    static void Swap32(uint8_t* p, size_t count){
+        size_t i = 0;
+#if defined(BYTE_SWAP_SSE2)
+        for (; i + 4 <= count; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(p + 4 * i));
+            // 先交换 32bit 中的两个 16bit 字，再交换字内的字节
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128((__m128i*)(p + 4 * i), v);
+        }
+#elif defined(BYTE_SWAP_NEON)
+        for (; i + 4 <= count; i += 4) {
+            vst1q_u8(p + 4 * i, vrev32q_u8(vld1q_u8(p + 4 * i)));
+        }
+#endif
+        Swap32Scalar(p, i, count);
+    }
+
+    static void Swap64(uint8_t* p, size_t count){
+        size_t i = 0;
+#if defined(BYTE_SWAP_SSE2)
+        for (; i + 2 <= count; i += 2) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(p + 8 * i));
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128((__m128i*)(p + 8 * i), v);
+        }
+#elif defined(BYTE_SWAP_NEON)
+        for (; i + 2 <= count; i += 2) {
+            vst1q_u8(p + 8 * i, vrev64q_u8(vld1q_u8(p + 8 * i)));
+        }
+#endif
+        Swap64Scalar(p, i, count);
+    }
+
+    void ByteSwapSamples(uint8_t* data, size_t size, uint32_t sampleBytes){
+        if (!data || sampleBytes <= 1) return;
+
+        size_t count = size / sampleBytes;
+        if (sampleBytes == 2) {
+            Swap16(data, count);
+            return;
+        }
+
+#ifdef BYTE_SWAP_SSSE3
+        if ((sampleBytes == 3 || sampleBytes == 4 || sampleBytes == 8) && HasSSSE3()) {
+            SwapShuffleSSSE3(data, count, sampleBytes);
+            return;
+        }
+#endif
+
+        if (sampleBytes == 3) Swap24Scalar(data, 0, count);
+        else if (sampleBytes == 4) Swap32(data, count);
+        else if (sampleBytes == 8) Swap64(data, count);
+    }
+}
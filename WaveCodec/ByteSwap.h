@@ -0,0 +1,36 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef BYTE_SWAP_H_
+#define BYTE_SWAP_H_
+
+#include <cstdint>
+#include <cstddef>
+
+namespace WaveCodec {
+
+    // ByteSwapSamples: 原地交换每个采样的字节序，用于大端存储的 RIFX/AIFF 文件
+    // 16/32/64bit 使用 SSE2/NEON，24bit 在支持 SSSE3 时使用 pshufb
+    // * data        : 采样数据
+    // * size        : 数据长度(字节)，末尾不足一个采样的部分不处理
+    // * sampleBytes : 每个采样的字节数，1 时不处理
+    void ByteSwapSamples(uint8_t* data, size_t size, uint32_t sampleBytes);
+
+    // ByteSwap16/ByteSwap32: 单个整数的字节序交换
+    inline uint16_t ByteSwap16(uint16_t v){
+        return (uint16_t)((v >> 8) | (v << 8));
+    }
+
+    inline uint32_t ByteSwap32(uint32_t v){
+        return (v >> 24) | ((v >> 8) & 0x0000FF00u) | ((v << 8) & 0x00FF0000u) | (v << 24);
+    }
+
+    // IsLittleEndianHost: 当前平台是否为小端
+    inline bool IsLittleEndianHost(){
+        const uint16_t v = 1;
+        return *(const uint8_t*)&v == 1;
+    }
+}
+
+#endif //BYTE_SWAP_H_
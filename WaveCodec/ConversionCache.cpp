@@ -0,0 +1,410 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "ConversionCache.h"
+#include "WaveChunks.h"
+#include "AsyncIO/AsyncIO.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <windows.h>
+#include <process.h>
+#include <sys/utime.h>
+#define getpid _getpid
+#else
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+namespace WaveCodec {
+
+    static const uint64_t kPrime1 = 11400714785074694791ULL;
+    static const uint64_t kPrime2 = 14029467366897019727ULL;
+    static const uint64_t kPrime3 = 1609587929392839161ULL;
+    static const uint64_t kPrime4 = 9650029242287828579ULL;
+    static const uint64_t kPrime5 = 2870177450012600261ULL;
+
+    // 计算哈希时每次读取的大小
+    static const size_t kHashBlockSize = 1 << 20;
+
+    static const char* kEntrySuffix = ".cache";
+
+    // 临时文件为 key + ".tmp" + 进程号 + "-" + 序号；超过这个时间没有修改的临时文件是崩溃的进程留下的，打开时删除
+    static const char* kTmpInfix = ".tmp";
+    static const int64_t kStaleTmpSeconds = 3600;
+
+    static inline uint64_t Rotl64(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static inline uint64_t Read64(const uint8_t* p) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static inline uint32_t Read32(const uint8_t* p) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static inline uint64_t Round(uint64_t acc, uint64_t input) {
+        acc += input * kPrime2;
+        acc = Rotl64(acc, 31);
+        return acc * kPrime1;
+    }
+
+    static inline uint64_t MergeRound(uint64_t acc, uint64_t val) {
+        acc ^= Round(0, val);
+        return acc * kPrime1 + kPrime4;
+    }
+
+    // 4 路各处理 8 字节
+    static inline void Stripe(uint64_t* acc, const uint8_t* p) {
+        acc[0] = Round(acc[0], Read64(p));
+        acc[1] = Round(acc[1], Read64(p + 8));
+        acc[2] = Round(acc[2], Read64(p + 16));
+        acc[3] = Round(acc[3], Read64(p + 24));
+    }
+
+    ///////////////////////////////////////////////////
+    // ContentHasher
+    void ContentHasher::Reset(uint64_t seed) {
+        m_seed = seed;
+        m_acc[0] = seed + kPrime1 + kPrime2;
+        m_acc[1] = seed + kPrime2;
+        m_acc[2] = seed;
+        m_acc[3] = seed - kPrime1;
+        m_buffered = 0;
+        m_total = 0;
+    }
+
+    void ContentHasher::Update(const void* data, size_t len) {
+        if (!data || len == 0) return;
+        const uint8_t* p = (const uint8_t*)data;
+        m_total += len;
+
+        if (m_buffered > 0) {
+            size_t n = std::min<size_t>(32 - m_buffered, len);
+            memcpy(m_buffer + m_buffered, p, n);
+            m_buffered += (uint32_t)n;
+            p += n;
+            len -= n;
+            if (m_buffered < 32) return;
+            Stripe(m_acc, m_buffer);
+            m_buffered = 0;
+        }
+
+        for (; len >= 32; p += 32, len -= 32) {
+            Stripe(m_acc, p);
+        }
+
+        if (len > 0) {
+            memcpy(m_buffer, p, len);
+            m_buffered = (uint32_t)len;
+        }
+    }
+
+    uint64_t ContentHasher::Digest() const {
+        uint64_t h;
+        if (m_total >= 32) {
+            h = Rotl64(m_acc[0], 1) + Rotl64(m_acc[1], 7) + Rotl64(m_acc[2], 12) + Rotl64(m_acc[3], 18);
+            for (int i = 0; i < 4; i++) {
+                h = MergeRound(h, m_acc[i]);
+            }
+        } else {
+            h = m_seed + kPrime5;
+        }
+        h += m_total;
+
+        // 剩余不足 32 字节的数据
+        const uint8_t* p = m_buffer;
+        uint32_t len = m_buffered;
+        for (; len >= 8; p += 8, len -= 8) {
+            h ^= Round(0, Read64(p));
+            h = Rotl64(h, 27) * kPrime1 + kPrime4;
+        }
+        if (len >= 4) {
+            h ^= (uint64_t)Read32(p) * kPrime1;
+            h = Rotl64(h, 23) * kPrime2 + kPrime3;
+            p += 4;
+            len -= 4;
+        }
+        for (; len > 0; p++, len--) {
+            h ^= (*p) * kPrime5;
+            h = Rotl64(h, 11) * kPrime1;
+        }
+
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    uint64_t ContentHash64(const void* data, size_t len, uint64_t seed) {
+        ContentHasher hasher(seed);
+        hasher.Update(data, len);
+        return hasher.Digest();
+    }
+
+    int64_t HashFileRange(int fd, uint64_t offset, uint64_t length, uint64_t& hash) {
+        if (fd < 0) return -1;
+
+        ContentHasher hasher;
+        std::vector<uint8_t> buffer((size_t)std::min<uint64_t>(kHashBlockSize, std::max<uint64_t>(length, 1)));
+        uint64_t done = 0;
+        while (done < length) {
+            size_t toRead = (size_t)std::min<uint64_t>(buffer.size(), length - done);
+            int64_t nRead = AsyncIO::ReadFileAt(fd, &buffer[0], toRead, offset + done);
+            if (nRead < 0) return -1;
+            hasher.Update(&buffer[0], (size_t)nRead);
+            done += (uint64_t)nRead;
+            if ((size_t)nRead < toRead) break;
+        }
+        hash = hasher.Digest();
+        return (int64_t)done;
+    }
+
+    bool HashWaveContent(const std::string& waveFilePath, uint64_t& hash, uint64_t& size) {
+        RiffChunkDirectory dir;
+        if (!dir.Open(waveFilePath)) return false;
+
+        int fmtIndex = dir.FindChunk("fmt ");
+        int dataIndex = dir.FindChunk("data");
+        const std::vector<uint8_t>* fmt = dir.LoadChunk(fmtIndex);
+        if (!fmt || dataIndex < 0) return false;
+
+        // 字节序影响采样的含义，一并计入
+        ContentHasher hasher;
+        uint8_t bigEndian = dir.IsBigEndian() ? 1 : 0;
+        hasher.Update(&bigEndian, 1);
+        hasher.Update(fmt->data(), fmt->size());
+        size = fmt->size();
+
+        uint64_t dataSize = dir.GetChunk(dataIndex).size;
+        std::vector<uint8_t> buffer((size_t)std::min<uint64_t>(kHashBlockSize, std::max<uint64_t>(dataSize, 1)));
+        for (uint64_t offset = 0; offset < dataSize; ) {
+            size_t toRead = (size_t)std::min<uint64_t>(buffer.size(), dataSize - offset);
+            int64_t nRead = dir.ReadChunk(dataIndex, offset, &buffer[0], toRead);
+            if (nRead < 0) return false;
+            if (nRead == 0) break;
+            hasher.Update(&buffer[0], (size_t)nRead);
+            offset += (uint64_t)nRead;
+        }
+        size += dataSize;
+        hash = hasher.Digest();
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // ConversionCache
+    ConversionCache::ConversionCache(const std::string& cacheDir, uint64_t maxBytes)
+        : m_dir(cacheDir), m_maxBytes(maxBytes) {
+        if (!m_dir.empty() && m_dir[m_dir.size() - 1] != '/' && m_dir[m_dir.size() - 1] != '\\') m_dir += "/";
+
+#ifdef WIN32
+        CreateDirectoryA(cacheDir.c_str(), nullptr);
+#else
+        mkdir(cacheDir.c_str(), 0755);
+#endif
+        struct stat st;
+        if (cacheDir.empty() || stat(cacheDir.c_str(), &st) != 0 || !(st.st_mode & S_IFDIR)) {
+            printf("invalid cache dir, %s\n", cacheDir.c_str());
+            return;
+        }
+        m_valid = true;
+        Scan();
+    }
+
+    std::string ConversionCache::MakeKey(uint64_t contentHash, uint64_t contentSize, const std::string& params) {
+        char key[64];
+        snprintf(key, sizeof(key), "%016llx-%llx-%016llx", (unsigned long long)contentHash, (unsigned long long)contentSize,
+                 (unsigned long long)ContentHash64(params.data(), params.size()));
+        return key;
+    }
+
+    std::string ConversionCache::GetEntryPath(const std::string& key) const {
+        return m_dir + key + kEntrySuffix;
+    }
+
+    // 按修改时间恢复使用顺序，同时删除过期的临时文件
+    void ConversionCache::Scan() {
+        std::vector<std::string> names;
+#ifdef WIN32
+        WIN32_FIND_DATAA data;
+        HANDLE handle = FindFirstFileA((m_dir + "*").c_str(), &data);
+        if (handle != INVALID_HANDLE_VALUE) {
+            do {
+                names.push_back(data.cFileName);
+            } while (FindNextFileA(handle, &data));
+            FindClose(handle);
+        }
+#else
+        DIR* d = opendir(m_dir.c_str());
+        if (!d) return;
+        struct dirent* ent;
+        while ((ent = readdir(d)) != nullptr) {
+            names.push_back(ent->d_name);
+        }
+        closedir(d);
+#endif
+
+        struct Found {
+            std::string key;
+            uint64_t size;
+            int64_t mtime;
+        };
+        std::vector<Found> found;
+        size_t suffixLen = strlen(kEntrySuffix);
+        int64_t now = (int64_t)time(nullptr);
+        for (size_t i = 0; i < names.size(); i++) {
+            const std::string& name = names[i];
+            struct stat st;
+            if (name.find(kTmpInfix) != std::string::npos) {
+                // 其它进程正在写入的临时文件修改时间是新的，不会被删除
+                if (stat((m_dir + name).c_str(), &st) == 0 && (st.st_mode & S_IFREG) && now - (int64_t)st.st_mtime > kStaleTmpSeconds) {
+                    remove((m_dir + name).c_str());
+                }
+                continue;
+            }
+            if (name.size() <= suffixLen || name.compare(name.size() - suffixLen, suffixLen, kEntrySuffix) != 0) continue;
+
+            if (stat((m_dir + name).c_str(), &st) != 0 || !(st.st_mode & S_IFREG)) continue;
+            Found f;
+            f.key = name.substr(0, name.size() - suffixLen);
+            f.size = (uint64_t)st.st_size;
+            f.mtime = (int64_t)st.st_mtime;
+            found.push_back(f);
+        }
+        std::sort(found.begin(), found.end(), [](const Found& a, const Found& b){ return a.mtime > b.mtime; });
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < found.size(); i++) {
+            Entry entry;
+            entry.key = found[i].key;
+            entry.size = found[i].size;
+            m_lru.push_back(entry);
+            m_index[entry.key] = --m_lru.end();
+            m_totalBytes += entry.size;
+        }
+        EvictLocked();
+    }
+
+    void ConversionCache::EvictLocked() {
+        // 至少保留最近使用的一项
+        while (m_totalBytes > m_maxBytes && m_lru.size() > 1) {
+            const Entry& entry = m_lru.back();
+            remove(GetEntryPath(entry.key).c_str());
+            m_totalBytes -= entry.size;
+            m_index.erase(entry.key);
+            m_lru.pop_back();
+        }
+    }
+
+    bool ConversionCache::Lookup(const std::string& key, const std::string& dstPath) {
+        if (!m_valid) return false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_index.find(key);
+            if (it == m_index.end()) {
+                m_misses++;
+                return false;
+            }
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+        }
+
+        // 复制时不持有锁，期间该项可能被其它线程淘汰，此时按未命中处理
+        std::string path = GetEntryPath(key);
+        bool ok = AsyncIO::CopyWholeFile(path, dstPath) >= 0;
+        if (ok) {
+#ifdef WIN32
+            _utime(path.c_str(), nullptr);
+#else
+            utime(path.c_str(), nullptr);
+#endif
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (ok) {
+            m_hits++;
+            return true;
+        }
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_totalBytes -= it->second->size;
+            m_lru.erase(it->second);
+            m_index.erase(it);
+        }
+        m_misses++;
+        return false;
+    }
+
+    bool ConversionCache::Store(const std::string& key, const std::string& srcPath) {
+        if (!m_valid) return false;
+
+        std::string tmpPath;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_index.find(key) != m_index.end()) return true;
+            // 序号只在进程内唯一，加上进程号，多个进程同时保存相同的 key 时不会写同一个临时文件
+            tmpPath = m_dir + key + kTmpInfix + std::to_string((long long)getpid()) + "-" + std::to_string(m_tmpSeq++);
+        }
+
+        int64_t size = AsyncIO::CopyWholeFile(srcPath, tmpPath);
+        if (size < 0 || (uint64_t)size > m_maxBytes) {
+            remove(tmpPath.c_str());
+            return false;
+        }
+
+        std::string path = GetEntryPath(key);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_index.find(key) != m_index.end()) {
+            remove(tmpPath.c_str()); // 其它线程已经保存了相同的结果
+            return true;
+        }
+        if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+            remove(tmpPath.c_str());
+            return false;
+        }
+
+        Entry entry;
+        entry.key = key;
+        entry.size = (uint64_t)size;
+        m_lru.push_front(entry);
+        m_index[key] = m_lru.begin();
+        m_totalBytes += (uint64_t)size;
+        EvictLocked();
+        return true;
+    }
+
+    uint64_t ConversionCache::GetTotalBytes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_totalBytes;
+    }
+
+    size_t ConversionCache::GetEntryCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lru.size();
+    }
+
+    uint64_t ConversionCache::GetHitCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hits;
+    }
+
+    uint64_t ConversionCache::GetMissCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_misses;
+    }
+}
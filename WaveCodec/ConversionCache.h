@@ -0,0 +1,119 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef CONVERSION_CACHE_H_
+#define CONVERSION_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace WaveCodec {
+
+    // ContentHasher: 流式计算 64 位内容哈希(XXH64 算法)
+    // 数据按 32 字节分为 4 路独立累加，各路之间没有依赖，乘法和移位可以并行执行
+    class ContentHasher {
+    public:
+        explicit ContentHasher(uint64_t seed = 0) { Reset(seed); }
+
+        void Reset(uint64_t seed = 0);
+        void Update(const void* data, size_t len);
+
+        // Digest: 当前已输入数据的哈希值，不影响之后继续 Update
+        uint64_t Digest() const;
+
+    private:
+        uint64_t m_seed = 0;
+        uint64_t m_acc[4];
+        uint8_t  m_buffer[32];   // 不足 32 字节的剩余数据
+        uint32_t m_buffered = 0;
+        uint64_t m_total = 0;
+    };
+
+    // ContentHash64: 计算一块内存的哈希值，与 ContentHasher 分多次 Update 的结果相同
+    uint64_t ContentHash64(const void* data, size_t len, uint64_t seed = 0);
+
+    // HashFileRange: 计算文件中 [offset, offset+length) 的哈希值，文件提前结束时只计算实际存在的部分
+    // * fd      : AsyncIO::OpenFileForRead 打开的文件
+    // * hash    : 输出哈希值
+    // * 返回值   : 实际计算的字节数，出错返回 -1
+    int64_t HashFileRange(int fd, uint64_t offset, uint64_t length, uint64_t& hash);
+
+    // HashWaveContent: 计算 Wave 文件 fmt 块和 data 块内容的哈希值，文件名和 LIST 等元数据块不影响结果
+    // * hash   : 输出哈希值
+    // * size   : 参与计算的字节数
+    bool HashWaveContent(const std::string& waveFilePath, uint64_t& hash, uint64_t& size);
+
+    /*example code
+
+        ConversionCache cache("/var/cache/audio", 1024ULL << 20);
+        std::string key = ConversionCache::MakeKey(hash, size, "requantize:16:2");
+        if(!cache.Lookup(key, dstPath)){
+            Convert(srcPath, dstPath);
+            cache.Store(key, dstPath);
+        }
+    */
+
+    // ConversionCache: 按内容寻址的转换结果缓存，保存在本地目录中，总大小超过上限时淘汰最久未使用的结果
+    // 键由输入内容的哈希、长度和转换参数组成，同一份音频换了文件名也能命中
+    // 启动时扫描缓存目录，按文件修改时间恢复使用顺序，命中时更新修改时间，因此使用顺序在进程之间保留；
+    // 同时删除崩溃的进程留下的、一小时以上没有修改的临时文件
+    // 可以在多个线程中同时使用
+    class ConversionCache {
+    public:
+        // * cacheDir : 缓存目录，不存在时创建(只创建最后一级)
+        // * maxBytes : 缓存总大小上限
+        ConversionCache(const std::string& cacheDir, uint64_t maxBytes);
+
+        bool IsValid() const { return m_valid; }
+
+        // MakeKey: 生成缓存键
+        // * contentHash : 输入内容的哈希值
+        // * contentSize : 输入内容的长度
+        // * params      : 转换类型和参数，如 "pcm2wave:8000:16:1"
+        static std::string MakeKey(uint64_t contentHash, uint64_t contentSize, const std::string& params);
+
+        // Lookup: 查找缓存，命中时将结果复制到 dstPath(同一文件系统上可能只复制元数据)
+        // * 返回值 : 是否命中并复制成功
+        bool Lookup(const std::string& key, const std::string& dstPath);
+
+        // Store: 将转换结果 srcPath 复制到缓存中，超过上限时淘汰旧的结果
+        // 先写入临时文件(文件名包含进程号和序号)再改名，其它线程和进程不会读到不完整的结果
+        bool Store(const std::string& key, const std::string& srcPath);
+
+        uint64_t GetTotalBytes() const;
+        size_t GetEntryCount() const;
+        uint64_t GetHitCount() const;
+        uint64_t GetMissCount() const;
+
+    private:
+        ConversionCache(const ConversionCache&);
+        ConversionCache& operator=(const ConversionCache&);
+
+        struct Entry {
+            std::string key;
+            uint64_t size = 0;
+        };
+
+        std::string GetEntryPath(const std::string& key) const;
+        void Scan();
+        void EvictLocked();
+
+        std::string m_dir;
+        uint64_t m_maxBytes = 0;
+        bool m_valid = false;
+
+        mutable std::mutex m_mutex;
+        std::list<Entry> m_lru; // 最近使用的在前
+        std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+        uint64_t m_totalBytes = 0;
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+        uint64_t m_tmpSeq = 0;
+    };
+}
+
+#endif //CONVERSION_CACHE_H_
@@ -0,0 +1,223 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "FramePacketizer.h"
+
+#include <algorithm>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WaveCodec {
+
+    ///////////////////////////////////////////////////
+    // SharedAudioSource
+    SharedAudioSource::SharedAudioSource() {}
+
+    SharedAudioSource::~SharedAudioSource() {
+        Close();
+    }
+
+    bool SharedAudioSource::MapFile(const std::string& filePath, bool preload){
+        if (filePath.size() == 0) return false;
+        if (m_file) return false;
+
+#ifndef WIN32
+        if (!preload) {
+            int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                printf("open file failed\n");
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) {
+                close(fd);
+                return false;
+            }
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (p == MAP_FAILED) return false;
+#ifdef MADV_WILLNEED
+            madvise(p, (size_t)st.st_size, MADV_WILLNEED);
+#endif
+            m_file = (const uint8_t*)p;
+            m_fileSize = (size_t)st.st_size;
+            m_mapped = true;
+            return true;
+        }
+#endif
+
+        FILE* fp = fopen(filePath.c_str(), "rb");
+        if (!fp) {
+            printf("open file failed\n");
+            return false;
+        }
+        fseek(fp, 0L, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0L, SEEK_SET);
+        if (size > 0) {
+            m_buffer.resize(size);
+            if (fread(&m_buffer[0], sizeof(uint8_t), size, fp) != (size_t)size) {
+                m_buffer.clear();
+            }
+        }
+        fclose(fp);
+        if (m_buffer.empty()) return false;
+
+        m_file = &m_buffer[0];
+        m_fileSize = m_buffer.size();
+        return true;
+    }
+
+    bool SharedAudioSource::SetFormat(uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels, uint64_t dataOffset, uint64_t dataSize){
+        if (audio_format != WaveAudioFormatPCM && audio_format != WaveAudioFormatALaw && audio_format != WaveAudioFormatMuLaw) {
+            printf("unsupported audio format: %d(%s)\n", audio_format, GetWaveAudioFormatString(audio_format).c_str());
+            return false;
+        }
+        uint16_t blockAlign = (uint16_t)(channels * sample_bits / 8);
+        if (sample_rate == 0 || blockAlign == 0 || dataOffset > m_fileSize) return false;
+
+        // 以文件实际大小为准，并去掉末尾不完整的采样
+        dataSize = std::min<uint64_t>(dataSize, m_fileSize - dataOffset);
+        dataSize -= dataSize % blockAlign;
+        if (dataSize == 0 || dataSize > UINT32_MAX) return false;
+
+        m_audioFormat = audio_format;
+        m_sampleRate = sample_rate;
+        m_sampleBits = sample_bits;
+        m_channels = channels;
+        m_blockAlign = blockAlign;
+        m_data = m_file + dataOffset;
+        m_dataSize = (uint32_t)dataSize;
+
+        // 衔接区：数据末尾 kMaxFrameMs 的数据 + 数据开头 kMaxFrameMs 的数据
+        // 跨越末尾的帧从这里取，保证帧数据连续且不需要按流复制
+        uint64_t maxFrameSize = (uint64_t)sample_rate * kMaxFrameMs / 1000 * blockAlign;
+        uint32_t seamPart = (uint32_t)std::min<uint64_t>(maxFrameSize, m_dataSize);
+        m_seam.resize((size_t)seamPart * 2);
+        memcpy(&m_seam[0], m_data + m_dataSize - seamPart, seamPart);
+        memcpy(&m_seam[seamPart], m_data, seamPart);
+        m_seamTail = seamPart;
+        return true;
+    }
+
+    bool SharedAudioSource::OpenWave(const std::string& waveFilePath, bool preload){
+        if (!MapFile(waveFilePath, preload)) return false;
+
+        WaveHeader header;
+        uint32_t dataOffset = 0;
+        if (!ParseWaveHeader(m_file, m_fileSize, header, dataOffset)) {
+            printf("invalid wave file, %s\n", waveFilePath.c_str());
+            Close();
+            return false;
+        }
+
+        const SubChunkFmt& fmt = header.riff.fmt;
+        if (!SetFormat(fmt.audio_format, fmt.sample_rate, fmt.bits_per_sample, fmt.channels, dataOffset, header.riff.data.header.size)) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool SharedAudioSource::OpenPCM(const std::string& pcmFilePath, uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels, bool preload){
+        if (!MapFile(pcmFilePath, preload)) return false;
+
+        if (!SetFormat(audio_format, sample_rate, sample_bits, channels, 0, m_fileSize)) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    const uint8_t* SharedAudioSource::GetFrameView(uint32_t offset, uint32_t size) const {
+        if (!m_data || offset >= m_dataSize) return nullptr;
+        if ((uint64_t)offset + size <= m_dataSize) {
+            return m_data + offset;
+        }
+
+        // 跨越末尾，从衔接区中取
+        uint32_t seamBegin = m_dataSize - m_seamTail;
+        if (offset < seamBegin || size > m_seam.size() - (offset - seamBegin)) return nullptr;
+        return &m_seam[offset - seamBegin];
+    }
+
+    void SharedAudioSource::Close(){
+#ifndef WIN32
+        if (m_mapped && m_file) {
+            munmap((void*)m_file, m_fileSize);
+        }
+#endif
+        m_file = nullptr;
+        m_fileSize = 0;
+        m_mapped = false;
+        m_buffer.clear();
+        m_data = nullptr;
+        m_dataSize = 0;
+        m_seam.clear();
+        m_seamTail = 0;
+        m_audioFormat = WaveAudioFormatUnknown;
+        m_sampleRate = 0;
+        m_sampleBits = 0;
+        m_channels = 0;
+        m_blockAlign = 0;
+    }
+
+    ///////////////////////////////////////////////////
+    // FramePacketizer
+    FramePacketizer::FramePacketizer(const SharedAudioSource& source, uint32_t frameMs, uint32_t ssrc, uint32_t startFrame, bool loop)
+        : m_source(&source), m_loop(loop), m_ssrc(ssrc) {
+        if (frameMs == 0 || frameMs > SharedAudioSource::kMaxFrameMs || source.GetDataSize() == 0) return;
+
+        // 按采样数计算帧长，避免 bytesPerMs 取整带来的误差
+        uint64_t samples = (uint64_t)source.GetSampleRate() * frameMs / 1000;
+        uint64_t frameSize = samples * source.GetBlockAlign();
+        if (samples == 0 || frameSize > source.GetDataSize()) return;
+
+        m_samplesPerFrame = (uint32_t)samples;
+        m_frameSize = (uint32_t)frameSize;
+        m_offset = (uint32_t)(((uint64_t)startFrame * m_frameSize) % source.GetDataSize());
+
+        if (source.GetAudioFormat() == WaveAudioFormatMuLaw) m_payloadType = 0;
+        else if (source.GetAudioFormat() == WaveAudioFormatALaw) m_payloadType = 8;
+        else m_payloadType = 96;
+    }
+
+    void FramePacketizer::SetRTPState(uint16_t sequence, uint32_t timestamp, uint8_t payloadType){
+        m_sequence = sequence;
+        m_timestamp = timestamp;
+        m_payloadType = payloadType;
+    }
+
+    bool FramePacketizer::NextFrame(MediaFrame& frame){
+        if (!IsValid() || m_eof) return false;
+
+        uint32_t dataSize = m_source->GetDataSize();
+        uint32_t size = m_frameSize;
+        if (!m_loop && m_offset + size >= dataSize) {
+            size = dataSize - m_offset; // 最后一帧
+            m_eof = true;
+        }
+
+        frame.data = m_source->GetFrameView(m_offset, size);
+        frame.size = size;
+        frame.sequence = m_sequence;
+        frame.timestamp = m_timestamp;
+        frame.ssrc = m_ssrc;
+        frame.payloadType = m_payloadType;
+        frame.marker = (m_frameIndex == 0);
+        frame.frameIndex = m_frameIndex;
+
+        m_offset += size;
+        if (m_offset >= dataSize) m_offset -= dataSize;
+        m_sequence++;
+        m_timestamp += m_samplesPerFrame;
+        m_frameIndex++;
+        return frame.data != nullptr;
+    }
+}
@@ -0,0 +1,141 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef FRAME_PACKETIZER_H_
+#define FRAME_PACKETIZER_H_
+
+#include "WaveFile.h"
+
+namespace WaveCodec {
+
+    // SharedAudioSource: 多路流共享的一份只读音频数据，来自 mmap 或预加载到内存的 Wave/PCM 文件
+    // 所有 FramePacketizer 都只引用其中的数据，SharedAudioSource 必须比它们活得更久
+    class SharedAudioSource {
+    public:
+        // 帧时长上限，用于预留首尾衔接区
+        static const uint32_t kMaxFrameMs = 60;
+
+        SharedAudioSource();
+        ~SharedAudioSource();
+
+        // OpenWave: 打开 Wave 文件，音频格式从 header 中获取
+        // * waveFilePath : Wave 文件路径
+        // * preload      : true 时读入内存，false 时 mmap(不支持 mmap 的平台总是读入内存)
+        bool OpenWave(const std::string& waveFilePath, bool preload = false);
+
+        // OpenPCM: 打开没有文件头的 PCM/G.711 文件，需要指定音频参数
+        // * audio_format : WaveAudioFormatPCM/WaveAudioFormatALaw/WaveAudioFormatMuLaw
+        bool OpenPCM(const std::string& pcmFilePath, uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels, bool preload = false);
+
+        void Close();
+
+        const uint8_t* GetData() const { return m_data; }
+        uint32_t GetDataSize() const { return m_dataSize; }
+        uint16_t GetAudioFormat() const { return m_audioFormat; }
+        uint32_t GetSampleRate() const { return m_sampleRate; }
+        uint16_t GetSampleBits() const { return m_sampleBits; }
+        uint16_t GetChannels() const { return m_channels; }
+        uint16_t GetBlockAlign() const { return m_blockAlign; }
+
+        // GetFrameView: 获取 [offset, offset+size) 的连续数据，offset+size 超过数据末尾时从开头接续
+        // size 不能超过 kMaxFrameMs 的数据量和整个数据的长度
+        const uint8_t* GetFrameView(uint32_t offset, uint32_t size) const;
+
+    private:
+        SharedAudioSource(const SharedAudioSource&);
+        SharedAudioSource& operator=(const SharedAudioSource&);
+
+        bool MapFile(const std::string& filePath, bool preload);
+        bool SetFormat(uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels, uint64_t dataOffset, uint64_t dataSize);
+
+        const uint8_t* m_file = nullptr;   // 整个文件的内容
+        size_t m_fileSize = 0;
+        bool m_mapped = false;
+        std::vector<uint8_t> m_buffer;     // 预加载时的文件内容
+
+        const uint8_t* m_data = nullptr;   // 音频数据
+        uint32_t m_dataSize = 0;
+        std::vector<uint8_t> m_seam;       // 数据末尾 + 数据开头，用于跨越末尾的帧
+        uint32_t m_seamTail = 0;           // m_seam 中末尾部分的长度
+
+        uint16_t m_audioFormat = WaveAudioFormatUnknown;
+        uint32_t m_sampleRate = 0;
+        uint16_t m_sampleBits = 0;
+        uint16_t m_channels = 0;
+        uint16_t m_blockAlign = 0;
+    };
+
+    // MediaFrame: 一帧音频的视图，不拥有数据，附带 RTP 风格的序号和时间戳
+    struct MediaFrame {
+        const uint8_t* data = nullptr; // 帧数据，指向 SharedAudioSource 中的数据
+        uint32_t size = 0;             // 帧长度(字节)
+        uint16_t sequence = 0;         // RTP 序号，每帧加 1，自然回绕
+        uint32_t timestamp = 0;        // RTP 时间戳，每帧增加帧内的采样数
+        uint32_t ssrc = 0;
+        uint8_t  payloadType = 0;      // PCMU 0, PCMA 8, 其它为动态类型
+        bool     marker = false;       // 第一帧为 true
+        uint64_t frameIndex = 0;       // 从 0 开始的帧计数
+    };
+
+    /*example code
+
+        SharedAudioSource source;
+        source.OpenWave("prompt_alaw.wav");
+
+        // 每路流一个 FramePacketizer，共享同一份音频数据
+        std::vector<FramePacketizer> streams;
+        for(uint32_t i = 0; i < 1000; i++){
+            streams.push_back(FramePacketizer(source, 20, i, i * 37)); // ssrc = i, 错开起始位置
+        }
+
+        MediaFrame frame;
+        for(size_t i = 0; i < streams.size(); i++){
+            streams[i].NextFrame(frame);
+            // send frame.data/frame.size with frame.sequence/frame.timestamp
+        }
+    */
+
+    // FramePacketizer: 将 SharedAudioSource 切成定长的帧(10/20/30ms 等)，首尾无缝循环
+    // 每路流只保存读取位置和 RTP 状态，可以廉价地创建成千上万个
+    class FramePacketizer {
+    public:
+        // * source          : 共享的音频数据
+        // * frameMs         : 帧时长，毫秒，不超过 SharedAudioSource::kMaxFrameMs
+        // * ssrc            : RTP SSRC
+        // * startFrame      : 起始帧位置，用于错开各路流
+        // * loop            : 是否循环，false 时到末尾后 NextFrame 返回 false
+        FramePacketizer(const SharedAudioSource& source, uint32_t frameMs, uint32_t ssrc, uint32_t startFrame = 0, bool loop = true);
+
+        // IsValid: 参数是否有效(帧时长、数据长度等)
+        bool IsValid() const { return m_frameSize > 0; }
+
+        // NextFrame: 获取下一帧
+        // 不循环时，最后一帧可能不足 frameMs
+        // * frame  : 帧的视图和 RTP 信息
+        // * 返回值  : 没有更多的帧时返回 false
+        bool NextFrame(MediaFrame& frame);
+
+        // SetRTPState: 设置初始的 RTP 序号、时间戳和 payload type
+        void SetRTPState(uint16_t sequence, uint32_t timestamp, uint8_t payloadType);
+
+        uint32_t GetFrameSize() const { return m_frameSize; }
+        uint32_t GetSamplesPerFrame() const { return m_samplesPerFrame; }
+
+    private:
+        const SharedAudioSource* m_source = nullptr;
+        uint32_t m_frameSize = 0;
+        uint32_t m_samplesPerFrame = 0;
+        uint32_t m_offset = 0;
+        bool     m_loop = true;
+        bool     m_eof = false;
+
+        uint32_t m_ssrc = 0;
+        uint16_t m_sequence = 0;
+        uint32_t m_timestamp = 0;
+        uint8_t  m_payloadType = 0;
+        uint64_t m_frameIndex = 0;
+    };
+}
+
+#endif //FRAME_PACKETIZER_H_
@@ -0,0 +1,1314 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "LosslessArchive.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+
+#include "WaveFile.h"
+#include "ByteSwap.h"
+#include "AsyncIO/ThreadPool.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace WaveCodec {
+
+    namespace {
+
+        const uint32_t kFileHeaderSize = 48;
+        const uint32_t kIndexEntrySize = 12;   // offset u64 + adler32 u32
+        const uint16_t kVersion = 1;
+        const uint32_t kMaxChannels = 8;
+        const uint32_t kMaxFixedOrder = 4;
+        const uint32_t kMaxLPCOrder = 12;
+        const uint32_t kMaxLPCPrecision = 15;
+        const uint32_t kMaxPartitionOrder = 8;
+        const uint32_t kMaxRiceParam = 30;
+        const double kPi = 3.14159265358979323846;
+
+        enum SubframeType {
+            SubframeConstant = 0,   // 所有采样相同
+            SubframeVerbatim = 1,   // 不压缩
+            SubframeFixed    = 2,   // 0~4 阶差分
+            SubframeLPC      = 3,   // 量化系数的 LPC
+        };
+
+        enum StereoMode {
+            StereoIndependent = 0,  // 左、右
+            StereoLeftSide    = 1,  // 左、左-右
+            StereoSideRight   = 2,  // 左-右、右
+            StereoMidSide     = 3,  // (左+右)>>1、左-右
+        };
+
+        inline uint32_t ZigZag(int32_t v){
+            return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+        }
+
+        inline int32_t UnZigZag(uint32_t u){
+            return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+        }
+
+        inline uint32_t CountLeadingZeros64(uint64_t v){
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanReverse64(&index, v);
+            return 63 - (uint32_t)index;
+#else
+            return (uint32_t)__builtin_clzll(v);
+#endif
+        }
+
+        inline uint64_t LoadBigEndian64(const uint8_t* p){
+            uint64_t v;
+            memcpy(&v, p, 8);
+            if (!IsLittleEndianHost()) return v;
+#if defined(_MSC_VER)
+            return _byteswap_uint64(v);
+#else
+            return __builtin_bswap64(v);
+#endif
+        }
+
+        // CeilLog2: 不小于 log2(v) 的最小整数
+        inline uint32_t CeilLog2(uint32_t v){
+            uint32_t n = 0;
+            while ((1u << n) < v) n++;
+            return n;
+        }
+
+        // 小端整数读写
+        inline void Put16(uint8_t* p, uint16_t v){ p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+        inline void Put32(uint8_t* p, uint32_t v){ for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (i * 8)); }
+        inline void Put64(uint8_t* p, uint64_t v){ for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (i * 8)); }
+        inline uint16_t Get16(const uint8_t* p){ return (uint16_t)(p[0] | (p[1] << 8)); }
+        inline uint32_t Get32(const uint8_t* p){ uint32_t v = 0; for (int i = 3; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+        inline uint64_t Get64(const uint8_t* p){ uint64_t v = 0; for (int i = 7; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+
+        // BitWriter: 高位在前的位流
+        class BitWriter {
+        public:
+            explicit BitWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+            // Put: 写入 v 的低 bits 位，bits 不超过 32
+            void Put(uint32_t v, uint32_t bits){
+                if (bits == 0) return;
+                m_acc = (m_acc << bits) | (bits == 32 ? v : (v & ((1u << bits) - 1)));
+                m_bits += bits;
+                while (m_bits >= 8) {
+                    m_bits -= 8;
+                    m_out.push_back((uint8_t)(m_acc >> m_bits));
+                }
+            }
+
+            // PutRice: q = u >> k 个 0 和一个 1，然后是 u 的低 k 位
+            void PutRice(uint32_t u, uint32_t k){
+                uint32_t q = u >> k;
+                while (q >= 31) {
+                    Put(0, 31);
+                    q -= 31;
+                }
+                Put(1, q + 1);
+                Put(u, k);
+            }
+
+            // Flush: 补齐到字节边界
+            void Flush(){
+                if (m_bits > 0) {
+                    m_out.push_back((uint8_t)(m_acc << (8 - m_bits)));
+                    m_bits = 0;
+                }
+            }
+
+        private:
+            std::vector<uint8_t>& m_out;
+            uint64_t m_acc = 0;
+            uint32_t m_bits = 0;
+        };
+
+        // BitReader: 64 位缓存，cache 的高 m_bits 位有效，其余位为 0；读过数据末尾时补 0 并记录
+        class BitReader {
+        public:
+            BitReader(const uint8_t* data, size_t size) : m_p(data), m_end(data + size) {
+                Refill();
+            }
+
+            void Refill(){
+                if (m_end - m_p >= 8) {
+                    uint32_t bytes = (64 - m_bits) >> 3;
+                    m_cache |= LoadBigEndian64(m_p) >> m_bits;
+                    m_p += bytes;
+                    m_bits += bytes * 8;
+                    if (m_bits < 64) m_cache &= ~(~0ULL >> m_bits);
+                } else {
+                    while (m_bits <= 56) {
+                        uint64_t b = 0;
+                        if (m_p < m_end) b = *m_p++;
+                        else m_pad++;
+                        m_cache |= b << (56 - m_bits);
+                        m_bits += 8;
+                    }
+                }
+            }
+
+            // Get: 读取 bits 位，bits 不超过 32
+            uint32_t Get(uint32_t bits){
+                if (bits == 0) return 0;
+                if (m_bits < bits) Refill();
+                uint32_t v = (uint32_t)(m_cache >> (64 - bits));
+                m_cache <<= bits;
+                m_bits -= bits;
+                return v;
+            }
+
+            int32_t GetSigned(uint32_t bits){
+                if (bits == 0) return 0;
+                uint32_t shift = 32 - bits;
+                return (int32_t)(Get(bits) << shift) >> shift;
+            }
+
+            // GetRiceBlock: 读取 count 个参数为 k 的 Rice 码，状态放在局部变量中，避免每次写 out 后重新加载
+            bool GetRiceBlock(uint32_t k, int32_t* out, uint32_t count){
+                uint64_t cache = m_cache;
+                uint32_t bits = m_bits;
+                const uint32_t maxQ = 0xFFFFFFFFu >> k;
+                for (uint32_t i = 0; i < count; i++) {
+                    if (bits < 32) {
+                        m_cache = cache;
+                        m_bits = bits;
+                        Refill();
+                        cache = m_cache;
+                        bits = m_bits;
+                    }
+                    if (cache == 0) {
+                        // 一元码超过了缓存中的有效位，很少出现
+                        m_cache = cache;
+                        m_bits = bits;
+                        if (!GetRice(k, out[i])) return false;
+                        cache = m_cache;
+                        bits = m_bits;
+                        continue;
+                    }
+                    uint32_t q = CountLeadingZeros64(cache);
+                    cache <<= q;
+                    cache <<= 1;
+                    bits -= q + 1;
+                    if (bits < k) {
+                        m_cache = cache;
+                        m_bits = bits;
+                        Refill();
+                        cache = m_cache;
+                        bits = m_bits;
+                    }
+                    uint32_t low = (uint32_t)((cache >> (63 - k)) >> 1);
+                    cache <<= k;
+                    bits -= k;
+                    if (q > maxQ) return false;
+                    out[i] = UnZigZag((q << k) | low);
+                }
+                m_cache = cache;
+                m_bits = bits;
+                return true;
+            }
+
+            bool GetRice(uint32_t k, int32_t& value){
+                if (m_bits < 32) Refill();
+                uint32_t q = 0;
+                while (m_cache == 0) {
+                    q += m_bits;
+                    m_bits = 0;
+                    Refill();
+                    if (m_pad > 8) return false;
+                }
+                uint32_t zeros = CountLeadingZeros64(m_cache);
+                q += zeros;
+                m_cache <<= zeros;
+                m_cache <<= 1;
+                m_bits -= zeros + 1;
+                if (q > (0xFFFFFFFFu >> k)) return false;
+                value = UnZigZag((q << k) | Get(k));
+                return true;
+            }
+
+            // Overrun: 是否读过了数据末尾
+            bool Overrun() const {
+                return (int64_t)(m_end - m_p) * 8 + m_bits < (int64_t)m_pad * 8;
+            }
+
+        private:
+            const uint8_t* m_p;
+            const uint8_t* m_end;
+            uint64_t m_cache = 0;
+            uint32_t m_bits = 0;
+            uint32_t m_pad = 0;
+        };
+
+        ///////////////////////////////////////////////////
+        // 编码
+
+        // RiceParam: 使 count 个 Rice 码的总长度最短的参数的估计
+        inline uint32_t RiceParam(uint64_t sum, uint32_t count){
+            uint32_t k = 0;
+            while (k < kMaxRiceParam && ((uint64_t)count << (k + 1)) < sum) k++;
+            return k;
+        }
+
+        inline uint64_t RiceBits(uint64_t sum, uint32_t count, uint32_t k){
+            return (uint64_t)count * (k + 1) + (sum >> k);
+        }
+
+        // RicePartition: 残差的分区方式，每个分区一个 Rice 参数
+        struct RicePartition {
+            uint32_t order = 0;
+            uint32_t params[1 << kMaxPartitionOrder];
+            uint64_t bits = 0;
+        };
+
+        // ChooseRicePartition: 在所有分区阶数中选择码长最短的
+        // * u         : zigzag 之后的残差，前 predOrder 个不使用
+        void ChooseRicePartition(const uint32_t* u, uint32_t n, uint32_t predOrder, RicePartition& best){
+            uint32_t maxOrder = 0;
+            while (maxOrder < kMaxPartitionOrder && n % (2u << maxOrder) == 0 && (n >> (maxOrder + 1)) > predOrder) maxOrder++;
+
+            uint64_t sums[1 << kMaxPartitionOrder];
+            uint32_t parts = 1u << maxOrder;
+            uint32_t size = n >> maxOrder;
+            for (uint32_t p = 0, i = predOrder; p < parts; p++) {
+                uint64_t sum = 0;
+                for (uint32_t end = (p + 1) * size; i < end; i++) sum += u[i];
+                sums[p] = sum;
+            }
+
+            best.bits = ~0ULL;
+            for (int order = (int)maxOrder; order >= 0; order--) {
+                uint32_t partCnt = 1u << order;
+                uint32_t partSize = n >> order;
+                uint64_t bits = 4;
+                uint32_t params[1 << kMaxPartitionOrder];
+                for (uint32_t p = 0; p < partCnt; p++) {
+                    uint32_t count = partSize - (p == 0 ? predOrder : 0);
+                    params[p] = RiceParam(sums[p], count);
+                    bits += 5 + RiceBits(sums[p], count, params[p]);
+                }
+                if (bits < best.bits) {
+                    best.bits = bits;
+                    best.order = (uint32_t)order;
+                    memcpy(best.params, params, partCnt * sizeof(uint32_t));
+                }
+                for (uint32_t p = 0; p < partCnt / 2; p++) sums[p] = sums[2 * p] + sums[2 * p + 1];
+            }
+        }
+
+        void WriteResidual(BitWriter& bw, const uint32_t* u, uint32_t n, uint32_t predOrder, const RicePartition& partition){
+            bw.Put(partition.order, 4);
+            uint32_t partSize = n >> partition.order;
+            for (uint32_t p = 0, i = predOrder; p < (1u << partition.order); p++) {
+                uint32_t k = partition.params[p];
+                bw.Put(k, 5);
+                for (uint32_t end = (p + 1) * partSize; i < end; i++) bw.PutRice(u[i], k);
+            }
+        }
+
+        // FixedResidual: order 阶差分的残差
+        void FixedResidual(const int32_t* x, uint32_t n, uint32_t order, int32_t* res){
+            for (uint32_t i = order; i < n; i++) {
+                switch (order) {
+                    case 0: res[i] = x[i]; break;
+                    case 1: res[i] = x[i] - x[i - 1]; break;
+                    case 2: res[i] = x[i] - 2 * x[i - 1] + x[i - 2]; break;
+                    case 3: res[i] = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3]; break;
+                    default: res[i] = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4]; break;
+                }
+            }
+        }
+
+        // EstimateFixed: 一次遍历估计 0~4 阶差分的码长，返回最好的阶数
+        uint32_t EstimateFixed(const int32_t* x, uint32_t n, uint64_t& bits){
+            if (n <= kMaxFixedOrder + 1) {
+                bits = (uint64_t)n * 32;
+                return 0;
+            }
+            uint64_t sums[kMaxFixedOrder + 1] = {0};
+            int32_t last0 = x[3];
+            int32_t last1 = x[3] - x[2];
+            int32_t last2 = last1 - (x[2] - x[1]);
+            int32_t last3 = last2 - ((x[2] - x[1]) - (x[1] - x[0]));
+            for (uint32_t i = 4; i < n; i++) {
+                int32_t e0 = x[i];
+                int32_t e1 = e0 - last0;
+                int32_t e2 = e1 - last1;
+                int32_t e3 = e2 - last2;
+                int32_t e4 = e3 - last3;
+                sums[0] += (uint32_t)std::abs(e0);
+                sums[1] += (uint32_t)std::abs(e1);
+                sums[2] += (uint32_t)std::abs(e2);
+                sums[3] += (uint32_t)std::abs(e3);
+                sums[4] += (uint32_t)std::abs(e4);
+                last0 = e0; last1 = e1; last2 = e2; last3 = e3;
+            }
+            uint32_t best = 0;
+            bits = ~0ULL;
+            uint32_t count = n - 4;
+            for (uint32_t order = 0; order <= kMaxFixedOrder; order++) {
+                uint64_t sum = sums[order] * 2; // zigzag 约为绝对值的 2 倍
+                uint64_t b = RiceBits(sum, count, RiceParam(sum, count));
+                if (b < bits) {
+                    bits = b;
+                    best = order;
+                }
+            }
+            return best;
+        }
+
+        // ComputeLPC: 加窗自相关 + Levinson-Durbin，得到 1~maxOrder 阶的预测系数和预测误差
+        // 预测值为 sum(lpc[order - 1][j] * x[i - 1 - j])
+        uint32_t ComputeLPC(const int32_t* x, uint32_t n, uint32_t maxOrder, std::vector<double>& windowed,
+                            double lpc[kMaxLPCOrder][kMaxLPCOrder], double error[kMaxLPCOrder]){
+            // Tukey(0.5) 窗
+            windowed.resize(n);
+            uint32_t taper = n / 4;
+            for (uint32_t i = 0; i < n; i++) {
+                double w = 1.0;
+                if (i < taper) w = 0.5 - 0.5 * cos(kPi * i / taper);
+                else if (i >= n - taper) w = 0.5 - 0.5 * cos(kPi * (n - 1 - i) / taper);
+                windowed[i] = x[i] * w;
+            }
+
+            double autoc[kMaxLPCOrder + 1];
+            for (uint32_t lag = 0; lag <= maxOrder; lag++) {
+                double sum = 0;
+                for (uint32_t i = lag; i < n; i++) sum += windowed[i] * windowed[i - lag];
+                autoc[lag] = sum;
+            }
+            if (autoc[0] <= 0) return 0;
+
+            double a[kMaxLPCOrder] = {0};
+            double err = autoc[0];
+            for (uint32_t i = 0; i < maxOrder; i++) {
+                double r = -autoc[i + 1];
+                for (uint32_t j = 0; j < i; j++) r -= a[j] * autoc[i - j];
+                r /= err;
+
+                a[i] = r;
+                uint32_t j = 0;
+                for (; j < (i >> 1); j++) {
+                    double tmp = a[j];
+                    a[j] += r * a[i - 1 - j];
+                    a[i - 1 - j] += r * tmp;
+                }
+                if (i & 1) a[j] += a[j] * r;
+
+                err *= (1.0 - r * r);
+                for (j = 0; j <= i; j++) lpc[i][j] = -a[j];
+                error[i] = err;
+                if (err <= 0) return i + 1;
+            }
+            return maxOrder;
+        }
+
+        // QuantizeLPC: 系数量化为 precision 位有符号整数，预测值右移 shift 位，量化误差向后传递
+        bool QuantizeLPC(const double* lpc, uint32_t order, uint32_t precision, int32_t* qlp, uint32_t& shift){
+            double cmax = 0;
+            for (uint32_t i = 0; i < order; i++) cmax = std::max(cmax, std::fabs(lpc[i]));
+            if (cmax <= 0) return false;
+
+            int exponent = 0;
+            frexp(cmax, &exponent);
+            int s = (int)precision - 1 - exponent;
+            if (s < 0) return false;
+            shift = (uint32_t)std::min(s, 31);
+
+            const int32_t qmax = (1 << (precision - 1)) - 1;
+            const int32_t qmin = -qmax - 1;
+            double error = 0;
+            for (uint32_t i = 0; i < order; i++) {
+                error += ldexp(lpc[i], (int)shift);
+                long q = lround(error);
+                q = std::max<long>(qmin, std::min<long>(qmax, q));
+                error -= q;
+                qlp[i] = (int32_t)q;
+            }
+            return true;
+        }
+
+        // LPCResidual: 残差超出 ±2^30 时返回 false
+        bool LPCResidual(const int32_t* x, uint32_t n, const int32_t* qlp, uint32_t order, uint32_t shift, int32_t* res){
+            for (uint32_t i = order; i < n; i++) {
+                int64_t sum = 0;
+                for (uint32_t j = 0; j < order; j++) sum += (int64_t)qlp[j] * x[i - 1 - j];
+                int64_t r = x[i] - (sum >> shift);
+                if (r >= (1 << 30) || r < -(1 << 30)) return false;
+                res[i] = (int32_t)r;
+            }
+            return true;
+        }
+
+        // EncodeScratch: 编码一个声道用到的临时缓冲区
+        struct EncodeScratch {
+            std::vector<int32_t> res;
+            std::vector<uint32_t> fixedU;
+            std::vector<uint32_t> lpcU;
+            std::vector<double> windowed;
+        };
+
+        // EncodeSubframe: 选择码长最短的方式编码一个声道
+        void EncodeSubframe(BitWriter& bw, const int32_t* x, uint32_t n, uint32_t bps, EncodeScratch& scratch){
+            bool constant = true;
+            for (uint32_t i = 1; i < n && constant; i++) constant = (x[i] == x[0]);
+            if (constant) {
+                bw.Put(SubframeConstant, 2);
+                bw.Put((uint32_t)x[0], bps);
+                return;
+            }
+
+            uint64_t bestBits = 2 + (uint64_t)n * bps;
+            SubframeType bestType = SubframeVerbatim;
+            scratch.res.resize(n);
+            scratch.fixedU.resize(n);
+            scratch.lpcU.resize(n);
+
+            // 定阶预测
+            uint64_t estimate = 0;
+            uint32_t fixedOrder = EstimateFixed(x, n, estimate);
+            RicePartition fixedPartition;
+            if (n > fixedOrder) {
+                FixedResidual(x, n, fixedOrder, scratch.res.data());
+                for (uint32_t i = fixedOrder; i < n; i++) scratch.fixedU[i] = ZigZag(scratch.res[i]);
+                ChooseRicePartition(scratch.fixedU.data(), n, fixedOrder, fixedPartition);
+                uint64_t bits = 2 + 3 + (uint64_t)fixedOrder * bps + fixedPartition.bits;
+                if (bits < bestBits) {
+                    bestBits = bits;
+                    bestType = SubframeFixed;
+                }
+            }
+
+            // LPC: 按预测误差估计每个阶数的码长，选最好的一个
+            uint32_t maxOrder = std::min(kMaxLPCOrder, n > 32 ? n / 4 : 0);
+            double lpc[kMaxLPCOrder][kMaxLPCOrder];
+            double error[kMaxLPCOrder];
+            maxOrder = maxOrder > 0 ? ComputeLPC(x, n, maxOrder, scratch.windowed, lpc, error) : 0;
+            uint32_t lpcOrder = 0;
+            double lpcEstimate = 1e300;
+            for (uint32_t order = 1; order <= maxOrder; order++) {
+                double e = error[order - 1] * 0.5 / n;
+                double bitsPerSample = e > 1 ? 0.5 * log2(e) : 0;
+                double total = bitsPerSample * (n - order) + order * (kMaxLPCPrecision + bps);
+                if (total < lpcEstimate) {
+                    lpcEstimate = total;
+                    lpcOrder = order;
+                }
+            }
+
+            int32_t qlp[kMaxLPCOrder];
+            uint32_t precision = 0, shift = 0;
+            RicePartition lpcPartition;
+            if (lpcOrder > 0) {
+                // 系数位数使预测值的累加不超过 32 位，解码时可以用 32 位整数计算
+                int p = 32 - (int)bps - (int)CeilLog2(lpcOrder);
+                precision = (uint32_t)std::max(5, std::min((int)kMaxLPCPrecision, p));
+                if (QuantizeLPC(lpc[lpcOrder - 1], lpcOrder, precision, qlp, shift) &&
+                    LPCResidual(x, n, qlp, lpcOrder, shift, scratch.res.data())) {
+                    for (uint32_t i = lpcOrder; i < n; i++) scratch.lpcU[i] = ZigZag(scratch.res[i]);
+                    ChooseRicePartition(scratch.lpcU.data(), n, lpcOrder, lpcPartition);
+                    uint64_t bits = 2 + 4 + 4 + 5 + (uint64_t)lpcOrder * (precision + bps) + lpcPartition.bits;
+                    if (bits < bestBits) {
+                        bestBits = bits;
+                        bestType = SubframeLPC;
+                    }
+                }
+            }
+
+            bw.Put(bestType, 2);
+            if (bestType == SubframeVerbatim) {
+                for (uint32_t i = 0; i < n; i++) bw.Put((uint32_t)x[i], bps);
+            } else if (bestType == SubframeFixed) {
+                bw.Put(fixedOrder, 3);
+                for (uint32_t i = 0; i < fixedOrder; i++) bw.Put((uint32_t)x[i], bps);
+                WriteResidual(bw, scratch.fixedU.data(), n, fixedOrder, fixedPartition);
+            } else {
+                bw.Put(lpcOrder - 1, 4);
+                bw.Put(precision - 1, 4);
+                bw.Put(shift, 5);
+                for (uint32_t i = 0; i < lpcOrder; i++) bw.Put((uint32_t)qlp[i], precision);
+                for (uint32_t i = 0; i < lpcOrder; i++) bw.Put((uint32_t)x[i], bps);
+                WriteResidual(bw, scratch.lpcU.data(), n, lpcOrder, lpcPartition);
+            }
+        }
+
+        ///////////////////////////////////////////////////
+        // 解码
+
+        bool DecodeResidual(BitReader& br, int32_t* x, uint32_t n, uint32_t predOrder){
+            uint32_t order = br.Get(4);
+            if (order > kMaxPartitionOrder || n % (1u << order) != 0 || (n >> order) < predOrder) return false;
+            uint32_t partSize = n >> order;
+            for (uint32_t p = 0, i = predOrder; p < (1u << order); p++) {
+                uint32_t k = br.Get(5);
+                uint32_t end = (p + 1) * partSize;
+                if (k > kMaxRiceParam || !br.GetRiceBlock(k, x + i, end - i)) return false;
+                i = end;
+            }
+            return true;
+        }
+
+        // RestoreFixed: x 中 order 之后为残差，原地还原为采样，按无符号运算避免损坏数据导致有符号溢出
+        void RestoreFixed(int32_t* x, uint32_t n, uint32_t order){
+            uint32_t* u = (uint32_t*)x;
+            switch (order) {
+                case 1: for (uint32_t i = 1; i < n; i++) u[i] += u[i - 1]; break;
+                case 2: for (uint32_t i = 2; i < n; i++) u[i] += 2 * u[i - 1] - u[i - 2]; break;
+                case 3: for (uint32_t i = 3; i < n; i++) u[i] += 3 * u[i - 1] - 3 * u[i - 2] + u[i - 3]; break;
+                case 4: for (uint32_t i = 4; i < n; i++) u[i] += 4 * u[i - 1] - 6 * u[i - 2] + 4 * u[i - 3] - u[i - 4]; break;
+                default: break;
+            }
+        }
+
+        // LPCSum: c[0] * u[-1] + ... + c[J-1] * u[-J]，用模板递归展开，-O2 下编译器不会展开阶数循环
+        template<uint32_t J>
+        struct LPCSum {
+            static inline uint32_t Run(const uint32_t* c, const uint32_t* u){
+                return c[J - 1] * u[-(int32_t)J] + LPCSum<J - 1>::Run(c, u);
+            }
+        };
+
+        template<>
+        struct LPCSum<0> {
+            static inline uint32_t Run(const uint32_t*, const uint32_t*){ return 0; }
+        };
+
+        // RestoreLPC32: 预测值的累加不会超过 32 位时使用
+        template<uint32_t ORDER>
+        void RestoreLPC32Fixed(int32_t* x, uint32_t n, const int32_t* qlp, uint32_t shift){
+            uint32_t* u = (uint32_t*)x;
+            uint32_t c[ORDER];
+            for (uint32_t j = 0; j < ORDER; j++) c[j] = (uint32_t)qlp[j];
+            for (uint32_t i = ORDER; i < n; i++) {
+                u[i] += (uint32_t)((int32_t)LPCSum<ORDER>::Run(c, u + i) >> shift);
+            }
+        }
+
+        // 每个阶数展开为一个函数，内层循环完全展开
+        void RestoreLPC32(int32_t* x, uint32_t n, const int32_t* qlp, uint32_t order, uint32_t shift){
+            switch (order) {
+                case 1:  RestoreLPC32Fixed<1>(x, n, qlp, shift); break;
+                case 2:  RestoreLPC32Fixed<2>(x, n, qlp, shift); break;
+                case 3:  RestoreLPC32Fixed<3>(x, n, qlp, shift); break;
+                case 4:  RestoreLPC32Fixed<4>(x, n, qlp, shift); break;
+                case 5:  RestoreLPC32Fixed<5>(x, n, qlp, shift); break;
+                case 6:  RestoreLPC32Fixed<6>(x, n, qlp, shift); break;
+                case 7:  RestoreLPC32Fixed<7>(x, n, qlp, shift); break;
+                case 8:  RestoreLPC32Fixed<8>(x, n, qlp, shift); break;
+                case 9:  RestoreLPC32Fixed<9>(x, n, qlp, shift); break;
+                case 10: RestoreLPC32Fixed<10>(x, n, qlp, shift); break;
+                case 11: RestoreLPC32Fixed<11>(x, n, qlp, shift); break;
+                default: RestoreLPC32Fixed<12>(x, n, qlp, shift); break;
+            }
+        }
+
+        void RestoreLPC64(int32_t* x, uint32_t n, const int32_t* qlp, uint32_t order, uint32_t shift){
+            for (uint32_t i = order; i < n; i++) {
+                int64_t sum = 0;
+                for (uint32_t j = 0; j < order; j++) sum += (int64_t)qlp[j] * x[i - 1 - j];
+                x[i] = (int32_t)((uint32_t)x[i] + (uint32_t)(sum >> shift));
+            }
+        }
+
+        bool DecodeSubframe(BitReader& br, int32_t* x, uint32_t n, uint32_t bps){
+            uint32_t type = br.Get(2);
+            if (type == SubframeConstant) {
+                int32_t v = br.GetSigned(bps);
+                for (uint32_t i = 0; i < n; i++) x[i] = v;
+                return true;
+            }
+            if (type == SubframeVerbatim) {
+                for (uint32_t i = 0; i < n; i++) x[i] = br.GetSigned(bps);
+                return true;
+            }
+            if (type == SubframeFixed) {
+                uint32_t order = br.Get(3);
+                if (order > kMaxFixedOrder || order > n) return false;
+                for (uint32_t i = 0; i < order; i++) x[i] = br.GetSigned(bps);
+                if (!DecodeResidual(br, x, n, order)) return false;
+                RestoreFixed(x, n, order);
+                return true;
+            }
+
+            uint32_t order = br.Get(4) + 1;
+            uint32_t precision = br.Get(4) + 1;
+            uint32_t shift = br.Get(5);
+            if (order > kMaxLPCOrder || order > n) return false;
+            int32_t qlp[kMaxLPCOrder];
+            for (uint32_t i = 0; i < order; i++) qlp[i] = br.GetSigned(precision);
+            for (uint32_t i = 0; i < order; i++) x[i] = br.GetSigned(bps);
+            if (!DecodeResidual(br, x, n, order)) return false;
+            if (bps + precision + CeilLog2(order) <= 32) RestoreLPC32(x, n, qlp, order, shift);
+            else RestoreLPC64(x, n, qlp, order, shift);
+            return true;
+        }
+
+        bool CheckInfo(const LosslessInfo& info){
+            if (info.sampleBits != 8 && info.sampleBits != 16 && info.sampleBits != 24) return false;
+            if (info.channels == 0 || info.channels > kMaxChannels) return false;
+            return info.blockFrames >= 16 && info.blockFrames <= (1u << 20);
+        }
+    }
+
+    uint32_t Adler32(const uint8_t* data, size_t size, uint32_t adler){
+        const uint32_t kBase = 65521;
+        const size_t kMaxRun = 5552; // 保证 b 不溢出的最大连续累加次数
+        uint32_t a = adler & 0xFFFF;
+        uint32_t b = adler >> 16;
+        while (size > 0) {
+            size_t n = std::min(size, kMaxRun);
+            size -= n;
+            for (size_t i = 0; i < n; i++) {
+                a += data[i];
+                b += a;
+            }
+            data += n;
+            a %= kBase;
+            b %= kBase;
+        }
+        return (b << 16) | a;
+    }
+
+    void LosslessEncodeBlock(const LosslessInfo& info, const uint8_t* pcm, uint32_t frames, std::vector<uint8_t>& out){
+        out.clear();
+        const uint32_t channels = info.channels;
+        const uint32_t bps = info.sampleBits;
+        const uint32_t sampleBytes = bps / 8;
+
+        // 解交错为 32bit 整数，8bit 是无符号数
+        std::vector<int32_t> samples((size_t)channels * frames);
+        for (uint32_t c = 0; c < channels; c++) {
+            int32_t* x = &samples[(size_t)c * frames];
+            const uint8_t* p = pcm + c * sampleBytes;
+            for (uint32_t i = 0; i < frames; i++, p += channels * sampleBytes) {
+                if (sampleBytes == 1) x[i] = (int32_t)p[0] - 128;
+                else if (sampleBytes == 2) x[i] = (int16_t)(p[0] | (p[1] << 8));
+                else x[i] = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+            }
+        }
+
+        BitWriter bw(out);
+        EncodeScratch scratch;
+
+        if (channels == 2 && frames > kMaxFixedOrder + 1) {
+            const int32_t* left = &samples[0];
+            const int32_t* right = &samples[frames];
+            std::vector<int32_t> mid(frames), side(frames);
+            for (uint32_t i = 0; i < frames; i++) {
+                side[i] = left[i] - right[i];
+                mid[i] = (left[i] + right[i]) >> 1;
+            }
+
+            uint64_t bitsL, bitsR, bitsM, bitsS;
+            EstimateFixed(left, frames, bitsL);
+            EstimateFixed(right, frames, bitsR);
+            EstimateFixed(mid.data(), frames, bitsM);
+            EstimateFixed(side.data(), frames, bitsS);
+
+            uint64_t costs[4] = {bitsL + bitsR, bitsL + bitsS, bitsS + bitsR, bitsM + bitsS};
+            uint32_t mode = (uint32_t)(std::min_element(costs, costs + 4) - costs);
+            bw.Put(mode, 8);
+            switch (mode) {
+                case StereoLeftSide:
+                    EncodeSubframe(bw, left, frames, bps, scratch);
+                    EncodeSubframe(bw, side.data(), frames, bps + 1, scratch);
+                    break;
+                case StereoSideRight:
+                    EncodeSubframe(bw, side.data(), frames, bps + 1, scratch);
+                    EncodeSubframe(bw, right, frames, bps, scratch);
+                    break;
+                case StereoMidSide:
+                    EncodeSubframe(bw, mid.data(), frames, bps, scratch);
+                    EncodeSubframe(bw, side.data(), frames, bps + 1, scratch);
+                    break;
+                default:
+                    EncodeSubframe(bw, left, frames, bps, scratch);
+                    EncodeSubframe(bw, right, frames, bps, scratch);
+                    break;
+            }
+        } else {
+            bw.Put(StereoIndependent, 8);
+            for (uint32_t c = 0; c < channels; c++) {
+                EncodeSubframe(bw, &samples[(size_t)c * frames], frames, bps, scratch);
+            }
+        }
+        bw.Flush();
+    }
+
+    bool LosslessDecodeBlock(const LosslessInfo& info, const uint8_t* data, size_t size, uint32_t frames, uint8_t* pcm){
+        if (!CheckInfo(info) || frames == 0 || frames > info.blockFrames) return false;
+        const uint32_t channels = info.channels;
+        const uint32_t bps = info.sampleBits;
+        const uint32_t sampleBytes = bps / 8;
+
+        BitReader br(data, size);
+        uint32_t mode = br.Get(8);
+        if (mode > StereoMidSide || (mode != StereoIndependent && channels != 2)) return false;
+
+        std::vector<int32_t> samples((size_t)channels * frames);
+        for (uint32_t c = 0; c < channels; c++) {
+            bool side = (mode == StereoLeftSide || mode == StereoMidSide) ? (c == 1) : (mode == StereoSideRight && c == 0);
+            if (!DecodeSubframe(br, &samples[(size_t)c * frames], frames, bps + (side ? 1 : 0))) return false;
+        }
+        if (br.Overrun()) return false;
+
+        if (mode != StereoIndependent) {
+            int32_t* a = &samples[0];
+            int32_t* b = &samples[frames];
+            for (uint32_t i = 0; i < frames; i++) {
+                int32_t l, r;
+                if (mode == StereoLeftSide) {
+                    l = a[i];
+                    r = a[i] - b[i];
+                } else if (mode == StereoSideRight) {
+                    l = a[i] + b[i];
+                    r = b[i];
+                } else {
+                    int32_t mid = (int32_t)(((uint32_t)a[i] << 1) | (uint32_t)(b[i] & 1));
+                    l = (mid + b[i]) >> 1;
+                    r = (mid - b[i]) >> 1;
+                }
+                a[i] = l;
+                b[i] = r;
+            }
+        }
+
+        for (uint32_t c = 0; c < channels; c++) {
+            const int32_t* x = &samples[(size_t)c * frames];
+            uint8_t* p = pcm + c * sampleBytes;
+            const uint32_t stride = channels * sampleBytes;
+            if (sampleBytes == 2) {
+                for (uint32_t i = 0; i < frames; i++, p += stride) {
+                    p[0] = (uint8_t)x[i];
+                    p[1] = (uint8_t)(x[i] >> 8);
+                }
+            } else if (sampleBytes == 1) {
+                for (uint32_t i = 0; i < frames; i++, p += stride) p[0] = (uint8_t)(x[i] + 128);
+            } else {
+                for (uint32_t i = 0; i < frames; i++, p += stride) {
+                    p[0] = (uint8_t)x[i];
+                    p[1] = (uint8_t)(x[i] >> 8);
+                    p[2] = (uint8_t)(x[i] >> 16);
+                }
+            }
+        }
+        return true;
+    }
+
+    ///////////////////////////////////////////////////
+    // LosslessFileWriter
+    LosslessFileWriter::LosslessFileWriter() {
+
+    }
+
+    LosslessFileWriter::~LosslessFileWriter() {
+        Close();
+    }
+
+    bool LosslessFileWriter::Open(const std::string& filePath, uint32_t sampleRate, uint16_t sampleBits, uint16_t channels,
+                                  uint32_t blockFrames, AsyncIO::ThreadPool* pool) {
+        Close();
+
+        LosslessInfo info;
+        info.sampleRate = sampleRate;
+        info.sampleBits = sampleBits;
+        info.channels = channels;
+        info.blockFrames = blockFrames;
+        if (!CheckInfo(info)) {
+            printf("LosslessFileWriter: unsupported format, sample bits:%d, channels:%d, block frames:%u\n", sampleBits, channels, blockFrames);
+            return false;
+        }
+
+        m_fp = fopen(filePath.c_str(), "wb");
+        if (!m_fp) {
+            printf("LosslessFileWriter: open %s failed\n", filePath.c_str());
+            return false;
+        }
+
+        // 文件头在 Close 时写入
+        uint8_t header[kFileHeaderSize] = {0};
+        fwrite(header, 1, kFileHeaderSize, m_fp);
+        m_offset = kFileHeaderSize;
+        m_info = info;
+        m_pool = pool;
+        return true;
+    }
+
+    void LosslessFileWriter::SetHeader(const uint8_t* data, size_t len) {
+        m_header.assign(data, data + len);
+    }
+
+    void LosslessFileWriter::SetTrailer(const uint8_t* data, size_t len) {
+        m_trailer.assign(data, data + len);
+    }
+
+    void LosslessFileWriter::Write(const uint8_t* data, uint32_t len) {
+        if (!m_fp || !data) return;
+
+        m_pending.insert(m_pending.end(), data, data + len);
+        size_t batchBlocks = m_pool ? m_pool->GetThreadCount() * 4 : 1;
+        if (m_pending.size() >= batchBlocks * m_info.blockFrames * m_info.GetFrameBytes()) {
+            EncodeBlocks(false);
+        }
+    }
+
+    void LosslessFileWriter::Write(const uint16_t* data, uint32_t len) {
+        Write((const uint8_t*)data, len * 2);
+    }
+
+    void LosslessFileWriter::Write(const std::vector<uint8_t>& data) {
+        if (data.size() == 0) return;
+        Write(&data[0], (uint32_t)data.size());
+    }
+
+    void LosslessFileWriter::Write(const std::vector<uint8_t>& data, size_t len) {
+        if (data.size() == 0) return;
+        Write(&data[0], (uint32_t)std::min(len, data.size()));
+    }
+
+    void LosslessFileWriter::Write(const std::vector<uint16_t>& data) {
+        if (data.size() == 0) return;
+        Write(&data[0], (uint32_t)data.size());
+    }
+
+    void LosslessFileWriter::Write(const std::vector<uint16_t>& data, size_t len) {
+        if (data.size() == 0) return;
+        Write(&data[0], (uint32_t)std::min(len, data.size()));
+    }
+
+    bool LosslessFileWriter::EncodeBlocks(bool final) {
+        const size_t frameBytes = m_info.GetFrameBytes();
+        const size_t blockBytes = (size_t)m_info.blockFrames * frameBytes;
+        size_t fullBlocks = m_pending.size() / blockBytes;
+        uint32_t lastFrames = final ? (uint32_t)((m_pending.size() - fullBlocks * blockBytes) / frameBytes) : 0;
+        size_t total = fullBlocks + (lastFrames > 0 ? 1 : 0);
+        if (total == 0) return true;
+
+        std::vector<std::vector<uint8_t> > outs(total);
+        std::vector<uint32_t> checksums(total);
+        std::vector<uint32_t> frames(total, m_info.blockFrames);
+        if (lastFrames > 0) frames[total - 1] = lastFrames;
+
+        const LosslessInfo& info = m_info;
+        const uint8_t* pending = m_pending.data();
+        auto encode = [&](size_t i){
+            const uint8_t* pcm = pending + i * blockBytes;
+            LosslessEncodeBlock(info, pcm, frames[i], outs[i]);
+            checksums[i] = Adler32(pcm, frames[i] * frameBytes);
+        };
+        if (m_pool && total > 1) {
+            for (size_t i = 0; i < total; i++) m_pool->Submit([&encode, i]{ encode(i); });
+            m_pool->Wait();
+        } else {
+            for (size_t i = 0; i < total; i++) encode(i);
+        }
+
+        bool ret = true;
+        for (size_t i = 0; i < total; i++) {
+            if (fwrite(outs[i].data(), 1, outs[i].size(), m_fp) != outs[i].size()) ret = false;
+            m_offsets.push_back(m_offset);
+            m_checksums.push_back(checksums[i]);
+            m_offset += outs[i].size();
+            m_info.blockCount++;
+            m_info.totalFrames += frames[i];
+        }
+        m_pending.erase(m_pending.begin(), m_pending.begin() + (fullBlocks * blockBytes + (size_t)lastFrames * frameBytes));
+        if (!ret) printf("LosslessFileWriter: write failed\n");
+        return ret;
+    }
+
+    void LosslessFileWriter::Close() {
+        if (!m_fp) return;
+
+        EncodeBlocks(true);
+
+        // 不足一帧的字节放在 trailer 前面
+        m_trailer.insert(m_trailer.begin(), m_pending.begin(), m_pending.end());
+        uint64_t metaOffset = m_offset;
+        if (!m_header.empty()) fwrite(m_header.data(), 1, m_header.size(), m_fp);
+        if (!m_trailer.empty()) fwrite(m_trailer.data(), 1, m_trailer.size(), m_fp);
+
+        std::vector<uint8_t> index((size_t)m_info.blockCount * kIndexEntrySize);
+        for (uint32_t i = 0; i < m_info.blockCount; i++) {
+            Put64(&index[(size_t)i * kIndexEntrySize], m_offsets[i]);
+            Put32(&index[(size_t)i * kIndexEntrySize + 8], m_checksums[i]);
+        }
+        if (!index.empty()) fwrite(index.data(), 1, index.size(), m_fp);
+
+        uint8_t header[kFileHeaderSize] = {0};
+        memcpy(header, "PLAC", 4);
+        Put16(header + 4, kVersion);
+        Put16(header + 6, m_info.channels);
+        Put32(header + 8, m_info.sampleRate);
+        Put16(header + 12, m_info.sampleBits);
+        Put32(header + 16, m_info.blockFrames);
+        Put32(header + 20, m_info.blockCount);
+        Put64(header + 24, m_info.totalFrames);
+        Put64(header + 32, metaOffset);
+        Put32(header + 40, (uint32_t)m_header.size());
+        Put32(header + 44, (uint32_t)m_trailer.size());
+        fseek(m_fp, 0, SEEK_SET);
+        fwrite(header, 1, kFileHeaderSize, m_fp);
+
+        fclose(m_fp);
+        m_fp = nullptr;
+        m_info = LosslessInfo();
+        m_pool = nullptr;
+        m_pending.clear();
+        m_header.clear();
+        m_trailer.clear();
+        m_offsets.clear();
+        m_checksums.clear();
+        m_offset = 0;
+    }
+
+    ///////////////////////////////////////////////////
+    // LosslessFileReader
+    LosslessFileReader::LosslessFileReader() {
+
+    }
+
+    LosslessFileReader::~LosslessFileReader() {
+        Close();
+    }
+
+    bool LosslessFileReader::Open(const std::string& filePath) {
+        Close();
+
+        m_fp = fopen(filePath.c_str(), "rb");
+        if (!m_fp) {
+            printf("LosslessFileReader: open %s failed\n", filePath.c_str());
+            return false;
+        }
+
+        uint8_t header[kFileHeaderSize];
+        if (fread(header, 1, kFileHeaderSize, m_fp) != kFileHeaderSize || memcmp(header, "PLAC", 4) != 0 || Get16(header + 4) != kVersion) {
+            printf("LosslessFileReader: %s is not a lossless archive\n", filePath.c_str());
+            Close();
+            return false;
+        }
+        m_info.channels = Get16(header + 6);
+        m_info.sampleRate = Get32(header + 8);
+        m_info.sampleBits = Get16(header + 12);
+        m_info.blockFrames = Get32(header + 16);
+        m_info.blockCount = Get32(header + 20);
+        m_info.totalFrames = Get64(header + 24);
+        uint64_t metaOffset = Get64(header + 32);
+        uint32_t headerSize = Get32(header + 40);
+        uint32_t trailerSize = Get32(header + 44);
+
+        fseek(m_fp, 0, SEEK_END);
+        uint64_t fileSize = (uint64_t)ftell(m_fp);
+        uint64_t indexSize = (uint64_t)m_info.blockCount * kIndexEntrySize;
+        bool valid = CheckInfo(m_info) &&
+                     m_info.blockCount == (m_info.totalFrames + m_info.blockFrames - 1) / m_info.blockFrames &&
+                     metaOffset >= kFileHeaderSize && metaOffset + headerSize + trailerSize + indexSize <= fileSize;
+        if (valid) {
+            m_header.resize(headerSize);
+            m_trailer.resize(trailerSize);
+            std::vector<uint8_t> index((size_t)indexSize);
+            fseek(m_fp, (long)metaOffset, SEEK_SET);
+            valid = fread(m_header.data(), 1, headerSize, m_fp) == headerSize &&
+                    fread(m_trailer.data(), 1, trailerSize, m_fp) == trailerSize &&
+                    fread(index.data(), 1, index.size(), m_fp) == index.size();
+
+            for (uint32_t i = 0; valid && i < m_info.blockCount; i++) {
+                uint64_t offset = Get64(&index[(size_t)i * kIndexEntrySize]);
+                valid = offset >= (m_offsets.empty() ? kFileHeaderSize : m_offsets.back()) && offset <= metaOffset;
+                m_offsets.push_back(offset);
+                m_checksums.push_back(Get32(&index[(size_t)i * kIndexEntrySize + 8]));
+            }
+            m_offsets.push_back(metaOffset);
+        }
+        if (!valid) {
+            printf("LosslessFileReader: %s is corrupted\n", filePath.c_str());
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t LosslessFileReader::GetBlockFrames(uint32_t index) const {
+        if (index >= m_info.blockCount) return 0;
+        if (index + 1 < m_info.blockCount) return m_info.blockFrames;
+        return (uint32_t)(m_info.totalFrames - (uint64_t)index * m_info.blockFrames);
+    }
+
+    bool LosslessFileReader::ReadBlock(uint32_t index, std::vector<uint8_t>& data, uint32_t& checksum) {
+        if (!m_fp || index >= m_info.blockCount) return false;
+        size_t size = (size_t)(m_offsets[index + 1] - m_offsets[index]);
+        data.resize(size);
+        fseek(m_fp, (long)m_offsets[index], SEEK_SET);
+        if (fread(data.data(), 1, size, m_fp) != size) return false;
+        checksum = m_checksums[index];
+        return true;
+    }
+
+    bool LosslessFileReader::LoadBlock(uint32_t index) {
+        uint32_t checksum = 0;
+        uint32_t frames = GetBlockFrames(index);
+        m_block.resize((size_t)frames * m_info.GetFrameBytes());
+        if (!ReadBlock(index, m_compressed, checksum) ||
+            !LosslessDecodeBlock(m_info, m_compressed.data(), m_compressed.size(), frames, m_block.data()) ||
+            Adler32(m_block.data(), m_block.size()) != checksum) {
+            printf("LosslessFileReader: block %u is corrupted\n", index);
+            m_error = true;
+            m_blockLoaded = false;
+            return false;
+        }
+        m_blockIndex = index;
+        m_blockLoaded = true;
+        m_blockPos = 0;
+        return true;
+    }
+
+    size_t LosslessFileReader::ReadBytes(uint32_t bytes2Read, uint8_t* bytes) {
+        if (!m_fp || !bytes || m_error) return 0;
+
+        size_t copied = 0;
+        while (copied < bytes2Read) {
+            if (!m_blockLoaded || m_blockPos >= m_block.size()) {
+                uint32_t next = m_blockLoaded ? m_blockIndex + 1 : m_blockIndex;
+                if (next >= m_info.blockCount || !LoadBlock(next)) break;
+            }
+            size_t n = std::min((size_t)bytes2Read - copied, m_block.size() - m_blockPos);
+            memcpy(bytes + copied, &m_block[m_blockPos], n);
+            m_blockPos += n;
+            copied += n;
+        }
+        return copied;
+    }
+
+    size_t LosslessFileReader::ReadBytes(uint32_t bytes2Read, std::vector<uint8_t>& bytes) {
+        bytes.resize(bytes2Read);
+        size_t n = bytes2Read > 0 ? ReadBytes(bytes2Read, &bytes[0]) : 0;
+        bytes.resize(n);
+        return n;
+    }
+
+    size_t LosslessFileReader::ReadShorts(uint32_t shorts2Read, uint16_t* shorts) {
+        return ReadBytes(shorts2Read * 2, (uint8_t*)shorts) / 2;
+    }
+
+    size_t LosslessFileReader::ReadShorts(uint32_t shorts2Read, std::vector<uint16_t>& shorts) {
+        shorts.resize(shorts2Read);
+        size_t n = shorts2Read > 0 ? ReadShorts(shorts2Read, &shorts[0]) : 0;
+        shorts.resize(n);
+        return n;
+    }
+
+    size_t LosslessFileReader::ReadDuration(uint32_t durationMs, std::vector<uint8_t>& data) {
+        uint64_t frames = (uint64_t)m_info.sampleRate * durationMs / 1000;
+        return ReadBytes((uint32_t)(frames * m_info.GetFrameBytes()), data);
+    }
+
+    size_t LosslessFileReader::ReadDuration(uint32_t durationMs, std::vector<uint16_t>& data) {
+        uint64_t frames = (uint64_t)m_info.sampleRate * durationMs / 1000;
+        return ReadShorts((uint32_t)(frames * m_info.GetFrameBytes() / 2), data);
+    }
+
+    bool LosslessFileReader::SeekToFrame(uint64_t frame) {
+        if (!m_fp) return false;
+        m_error = false;
+        if (frame >= m_info.totalFrames) {
+            m_blockIndex = m_info.blockCount;
+            m_blockLoaded = false;
+            return true;
+        }
+        uint32_t index = (uint32_t)(frame / m_info.blockFrames);
+        if (!(m_blockLoaded && m_blockIndex == index) && !LoadBlock(index)) return false;
+        m_blockPos = (size_t)(frame - (uint64_t)index * m_info.blockFrames) * m_info.GetFrameBytes();
+        return true;
+    }
+
+    void LosslessFileReader::SeekToTime(uint32_t tmMs) {
+        SeekToFrame((uint64_t)tmMs * m_info.sampleRate / 1000);
+    }
+
+    void LosslessFileReader::Close() {
+        if (m_fp) {
+            fclose(m_fp);
+            m_fp = nullptr;
+        }
+        m_info = LosslessInfo();
+        m_header.clear();
+        m_trailer.clear();
+        m_offsets.clear();
+        m_checksums.clear();
+        m_block.clear();
+        m_blockIndex = 0;
+        m_blockLoaded = false;
+        m_blockPos = 0;
+        m_error = false;
+    }
+
+    ///////////////////////////////////////////////////
+    // 文件级
+
+    namespace {
+
+        // EncodeStream: 将 fp 中 size 字节的 PCM 数据写入 writer
+        bool EncodeStream(FILE* fp, uint64_t size, LosslessFileWriter& writer){
+            std::vector<uint8_t> buffer(1 << 20);
+            while (size > 0) {
+                size_t n = (size_t)std::min<uint64_t>(size, buffer.size());
+                if (fread(buffer.data(), 1, n, fp) != n) return false;
+                writer.Write(buffer.data(), (uint32_t)n);
+                size -= n;
+            }
+            return true;
+        }
+    }
+
+    bool LosslessEncodePCMFile(const std::string& srcPCMFilePath, const std::string& dstFilePath,
+                               uint32_t sampleRate, uint16_t sampleBits, uint16_t channels, AsyncIO::ThreadPool* pool) {
+        FILE* fp = fopen(srcPCMFilePath.c_str(), "rb");
+        if (!fp) {
+            printf("LosslessEncodePCMFile: open %s failed\n", srcPCMFilePath.c_str());
+            return false;
+        }
+        fseek(fp, 0, SEEK_END);
+        uint64_t size = (uint64_t)ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+
+        std::unique_ptr<AsyncIO::ThreadPool> ownPool;
+        if (!pool) {
+            ownPool.reset(new AsyncIO::ThreadPool());
+            pool = ownPool.get();
+        }
+
+        LosslessFileWriter writer;
+        bool ret = writer.Open(dstFilePath, sampleRate, sampleBits, channels, 4096, pool) && EncodeStream(fp, size, writer);
+        writer.Close();
+        fclose(fp);
+        return ret;
+    }
+
+    bool LosslessEncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstFilePath, AsyncIO::ThreadPool* pool) {
+        FILE* fp = fopen(srcWaveFilePath.c_str(), "rb");
+        if (!fp) {
+            printf("LosslessEncodeWaveFile: open %s failed\n", srcWaveFilePath.c_str());
+            return false;
+        }
+        fseek(fp, 0, SEEK_END);
+        uint64_t fileSize = (uint64_t)ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+
+        // data 子块之前可能有较大的 LIST 等子块，读取最多 1MB 来解析
+        std::vector<uint8_t> head((size_t)std::min<uint64_t>(fileSize, 1 << 20));
+        bool ret = fread(head.data(), 1, head.size(), fp) == head.size();
+
+        WaveHeader header;
+        uint32_t dataOffset = 0;
+        uint64_t dataBytes = 0;
+        uint32_t sampleRate = 0;
+        uint16_t sampleBits = 8;
+        uint16_t channels = 1;
+        if (ret && ParseWaveHeader(head.data(), head.size(), header, dataOffset)) {
+            const SubChunkFmt& fmt = header.riff.fmt;
+            dataBytes = std::min<uint64_t>(header.riff.data.header.size, fileSize - dataOffset);
+            bool pcm = fmt.audio_format == WaveAudioFormatPCM || fmt.audio_format == WaveAudioFormatExtensible;
+            bool bitsOk = fmt.bits_per_sample == 8 || fmt.bits_per_sample == 16 || fmt.bits_per_sample == 24;
+            if (pcm && bitsOk && fmt.channels > 0 && fmt.channels <= kMaxChannels && fmt.block_align == fmt.channels * fmt.bits_per_sample / 8) {
+                sampleRate = fmt.sample_rate;
+                sampleBits = fmt.bits_per_sample;
+                channels = fmt.channels;
+                dataBytes -= dataBytes % fmt.block_align;
+            }
+        } else {
+            // 无法解析时整个文件按字节流压缩
+            dataOffset = 0;
+            dataBytes = fileSize;
+        }
+
+        std::unique_ptr<AsyncIO::ThreadPool> ownPool;
+        if (!pool) {
+            ownPool.reset(new AsyncIO::ThreadPool());
+            pool = ownPool.get();
+        }
+
+        LosslessFileWriter writer;
+        ret = ret && writer.Open(dstFilePath, sampleRate, sampleBits, channels, 4096, pool);
+        if (ret) {
+            writer.SetHeader(head.data(), dataOffset);
+            fseek(fp, (long)dataOffset, SEEK_SET);
+            ret = EncodeStream(fp, dataBytes, writer);
+
+            std::vector<uint8_t> trailer((size_t)(fileSize - dataOffset - dataBytes));
+            ret = ret && fread(trailer.data(), 1, trailer.size(), fp) == trailer.size();
+            writer.SetTrailer(trailer.data(), trailer.size());
+        }
+        writer.Close();
+        fclose(fp);
+        return ret;
+    }
+
+    bool LosslessDecodeFile(const std::string& srcFilePath, const std::string& dstFilePath, AsyncIO::ThreadPool* pool) {
+        LosslessFileReader reader;
+        if (!reader.Open(srcFilePath)) return false;
+
+        FILE* fp = fopen(dstFilePath.c_str(), "wb");
+        if (!fp) {
+            printf("LosslessDecodeFile: open %s failed\n", dstFilePath.c_str());
+            return false;
+        }
+
+        std::unique_ptr<AsyncIO::ThreadPool> ownPool;
+        if (!pool) {
+            ownPool.reset(new AsyncIO::ThreadPool());
+            pool = ownPool.get();
+        }
+
+        const LosslessInfo& info = reader.GetInfo();
+        const std::vector<uint8_t>& header = reader.GetHeader();
+        bool ret = header.empty() || fwrite(header.data(), 1, header.size(), fp) == header.size();
+
+        // 每批读取若干块的压缩数据，并行解码后按顺序写出
+        const uint32_t batch = pool->GetThreadCount() * 4;
+        const size_t blockBytes = (size_t)info.blockFrames * info.GetFrameBytes();
+        std::vector<std::vector<uint8_t> > compressed(batch);
+        std::vector<uint32_t> checksums(batch);
+        std::vector<uint8_t> pcm(batch * blockBytes);
+        std::vector<uint8_t> ok(batch);
+        for (uint32_t first = 0; ret && first < info.blockCount; first += batch) {
+            uint32_t count = std::min(batch, info.blockCount - first);
+            for (uint32_t i = 0; ret && i < count; i++) ret = reader.ReadBlock(first + i, compressed[i], checksums[i]);
+            if (!ret) break;
+
+            size_t bytes = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t frames = reader.GetBlockFrames(first + i);
+                uint8_t* out = &pcm[i * blockBytes];
+                size_t outBytes = (size_t)frames * info.GetFrameBytes();
+                bytes += outBytes;
+                pool->Submit([&, i, frames, out, outBytes]{
+                    ok[i] = LosslessDecodeBlock(info, compressed[i].data(), compressed[i].size(), frames, out) &&
+                            Adler32(out, outBytes) == checksums[i];
+                });
+            }
+            pool->Wait();
+
+            for (uint32_t i = 0; ret && i < count; i++) {
+                if (!ok[i]) {
+                    printf("LosslessDecodeFile: block %u is corrupted\n", first + i);
+                    ret = false;
+                }
+            }
+            ret = ret && fwrite(pcm.data(), 1, bytes, fp) == bytes;
+        }
+
+        const std::vector<uint8_t>& trailer = reader.GetTrailer();
+        ret = ret && (trailer.empty() || fwrite(trailer.data(), 1, trailer.size(), fp) == trailer.size());
+        fclose(fp);
+        return ret;
+    }
+}
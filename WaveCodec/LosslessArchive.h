@@ -0,0 +1,191 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef LOSSLESS_ARCHIVE_H_
+#define LOSSLESS_ARCHIVE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace AsyncIO {
+    class ThreadPool;
+}
+
+namespace WaveCodec {
+
+    // 无损压缩归档格式(.pla)，用于长期保存 PCM/Wave 文件，解压后与原文件逐字节相同
+    // - 采样按块(默认每声道 4096 个采样)独立压缩，块之间没有依赖，可以从任意块开始解码，也可以多个块并行解码
+    // - 每个声道做定阶(0~4 阶差分)或 LPC(最高 12 阶，系数量化后定点计算)预测，残差分区后使用 Rice 编码
+    // - 双声道在 左右/左侧/侧右/中侧 四种组合中选择码长最短的一种
+    // - 文件末尾有块索引(每块的偏移和解码后数据的 Adler-32)，解码时校验
+    // 支持 8bit(无符号)/16bit/24bit 小端整数 PCM，1~8 个声道
+    //
+    // 文件结构(整数均为小端):
+    //   文件头 48 字节: "PLAC" | version u16 | channels u16 | sample_rate u32 | sample_bits u16 | reserved u16
+    //                  | block_frames u32 | block_count u32 | total_frames u64 | meta_offset u64 | header_size u32 | trailer_size u32
+    //   压缩块 * block_count
+    //   header(原文件中 PCM 数据之前的字节) | trailer(原文件中 PCM 数据之后的字节)，从 meta_offset 开始
+    //   块索引: (offset u64 | adler32 u32) * block_count，紧跟在 trailer 之后
+
+    // LosslessInfo: 归档文件中 PCM 数据的参数
+    struct LosslessInfo {
+        uint32_t sampleRate  = 0;
+        uint16_t sampleBits  = 0;
+        uint16_t channels    = 0;
+        uint32_t blockFrames = 0;  // 每块的帧数(每声道的采样数)，最后一块可能不足
+        uint32_t blockCount  = 0;
+        uint64_t totalFrames = 0;
+
+        uint32_t GetFrameBytes() const { return channels * (sampleBits / 8); }
+    };
+
+    // LosslessEncodeBlock: 压缩一块 PCM 数据，线程安全
+    // * pcm    : 交错存储的 PCM 数据，frames * info.GetFrameBytes() 字节
+    // * frames : 帧数，不超过 info.blockFrames
+    // * out    : 输出压缩数据，会被清空
+    void LosslessEncodeBlock(const LosslessInfo& info, const uint8_t* pcm, uint32_t frames, std::vector<uint8_t>& out);
+
+    // LosslessDecodeBlock: 解压一块数据，线程安全
+    // * data/size : 压缩数据
+    // * frames    : 该块的帧数
+    // * pcm       : 输出，frames * info.GetFrameBytes() 字节
+    // * 返回值     : 数据损坏时返回 false
+    bool LosslessDecodeBlock(const LosslessInfo& info, const uint8_t* data, size_t size, uint32_t frames, uint8_t* pcm);
+
+    // Adler32: 计算数据的 Adler-32 校验值
+    uint32_t Adler32(const uint8_t* data, size_t size, uint32_t adler = 1);
+
+    /*example code
+
+        LosslessFileWriter writer;
+        writer.Open("test.pla", 44100, 16, 2);
+        writer.Write(pcm, len);             // 与 PCMFileWriter 一样，可以多次写入
+        writer.Close();
+
+        LosslessFileReader reader;
+        reader.Open("test.pla");
+        reader.SeekToTime(60000);           // 从第 60 秒所在的块开始解码
+        std::vector<uint16_t> pcm;
+        while(reader.ReadDuration(20, pcm) > 0){
+            // process pcm
+        }
+        reader.Close();
+    */
+
+    // LosslessFileWriter: 写入无损压缩归档文件，接口与 PCMFileWriter/WaveFileWriter 相同
+    class LosslessFileWriter {
+    public:
+        LosslessFileWriter();
+        ~LosslessFileWriter();
+
+        // Open: 创建归档文件
+        // * sampleRate/sampleBits/channels : PCM 参数，sampleBits 为 8/16/24
+        // * blockFrames : 每块的帧数，块越大压缩率略高，随机访问的粒度越粗
+        // * pool        : 不为空时攒够一批块后在线程池中并行压缩
+        bool Open(const std::string& filePath, uint32_t sampleRate, uint16_t sampleBits, uint16_t channels,
+                  uint32_t blockFrames = 4096, AsyncIO::ThreadPool* pool = nullptr);
+
+        // SetHeader/SetTrailer: 原文件中 PCM 数据之前/之后的字节(如 Wave 文件头和 LIST 子块)，原样保存
+        void SetHeader(const uint8_t* data, size_t len);
+        void SetTrailer(const uint8_t* data, size_t len);
+
+        // Write: 写入交错存储的 PCM 数据
+        void Write(const uint8_t* data, uint32_t len);
+        void Write(const uint16_t* data, uint32_t len);
+        void Write(const std::vector<uint8_t>& data);
+        void Write(const std::vector<uint8_t>& data, size_t len);
+        void Write(const std::vector<uint16_t>& data);
+        void Write(const std::vector<uint16_t>& data, size_t len);
+
+        // Close: 压缩剩余的数据，写入 header/trailer、块索引，更新文件头
+        // 最后不足一帧的字节放在 trailer 的最前面
+        void Close();
+
+    private:
+        // EncodeBlocks: 压缩 m_pending 中的完整块并写入文件，final 为 true 时最后不足一块的帧也作为一块
+        bool EncodeBlocks(bool final);
+
+        FILE* m_fp = nullptr;
+        LosslessInfo m_info;
+        AsyncIO::ThreadPool* m_pool = nullptr;
+        std::vector<uint8_t> m_pending;  // 尚未压缩的 PCM 数据
+        std::vector<uint8_t> m_header;
+        std::vector<uint8_t> m_trailer;
+        std::vector<uint64_t> m_offsets;
+        std::vector<uint32_t> m_checksums;
+        uint64_t m_offset = 0;
+    };
+
+    // LosslessFileReader: 读取无损压缩归档文件，接口与 PCMFileReader/WaveFileReader 相同，读出的是解压后的 PCM 数据
+    class LosslessFileReader {
+    public:
+        LosslessFileReader();
+        ~LosslessFileReader();
+
+        // Open: 打开归档文件，读取文件头、header/trailer 和块索引
+        bool Open(const std::string& filePath);
+
+        const LosslessInfo& GetInfo() const { return m_info; }
+        const std::vector<uint8_t>& GetHeader() const { return m_header; }
+        const std::vector<uint8_t>& GetTrailer() const { return m_trailer; }
+
+        // ReadBytes/ReadShorts: 读取解压后的 PCM 数据，返回实际读取到的字节数/short 个数，数据损坏时停止读取
+        size_t ReadBytes(uint32_t bytes2Read, uint8_t* bytes);
+        size_t ReadBytes(uint32_t bytes2Read, std::vector<uint8_t>& bytes);
+        size_t ReadShorts(uint32_t shorts2Read, uint16_t* shorts);
+        size_t ReadShorts(uint32_t shorts2Read, std::vector<uint16_t>& shorts);
+
+        // ReadDuration: 读取指定时长(毫秒)的数据，返回实际读取到的 uint8_t 或 uint16_t 个数
+        size_t ReadDuration(uint32_t durationMs, std::vector<uint8_t>& data);
+        size_t ReadDuration(uint32_t durationMs, std::vector<uint16_t>& data);
+
+        // SeekToFrame/SeekToTime: 定位到指定帧/时间，只需要解码所在的一块
+        bool SeekToFrame(uint64_t frame);
+        void SeekToTime(uint32_t tmMs);
+
+        // GetBlockFrames: 第 index 块的帧数
+        uint32_t GetBlockFrames(uint32_t index) const;
+
+        // ReadBlock: 读取第 index 块的压缩数据，不解压，与 LosslessDecodeBlock 配合实现并行解码
+        // * 返回值 : 读取成功后 checksum 为该块解码后数据的 Adler-32
+        bool ReadBlock(uint32_t index, std::vector<uint8_t>& data, uint32_t& checksum);
+
+        void Close();
+
+    private:
+        // LoadBlock: 解压第 index 块到 m_block
+        bool LoadBlock(uint32_t index);
+
+        FILE* m_fp = nullptr;
+        LosslessInfo m_info;
+        std::vector<uint8_t> m_header;
+        std::vector<uint8_t> m_trailer;
+        std::vector<uint64_t> m_offsets;   // block_count + 1 个，最后一个为块数据的结尾
+        std::vector<uint32_t> m_checksums;
+
+        std::vector<uint8_t> m_compressed;
+        std::vector<uint8_t> m_block;      // 当前块解压后的数据
+        uint32_t m_blockIndex = 0;         // m_block 对应的块
+        bool m_blockLoaded = false;
+        size_t m_blockPos = 0;             // 在 m_block 中的读取位置
+        bool m_error = false;
+    };
+
+    // LosslessEncodePCMFile: 将 PCM 文件压缩为归档文件
+    // * pool : 并行压缩的线程池，为空时内部按 CPU 核数创建一个
+    bool LosslessEncodePCMFile(const std::string& srcPCMFilePath, const std::string& dstFilePath,
+                               uint32_t sampleRate, uint16_t sampleBits, uint16_t channels, AsyncIO::ThreadPool* pool = nullptr);
+
+    // LosslessEncodeWaveFile: 将 Wave 文件压缩为归档文件，data 子块之前和之后的内容原样保存
+    // 8/16/24bit 整数 PCM 按采样预测；其它格式(如 G.711、float)按 8bit 单声道字节流压缩，仍然是无损的
+    bool LosslessEncodeWaveFile(const std::string& srcWaveFilePath, const std::string& dstFilePath, AsyncIO::ThreadPool* pool = nullptr);
+
+    // LosslessDecodeFile: 将归档文件还原为原文件(header + PCM + trailer)，按块并行解码
+    bool LosslessDecodeFile(const std::string& srcFilePath, const std::string& dstFilePath, AsyncIO::ThreadPool* pool = nullptr);
+}
+
+#endif //LOSSLESS_ARCHIVE_H_
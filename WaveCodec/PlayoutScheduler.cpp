@@ -0,0 +1,305 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "PlayoutScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <queue>
+
+#if defined(__linux__)
+#include <time.h>
+#include <errno.h>
+#endif
+
+namespace WaveCodec {
+
+    // 单次睡眠的上限，保证 Stop 能及时生效
+    static const int64_t kMaxSleepNs = 50 * 1000000LL;
+
+    static int64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 睡眠到绝对时刻 deadlineNs，libstdc++ 的 steady_clock 即 CLOCK_MONOTONIC
+    static void SleepUntilNs(int64_t deadlineNs) {
+#if defined(__linux__)
+        struct timespec ts;
+        ts.tv_sec = (time_t)(deadlineNs / 1000000000LL);
+        ts.tv_nsec = (long)(deadlineNs % 1000000000LL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(deadlineNs))));
+#endif
+    }
+
+    ///////////////////////////////////////////////////
+    // PlayoutStream: 一路流的帧来源和统计
+    class PlayoutStream {
+    public:
+        PlayoutStream(const PlayoutCallback& callback, uint32_t startDelayMs) : m_callback(callback), m_startDelayNs(startDelayMs * 1000000LL) {}
+        virtual ~PlayoutStream() {}
+
+        // NextFrame: 获取下一帧，frame.timestamp 为该帧之前已播放的采样数
+        virtual bool NextFrame(MediaFrame& frame) = 0;
+
+        // 每秒的字节数，用于把已投递的字节数换算为媒体时间
+        uint64_t byteRate = 0;
+        uint32_t worker = 0;
+        int id = -1;
+
+        // 下一帧的投递时刻
+        // 先按整秒拆分，避免 m_bytesPlayed * 1e9 溢出(48kHz 16bit 双声道约 26.7 小时后)
+        int64_t Deadline(int64_t startNs) const {
+            uint64_t playedNs = m_bytesPlayed / byteRate * 1000000000ULL + m_bytesPlayed % byteRate * 1000000000ULL / byteRate;
+            return startNs + m_startDelayNs + (int64_t)playedNs;
+        }
+
+        void Deliver(int64_t startNs, int64_t missThresholdNs, const MediaFrame& frame) {
+            PlayoutFrame out;
+            out.streamId = id;
+            out.frame = frame;
+            out.deadlineNs = Deadline(startNs);
+            out.lateNs = std::max<int64_t>(0, NowNs() - out.deadlineNs);
+            m_callback(out);
+            m_bytesPlayed += frame.size;
+
+            frames++;
+            if (out.lateNs > missThresholdNs) misses++;
+            totalLateNs += (uint64_t)out.lateNs;
+            if ((uint64_t)out.lateNs > maxLateNs) maxLateNs = (uint64_t)out.lateNs;
+        }
+
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> totalLateNs{0};
+        std::atomic<uint64_t> maxLateNs{0};
+        std::atomic<bool> finished{false};
+
+    private:
+        PlayoutCallback m_callback;
+        int64_t m_startDelayNs = 0;
+        uint64_t m_bytesPlayed = 0;
+    };
+
+    // Wave 文件，ReadDuration 逐帧读取
+    class WaveFileStream : public PlayoutStream {
+    public:
+        WaveFileStream(const PlayoutCallback& callback, uint32_t startDelayMs) : PlayoutStream(callback, startDelayMs) {}
+
+        bool Open(const std::string& waveFilePath, uint32_t frameMs, uint32_t ssrc) {
+            WaveHeader header;
+            if (!m_reader.Open(waveFilePath) || !m_reader.ReadWaveHeader(header)) {
+                printf("read wave header failed, %s\n", waveFilePath.c_str());
+                return false;
+            }
+            uint16_t format = header.riff.fmt.audio_format;
+            if (format != WaveAudioFormatPCM && format != WaveAudioFormatALaw && format != WaveAudioFormatMuLaw) {
+                printf("unsupported audio format for playout: %d\n", format);
+                return false;
+            }
+
+            m_blockAlign = header.riff.fmt.channels * header.riff.fmt.bits_per_sample / 8;
+            byteRate = (uint64_t)header.riff.fmt.sample_rate * m_blockAlign;
+            if (byteRate == 0 || frameMs == 0) return false;
+
+            // 只读取 data 块，流式写入的文件 data 大小可能为 0，此时读到文件末尾
+            m_dataLeft = header.riff.data.header.size;
+            if (m_dataLeft == 0) m_dataLeft = UINT64_MAX;
+
+            m_frameMs = frameMs;
+            m_ssrc = ssrc;
+            m_payloadType = format == WaveAudioFormatMuLaw ? 0 : (format == WaveAudioFormatALaw ? 8 : 96);
+            m_buffer.resize((size_t)(byteRate * frameMs / 1000) + m_blockAlign);
+            return true;
+        }
+
+        bool NextFrame(MediaFrame& frame) override {
+            if (m_dataLeft == 0) return false;
+
+            size_t nRead = m_reader.ReadDuration(m_frameMs, &m_buffer[0]);
+            nRead = (size_t)std::min<uint64_t>(nRead, m_dataLeft) / m_blockAlign * m_blockAlign;
+            if (nRead == 0) {
+                m_dataLeft = 0;
+                return false;
+            }
+            m_dataLeft -= nRead;
+
+            frame.data = &m_buffer[0];
+            frame.size = (uint32_t)nRead;
+            frame.sequence = (uint16_t)m_frameIndex;
+            frame.timestamp = m_timestamp;
+            frame.ssrc = m_ssrc;
+            frame.payloadType = m_payloadType;
+            frame.marker = (m_frameIndex == 0);
+            frame.frameIndex = m_frameIndex++;
+            m_timestamp += (uint32_t)(nRead / m_blockAlign);
+            return true;
+        }
+
+    private:
+        WaveFileReader m_reader;
+        std::vector<uint8_t> m_buffer;
+        uint64_t m_dataLeft = 0;
+        uint32_t m_frameMs = 0;
+        uint32_t m_blockAlign = 0;
+        uint32_t m_ssrc = 0;
+        uint8_t m_payloadType = 0;
+        uint32_t m_timestamp = 0;
+        uint64_t m_frameIndex = 0;
+    };
+
+    // SharedAudioSource + FramePacketizer
+    class SharedSourceStream : public PlayoutStream {
+    public:
+        SharedSourceStream(const SharedAudioSource& source, uint32_t frameMs, uint32_t ssrc, uint32_t startFrame, bool loop,
+                           const PlayoutCallback& callback, uint32_t startDelayMs)
+            : PlayoutStream(callback, startDelayMs), m_packetizer(source, frameMs, ssrc, startFrame, loop) {
+            byteRate = (uint64_t)source.GetSampleRate() * source.GetBlockAlign();
+        }
+
+        bool IsValid() const { return m_packetizer.IsValid() && byteRate > 0; }
+
+        bool NextFrame(MediaFrame& frame) override {
+            return m_packetizer.NextFrame(frame);
+        }
+
+    private:
+        FramePacketizer m_packetizer;
+    };
+
+    ///////////////////////////////////////////////////
+    // PlayoutScheduler
+    PlayoutScheduler::PlayoutScheduler(uint32_t threadCnt, uint32_t missThresholdUs)
+        : m_threadCnt(threadCnt ? threadCnt : 1), m_missThresholdNs(missThresholdUs * 1000LL), m_stop(false) {}
+
+    PlayoutScheduler::~PlayoutScheduler() {
+        Stop();
+    }
+
+    int PlayoutScheduler::AddStream(PlayoutStream* stream) {
+        if (m_started) {
+            printf("streams must be added before start\n");
+            delete stream;
+            return -1;
+        }
+        stream->id = (int)m_streams.size();
+        stream->worker = (uint32_t)(m_streams.size() % m_threadCnt);
+        m_streams.push_back(std::unique_ptr<PlayoutStream>(stream));
+        return stream->id;
+    }
+
+    int PlayoutScheduler::AddWaveFile(const std::string& waveFilePath, uint32_t frameMs, const PlayoutCallback& callback, uint32_t startDelayMs) {
+        std::unique_ptr<WaveFileStream> stream(new WaveFileStream(callback, startDelayMs));
+        if (!stream->Open(waveFilePath, frameMs, (uint32_t)m_streams.size())) return -1;
+        return AddStream(stream.release());
+    }
+
+    int PlayoutScheduler::AddSharedSource(const SharedAudioSource& source, uint32_t frameMs, uint32_t ssrc, uint32_t startFrame, bool loop,
+                                          const PlayoutCallback& callback, uint32_t startDelayMs) {
+        std::unique_ptr<SharedSourceStream> stream(new SharedSourceStream(source, frameMs, ssrc, startFrame, loop, callback, startDelayMs));
+        if (!stream->IsValid()) {
+            printf("invalid shared source stream\n");
+            return -1;
+        }
+        return AddStream(stream.release());
+    }
+
+    bool PlayoutScheduler::Start() {
+        if (m_started) {
+            // 各路流的读取位置和已播放的字节数不会重置，不支持重新开始
+            printf("scheduler can only be started once\n");
+            return false;
+        }
+        if (m_streams.empty()) return false;
+
+        m_started = true;
+        m_stop = false;
+        m_startNs = NowNs();
+        uint32_t threadCnt = std::min<uint32_t>(m_threadCnt, (uint32_t)m_streams.size());
+        for (uint32_t i = 0; i < threadCnt; i++) {
+            m_threads.push_back(std::thread(&PlayoutScheduler::Run, this, i));
+        }
+        return true;
+    }
+
+    void PlayoutScheduler::Wait() {
+        for (size_t i = 0; i < m_threads.size(); i++) {
+            if (m_threads[i].joinable()) m_threads[i].join();
+        }
+        m_threads.clear();
+    }
+
+    void PlayoutScheduler::Stop() {
+        m_stop = true;
+        Wait();
+    }
+
+    void PlayoutScheduler::Run(uint32_t worker) {
+        // 按投递时刻排序的最小堆
+        typedef std::pair<int64_t, PlayoutStream*> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > heap;
+
+        // 每路流预取下一帧，数据在投递前保持有效
+        std::vector<MediaFrame> pending(m_streams.size());
+        for (size_t i = 0; i < m_streams.size(); i++) {
+            PlayoutStream* stream = m_streams[i].get();
+            if (stream->worker != worker) continue;
+            if (stream->NextFrame(pending[i])) {
+                heap.push(Entry(stream->Deadline(m_startNs), stream));
+            } else {
+                stream->finished = true;
+            }
+        }
+
+        while (!heap.empty() && !m_stop) {
+            int64_t deadline = heap.top().first;
+            int64_t now = NowNs();
+            if (deadline > now) {
+                SleepUntilNs(std::min(deadline, now + kMaxSleepNs));
+                continue;
+            }
+
+            // 到期的流逐个投递，落后时连续补发
+            PlayoutStream* stream = heap.top().second;
+            heap.pop();
+            stream->Deliver(m_startNs, m_missThresholdNs, pending[stream->id]);
+            if (stream->NextFrame(pending[stream->id])) {
+                heap.push(Entry(stream->Deadline(m_startNs), stream));
+            } else {
+                stream->finished = true;
+            }
+        }
+    }
+
+    static void FillStats(uint64_t frames, uint64_t misses, uint64_t totalLateNs, uint64_t maxLateNs, bool finished, PlayoutStats& stats) {
+        stats.frames = frames;
+        stats.deadlineMisses = misses;
+        stats.maxLateUs = maxLateNs / 1000.0;
+        stats.meanLateUs = frames ? totalLateNs / 1000.0 / frames : 0;
+        stats.finished = finished;
+    }
+
+    bool PlayoutScheduler::GetStats(int streamId, PlayoutStats& stats) const {
+        if (streamId < 0 || streamId >= (int)m_streams.size()) return false;
+        const PlayoutStream& s = *m_streams[streamId];
+        FillStats(s.frames, s.misses, s.totalLateNs, s.maxLateNs, s.finished, stats);
+        return true;
+    }
+
+    void PlayoutScheduler::GetTotalStats(PlayoutStats& stats) const {
+        uint64_t frames = 0, misses = 0, totalLateNs = 0, maxLateNs = 0;
+        bool finished = true;
+        for (size_t i = 0; i < m_streams.size(); i++) {
+            const PlayoutStream& s = *m_streams[i];
+            frames += s.frames;
+            misses += s.misses;
+            totalLateNs += s.totalLateNs;
+            maxLateNs = std::max<uint64_t>(maxLateNs, s.maxLateNs);
+            finished = finished && s.finished;
+        }
+        FillStats(frames, misses, totalLateNs, maxLateNs, finished, stats);
+    }
+}
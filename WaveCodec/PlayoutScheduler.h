@@ -0,0 +1,118 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef PLAYOUT_SCHEDULER_H_
+#define PLAYOUT_SCHEDULER_H_
+
+#include "WaveFile.h"
+#include "FramePacketizer.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace WaveCodec {
+
+    // PlayoutFrame: 按时投递的一帧
+    struct PlayoutFrame {
+        int        streamId = -1;
+        MediaFrame frame;           // 帧数据和 RTP 信息，数据只在回调期间有效
+        int64_t    deadlineNs = 0;  // 该帧应投递的时刻(steady_clock，纳秒)
+        int64_t    lateNs = 0;      // 实际投递时刻 - deadlineNs
+    };
+
+    typedef std::function<void(const PlayoutFrame& frame)> PlayoutCallback;
+
+    class PlayoutStream;
+
+    // PlayoutStats: 投递统计
+    struct PlayoutStats {
+        uint64_t frames = 0;          // 已投递的帧数
+        uint64_t deadlineMisses = 0;  // 延迟超过阈值的帧数
+        double   maxLateUs = 0;       // 最大延迟，微秒
+        double   meanLateUs = 0;      // 平均延迟，微秒
+        bool     finished = false;    // 是否已播放完毕
+    };
+
+    /*example code
+
+        PlayoutScheduler scheduler(2); // 2 个调度线程
+        for(size_t i = 0; i < files.size(); i++){
+            scheduler.AddWaveFile(files[i], 20, [](const PlayoutFrame& frame){
+                // send frame.frame.data/frame.frame.size
+            }, i % 20); // 错开各路流的起始时间
+        }
+        scheduler.Start();
+        scheduler.Wait();
+
+        PlayoutStats stats;
+        scheduler.GetTotalStats(stats);
+    */
+
+    // PlayoutScheduler: 按媒体时间实时投递多路音频帧，模拟实时音源
+    // 每路流的第 n 帧的投递时刻 = 开始时刻 + 起始延迟 + 前 n 帧的媒体时长(按实际字节数计算)，
+    // 使用绝对时刻睡眠(Linux 下为 clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME))，唤醒误差和回调耗时不会累积；
+    // 落后时立即按时刻顺序补发，之后恢复原有节奏
+    // 多路流按添加顺序轮流分配到少量调度线程，每个线程用最小堆按投递时刻排序，回调在调度线程中执行，应尽快返回
+    class PlayoutScheduler {
+    public:
+        // * threadCnt       : 调度线程数，为 0 时为 1
+        // * missThresholdUs : 延迟超过该值的帧计为 deadline miss
+        explicit PlayoutScheduler(uint32_t threadCnt = 1, uint32_t missThresholdUs = 2000);
+
+        // 停止并等待调度线程退出
+        ~PlayoutScheduler();
+
+        // AddWaveFile: 添加一路 Wave 文件流，通过 WaveFileReader::ReadDuration 每次读取一帧，播放到 data 末尾结束
+        // 仅支持 PCM/ALaw/ULaw 格式，需要在 Start 之前调用
+        // * waveFilePath : Wave 文件路径
+        // * frameMs      : 帧时长，毫秒
+        // * callback     : 投递回调
+        // * startDelayMs : 相对于 Start 的起始延迟，用于错开各路流
+        // * 返回值        : 流 id，失败时返回 -1
+        int AddWaveFile(const std::string& waveFilePath, uint32_t frameMs, const PlayoutCallback& callback, uint32_t startDelayMs = 0);
+
+        // AddSharedSource: 添加一路共享音频数据的流，由 FramePacketizer 切帧，不复制数据
+        // * source       : 共享的音频数据，必须比 PlayoutScheduler 活得更久
+        // * frameMs/ssrc/startFrame/loop : 同 FramePacketizer
+        // * 返回值        : 流 id，失败时返回 -1
+        int AddSharedSource(const SharedAudioSource& source, uint32_t frameMs, uint32_t ssrc, uint32_t startFrame, bool loop,
+                            const PlayoutCallback& callback, uint32_t startDelayMs = 0);
+
+        // Start: 启动调度线程，所有流从此刻开始计时，只能调用一次，Stop 之后再次调用返回 false
+        bool Start();
+
+        // Wait: 等待所有流播放完毕(循环的流需要调用 Stop)
+        void Wait();
+
+        // Stop: 停止投递，等待调度线程退出
+        void Stop();
+
+        size_t GetStreamCount() const { return m_streams.size(); }
+
+        // GetStats: 获取一路流的统计，可以在运行中调用
+        bool GetStats(int streamId, PlayoutStats& stats) const;
+
+        // GetTotalStats: 获取所有流的汇总统计
+        void GetTotalStats(PlayoutStats& stats) const;
+
+    private:
+        PlayoutScheduler(const PlayoutScheduler&);
+        PlayoutScheduler& operator=(const PlayoutScheduler&);
+
+        int AddStream(PlayoutStream* stream);
+        void Run(uint32_t worker);
+
+        uint32_t m_threadCnt = 1;
+        int64_t m_missThresholdNs = 0;
+        std::vector<std::unique_ptr<PlayoutStream> > m_streams;
+        std::vector<std::thread> m_threads;
+        std::atomic<bool> m_stop;
+        bool m_started = false;
+        int64_t m_startNs = 0;
+    };
+}
+
+#endif //PLAYOUT_SCHEDULER_H_
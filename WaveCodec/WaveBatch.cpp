@@ -0,0 +1,231 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "WaveBatch.h"
+#include "AsyncIO/BatchIO.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace WaveCodec {
+
+    // 每一轮同时打开的文件数，避免耗尽文件描述符
+    static const size_t kFilesPerRound = 256;
+    static const uint32_t kQueueDepth = 128;
+
+    // 解析 Wave Header 时读取的文件开头长度，data 子块不在其中的文件退回到 Wave2PCMFile
+    static const uint32_t kHeadSize = 4096;
+
+    static void CloseFiles(std::vector<int>& fds){
+        for (size_t i = 0; i < fds.size(); i++) {
+            AsyncIO::CloseFile(fds[i]);
+        }
+        fds.clear();
+    }
+
+    // RoundCache: 一轮批量转换中各个文件的缓存状态
+    // 未命中且本轮中已有相同内容的文件时记为重复，不再转换，等前一个文件转换完成后直接复制它的结果
+    class RoundCache {
+    public:
+        RoundCache(ConversionCache* cache, size_t count) : m_cache(cache), m_keys(count), m_first(count, -1), m_hits(count, false) {}
+
+        // Lookup: 查找缓存，返回 true 表示该文件不需要转换(命中或重复)
+        bool Lookup(size_t index, uint64_t hash, uint64_t size, const std::string& params, const std::string& dstPath) {
+            std::string key = ConversionCache::MakeKey(hash, size, params);
+            if (m_cache->Lookup(key, dstPath)) {
+                m_hits[index] = true;
+                return true;
+            }
+            auto it = m_pending.find(key);
+            if (it != m_pending.end()) {
+                m_first[index] = (int)it->second;
+                return true;
+            }
+            m_pending[key] = index;
+            m_keys[index] = key;
+            return false;
+        }
+
+        bool IsHit(size_t index) const { return m_hits[index]; }
+
+        // Finish: 转换成功的结果存入缓存，然后复制重复文件的结果
+        void Finish(std::vector<BatchConvertJob>& jobs, size_t begin) {
+            for (size_t i = 0; i < m_keys.size(); i++) {
+                if (!m_keys[i].empty() && jobs[begin + i].success) m_cache->Store(m_keys[i], jobs[begin + i].dstPath);
+            }
+            for (size_t i = 0; i < m_first.size(); i++) {
+                if (m_first[i] < 0) continue;
+                const BatchConvertJob& first = jobs[begin + m_first[i]];
+                BatchConvertJob& job = jobs[begin + i];
+                job.success = first.success && AsyncIO::CopyWholeFile(first.dstPath, job.dstPath) >= 0;
+            }
+        }
+
+    private:
+        ConversionCache* m_cache;
+        std::vector<std::string> m_keys;   // 未命中的文件的键
+        std::vector<int> m_first;          // 重复的文件对应的第一个文件
+        std::vector<bool> m_hits;
+        std::unordered_map<std::string, size_t> m_pending;
+    };
+
+    size_t BatchPCM2WaveFile(std::vector<BatchConvertJob>& jobs, AsyncIO::IOEngine* engine, ConversionCache* cache){
+        std::unique_ptr<AsyncIO::IOEngine> ownEngine;
+        if (!engine) {
+            ownEngine = AsyncIO::CreateIOEngine(kQueueDepth);
+            if (!ownEngine) return 0;
+            engine = ownEngine.get();
+        }
+
+        size_t successCnt = 0;
+        for (size_t begin = 0; begin < jobs.size(); begin += kFilesPerRound) {
+            size_t end = std::min(jobs.size(), begin + kFilesPerRound);
+            std::vector<int> fds;
+            std::vector<AsyncIO::FileCopyTask> tasks(end - begin);
+            std::unique_ptr<RoundCache> roundCache(cache ? new RoundCache(cache, end - begin) : nullptr);
+
+            for (size_t i = begin; i < end; i++) {
+                BatchConvertJob& job = jobs[i];
+                AsyncIO::FileCopyTask& task = tasks[i - begin];
+                job.success = false;
+
+                task.srcFd = AsyncIO::OpenFileForRead(job.srcPath);
+                fds.push_back(task.srcFd);
+                int64_t pcmSize = task.srcFd >= 0 ? AsyncIO::GetFileSize(task.srcFd) : -1;
+                if (pcmSize < 0) {
+                    printf("open pcm file failed, %s\n", job.srcPath.c_str());
+                    continue;
+                }
+
+                uint64_t hash = 0;
+                if (roundCache && HashFileRange(task.srcFd, 0, (uint64_t)pcmSize, hash) == pcmSize) {
+                    std::string params = "pcm2wave:" + std::to_string(job.sample_rate) + ":" + std::to_string(job.sample_bits)
+                                         + ":" + std::to_string(job.channels);
+                    if (roundCache->Lookup(i - begin, hash, (uint64_t)pcmSize, params, job.dstPath)) continue;
+                }
+
+                task.dstFd = AsyncIO::OpenFileForWrite(job.dstPath);
+                fds.push_back(task.dstFd);
+                if (task.dstFd < 0) {
+                    printf("open wave file failed, %s\n", job.dstPath.c_str());
+                    continue;
+                }
+
+                // PCM 文件大小已知，wave header 可以直接写出，不需要回填
+                WaveHeader header;
+                header.FormatPCMWaveHeader(job.sample_rate, job.sample_bits, job.channels, (uint32_t)pcmSize);
+                header.ToBuffer(task.prefix);
+                task.prefixOffset = 0;
+                task.srcOffset = 0;
+                task.length = (uint64_t)pcmSize;
+                task.dstOffset = task.prefix.size();
+            }
+
+            AsyncIO::BatchCopy(*engine, tasks);
+            CloseFiles(fds);
+
+            for (size_t i = begin; i < end; i++) {
+                jobs[i].success = (roundCache && roundCache->IsHit(i - begin)) || tasks[i - begin].success;
+            }
+            if (roundCache) roundCache->Finish(jobs, begin);
+            for (size_t i = begin; i < end; i++) {
+                if (jobs[i].success) successCnt++;
+            }
+        }
+
+        return successCnt;
+    }
+
+    size_t BatchWave2PCMFile(std::vector<BatchConvertJob>& jobs, AsyncIO::IOEngine* engine, ConversionCache* cache){
+        std::unique_ptr<AsyncIO::IOEngine> ownEngine;
+        if (!engine) {
+            ownEngine = AsyncIO::CreateIOEngine(kQueueDepth);
+            if (!ownEngine) return 0;
+            engine = ownEngine.get();
+        }
+
+        size_t successCnt = 0;
+        for (size_t begin = 0; begin < jobs.size(); begin += kFilesPerRound) {
+            size_t end = std::min(jobs.size(), begin + kFilesPerRound);
+            std::vector<int> srcFds(end - begin, -1);
+            std::vector<int> dstFds;
+            std::vector<AsyncIO::FileCopyTask> tasks(end - begin);
+            std::vector<size_t> fallback; // header 不在文件开头 kHeadSize 字节内的文件
+            std::unique_ptr<RoundCache> roundCache(cache ? new RoundCache(cache, end - begin) : nullptr);
+
+            // 1. 同时读取所有文件的开头，解析 wave header
+            for (size_t i = begin; i < end; i++) {
+                jobs[i].success = false;
+                srcFds[i - begin] = AsyncIO::OpenFileForRead(jobs[i].srcPath);
+                if (srcFds[i - begin] < 0) {
+                    printf("open wave file failed, %s\n", jobs[i].srcPath.c_str());
+                }
+            }
+
+            std::vector<std::vector<uint8_t>> heads;
+            AsyncIO::BatchReadHead(*engine, srcFds, kHeadSize, heads);
+
+            // 2. 只复制 data 子块中的音频数据
+            for (size_t i = begin; i < end; i++) {
+                BatchConvertJob& job = jobs[i];
+                AsyncIO::FileCopyTask& task = tasks[i - begin];
+                const std::vector<uint8_t>& head = heads[i - begin];
+                if (srcFds[i - begin] < 0 || head.empty()) continue;
+
+                WaveHeader header;
+                uint32_t dataOffset = 0;
+                if (!ParseWaveHeader(&head[0], head.size(), header, dataOffset)) {
+                    fallback.push_back(i);
+                    continue;
+                }
+
+                job.sample_rate = header.riff.fmt.sample_rate;
+                job.sample_bits = header.riff.fmt.bits_per_sample;
+                job.channels    = header.riff.fmt.channels;
+
+                // data 子块的大小可能不准确(如录音中断)，以文件实际大小为准
+                int64_t fileSize = AsyncIO::GetFileSize(srcFds[i - begin]);
+                uint64_t dataSize = header.riff.data.header.size;
+                if (fileSize >= dataOffset) {
+                    dataSize = std::min<uint64_t>(dataSize, (uint64_t)fileSize - dataOffset);
+                }
+
+                // 输出就是 data 子块的内容，只按内容查找
+                uint64_t hash = 0;
+                if (roundCache && HashFileRange(srcFds[i - begin], dataOffset, dataSize, hash) == (int64_t)dataSize) {
+                    if (roundCache->Lookup(i - begin, hash, dataSize, "wave2pcm", job.dstPath)) continue;
+                }
+
+                task.dstFd = AsyncIO::OpenFileForWrite(job.dstPath);
+                dstFds.push_back(task.dstFd);
+                if (task.dstFd < 0) {
+                    printf("open pcm file failed, %s\n", job.dstPath.c_str());
+                    continue;
+                }
+                task.srcFd = srcFds[i - begin];
+                task.srcOffset = dataOffset;
+                task.length = dataSize;
+                task.dstOffset = 0;
+            }
+
+            AsyncIO::BatchCopy(*engine, tasks);
+            CloseFiles(srcFds);
+            CloseFiles(dstFds);
+
+            for (size_t i = begin; i < end; i++) {
+                jobs[i].success = (roundCache && roundCache->IsHit(i - begin)) || tasks[i - begin].success;
+            }
+            if (roundCache) roundCache->Finish(jobs, begin);
+            for (size_t k = 0; k < fallback.size(); k++) {
+                BatchConvertJob& job = jobs[fallback[k]];
+                job.success = Wave2PCMFile(job.srcPath, job.dstPath, job.sample_rate, job.sample_bits, job.channels);
+            }
+            for (size_t i = begin; i < end; i++) {
+                if (jobs[i].success) successCnt++;
+            }
+        }
+
+        return successCnt;
+    }
+}
@@ -0,0 +1,40 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef WAVE_BATCH_H_
+#define WAVE_BATCH_H_
+
+#include "WaveFile.h"
+#include "AsyncIO/AsyncIO.h"
+#include "ConversionCache.h"
+
+namespace WaveCodec {
+
+    // BatchConvertJob: 批量转换中的一个文件
+    struct BatchConvertJob {
+        std::string srcPath;        // 源文件路径
+        std::string dstPath;        // 目标文件路径
+        uint32_t sample_rate = 0;   // PCM2Wave 时为输入参数；Wave2PCM 时为输出参数
+        uint16_t sample_bits = 0;   // 同上
+        uint16_t channels    = 0;   // 同上
+        bool     success     = false; // [输出] 转换是否成功
+    };
+
+    // BatchPCM2WaveFile: 批量将 PCM 文件转换为 Wave 文件
+    // 多个文件的读写同时在途，适合大量小文件，单个文件的结果与 PCM2WaveFile 相同
+    // * jobs   : 要转换的文件，需要指定 sample_rate/sample_bits/channels
+    // * engine : 异步 IO 引擎，为空时内部创建一个
+    // * cache  : 转换结果缓存，不为空时先按 PCM 内容和参数查找，命中的文件不再转换，转换成功的结果存入缓存
+    // * 返回值  : 转换成功的文件个数
+    size_t BatchPCM2WaveFile(std::vector<BatchConvertJob>& jobs, AsyncIO::IOEngine* engine = nullptr, ConversionCache* cache = nullptr);
+
+    // BatchWave2PCMFile: 批量将 Wave 文件转换为 PCM 文件，同时在 jobs 中返回音频的编码参数
+    // * jobs   : 要转换的文件
+    // * engine : 异步 IO 引擎，为空时内部创建一个
+    // * cache  : 转换结果缓存，按 data 子块的内容查找，同上
+    // * 返回值  : 转换成功的文件个数
+    size_t BatchWave2PCMFile(std::vector<BatchConvertJob>& jobs, AsyncIO::IOEngine* engine = nullptr, ConversionCache* cache = nullptr);
+}
+
+#endif //WAVE_BATCH_H_
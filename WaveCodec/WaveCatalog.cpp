@@ -0,0 +1,488 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "WaveCatalog.h"
+#include "AsyncIO/BatchIO.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace WaveCodec {
+
+    // 索引文件格式(本机字节序)：
+    // CatalogFileHeader | CatalogEntry * entry_count (按 path_hash, path 排序) | 字符串表(路径)
+    struct CatalogFileHeader {
+        uint8_t  magic[4];       // "WCAT"
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t entry_size;     // sizeof(CatalogEntry)，用于校验
+        uint64_t strings_offset;
+        uint64_t strings_size;
+    };
+
+    struct CatalogEntry {
+        uint64_t path_hash;
+        uint64_t path_offset;    // 路径在字符串表中的偏移
+        uint32_t path_len;
+        uint32_t data_offset;
+        uint64_t file_size;
+        int64_t  mtime;
+        uint32_t data_size;
+        uint32_t riff_size;
+        uint32_t fmt_size;
+        uint32_t fact_size;      // 0 表示没有 fact 子块
+        uint32_t fact_samples;
+        uint32_t sample_rate;
+        uint32_t byte_rate;
+        uint16_t audio_format;
+        uint16_t channels;
+        uint16_t block_align;
+        uint16_t bits_per_sample;
+        uint16_t ex_size;
+        uint16_t reserved;
+    };
+
+    static_assert(sizeof(CatalogFileHeader) == 32, "unexpected catalog header size");
+    static_assert(sizeof(CatalogEntry) == 80, "unexpected catalog entry size");
+
+    static const uint32_t kCatalogVersion = 1;
+
+    // 批量解析时读取的文件开头长度；header 不在其中时，逐步加大读取长度，直到 kMaxHeadSize
+    static const uint32_t kHeadSize = 4096;
+    static const uint32_t kMaxHeadSize = 16 * 1024 * 1024;
+    static const size_t kFilesPerRound = 256;
+    static const uint32_t kQueueDepth = 128;
+
+    // FNV-1a
+    static uint64_t HashPath(const char* path, size_t len){
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < len; i++) {
+            hash ^= (uint8_t)path[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    static bool StatFile(const std::string& filePath, uint64_t& fileSize, int64_t& mtime){
+        struct stat st;
+        if (stat(filePath.c_str(), &st) != 0) return false;
+        fileSize = (uint64_t)st.st_size;
+#if defined(__linux__)
+        mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+        mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+        mtime = (int64_t)st.st_mtime * 1000000000LL;
+#endif
+        return true;
+    }
+
+    static bool IsWaveFileName(const std::string& name){
+        if (name.size() < 4) return false;
+        std::string ext = name.substr(name.size() - 4);
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return ext == ".wav";
+    }
+
+    // 递归列出目录下的所有 .wav 文件
+    static void ListWaveFiles(const std::string& dir, std::vector<std::string>& filePaths){
+        std::string prefix = dir;
+        if (!prefix.empty() && prefix[prefix.size() - 1] != '/' && prefix[prefix.size() - 1] != '\\') prefix += "/";
+
+#ifdef WIN32
+        WIN32_FIND_DATAA data;
+        HANDLE handle = FindFirstFileA((prefix + "*").c_str(), &data);
+        if (handle == INVALID_HANDLE_VALUE) return;
+        do {
+            std::string name(data.cFileName);
+            if (name == "." || name == "..") continue;
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                ListWaveFiles(prefix + name, filePaths);
+            } else if (IsWaveFileName(name)) {
+                filePaths.push_back(prefix + name);
+            }
+        } while (FindNextFileA(handle, &data));
+        FindClose(handle);
+#else
+        DIR* d = opendir(dir.c_str());
+        if (!d) return;
+        struct dirent* ent;
+        while ((ent = readdir(d)) != nullptr) {
+            std::string name(ent->d_name);
+            if (name == "." || name == "..") continue;
+
+            bool isDir = false;
+            bool isFile = false;
+#ifdef DT_DIR
+            if (ent->d_type == DT_DIR) isDir = true;
+            else if (ent->d_type == DT_REG) isFile = true;
+            else if (ent->d_type == DT_UNKNOWN)
+#endif
+            {
+                struct stat st;
+                if (stat((prefix + name).c_str(), &st) == 0) {
+                    isDir = S_ISDIR(st.st_mode);
+                    isFile = S_ISREG(st.st_mode);
+                }
+            }
+
+            if (isDir) {
+                ListWaveFiles(prefix + name, filePaths);
+            } else if (isFile && IsWaveFileName(name)) {
+                filePaths.push_back(prefix + name);
+            }
+        }
+        closedir(d);
+#endif
+    }
+
+    // 由解析出的 header 填充 info 中的 dataOffset/dataSize
+    static void FillDataRange(const WaveHeader& header, uint32_t dataOffset, WaveFileInfo& info){
+        info.header = header;
+        info.dataOffset = dataOffset;
+        uint64_t dataSize = header.riff.data.header.size;
+        if (info.fileSize >= dataOffset) {
+            dataSize = std::min<uint64_t>(dataSize, info.fileSize - dataOffset); // 以文件实际大小为准
+        }
+        info.dataSize = (uint32_t)dataSize;
+    }
+
+    bool GetWaveFileInfo(const std::string& waveFilePath, WaveFileInfo& info){
+        if (!StatFile(waveFilePath, info.fileSize, info.mtime)) return false;
+
+        FILE* fp = fopen(waveFilePath.c_str(), "rb");
+        if (!fp) return false;
+
+        bool success = false;
+        std::vector<uint8_t> head;
+        for (uint32_t headSize = kHeadSize; headSize <= kMaxHeadSize; headSize *= 16) {
+            head.resize(headSize);
+            fseek(fp, 0L, SEEK_SET);
+            size_t nRead = fread(&head[0], sizeof(uint8_t), headSize, fp);
+
+            WaveHeader header;
+            uint32_t dataOffset = 0;
+            if (ParseWaveHeader(&head[0], nRead, header, dataOffset)) {
+                FillDataRange(header, dataOffset, info);
+                success = true;
+                break;
+            }
+            if (nRead < headSize) break; // 整个文件都读了，仍然没有 data 子块
+        }
+
+        fclose(fp);
+        return success;
+    }
+
+    static void EntryToInfo(const CatalogEntry& entry, WaveFileInfo& info){
+        WaveHeader& header = info.header;
+        header = WaveHeader();
+
+        header.riff.header.fourcc = MAKE_FOURCC('R', 'I', 'F', 'F');
+        header.riff.header.size = entry.riff_size;
+        header.riff.form_type = MAKE_FOURCC('W', 'A', 'V', 'E');
+
+        header.riff.fmt.header.fourcc = MAKE_FOURCC('f', 'm', 't', ' ');
+        header.riff.fmt.header.size = entry.fmt_size;
+        header.riff.fmt.audio_format = entry.audio_format;
+        header.riff.fmt.channels = entry.channels;
+        header.riff.fmt.sample_rate = entry.sample_rate;
+        header.riff.fmt.byte_rate = entry.byte_rate;
+        header.riff.fmt.block_align = entry.block_align;
+        header.riff.fmt.bits_per_sample = entry.bits_per_sample;
+        header.riff.fmt.ex_size = entry.ex_size;
+
+        if (entry.fact_size > 0) {
+            header.riff.fact.header.fourcc = MAKE_FOURCC('f', 'a', 'c', 't');
+            header.riff.fact.header.size = entry.fact_size;
+            header.riff.fact.samples = entry.fact_samples;
+        }
+
+        header.riff.data.header.fourcc = MAKE_FOURCC('d', 'a', 't', 'a');
+        header.riff.data.header.size = entry.data_size;
+
+        info.dataOffset = entry.data_offset;
+        info.dataSize = entry.data_size;
+        info.fileSize = entry.file_size;
+        info.mtime = entry.mtime;
+    }
+
+    static void InfoToEntry(const WaveFileInfo& info, CatalogEntry& entry){
+        const WaveHeader& header = info.header;
+        memset(&entry, 0, sizeof(entry));
+
+        entry.data_offset = info.dataOffset;
+        entry.data_size = info.dataSize;
+        entry.file_size = info.fileSize;
+        entry.mtime = info.mtime;
+
+        entry.riff_size = header.riff.header.size;
+        entry.fmt_size = header.riff.fmt.header.size;
+        entry.audio_format = header.riff.fmt.audio_format;
+        entry.channels = header.riff.fmt.channels;
+        entry.sample_rate = header.riff.fmt.sample_rate;
+        entry.byte_rate = header.riff.fmt.byte_rate;
+        entry.block_align = header.riff.fmt.block_align;
+        entry.bits_per_sample = header.riff.fmt.bits_per_sample;
+        entry.ex_size = header.riff.fmt.ex_size;
+        if (header.riff.fact.header.fourcc == MAKE_FOURCC('f', 'a', 'c', 't')) {
+            entry.fact_size = header.riff.fact.header.size;
+            entry.fact_samples = header.riff.fact.samples;
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // WaveCatalog
+    WaveCatalog::WaveCatalog() {}
+
+    WaveCatalog::~WaveCatalog() {
+        Close();
+    }
+
+    int64_t WaveCatalog::Build(const std::string& rootDir, const std::string& indexPath, AsyncIO::IOEngine* engine){
+        if (rootDir.size() == 0 || indexPath.size() == 0) return -1;
+
+        std::unique_ptr<AsyncIO::IOEngine> ownEngine;
+        if (!engine) {
+            ownEngine = AsyncIO::CreateIOEngine(kQueueDepth);
+            if (!ownEngine) return -1;
+            engine = ownEngine.get();
+        }
+
+        std::vector<std::string> filePaths;
+        ListWaveFiles(rootDir, filePaths);
+
+        // 复用旧索引中未变化的记录
+        WaveCatalog oldCatalog;
+        bool hasOld = oldCatalog.Open(indexPath);
+
+        std::vector<WaveFileInfo> infos(filePaths.size());
+        std::vector<bool> valid(filePaths.size(), false);
+        std::vector<size_t> toParse;
+        for (size_t i = 0; i < filePaths.size(); i++) {
+            WaveFileInfo& info = infos[i];
+            if (!StatFile(filePaths[i], info.fileSize, info.mtime)) continue;
+
+            int64_t index = hasOld ? oldCatalog.Find(filePaths[i]) : -1;
+            if (index >= 0) {
+                const CatalogEntry* entries = (const CatalogEntry*)(oldCatalog.m_data + sizeof(CatalogFileHeader));
+                const CatalogEntry& entry = entries[index];
+                if (entry.file_size == info.fileSize && entry.mtime == info.mtime) {
+                    EntryToInfo(entry, info);
+                    valid[i] = true;
+                    continue;
+                }
+            }
+            toParse.push_back(i);
+        }
+        oldCatalog.Close();
+
+        // 同时读取多个文件的开头并解析
+        for (size_t begin = 0; begin < toParse.size(); begin += kFilesPerRound) {
+            size_t end = std::min(toParse.size(), begin + kFilesPerRound);
+            std::vector<int> fds;
+            for (size_t k = begin; k < end; k++) {
+                fds.push_back(AsyncIO::OpenFileForRead(filePaths[toParse[k]]));
+            }
+
+            std::vector<std::vector<uint8_t>> heads;
+            AsyncIO::BatchReadHead(*engine, fds, kHeadSize, heads);
+
+            for (size_t k = begin; k < end; k++) {
+                size_t i = toParse[k];
+                const std::vector<uint8_t>& head = heads[k - begin];
+                AsyncIO::CloseFile(fds[k - begin]);
+
+                WaveHeader header;
+                uint32_t dataOffset = 0;
+                if (!head.empty() && ParseWaveHeader(&head[0], head.size(), header, dataOffset)) {
+                    FillDataRange(header, dataOffset, infos[i]);
+                    valid[i] = true;
+                } else if (head.size() == kHeadSize) {
+                    // data 子块前有较大的其他子块
+                    valid[i] = GetWaveFileInfo(filePaths[i], infos[i]);
+                }
+            }
+        }
+
+        // 生成记录和字符串表，按 (path_hash, path) 排序
+        std::vector<CatalogEntry> entries;
+        std::string strings;
+        for (size_t i = 0; i < filePaths.size(); i++) {
+            if (!valid[i]) continue;
+            CatalogEntry entry;
+            InfoToEntry(infos[i], entry);
+            entry.path_hash = HashPath(filePaths[i].c_str(), filePaths[i].size());
+            entry.path_offset = strings.size();
+            entry.path_len = (uint32_t)filePaths[i].size();
+            strings += filePaths[i];
+            entries.push_back(entry);
+        }
+
+        std::sort(entries.begin(), entries.end(), [&](const CatalogEntry& a, const CatalogEntry& b){
+            if (a.path_hash != b.path_hash) return a.path_hash < b.path_hash;
+            return strings.compare(a.path_offset, a.path_len, strings, b.path_offset, b.path_len) < 0;
+        });
+
+        CatalogFileHeader fileHeader;
+        memset(&fileHeader, 0, sizeof(fileHeader));
+        memcpy(fileHeader.magic, "WCAT", 4);
+        fileHeader.version = kCatalogVersion;
+        fileHeader.entry_count = (uint32_t)entries.size();
+        fileHeader.entry_size = sizeof(CatalogEntry);
+        fileHeader.strings_offset = sizeof(CatalogFileHeader) + entries.size() * sizeof(CatalogEntry);
+        fileHeader.strings_size = strings.size();
+
+        // 先写临时文件再改名，已经 mmap 旧索引的进程不受影响
+        std::string tmpPath = indexPath + ".tmp";
+        FILE* fp = fopen(tmpPath.c_str(), "wb");
+        if (!fp) {
+            printf("open catalog file failed, %s\n", tmpPath.c_str());
+            return -1;
+        }
+        bool success = fwrite(&fileHeader, sizeof(fileHeader), 1, fp) == 1;
+        if (success && !entries.empty()) success = fwrite(&entries[0], sizeof(CatalogEntry), entries.size(), fp) == entries.size();
+        if (success && !strings.empty()) success = fwrite(strings.data(), 1, strings.size(), fp) == strings.size();
+        success = (fclose(fp) == 0) && success;
+
+#ifdef WIN32
+        remove(indexPath.c_str());
+#endif
+        if (!success || rename(tmpPath.c_str(), indexPath.c_str()) != 0) {
+            remove(tmpPath.c_str());
+            return -1;
+        }
+        return (int64_t)entries.size();
+    }
+
+    bool WaveCatalog::Open(const std::string& indexPath){
+        if (indexPath.size() == 0) return false;
+        if (m_data) return false;
+
+#ifdef WIN32
+        FILE* fp = fopen(indexPath.c_str(), "rb");
+        if (!fp) return false;
+        fseek(fp, 0L, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0L, SEEK_SET);
+        if (size > 0) {
+            m_buffer.resize(size);
+            if (fread(&m_buffer[0], 1, size, fp) != (size_t)size) m_buffer.clear();
+        }
+        fclose(fp);
+        if (m_buffer.empty()) return false;
+        m_data = &m_buffer[0];
+        m_size = m_buffer.size();
+#else
+        int fd = open(indexPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        m_data = (const uint8_t*)p;
+        m_size = (size_t)st.st_size;
+#endif
+
+        // 校验文件头和各部分的范围
+        const CatalogFileHeader* header = (const CatalogFileHeader*)m_data;
+        bool valid = m_size >= sizeof(CatalogFileHeader)
+                     && memcmp(header->magic, "WCAT", 4) == 0
+                     && header->version == kCatalogVersion
+                     && header->entry_size == sizeof(CatalogEntry)
+                     && header->strings_offset == sizeof(CatalogFileHeader) + (uint64_t)header->entry_count * sizeof(CatalogEntry)
+                     && header->strings_offset + header->strings_size <= m_size;
+        if (!valid) {
+            printf("invalid catalog file, %s\n", indexPath.c_str());
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    int64_t WaveCatalog::Find(const std::string& waveFilePath) const {
+        if (!m_data) return -1;
+
+        const CatalogFileHeader* header = (const CatalogFileHeader*)m_data;
+        const CatalogEntry* entries = (const CatalogEntry*)(m_data + sizeof(CatalogFileHeader));
+        const char* strings = (const char*)(m_data + header->strings_offset);
+        uint64_t hash = HashPath(waveFilePath.c_str(), waveFilePath.size());
+
+        const CatalogEntry* end = entries + header->entry_count;
+        const CatalogEntry* it = std::lower_bound(entries, end, hash, [](const CatalogEntry& entry, uint64_t h){
+            return entry.path_hash < h;
+        });
+        for (; it != end && it->path_hash == hash; ++it) {
+            if (it->path_offset + it->path_len > header->strings_size) continue;
+            if (it->path_len == waveFilePath.size() && memcmp(strings + it->path_offset, waveFilePath.c_str(), it->path_len) == 0) {
+                return it - entries;
+            }
+        }
+        return -1;
+    }
+
+    bool WaveCatalog::Lookup(const std::string& waveFilePath, WaveFileInfo& info, bool* fromCatalog) const {
+        if (fromCatalog) *fromCatalog = false;
+
+        int64_t index = Find(waveFilePath);
+        if (index >= 0) {
+            uint64_t fileSize = 0;
+            int64_t mtime = 0;
+            if (!StatFile(waveFilePath, fileSize, mtime)) return false;
+
+            const CatalogEntry* entries = (const CatalogEntry*)(m_data + sizeof(CatalogFileHeader));
+            const CatalogEntry& entry = entries[index];
+            if (entry.file_size == fileSize && entry.mtime == mtime) {
+                EntryToInfo(entry, info);
+                if (fromCatalog) *fromCatalog = true;
+                return true;
+            }
+        }
+
+        // 没有记录或者记录已过期，重新解析
+        return GetWaveFileInfo(waveFilePath, info);
+    }
+
+    uint32_t WaveCatalog::GetEntryCount() const {
+        if (!m_data) return 0;
+        return ((const CatalogFileHeader*)m_data)->entry_count;
+    }
+
+    bool WaveCatalog::GetEntry(uint32_t index, std::string& waveFilePath, WaveFileInfo& info) const {
+        if (index >= GetEntryCount()) return false;
+
+        const CatalogFileHeader* header = (const CatalogFileHeader*)m_data;
+        const CatalogEntry& entry = ((const CatalogEntry*)(m_data + sizeof(CatalogFileHeader)))[index];
+        if (entry.path_offset + entry.path_len > header->strings_size) return false;
+
+        waveFilePath.assign((const char*)(m_data + header->strings_offset + entry.path_offset), entry.path_len);
+        EntryToInfo(entry, info);
+        return true;
+    }
+
+    void WaveCatalog::Close(){
+        if (!m_data) return;
+#ifdef WIN32
+        m_buffer.clear();
+#else
+        munmap((void*)m_data, m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
@@ -0,0 +1,96 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef WAVE_CATALOG_H_
+#define WAVE_CATALOG_H_
+
+#include "WaveFile.h"
+#include "AsyncIO/AsyncIO.h"
+
+namespace WaveCodec {
+
+    // WaveFileInfo: 一个 Wave 文件的头信息，不需要打开文件即可获得格式、时长和数据位置
+    struct WaveFileInfo {
+        WaveHeader header;        // 解析出的 Wave Header
+        uint32_t dataOffset = 0;  // 音频数据在文件中的偏移
+        uint32_t dataSize   = 0;  // 音频数据的长度，已按文件实际大小截断
+        uint64_t fileSize   = 0;  // 文件大小
+        int64_t  mtime      = 0;  // 文件修改时间，纳秒
+
+        // GetDurationMs: 音频时长，单位毫秒，byte_rate 为 0 时返回 0
+        uint64_t GetDurationMs() const {
+            if(header.riff.fmt.byte_rate == 0) return 0;
+            return (uint64_t)dataSize * 1000 / header.riff.fmt.byte_rate;
+        }
+    };
+
+    // GetWaveFileInfo: 打开并解析一个 Wave 文件，得到 WaveFileInfo
+    // * waveFilePath : Wave 文件路径
+    // * info         : 解析出的文件信息
+    // * 返回值        : 解析是否成功
+    bool GetWaveFileInfo(const std::string& waveFilePath, WaveFileInfo& info);
+
+    /*example code
+
+        // 一次性扫描，生成索引文件
+        WaveCatalog::Build("/data/archive", "/data/archive.wcat");
+
+        // 任务启动时打开索引
+        WaveCatalog catalog;
+        catalog.Open("/data/archive.wcat");
+        WaveFileInfo info;
+        if(catalog.Lookup("/data/archive/2026/10/a.wav", info)){
+            // info.header.riff.fmt.sample_rate, info.GetDurationMs(), info.dataOffset ...
+        }
+    */
+
+    // WaveCatalog: 持久化的 Wave Header 索引
+    // 索引文件是定长记录 + 字符串表，可以直接 mmap，查询时只需要一次 stat 校验 mtime 和大小
+    class WaveCatalog {
+    public:
+        WaveCatalog();
+        ~WaveCatalog();
+
+        // Build: 扫描 rootDir 目录树下的所有 .wav 文件，生成索引文件
+        // 如果 indexPath 已存在，其中 mtime 和大小未变化的记录会被复用，不重新解析
+        // 文件头通过异步 IO 同时读取
+        // * rootDir   : 要扫描的根目录
+        // * indexPath : 索引文件路径
+        // * engine    : 异步 IO 引擎，为空时内部创建一个
+        // * 返回值     : 成功时返回索引中的文件个数，失败返回 -1
+        static int64_t Build(const std::string& rootDir, const std::string& indexPath, AsyncIO::IOEngine* engine = nullptr);
+
+        // Open: 打开(mmap)索引文件
+        bool Open(const std::string& indexPath);
+
+        // Lookup: 查询文件的头信息
+        // 如果索引中没有该文件，或者文件的 mtime/大小与索引不一致，则重新解析文件
+        // * waveFilePath : 文件路径，需要和 Build 时扫描得到的路径一致 (rootDir + 相对路径)
+        // * info         : 文件信息
+        // * fromCatalog  : [可选] 返回结果是否来自索引
+        // * 返回值        : 是否获得了文件信息
+        bool Lookup(const std::string& waveFilePath, WaveFileInfo& info, bool* fromCatalog = nullptr) const;
+
+        // GetEntryCount: 索引中的文件个数
+        uint32_t GetEntryCount() const;
+
+        // GetEntry: 获取第 index 条记录，不校验 mtime
+        bool GetEntry(uint32_t index, std::string& waveFilePath, WaveFileInfo& info) const;
+
+        void Close();
+
+    private:
+        WaveCatalog(const WaveCatalog&);
+        WaveCatalog& operator=(const WaveCatalog&);
+
+        // 在索引中查找，返回记录下标，未找到返回 -1
+        int64_t Find(const std::string& waveFilePath) const;
+
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+        std::vector<uint8_t> m_buffer; // 不支持 mmap 的平台，索引文件读入内存
+    };
+}
+
+#endif //WAVE_CATALOG_H_
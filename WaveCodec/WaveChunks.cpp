@@ -0,0 +1,221 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "WaveChunks.h"
+#include "ByteSwap.h"
+#include "AsyncIO/AsyncIO.h"
+
+#include <algorithm>
+
+namespace WaveCodec {
+
+    // RF64 文件中，大小超过 4GB 的块的 size 字段为 0xFFFFFFFF，实际大小记录在 ds64 块中
+    static const uint32_t kRF64SizePlaceholder = 0xFFFFFFFF;
+
+    static uint32_t ToFourcc(const uint8_t* p){
+        return MAKE_FOURCC(p[0], p[1], p[2], p[3]);
+    }
+
+    // 读取文件中的 16/32/64bit 整数，swap 为 true 时交换字节序
+    static uint16_t GetU16(const uint8_t* p, bool swap){
+        uint16_t v;
+        memcpy(&v, p, sizeof(v));
+        return swap ? ByteSwap16(v) : v;
+    }
+
+    static uint32_t GetU32(const uint8_t* p, bool swap){
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return swap ? ByteSwap32(v) : v;
+    }
+
+    static uint64_t GetU64(const uint8_t* p, bool swap){
+        uint32_t lo = GetU32(p, swap);
+        uint32_t hi = GetU32(p + 4, swap);
+        return swap ? (((uint64_t)lo << 32) | hi) : (((uint64_t)hi << 32) | lo);
+    }
+
+    RiffChunkDirectory::RiffChunkDirectory() {
+
+    }
+
+    RiffChunkDirectory::~RiffChunkDirectory() {
+        Close();
+    }
+
+    bool RiffChunkDirectory::Open(const std::string& waveFilePath){
+        if (waveFilePath.size() == 0) return false;
+        if (m_fd >= 0) return false;
+
+        m_fd = AsyncIO::OpenFileForRead(waveFilePath);
+        if (m_fd < 0) {
+            printf("open file failed\n");
+            return false;
+        }
+
+        int64_t fileSize = AsyncIO::GetFileSize(m_fd);
+        uint8_t riff[12];
+        if (fileSize < 12 || AsyncIO::ReadFileAt(m_fd, riff, sizeof(riff), 0) != (int64_t)sizeof(riff)) {
+            printf("invalid riff file, too small\n");
+            Close();
+            return false;
+        }
+        m_fileSize = (uint64_t)fileSize;
+
+        bool rf64 = false;
+        if (memcmp(riff, "RIFF", 4) == 0) {
+            m_bigEndian = false;
+        } else if (memcmp(riff, "RIFX", 4) == 0) {
+            m_bigEndian = true;
+        } else if (memcmp(riff, "RF64", 4) == 0) {
+            rf64 = true;
+        } else {
+            printf("invalid riff file, riff fourcc error\n");
+            Close();
+            return false;
+        }
+        m_formType = ToFourcc(riff + 8);
+        const bool swap = (m_bigEndian == IsLittleEndianHost());
+
+        // 逐个读取块头，跳过块内容
+        uint64_t ds64DataSize = 0;
+        uint64_t pos = 12;
+        while (pos + 8 <= m_fileSize) {
+            uint8_t header[8];
+            if (AsyncIO::ReadFileAt(m_fd, header, sizeof(header), pos) != (int64_t)sizeof(header)) break;
+
+            RiffChunk chunk;
+            chunk.fourcc = ToFourcc(header);
+            chunk.offset = pos + 8;
+            chunk.size = GetU32(header + 4, swap);
+
+            if (rf64 && chunk.fourcc == MAKE_FOURCC('d', 's', '6', '4') && chunk.size >= 16) {
+                // ds64: riff size(8) + data size(8) + sample count(8) + ...
+                uint8_t ds64[16];
+                if (AsyncIO::ReadFileAt(m_fd, ds64, sizeof(ds64), chunk.offset) == (int64_t)sizeof(ds64)) {
+                    ds64DataSize = GetU64(ds64 + 8, swap);
+                }
+            } else if (rf64 && chunk.fourcc == MAKE_FOURCC('d', 'a', 't', 'a') && chunk.size == kRF64SizePlaceholder) {
+                chunk.size = ds64DataSize;
+            }
+
+            // 文件被截断时，最后一个块只保留实际存在的部分
+            bool truncated = chunk.size > m_fileSize - chunk.offset;
+            if (truncated) {
+                chunk.size = m_fileSize - chunk.offset;
+            }
+            m_chunks.push_back(chunk);
+            if (truncated) break;
+
+            // 块按 2 字节对齐
+            pos = chunk.offset + chunk.size + (chunk.size & 1);
+        }
+
+        m_payloads.resize(m_chunks.size());
+        m_loaded.assign(m_chunks.size(), false);
+        return true;
+    }
+
+    int RiffChunkDirectory::FindChunk(const char* fourcc, int nth) const {
+        if (!fourcc) return -1;
+
+        uint8_t name[4] = {' ', ' ', ' ', ' '};
+        for (int i = 0; i < 4 && fourcc[i] != 0; i++) {
+            name[i] = (uint8_t)fourcc[i];
+        }
+        return FindChunk(ToFourcc(name), nth);
+    }
+
+    int RiffChunkDirectory::FindChunk(uint32_t fourcc, int nth) const {
+        for (size_t i = 0; i < m_chunks.size(); i++) {
+            if (m_chunks[i].fourcc != fourcc) continue;
+            if (nth == 0) return (int)i;
+            nth--;
+        }
+        return -1;
+    }
+
+    const std::vector<uint8_t>* RiffChunkDirectory::LoadChunk(int index){
+        if (m_fd < 0 || index < 0 || (size_t)index >= m_chunks.size()) return nullptr;
+        if (m_loaded[index]) return &m_payloads[index];
+
+        const RiffChunk& chunk = m_chunks[index];
+        std::vector<uint8_t>& payload = m_payloads[index];
+        payload.resize((size_t)chunk.size);
+        if (chunk.size > 0 && AsyncIO::ReadFileAt(m_fd, &payload[0], payload.size(), chunk.offset) != (int64_t)payload.size()) {
+            printf("read chunk %s failed\n", chunk.GetName().c_str());
+            std::vector<uint8_t>().swap(payload);
+            return nullptr;
+        }
+
+        m_loaded[index] = true;
+        return &payload;
+    }
+
+    int64_t RiffChunkDirectory::ReadChunk(int index, uint64_t offset, void* buffer, size_t length) const {
+        if (m_fd < 0 || index < 0 || (size_t)index >= m_chunks.size() || !buffer) return -1;
+
+        const RiffChunk& chunk = m_chunks[index];
+        if (offset >= chunk.size) return 0;
+        if (length > chunk.size - offset) length = (size_t)(chunk.size - offset);
+        return AsyncIO::ReadFileAt(m_fd, buffer, length, chunk.offset + offset);
+    }
+
+    bool RiffChunkDirectory::GetWaveHeader(WaveHeader& header, uint64_t& dataOffset, uint64_t& dataSize){
+        if (m_formType != MAKE_FOURCC('W', 'A', 'V', 'E')) return false;
+
+        int fmtIndex = FindChunk("fmt ");
+        int dataIndex = FindChunk("data");
+        const std::vector<uint8_t>* fmt = LoadChunk(fmtIndex);
+        if (!fmt || fmt->size() < 16 || dataIndex < 0) return false;
+
+        const bool swap = (m_bigEndian == IsLittleEndianHost());
+        const uint8_t* body = &(*fmt)[0];
+
+        header = WaveHeader();
+        header.riff.header.fourcc = m_bigEndian ? MAKE_FOURCC('R', 'I', 'F', 'X') : MAKE_FOURCC('R', 'I', 'F', 'F');
+        header.riff.header.size = (uint32_t)std::min<uint64_t>(m_fileSize - 8, 0xFFFFFFFF);
+        header.riff.form_type = m_formType;
+
+        header.riff.fmt.header.fourcc = MAKE_FOURCC('f', 'm', 't', ' ');
+        header.riff.fmt.header.size = (uint32_t)fmt->size();
+        header.riff.fmt.audio_format    = GetU16(body + 0, swap);
+        header.riff.fmt.channels        = GetU16(body + 2, swap);
+        header.riff.fmt.sample_rate     = GetU32(body + 4, swap);
+        header.riff.fmt.byte_rate       = GetU32(body + 8, swap);
+        header.riff.fmt.block_align     = GetU16(body + 12, swap);
+        header.riff.fmt.bits_per_sample = GetU16(body + 14, swap);
+        if (fmt->size() >= 18) {
+            header.riff.fmt.ex_size = GetU16(body + 16, swap);
+        }
+
+        const std::vector<uint8_t>* fact = LoadChunk(FindChunk("fact"));
+        if (fact && fact->size() >= 4) {
+            header.riff.fact.header.fourcc = MAKE_FOURCC('f', 'a', 'c', 't');
+            header.riff.fact.header.size = (uint32_t)fact->size();
+            header.riff.fact.samples = GetU32(&(*fact)[0], swap);
+        }
+
+        const RiffChunk& data = m_chunks[dataIndex];
+        header.riff.data.header.fourcc = MAKE_FOURCC('d', 'a', 't', 'a');
+        header.riff.data.header.size = (uint32_t)std::min<uint64_t>(data.size, 0xFFFFFFFF);
+
+        dataOffset = data.offset;
+        dataSize = data.size;
+        return true;
+    }
+
+    void RiffChunkDirectory::Close(){
+        if (m_fd >= 0) {
+            AsyncIO::CloseFile(m_fd);
+            m_fd = -1;
+        }
+        m_fileSize = 0;
+        m_formType = 0;
+        m_bigEndian = false;
+        m_chunks.clear();
+        m_payloads.clear();
+        m_loaded.clear();
+    }
+}
@@ -0,0 +1,99 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef WAVE_CHUNKS_H_
+#define WAVE_CHUNKS_H_
+
+#include "WaveFile.h"
+
+namespace WaveCodec {
+
+    // RiffChunk: 块目录中的一项
+    struct RiffChunk {
+        uint32_t fourcc = 0; // 块id，与 MAKE_FOURCC 相同的顺序
+        uint64_t offset = 0; // 块内容(不含 fourcc 和 size)在文件中的偏移
+        uint64_t size   = 0; // 块内容的长度，已按文件实际大小截断
+
+        // GetName: 块id 的字符串形式，如 "bext"
+        std::string GetName() const {
+            char name[5] = {(char)(fourcc & 0xFF), (char)((fourcc >> 8) & 0xFF), (char)((fourcc >> 16) & 0xFF), (char)(fourcc >> 24), 0};
+            return name;
+        }
+    };
+
+    /*example code
+
+        RiffChunkDirectory dir;
+        dir.Open("test.wav");
+        int index = dir.FindChunk("bext");
+        if(index >= 0){
+            const std::vector<uint8_t>* bext = dir.LoadChunk(index);
+            // parse bext as you want
+        }
+        dir.Close();
+    */
+
+    // RiffChunkDirectory: RIFF/RIFX/RF64 文件的块目录
+    // Open 时只读取每个块的 8 字节块头，按块大小跳到下一个块，不读取音频数据
+    // 因此位于 data 之后的 LIST/cue /bext/iXML 等块也可以快速找到
+    // 块内容在第一次 LoadChunk 时读取并缓存
+    class RiffChunkDirectory {
+    public:
+        RiffChunkDirectory();
+        ~RiffChunkDirectory();
+
+        // Open: 打开文件并建立块目录
+        bool Open(const std::string& waveFilePath);
+
+        // IsBigEndian: 是否为 RIFX 文件
+        bool IsBigEndian() const { return m_bigEndian; }
+
+        // GetFormType: RIFF 的类型码，Wave 文件为 "WAVE"
+        uint32_t GetFormType() const { return m_formType; }
+
+        uint64_t GetFileSize() const { return m_fileSize; }
+
+        size_t GetChunkCount() const { return m_chunks.size(); }
+        const RiffChunk& GetChunk(size_t index) const { return m_chunks[index]; }
+
+        // FindChunk: 查找第 nth 个 id 为 fourcc 的块
+        // * fourcc : 块id，如 "LIST"，不足 4 个字符时用空格补齐
+        // * nth    : 同名块中的序号，从 0 开始
+        // * 返回值  : 块在目录中的下标，未找到返回 -1
+        int FindChunk(const char* fourcc, int nth = 0) const;
+        int FindChunk(uint32_t fourcc, int nth = 0) const;
+
+        // LoadChunk: 读取块的全部内容，结果被缓存，重复调用不会再次读取文件
+        // * 返回值 : 块内容，失败返回 nullptr；指针在 Close 之前一直有效
+        const std::vector<uint8_t>* LoadChunk(int index);
+
+        // ReadChunk: 读取块内容的一部分，不缓存，用于 data 等较大的块
+        // * index  : 块在目录中的下标
+        // * offset : 块内容中的偏移
+        // * buffer : 输出
+        // * length : 要读取的长度
+        // * 返回值  : 实际读取的长度，失败返回 -1
+        int64_t ReadChunk(int index, uint64_t offset, void* buffer, size_t length) const;
+
+        // GetWaveHeader: 根据 fmt /fact/data 块得到 Wave Header，以及音频数据的位置
+        // RIFX 文件的头信息被转换为本机字节序，RF64 文件的 data 大小超过 4GB 时截断为 0xFFFFFFFF
+        bool GetWaveHeader(WaveHeader& header, uint64_t& dataOffset, uint64_t& dataSize);
+
+        void Close();
+
+    private:
+        RiffChunkDirectory(const RiffChunkDirectory&);
+        RiffChunkDirectory& operator=(const RiffChunkDirectory&);
+
+        int m_fd = -1;
+        uint64_t m_fileSize = 0;
+        uint32_t m_formType = 0;
+        bool m_bigEndian = false;
+        std::vector<RiffChunk> m_chunks;
+        std::vector<std::vector<uint8_t> > m_payloads; // 已读取的块内容，与 m_chunks 一一对应
+        std::vector<bool> m_loaded;
+    };
+}
+
+#endif //WAVE_CHUNKS_H_
@@ -0,0 +1,145 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "WaveEdit.h"
+#include "WaveChunks.h"
+#include "AsyncIO/AsyncIO.h"
+#include "PCMCodec/PCMCrop.h"
+
+namespace WaveCodec {
+
+    // 输出文件中的一段数据
+    struct WaveSegment {
+        std::string path;
+        uint64_t dataOffset = 0; // 在源文件中的偏移
+        uint64_t dataSize = 0;
+    };
+
+    // 解析源文件，得到头信息和 data 块的位置，data 大小按 block_align 截断
+    static bool OpenWaveSource(const std::string& path, WaveHeader& header, WaveSegment& segment) {
+        RiffChunkDirectory dir;
+        segment.path = path;
+        if (!dir.Open(path) || !dir.GetWaveHeader(header, segment.dataOffset, segment.dataSize)) {
+            printf("parse wave header failed, %s\n", path.c_str());
+            return false;
+        }
+
+        uint16_t audio_format = header.riff.fmt.audio_format;
+        if (header.IsBigEndian() || (audio_format != WaveAudioFormatPCM && audio_format != WaveAudioFormatALaw && audio_format != WaveAudioFormatMuLaw)) {
+            printf("unsupported wave file, %s, %s%s\n", path.c_str(), header.IsBigEndian() ? "RIFX " : "",
+                   GetWaveAudioFormatString(audio_format).c_str());
+            return false;
+        }
+        if (header.riff.fmt.block_align == 0) {
+            printf("invalid block align, %s\n", path.c_str());
+            return false;
+        }
+
+        segment.dataSize -= segment.dataSize % header.riff.fmt.block_align;
+        return true;
+    }
+
+    // 写一个文件头，然后依次复制各段数据
+    static bool WriteWaveSegments(const std::string& dstPath, const WaveHeader& format, const std::vector<WaveSegment>& segments) {
+        uint64_t total = 0;
+        for (size_t i = 0; i < segments.size(); i++) {
+            total += segments[i].dataSize;
+        }
+
+        WaveHeader out;
+        out.riff.fmt.audio_format = format.riff.fmt.audio_format;
+        uint64_t headerSize = out.GetHeaderSize();
+        if (total + headerSize - 8 > 0xFFFFFFFF) {
+            printf("wave output exceeds 4GB, total data size:%llu\n", (unsigned long long)total);
+            return false;
+        }
+        if (format.riff.fmt.audio_format == WaveAudioFormatPCM) {
+            out.FormatPCMWaveHeader(format.riff.fmt.sample_rate, format.riff.fmt.bits_per_sample, format.riff.fmt.channels, (uint32_t)total);
+        } else {
+            out.FormatG711WaveHeader(format.riff.fmt.audio_format, format.riff.fmt.sample_rate, format.riff.fmt.bits_per_sample, format.riff.fmt.channels, (uint32_t)total);
+        }
+
+        int dstFd = AsyncIO::OpenFileForWrite(dstPath);
+        if (dstFd < 0) {
+            printf("open file failed, %s\n", dstPath.c_str());
+            return false;
+        }
+
+        std::vector<uint8_t> buffer;
+        out.ToBuffer(buffer);
+        bool ret = AsyncIO::WriteFileAt(dstFd, &buffer[0], buffer.size(), 0) == (int64_t)buffer.size();
+
+        uint64_t dstOffset = headerSize;
+        for (size_t i = 0; ret && i < segments.size(); i++) {
+            int srcFd = AsyncIO::OpenFileForRead(segments[i].path);
+            int64_t copied = AsyncIO::CopyFileRange(srcFd, segments[i].dataOffset, dstFd, dstOffset, segments[i].dataSize);
+            AsyncIO::CloseFile(srcFd);
+            if (copied != (int64_t)segments[i].dataSize) {
+                printf("copy wave data failed, %s\n", segments[i].path.c_str());
+                ret = false;
+            }
+            dstOffset += segments[i].dataSize;
+        }
+
+        AsyncIO::CloseFile(dstFd);
+        return ret;
+    }
+
+    static bool IsSameFormat(const WaveHeader& a, const WaveHeader& b) {
+        return a.riff.fmt.audio_format == b.riff.fmt.audio_format
+            && a.riff.fmt.sample_rate == b.riff.fmt.sample_rate
+            && a.riff.fmt.bits_per_sample == b.riff.fmt.bits_per_sample
+            && a.riff.fmt.channels == b.riff.fmt.channels
+            && a.riff.fmt.block_align == b.riff.fmt.block_align;
+    }
+
+    bool ConcatWaveFiles(const std::vector<std::string>& srcPaths, const std::string& dstPath) {
+        if (srcPaths.empty()) return false;
+
+        // 先检查所有文件，格式不一致时不创建输出文件
+        WaveHeader format;
+        std::vector<WaveSegment> segments(srcPaths.size());
+        for (size_t i = 0; i < srcPaths.size(); i++) {
+            if (AsyncIO::IsSameFile(srcPaths[i], dstPath)) {
+                printf("output file is also an input file, %s\n", dstPath.c_str());
+                return false;
+            }
+
+            WaveHeader header;
+            if (!OpenWaveSource(srcPaths[i], header, segments[i])) return false;
+
+            if (i == 0) {
+                format = header;
+            } else if (!IsSameFormat(format, header)) {
+                printf("wave format mismatch, %s: %d %dHz %dbit %dch, %s: %d %dHz %dbit %dch\n",
+                       srcPaths[0].c_str(), format.riff.fmt.audio_format, format.riff.fmt.sample_rate, format.riff.fmt.bits_per_sample, format.riff.fmt.channels,
+                       srcPaths[i].c_str(), header.riff.fmt.audio_format, header.riff.fmt.sample_rate, header.riff.fmt.bits_per_sample, header.riff.fmt.channels);
+                return false;
+            }
+        }
+
+        return WriteWaveSegments(dstPath, format, segments);
+    }
+
+    bool CropWaveFile(const std::string& srcPath, const std::string& dstPath, uint32_t startMs, uint32_t endMs) {
+        WaveHeader header;
+        WaveSegment segment;
+        if (AsyncIO::IsSameFile(srcPath, dstPath)) {
+            printf("output file is also the input file, %s\n", dstPath.c_str());
+            return false;
+        }
+        if (!OpenWaveSource(srcPath, header, segment)) return false;
+
+        uint64_t offset = 0, length = 0;
+        if (!PCMCodec::GetCropRange(header.riff.fmt.sample_rate, header.riff.fmt.block_align, segment.dataSize, startMs, endMs, offset, length)) {
+            printf("invalid crop params, sample_rate:%d, block_align:%d, startMs:%d, endMs:%d\n",
+                   header.riff.fmt.sample_rate, header.riff.fmt.block_align, startMs, endMs);
+            return false;
+        }
+        segment.dataOffset += offset;
+        segment.dataSize = length;
+
+        return WriteWaveSegments(dstPath, header, std::vector<WaveSegment>(1, segment));
+    }
+}
@@ -0,0 +1,32 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef WAVE_EDIT_H_
+#define WAVE_EDIT_H_
+
+#include "WaveFile.h"
+
+namespace WaveCodec {
+
+    // ConcatWaveFiles: 将多个格式相同的 Wave 文件拼接为一个文件
+    // 各文件的头信息由块目录解析，要求编码格式、采样率、位深、声道数都相同，只支持 PCM/ALaw/MuLaw 的 RIFF 文件
+    // 输出文件只写一个文件头，各文件 data 块中的数据通过 AsyncIO::CopyFileRange 在内核中直接复制，不经过 PCM 中间文件
+    // 每个文件的数据按 block_align 截断，保证拼接处不会出现半个采样
+    // * srcPaths : 要拼接的文件，按顺序拼接
+    // * dstPath  : 输出文件
+    // * 返回值    : 是否成功，格式不一致、输出文件与某个源文件相同或输出超过 4GB 时返回 false
+    bool ConcatWaveFiles(const std::vector<std::string>& srcPaths, const std::string& dstPath);
+
+    // CropWaveFile: 截取 Wave 文件中 [startMs, endMs) 的数据，保存为新的 Wave 文件
+    // 起止位置按帧对齐(见 PCMCodec::GetCropRange)，输出文件头中的 data/fact 大小与截取的长度一致
+    // 数据与 ConcatWaveFiles 一样通过 AsyncIO::CopyFileRange 复制，内存占用与截取长度无关
+    // * srcPath : 原始文件，PCM/ALaw/MuLaw 的 RIFF 文件
+    // * dstPath : 输出文件，不能与 srcPath 相同
+    // * startMs : 开始时间
+    // * endMs   : 结束时间，必须大于 startMs，超过文件时长时截取到末尾
+    // * 返回值   : 是否成功
+    bool CropWaveFile(const std::string& srcPath, const std::string& dstPath, uint32_t startMs, uint32_t endMs);
+}
+
+#endif //WAVE_EDIT_H_
@@ -3,6 +3,7 @@
 //
 
 #include "WaveFile.h"
+#include "ByteSwap.h"
 
 #define READ_AND_CHECK(ptr, size, cnt, fp) { \
       size_t read_cnt = fread(ptr, size, cnt, fp); \
@@ -13,6 +14,10 @@
 
 namespace WaveCodec {
 
+    // 文件中整数的字节序与本机不同时，读出的整数需要交换字节序
+    static uint16_t FixEndian16(uint16_t v, bool swap){ return swap ? ByteSwap16(v) : v; }
+    static uint32_t FixEndian32(uint32_t v, bool swap){ return swap ? ByteSwap32(v) : v; }
+
     std::string GetWaveAudioFormatString(uint16_t audio_format){
         if(audio_format == WaveAudioFormatPCM) return "PCM";
         if(audio_format == WaveAudioFormatMSADPCM) return "Microsoft ADPCM";
@@ -21,11 +26,70 @@ namespace WaveCodec {
         if(audio_format == WaveAudioFormatMuLaw) return "8-bit ITU-T G.711 mu-law";
         if(audio_format == WaveAudioFormatGSM) return "GSM 6.10";
         if(audio_format == WaveAudioFormatG721) return "ITU G.721 ADPCM";
+        if(audio_format == WaveAudioFormatG722) return "ITU G.722 ADPCM";
         if(audio_format == WaveAudioFormatExtensible) return "Extensible";
 
         return "unknown";
     }
 
+    bool ParseWaveHeader(const uint8_t* buffer, size_t bufferSize, WaveHeader& header, uint32_t& dataOffset){
+        if(!buffer || bufferSize < 12) return false;
+
+        // riff chunk
+        if(memcmp(buffer, "RIFF", 4) != 0 || memcmp(buffer + 8, "WAVE", 4) != 0){
+            return false;
+        }
+        header = WaveHeader();
+        header.riff.header.fourcc = MAKE_FOURCC('R', 'I', 'F', 'F');
+        memcpy(&header.riff.header.size, buffer + 4, sizeof(uint32_t));
+        header.riff.form_type = MAKE_FOURCC('W', 'A', 'V', 'E');
+
+        // sub chunks
+        size_t pos = 12;
+        bool fmtFound = false;
+        while(pos + 8 <= bufferSize){
+            const uint8_t* name = buffer + pos;
+            uint32_t sub_chunk_size = 0;
+            memcpy(&sub_chunk_size, buffer + pos + 4, sizeof(uint32_t));
+            const uint8_t* body = buffer + pos + 8;
+            size_t bodySize = bufferSize - pos - 8; // buffer 中该子块可用的长度
+
+            if(memcmp(name, "fmt ", 4) == 0){
+                if(sub_chunk_size < 16 || bodySize < 16) return false;
+                header.riff.fmt.header.fourcc = MAKE_FOURCC('f', 'm', 't', ' ');
+                header.riff.fmt.header.size = sub_chunk_size;
+                memcpy(&header.riff.fmt.audio_format,    body + 0,  sizeof(uint16_t));
+                memcpy(&header.riff.fmt.channels,        body + 2,  sizeof(uint16_t));
+                memcpy(&header.riff.fmt.sample_rate,     body + 4,  sizeof(uint32_t));
+                memcpy(&header.riff.fmt.byte_rate,       body + 8,  sizeof(uint32_t));
+                memcpy(&header.riff.fmt.block_align,     body + 12, sizeof(uint16_t));
+                memcpy(&header.riff.fmt.bits_per_sample, body + 14, sizeof(uint16_t));
+                if(sub_chunk_size >= 18 && bodySize >= 18){
+                    memcpy(&header.riff.fmt.ex_size, body + 16, sizeof(uint16_t));
+                }
+                fmtFound = true;
+            }
+            else if(memcmp(name, "fact", 4) == 0){
+                if(sub_chunk_size < 4 || bodySize < 4) return false;
+                header.riff.fact.header.fourcc = MAKE_FOURCC('f', 'a', 'c', 't');
+                header.riff.fact.header.size = sub_chunk_size;
+                memcpy(&header.riff.fact.samples, body, sizeof(uint32_t));
+            }
+            else if(memcmp(name, "data", 4) == 0){
+                if(!fmtFound) return false;
+                header.riff.data.header.fourcc = MAKE_FOURCC('d', 'a', 't', 'a');
+                header.riff.data.header.size = sub_chunk_size;
+                dataOffset = (uint32_t)(pos + 8);
+                return true;
+            }
+
+            // 子块按 2 字节对齐
+            pos += 8 + (size_t)sub_chunk_size + (sub_chunk_size & 1);
+        }
+
+        return false;
+    }
+
     ///////////////////////////////////////////////////
     // WaveFileReader
     WaveFileReader::WaveFileReader() {
@@ -72,18 +136,20 @@ namespace WaveCodec {
         long file_size = ftell(m_fp);
         fseek(m_fp, 0L, SEEK_SET);
 
-        // read riff chunk fourcc
+        // read riff chunk fourcc, "RIFF" 为小端存储，"RIFX" 为大端存储
         uint8_t fourcc[4];
         READ_AND_CHECK(fourcc,sizeof(uint8_t), 4, m_fp )
-        if (fourcc[0] != 'R' || fourcc[1] != 'I' || fourcc[2] != 'F' || fourcc[3] != 'F') {
+        if (fourcc[0] != 'R' || fourcc[1] != 'I' || fourcc[2] != 'F' || (fourcc[3] != 'F' && fourcc[3] != 'X')) {
             printf("invalid wave file, riff fourcc error\n");
             return false;
         }
-        m_header.riff.header.fourcc = MAKE_FOURCC('R', 'I', 'F', 'F');
+        m_header.riff.header.fourcc = MAKE_FOURCC('R', 'I', 'F', fourcc[3]);
+        const bool swap = (m_header.IsBigEndian() == IsLittleEndianHost());
 
         // read RIFF chunk size
         uint32_t riff_chunk_size = 0;
         READ_AND_CHECK(&riff_chunk_size, sizeof(uint32_t), 1, m_fp);
+        riff_chunk_size = FixEndian32(riff_chunk_size, swap);
 
         // check RIFF chunk size
         if ((uint32_t)file_size != riff_chunk_size + sizeof(fourcc) + sizeof(riff_chunk_size)) {
@@ -111,6 +177,7 @@ namespace WaveCodec {
             // sub chunk size
             uint32_t sub_chunk_size = 0;
             READ_AND_CHECK(&sub_chunk_size, sizeof(uint32_t), 1, m_fp);
+            sub_chunk_size = FixEndian32(sub_chunk_size, swap);
             printf("sub chunk size: %d\n", sub_chunk_size);
 
             // Handle sub chunk
@@ -123,31 +190,37 @@ namespace WaveCodec {
                 // audio format
                 uint16_t audio_format = WaveAudioFormatUnknown;
                 READ_AND_CHECK(&audio_format, sizeof(uint16_t), 1, m_fp);
+                audio_format = FixEndian16(audio_format, swap);
                 m_header.riff.fmt.audio_format = audio_format;
 
                 // channels
                 uint16_t channels = 0;
                 READ_AND_CHECK(&channels, sizeof(uint16_t), 1, m_fp);
+                channels = FixEndian16(channels, swap);
                 m_header.riff.fmt.channels = channels;
 
                 // sample_rate
                 uint32_t sample_rate = 0;
                 READ_AND_CHECK(&sample_rate, sizeof(uint32_t), 1, m_fp);
+                sample_rate = FixEndian32(sample_rate, swap);
                 m_header.riff.fmt.sample_rate = sample_rate;
 
                 // byte_rate
                 uint32_t byte_rate = 0;
                 READ_AND_CHECK(&byte_rate, sizeof(uint32_t), 1, m_fp);
+                byte_rate = FixEndian32(byte_rate, swap);
                 m_header.riff.fmt.byte_rate = byte_rate;
 
                 // block_align
                 uint16_t block_align = 0;
                 READ_AND_CHECK(&block_align, sizeof(uint16_t), 1, m_fp);
+                block_align = FixEndian16(block_align, swap);
                 m_header.riff.fmt.block_align = block_align;
 
                 // sample_bits
                 uint16_t sample_bits  = 0;
                 READ_AND_CHECK(&sample_bits, sizeof(uint16_t), 1, m_fp);
+                sample_bits = FixEndian16(sample_bits, swap);
                 m_header.riff.fmt.bits_per_sample = sample_bits;
 
                 // ex_size
@@ -161,6 +234,7 @@ namespace WaveCodec {
                     if(left < 2) return false;
                     uint16_t ex_size = 0;
                     READ_AND_CHECK(&ex_size, sizeof(uint16_t), 1, m_fp);
+                    ex_size = FixEndian16(ex_size, swap);
                     m_header.riff.fmt.ex_size = ex_size;
 
                     if(ex_size < 0) return false;
@@ -183,11 +257,11 @@ namespace WaveCodec {
                 // samples
                 uint32_t samples = 0;
                 READ_AND_CHECK(&samples, sizeof(uint32_t), 1, m_fp);
+                samples = FixEndian32(samples, swap);
                 m_header.riff.fact.samples = samples;
 
-                uint32_t left = sub_chunk_size - 16;
-                if(left > 0){
-                    fseek(m_fp, left, SEEK_CUR);
+                if(sub_chunk_size > 4){
+                    fseek(m_fp, sub_chunk_size - 4, SEEK_CUR);
                 }
             }
 
@@ -204,10 +278,18 @@ namespace WaveCodec {
             }
         }
 
+        // 8bit 采样和 G.711 数据是单字节，不需要交换
+        m_swap = swap && m_header.riff.fmt.bits_per_sample > 8;
+
         memcpy(&header, &m_header, sizeof(m_header));
         return true;
     }
 
+    void WaveFileReader::ToHostEndian(uint8_t* data, size_t size) {
+        if (!m_swap || size == 0) return;
+        ByteSwapSamples(data, size, m_header.riff.fmt.bits_per_sample / 8);
+    }
+
     bool WaveFileReader::SkipBytes(uint32_t bytes2Skip) {
         if (!m_fp) return false;
         return (0 == fseek(m_fp, bytes2Skip, SEEK_CUR));
@@ -217,7 +299,9 @@ namespace WaveCodec {
         if (!m_fp) return 0;
         if (bytes2Read == 0 || bytes == nullptr) return 0;
 
-        return fread(bytes, sizeof(uint8_t), bytes2Read, m_fp);
+        size_t nRead = fread(bytes, sizeof(uint8_t), bytes2Read, m_fp);
+        ToHostEndian(bytes, nRead);
+        return nRead;
     }
 
     size_t WaveFileReader::ReadBytes(uint32_t bytes2Read, std::vector<uint8_t>& bytes){
@@ -229,6 +313,7 @@ namespace WaveCodec {
         if(nRead < bytes2Read){
             bytes.resize(nRead);
         }
+        ToHostEndian(bytes.data(), nRead);
 
         return nRead;
     }
@@ -237,7 +322,9 @@ namespace WaveCodec {
         if (!m_fp) return 0;
         if (shorts2Read == 0 || shorts == nullptr) return 0;
 
-        return fread(shorts, sizeof(uint16_t), shorts2Read, m_fp);
+        size_t nRead = fread(shorts, sizeof(uint16_t), shorts2Read, m_fp);
+        ToHostEndian((uint8_t*)shorts, nRead * sizeof(uint16_t));
+        return nRead;
     }
 
     size_t WaveFileReader::ReadShorts(uint32_t shorts2Read, std::vector<uint16_t>& shorts){
@@ -249,6 +336,7 @@ namespace WaveCodec {
         if(nRead < shorts2Read){
             shorts.resize(nRead);
         }
+        ToHostEndian((uint8_t*)shorts.data(), nRead * sizeof(uint16_t));
         return nRead;
     }
 
@@ -327,7 +415,8 @@ namespace WaveCodec {
 
     bool WaveFileWriter::Open(const std::string& waveFilePath, uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels){
         if (waveFilePath.size() == 0) return false;
-        if (audio_format != WaveAudioFormatPCM && audio_format != WaveAudioFormatALaw && audio_format != WaveAudioFormatMuLaw){
+        if (audio_format != WaveAudioFormatPCM && audio_format != WaveAudioFormatALaw && audio_format != WaveAudioFormatMuLaw &&
+            audio_format != WaveAudioFormatG722 && audio_format != WaveAudioFormatG721 && audio_format != WaveAudioFormatGSM){
             return false;
         }
 
@@ -339,6 +428,7 @@ namespace WaveCodec {
         }
 
         m_data_len = 0;
+        m_fact_samples = 0;
         m_header.riff.fmt.audio_format = audio_format;
         m_header.riff.fmt.sample_rate = sample_rate;
         m_header.riff.fmt.bits_per_sample = sample_bits;
@@ -353,7 +443,8 @@ namespace WaveCodec {
 #ifdef WIN32
     bool WaveFileWriter::OpenW(const std::wstring& waveFilePath, uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels) {
         if (waveFilePath.size() == 0) return false;
-        if (audio_format != WaveAudioFormatPCM && audio_format != WaveAudioFormatALaw && audio_format != WaveAudioFormatMuLaw) {
+        if (audio_format != WaveAudioFormatPCM && audio_format != WaveAudioFormatALaw && audio_format != WaveAudioFormatMuLaw &&
+            audio_format != WaveAudioFormatG722 && audio_format != WaveAudioFormatG721 && audio_format != WaveAudioFormatGSM) {
             return false;
         }
 
@@ -365,6 +456,7 @@ namespace WaveCodec {
         }
 
         m_data_len = 0;
+        m_fact_samples = 0;
         m_header.riff.fmt.audio_format = audio_format;
         m_header.riff.fmt.sample_rate = sample_rate;
         m_header.riff.fmt.bits_per_sample = sample_bits;
@@ -417,10 +509,10 @@ namespace WaveCodec {
         if(m_fp){
 
             // 生成 wave header
-            if(m_header.riff.fmt.audio_format == WaveAudioFormatPCM){
-                m_header.FormatPCMWaveHeader(m_header.riff.fmt.sample_rate, m_header.riff.fmt.bits_per_sample, m_header.riff.fmt.channels, m_data_len);
-            }else if(m_header.riff.fmt.audio_format == WaveAudioFormatALaw || m_header.riff.fmt.audio_format == WaveAudioFormatMuLaw){
-                m_header.FormatG711WaveHeader(m_header.riff.fmt.audio_format, m_header.riff.fmt.sample_rate, m_header.riff.fmt.bits_per_sample, m_header.riff.fmt.channels, m_data_len);
+            m_header.FormatWaveHeader(m_header.riff.fmt.audio_format, m_header.riff.fmt.sample_rate, m_header.riff.fmt.bits_per_sample,
+                                      m_header.riff.fmt.channels, m_data_len);
+            if (m_fact_samples > 0 && m_header.riff.fact.header.fourcc == MAKE_FOURCC('f', 'a', 'c', 't')) {
+                m_header.riff.fact.samples = m_fact_samples;
             }
 
             // 回填 wave header 到文件开头
@@ -484,9 +576,16 @@ namespace WaveCodec {
             return false;
         }
 
+        // 每次读取整数个采样块，大端文件的采样才能被正确转换
+        uint32_t readSize = 1024;
+        if(header.riff.fmt.block_align > 0){
+            uint32_t block_align = header.riff.fmt.block_align;
+            readSize = (readSize + block_align - 1) / block_align * block_align;
+        }
+
         std::vector<uint8_t> buffer;
         while(true){
-            int read_cnt = reader.ReadBytes(1024, buffer);
+            int read_cnt = reader.ReadBytes(readSize, buffer);
             if(read_cnt > 0){
                 fwrite(&buffer[0], sizeof(uint8_t), read_cnt, fpPCM);
             }else{
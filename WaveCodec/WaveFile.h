@@ -6,6 +6,8 @@
 #define WAVE_FILE_H_
 
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -21,8 +23,9 @@
 #define WaveAudioFormatIeeeFloat 3 // IEEE float.               [fmt chunk size: 18, has fact chunk]
 #define WaveAudioFormatALaw      6 // 8-bit ITU-T G.711 A-law.  [fmt chunk size: 18, has fact chunk] 欧洲和其它
 #define WaveAudioFormatMuLaw     7 // 8-bit ITU-T G.711 mu-law. [fmt chunk size: 18, has fact chunk] 北美日本
-#define WaveAudioFormatGSM      49 // GSM 6.10.                 [fmt chunk size: 20, has fact chunk]
-#define WaveAudioFormatG721     64 // ITU G.721 ADPCM           [fmt chunk size: 20, has fact chunk]
+#define WaveAudioFormatGSM      49 // GSM 6.10.                 [fmt chunk size: 20, has fact chunk] WAV49 打包，每 65 字节 320 个采样
+#define WaveAudioFormatG721     64 // ITU G.721 ADPCM           [fmt chunk size: 20, has fact chunk] G.726 16/24/32/40k 也使用该格式，bits_per_sample 为码字位数
+#define WaveAudioFormatG722    101 // ITU G.722 ADPCM (0x0065)  [fmt chunk size: 18, has fact chunk] 16kHz 宽带，每个字节对应 2 个采样
 
 // 使用扩展区中的sub_format来决定音频的数据的编码方式。在以下几种情况下必须要使用 WAVE_FORMAT_EXTENSIBLE
 // - PCM数据的量化位数大于16
@@ -35,7 +38,7 @@ namespace WaveCodec {
 
     // Wave Header 相关定义
     struct ChunkHeader {
-        uint32_t fourcc; // 块id，大端存储，如 "RIFF", "fmt ", "fact", "data"
+        uint32_t fourcc; // 块id，大端存储，如 "RIFF"(或大端文件的 "RIFX"), "fmt ", "fact", "data"
         uint32_t size;   // 块大小，不包含 fourcc 和 size字段
     };
 
@@ -77,12 +80,21 @@ namespace WaveCodec {
     struct WaveHeader {
         RIFFChunk riff; // Wave文件本质就是一个 RIFF Chunk
 
-        WaveHeader(){};
+        // riff 值初始化，所有字段为 0，清空时使用 header = WaveHeader()
+        WaveHeader() : riff() {}
+
+        // IsBigEndian: 是否为 RIFX 文件，RIFX 与 RIFF 结构相同，但所有整数和采样都是大端存储
+        bool IsBigEndian() const {
+            return riff.header.fourcc == MAKE_FOURCC('R', 'I', 'F', 'X');
+        }
 
         int GetHeaderSize(){
             if(riff.fmt.audio_format == WaveAudioFormatPCM) {
                 return 44;
             }
+            if(riff.fmt.audio_format == WaveAudioFormatG721 || riff.fmt.audio_format == WaveAudioFormatGSM) {
+                return 60; // 60 = 58 + 2 (fmt 扩展区中的 aux block size / samples per block)
+            }
             return 58; // 58 = 44 + 2 (fmt.ex_size) + 12(fact)
         }
 
@@ -114,13 +126,13 @@ namespace WaveCodec {
         void FormatG711WaveHeader(uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels, uint32_t data_len){
             // riff
             riff.header.fourcc = MAKE_FOURCC('R', 'I', 'F', 'F');
-            riff.header.size = 38 + data_len; // 38 = 46 (header size) - 8(sizeof chunk + sizeof chunk_size)
+            riff.header.size = 50 + data_len; // 50 = 58 (header size) - 8(sizeof chunk + sizeof chunk_size)
             riff.form_type = MAKE_FOURCC('W', 'A', 'V', 'E');
 
             // fmt
             riff.fmt.header.fourcc = MAKE_FOURCC('f', 'm', 't', ' ');
             riff.fmt.header.size = 18; // has ex_size field
-            riff.fmt.audio_format = WaveAudioFormatPCM;
+            riff.fmt.audio_format = audio_format;
             riff.fmt.channels = channels;
             riff.fmt.sample_rate = sample_rate;
             riff.fmt.byte_rate = sample_rate*channels*sample_bits / 8;
@@ -138,6 +150,59 @@ namespace WaveCodec {
             riff.data.header.size   = data_len;
         }
 
+        // G.722 每个声道每 2 个采样编码为 1 个字节，bits_per_sample 记为 4
+        void FormatG722WaveHeader(uint32_t sample_rate, uint16_t channels, uint32_t data_len){
+            FormatG711WaveHeader(WaveAudioFormatG722, sample_rate, 8, channels, data_len);
+            riff.fmt.byte_rate = sample_rate * channels / 2;
+            riff.fmt.block_align = channels;
+            riff.fmt.bits_per_sample = 4;
+            riff.fact.samples = data_len / channels * 2;
+        }
+
+        // G.726 的码字按 sample_bits(2~5) 位紧密排列，每个声道 8 个采样正好是 sample_bits 个字节
+        // fmt 子块为 20 字节，扩展区只有 2 字节的 aux block size(写 0)
+        void FormatG726WaveHeader(uint32_t sample_rate, uint16_t sample_bits, uint16_t channels, uint32_t data_len){
+            FormatG711WaveHeader(WaveAudioFormatG721, sample_rate, 8, channels, data_len);
+            riff.header.size = 52 + data_len; // 52 = 60 (header size) - 8
+            riff.fmt.header.size = 20;
+            riff.fmt.byte_rate = sample_rate * channels * sample_bits / 8;
+            riff.fmt.block_align = channels * sample_bits;
+            riff.fmt.bits_per_sample = sample_bits;
+            riff.fmt.ex_size = 2;
+            riff.fact.samples = (uint32_t)((uint64_t)data_len * 8 / (channels * sample_bits));
+        }
+
+        // GSM 06.10 使用 WAV49 打包，只支持单声道，每 65 字节为一块，对应 320 个采样
+        // fmt 子块为 20 字节，扩展区只有 2 字节的 wSamplesPerBlock(320)，bits_per_sample 为 0
+        void FormatGSMWaveHeader(uint32_t sample_rate, uint16_t channels, uint32_t data_len){
+            FormatG711WaveHeader(WaveAudioFormatGSM, sample_rate, 8, channels, data_len);
+            riff.header.size = 52 + data_len; // 52 = 60 (header size) - 8
+            riff.fmt.header.size = 20;
+            riff.fmt.byte_rate = sample_rate * 65 / 320;
+            riff.fmt.block_align = 65;
+            riff.fmt.bits_per_sample = 0;
+            riff.fmt.ex_size = 2;
+            riff.fact.samples = data_len / 65 * 320;
+        }
+
+        // FormatWaveHeader: 按 audio_format 调用对应的 Format*WaveHeader，支持的格式与 WaveFileWriter 相同
+        bool FormatWaveHeader(uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels, uint32_t data_len){
+            if(audio_format == WaveAudioFormatPCM){
+                FormatPCMWaveHeader(sample_rate, sample_bits, channels, data_len);
+            }else if(audio_format == WaveAudioFormatALaw || audio_format == WaveAudioFormatMuLaw){
+                FormatG711WaveHeader(audio_format, sample_rate, sample_bits, channels, data_len);
+            }else if(audio_format == WaveAudioFormatG722){
+                FormatG722WaveHeader(sample_rate, channels, data_len);
+            }else if(audio_format == WaveAudioFormatG721){
+                FormatG726WaveHeader(sample_rate, sample_bits, channels, data_len);
+            }else if(audio_format == WaveAudioFormatGSM){
+                FormatGSMWaveHeader(sample_rate, channels, data_len);
+            }else{
+                return false;
+            }
+            return true;
+        }
+
         void ToBuffer(std::vector<uint8_t>& bufferOut){
             bufferOut.resize(GetHeaderSize());
             uint8_t *p = &bufferOut[0];
@@ -160,6 +225,14 @@ namespace WaveCodec {
             if(riff.fmt.audio_format != WaveAudioFormatPCM){
                 CPY_FIELD(p, riff.fmt.ex_size);
             }
+            if(riff.fmt.audio_format == WaveAudioFormatG721){
+                uint16_t aux_block_size = 0;
+                CPY_FIELD(p, aux_block_size);
+            }
+            if(riff.fmt.audio_format == WaveAudioFormatGSM){
+                uint16_t samples_per_block = 320;
+                CPY_FIELD(p, samples_per_block);
+            }
 
             // fact
             if(riff.fmt.audio_format != WaveAudioFormatPCM){
@@ -179,6 +252,16 @@ namespace WaveCodec {
     // * 返回值       : audio_format 对于的描述
     std::string GetWaveAudioFormatString(uint16_t audio_format);
 
+    // ParseWaveHeader: 从内存中解析 Wave Header，用于已经读到内存中的文件开头
+    // 与 WaveFileReader::ReadWaveHeader 一样，解析到 data 子块为止
+    // 只支持 RIFF，调用者直接使用原始采样数据，RIFX 文件需要通过 WaveFileReader 读取
+    // * buffer     : 文件开头的数据
+    // * bufferSize : buffer 的长度
+    // * header     : 解析出的 Wave Header
+    // * dataOffset : data 子块中音频数据在文件中的偏移
+    // * 返回值      : 解析是否成功，buffer 中不包含 data 子块头时返回 false
+    bool ParseWaveHeader(const uint8_t* buffer, size_t bufferSize, WaveHeader& header, uint32_t& dataOffset);
+
     /*example code
     
         WaveFileReader reader;
@@ -194,6 +277,9 @@ namespace WaveCodec {
             // process buffer as you want
         }
         reader.Close();
+
+        RIFX(大端)文件的头信息会被转换为本机字节序，读取的采样也会被转换为本机字节序，
+        此时每次读取的长度应为 block_align 的整数倍，否则跨越两次读取的采样无法正确转换
     */
     class WaveFileReader{
     public:
@@ -226,8 +312,12 @@ namespace WaveCodec {
         // Close: 关闭PCM文件
         void Close();
     private:
+        // 大端文件时，将读到的采样转换为本机字节序
+        void ToHostEndian(uint8_t* data, size_t size);
+
         FILE* m_fp = nullptr;
         WaveHeader m_header;
+        bool m_swap = false; // 采样是否需要交换字节序
     };
 
     class WaveFileWriter{
@@ -236,7 +326,7 @@ namespace WaveCodec {
         ~WaveFileWriter();
 
         // Open wave file for write
-        // audio_format: Wave文件的音频格式，目前仅支持WaveAudioFormatPCM/WaveAudioFormatALaw/WaveAudioFormatMuLaw
+        // audio_format: Wave文件的音频格式，目前仅支持WaveAudioFormatPCM/WaveAudioFormatALaw/WaveAudioFormatMuLaw/WaveAudioFormatG722/WaveAudioFormatG721/WaveAudioFormatGSM
         bool Open(const std::string& waveFilePath, uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels);
 
 #ifdef WIN32
@@ -252,6 +342,10 @@ namespace WaveCodec {
         void Write(const std::vector<uint16_t>& data);
         void Write(const std::vector<uint16_t>& data, size_t len);
 
+        // SetFactSamples: 指定 fact 中每个声道的采样数，默认由数据长度计算
+        // 编码器在最后一块补了静音时用于记录实际的采样数，PCM 格式没有 fact，设置无效
+        void SetFactSamples(uint32_t samples) { m_fact_samples = samples; }
+
         void Close();
     private:
 
@@ -259,6 +353,7 @@ namespace WaveCodec {
         FILE* m_fp = nullptr;
         WaveHeader m_header;
         uint32_t m_data_len;
+        uint32_t m_fact_samples = 0;
     };
 
     // PCM 文件转 Wave 文件
@@ -0,0 +1,142 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "WaveRequantize.h"
+#include "WaveChunks.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace WaveCodec {
+
+    // 每次读取的帧数
+    static const uint32_t kRequantizeFrames = 16384;
+
+    // WAVE_FORMAT_EXTENSIBLE 的实际格式在 fmt 块偏移 24 处 sub_format GUID 的前两个字节
+    static uint16_t GetExtensibleSubFormat(const std::string& path) {
+        RiffChunkDirectory dir;
+        if (!dir.Open(path) || dir.IsBigEndian()) return WaveAudioFormatUnknown;
+
+        const std::vector<uint8_t>* fmt = dir.LoadChunk(dir.FindChunk("fmt "));
+        if (!fmt || fmt->size() < 26) return WaveAudioFormatUnknown;
+        return (uint16_t)((*fmt)[24] | ((*fmt)[25] << 8));
+    }
+
+    static bool RequantizeWaveFile(const std::string& srcPath, const std::string& dstPath, uint16_t targetBits, PCMCodec::DitherMode mode,
+                                   BatchConvertJob* info) {
+        WaveFileReader reader;
+        WaveHeader header;
+        if (!reader.Open(srcPath) || !reader.ReadWaveHeader(header)) {
+            printf("read wave header failed, %s\n", srcPath.c_str());
+            return false;
+        }
+
+        uint16_t audio_format = header.riff.fmt.audio_format;
+        if (audio_format == WaveAudioFormatExtensible) {
+            audio_format = GetExtensibleSubFormat(srcPath);
+        }
+
+        uint16_t channels = header.riff.fmt.channels;
+        uint32_t sampleBytes = header.riff.fmt.bits_per_sample / 8;
+        bool isFloat = (audio_format == WaveAudioFormatIeeeFloat);
+        if ((audio_format != WaveAudioFormatPCM && !isFloat) || channels == 0 || sampleBytes == 0
+            || (isFloat && sampleBytes != 4 && sampleBytes != 8) || (!isFloat && sampleBytes > 4)) {
+            printf("unsupported wave format for requantize, %s, audio_format:%d, sample_bits:%d\n", srcPath.c_str(),
+                   header.riff.fmt.audio_format, header.riff.fmt.bits_per_sample);
+            return false;
+        }
+        if (info) {
+            info->sample_rate = header.riff.fmt.sample_rate;
+            info->sample_bits = header.riff.fmt.bits_per_sample;
+            info->channels = channels;
+        }
+
+        PCMCodec::Requantizer requantizer(channels, targetBits, mode);
+        if (!requantizer.IsValid()) {
+            printf("invalid target bits: %d\n", targetBits);
+            return false;
+        }
+
+        WaveFileWriter writer;
+        if (!writer.Open(dstPath, WaveAudioFormatPCM, header.riff.fmt.sample_rate, targetBits, channels)) {
+            printf("open wave file failed, %s\n", dstPath.c_str());
+            return false;
+        }
+
+        // 只读取 data 块，流式写入的文件 data 大小可能为 0，此时读到文件末尾
+        uint32_t blockAlign = sampleBytes * channels;
+        uint64_t dataLeft = header.riff.data.header.size;
+        if (dataLeft == 0) dataLeft = UINT64_MAX;
+
+        std::vector<uint8_t> input((size_t)kRequantizeFrames * blockAlign);
+        std::vector<float> samples((size_t)kRequantizeFrames * channels);
+        std::vector<uint8_t> output((size_t)kRequantizeFrames * channels * requantizer.GetSampleBytes());
+        while (dataLeft > 0) {
+            uint32_t toRead = (uint32_t)std::min<uint64_t>(input.size(), dataLeft);
+            size_t nRead = reader.ReadBytes(toRead, &input[0]);
+            size_t count = nRead / blockAlign * channels; // 末尾不完整的帧被丢弃
+            if (count == 0) break;
+
+            PCMCodec::SamplesToFloat(&input[0], count, sampleBytes, isFloat, &samples[0]);
+            requantizer.Process(&samples[0], count, &output[0]);
+            writer.Write(&output[0], (uint32_t)(count * requantizer.GetSampleBytes()));
+
+            dataLeft = nRead < toRead ? 0 : dataLeft - nRead;
+        }
+
+        writer.Close();
+        return true;
+    }
+
+    bool RequantizeWaveFile(const std::string& srcPath, const std::string& dstPath, uint16_t targetBits, PCMCodec::DitherMode mode) {
+        return RequantizeWaveFile(srcPath, dstPath, targetBits, mode, nullptr);
+    }
+
+    // 先查找缓存，未命中时转换并存入缓存
+    static bool RequantizeWaveFileCached(BatchConvertJob& job, uint16_t targetBits, PCMCodec::DitherMode mode, ConversionCache* cache) {
+        uint64_t hash = 0, size = 0;
+        std::string key;
+        if (cache && HashWaveContent(job.srcPath, hash, size)) {
+            key = ConversionCache::MakeKey(hash, size, "requantize:" + std::to_string(targetBits) + ":" + std::to_string((int)mode));
+            if (cache->Lookup(key, job.dstPath)) {
+                // 命中时只读取 header 返回音频参数
+                WaveFileReader reader;
+                WaveHeader header;
+                if (reader.Open(job.srcPath) && reader.ReadWaveHeader(header)) {
+                    job.sample_rate = header.riff.fmt.sample_rate;
+                    job.sample_bits = header.riff.fmt.bits_per_sample;
+                    job.channels = header.riff.fmt.channels;
+                }
+                return true;
+            }
+        }
+
+        bool ret = RequantizeWaveFile(job.srcPath, job.dstPath, targetBits, mode, &job);
+        if (ret && !key.empty()) cache->Store(key, job.dstPath);
+        return ret;
+    }
+
+    size_t BatchRequantizeWaveFiles(std::vector<BatchConvertJob>& jobs, uint16_t targetBits, PCMCodec::DitherMode mode,
+                                    AsyncIO::ThreadPool* pool, ConversionCache* cache) {
+        std::unique_ptr<AsyncIO::ThreadPool> ownedPool;
+        if (!pool) {
+            ownedPool.reset(new AsyncIO::ThreadPool());
+            pool = ownedPool.get();
+        }
+
+        for (size_t i = 0; i < jobs.size(); i++) {
+            BatchConvertJob* job = &jobs[i];
+            pool->Submit([job, targetBits, mode, cache]{
+                job->success = RequantizeWaveFileCached(*job, targetBits, mode, cache);
+            });
+        }
+        pool->Wait();
+
+        size_t succeeded = 0;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (jobs[i].success) succeeded++;
+        }
+        return succeeded;
+    }
+}
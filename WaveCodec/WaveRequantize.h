@@ -0,0 +1,36 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef WAVE_REQUANTIZE_H_
+#define WAVE_REQUANTIZE_H_
+
+#include "WaveFile.h"
+#include "WaveBatch.h"
+#include "AsyncIO/ThreadPool.h"
+#include "PCMCodec/PCMRequantize.h"
+
+namespace WaveCodec {
+
+    // RequantizeWaveFile: 降低 Wave 文件的位深，如 24bit/32bit/浮点 母带转换为 16bit 或 8bit
+    // 输入支持 8/16/24/32bit PCM、32/64bit IEEE 浮点，以及子格式为 PCM/浮点的 WAVE_FORMAT_EXTENSIBLE
+    // 数据按块流式读取、转换为浮点后由 PCMCodec::Requantizer 量化，内存占用与文件长度无关
+    // * srcPath    : 输入 Wave 文件
+    // * dstPath    : 输出 Wave 文件，PCM 格式
+    // * targetBits : 输出位深，8/16/24
+    // * mode       : 抖动方式
+    // * 返回值      : 是否成功
+    bool RequantizeWaveFile(const std::string& srcPath, const std::string& dstPath, uint16_t targetBits, PCMCodec::DitherMode mode);
+
+    // BatchRequantizeWaveFiles: 在线程池中同时处理多个文件，每个文件一个任务
+    // * jobs       : 要处理的文件，结果保存在 success 中，同时返回输入的 sample_rate/sample_bits/channels
+    // * targetBits : 输出位深
+    // * mode       : 抖动方式
+    // * pool       : 线程池，为空时内部创建一个(线程数为 CPU 核数)
+    // * cache      : 转换结果缓存，不为空时先按 fmt/data 块内容和参数查找，命中的文件不再转换
+    // * 返回值      : 成功的文件个数
+    size_t BatchRequantizeWaveFiles(std::vector<BatchConvertJob>& jobs, uint16_t targetBits, PCMCodec::DitherMode mode,
+                                    AsyncIO::ThreadPool* pool = nullptr, ConversionCache* cache = nullptr);
+}
+
+#endif //WAVE_REQUANTIZE_H_
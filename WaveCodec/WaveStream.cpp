@@ -0,0 +1,398 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#include "WaveStream.h"
+#include "ByteSwap.h"
+#include "PCMCodec/PCMStream.h"
+
+#include <algorithm>
+
+namespace WaveCodec {
+
+    // 流式写入时 riff/data 的 size 字段，RF64 中也表示实际大小记录在 ds64 块中
+    static const uint32_t kStreamSizePlaceholder = 0xFFFFFFFF;
+
+    // fmt 子块的最大长度，超过时认为文件损坏，避免按错误的大小分配内存
+    static const uint32_t kMaxFmtChunkSize = 64 * 1024;
+
+    static uint16_t GetU16(const uint8_t* p, bool swap){
+        uint16_t v;
+        memcpy(&v, p, sizeof(v));
+        return swap ? ByteSwap16(v) : v;
+    }
+
+    static uint32_t GetU32(const uint8_t* p, bool swap){
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return swap ? ByteSwap32(v) : v;
+    }
+
+    // 只用于 RF64 的 ds64 块，RF64 总是小端存储，低 32 位在前
+    static uint64_t GetU64(const uint8_t* p, bool swap){
+        uint64_t lo = GetU32(p, swap);
+        uint64_t hi = GetU32(p + 4, swap);
+        return (hi << 32) | lo;
+    }
+
+    static bool IsFourcc(const uint8_t* p, const char* fourcc){
+        return memcmp(p, fourcc, 4) == 0;
+    }
+
+    ///////////////////////////////////////////////////
+    // WaveStreamReader
+    WaveStreamReader::WaveStreamReader(){}
+
+    WaveStreamReader::~WaveStreamReader(){
+        Close();
+    }
+
+    bool WaveStreamReader::Open(const std::string& waveFilePath){
+        if (m_fp) return false;
+
+        bool ownsFile = false;
+        FILE* fp = PCMCodec::OpenStreamFile(waveFilePath, false, ownsFile);
+        if (!fp) return false;
+        return Attach(fp, ownsFile);
+    }
+
+    bool WaveStreamReader::Attach(FILE* fp, bool ownsFile){
+        if (!fp || m_fp) return false;
+
+        m_fp = fp;
+        m_ownsFile = ownsFile;
+        m_headerRead = false;
+        m_swap = false;
+        m_dataSize = kWaveStreamUnknownSize;
+        m_dataRead = 0;
+        return true;
+    }
+
+    bool WaveStreamReader::ReadExact(void* buffer, size_t size){
+        if (size == 0) return true;
+        return fread(buffer, 1, size, m_fp) == size;
+    }
+
+    bool WaveStreamReader::Discard(uint64_t size){
+        uint8_t buffer[4096];
+        while (size > 0) {
+            size_t n = (size_t)std::min<uint64_t>(size, sizeof(buffer));
+            if (fread(buffer, 1, n, m_fp) != n) return false;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool WaveStreamReader::ReadWaveHeader(WaveHeader& header){
+        if (!m_fp || m_headerRead) return false;
+
+        // riff chunk，"RIFF" 为小端存储，"RIFX" 为大端存储，"RF64" 为小端且大小记录在 ds64 块中
+        uint8_t riff[12];
+        if (!ReadExact(riff, sizeof(riff))) {
+            fprintf(stderr, "invalid wave stream, too short\n");
+            return false;
+        }
+        const bool rf64 = IsFourcc(riff, "RF64");
+        if (!IsFourcc(riff, "RIFF") && !IsFourcc(riff, "RIFX") && !rf64) {
+            fprintf(stderr, "invalid wave stream, riff fourcc error\n");
+            return false;
+        }
+        if (!IsFourcc(riff + 8, "WAVE")) {
+            fprintf(stderr, "RIFF not WAVE, invalid wave stream\n");
+            return false;
+        }
+
+        m_header = WaveHeader();
+        m_header.riff.header.fourcc = MAKE_FOURCC(riff[0], riff[1], riff[2], riff[3]);
+        const bool swap = (m_header.IsBigEndian() == IsLittleEndianHost());
+        m_header.riff.header.size = GetU32(riff + 4, swap);
+        m_header.riff.form_type = MAKE_FOURCC('W', 'A', 'V', 'E');
+
+        // 按顺序逐个解析子块，直到 data 子块
+        bool hasFmt = false;
+        uint64_t ds64DataSize = 0;
+        std::vector<uint8_t> body;
+        while (true) {
+            uint8_t chunk[8];
+            if (!ReadExact(chunk, sizeof(chunk))) {
+                fprintf(stderr, "invalid wave stream, data chunk not found\n");
+                return false;
+            }
+            const uint32_t size = GetU32(chunk + 4, swap);
+            const uint32_t pad = size & 1; // 子块按 2 字节对齐
+
+            if (IsFourcc(chunk, "data")) {
+                if (!hasFmt) {
+                    fprintf(stderr, "invalid wave stream, fmt chunk not found\n");
+                    return false;
+                }
+                m_header.riff.data.header.fourcc = MAKE_FOURCC('d', 'a', 't', 'a');
+                m_header.riff.data.header.size = size;
+
+                if (rf64 && size == kStreamSizePlaceholder && ds64DataSize != 0) {
+                    m_dataSize = ds64DataSize;
+                } else if (size == 0 || size == kStreamSizePlaceholder) {
+                    m_dataSize = kWaveStreamUnknownSize;
+                } else {
+                    m_dataSize = size;
+                }
+                break;
+            }
+
+            if (IsFourcc(chunk, "fmt ")) {
+                if (size < 16 || size > kMaxFmtChunkSize) {
+                    fprintf(stderr, "invalid wave stream, fmt chunk size:%u\n", size);
+                    return false;
+                }
+                body.resize(size + pad);
+                if (!ReadExact(body.data(), body.size())) return false;
+
+                const uint8_t* p = body.data();
+                m_header.riff.fmt.header.fourcc = MAKE_FOURCC('f', 'm', 't', ' ');
+                m_header.riff.fmt.header.size = size;
+                m_header.riff.fmt.audio_format = GetU16(p, swap);
+                m_header.riff.fmt.channels = GetU16(p + 2, swap);
+                m_header.riff.fmt.sample_rate = GetU32(p + 4, swap);
+                m_header.riff.fmt.byte_rate = GetU32(p + 8, swap);
+                m_header.riff.fmt.block_align = GetU16(p + 12, swap);
+                m_header.riff.fmt.bits_per_sample = GetU16(p + 14, swap);
+                m_header.riff.fmt.ex_size = size >= 18 ? GetU16(p + 16, swap) : 0;
+                hasFmt = true;
+            } else if (IsFourcc(chunk, "fact") && size >= 4) {
+                body.resize(size + pad);
+                if (!ReadExact(body.data(), body.size())) return false;
+
+                m_header.riff.fact.header.fourcc = MAKE_FOURCC('f', 'a', 'c', 't');
+                m_header.riff.fact.header.size = size;
+                m_header.riff.fact.samples = GetU32(body.data(), swap);
+            } else if (rf64 && IsFourcc(chunk, "ds64") && size >= 16 && size <= kMaxFmtChunkSize) {
+                // ds64: riff size(8) + data size(8) + sample count(8) + ...
+                body.resize(size + pad);
+                if (!ReadExact(body.data(), body.size())) return false;
+                ds64DataSize = GetU64(body.data() + 8, swap);
+            } else {
+                // 其它子块，读取并丢弃
+                if (!Discard((uint64_t)size + pad)) {
+                    fprintf(stderr, "invalid wave stream, chunk truncated\n");
+                    return false;
+                }
+            }
+        }
+
+        // 8bit 采样和 G.711 数据是单字节，不需要交换
+        m_swap = swap && m_header.riff.fmt.bits_per_sample > 8;
+        m_headerRead = true;
+
+        header = m_header;
+        return true;
+    }
+
+    uint32_t WaveStreamReader::Limit(uint32_t bytes2Read) const {
+        if (m_dataSize == kWaveStreamUnknownSize) return bytes2Read;
+        if (m_dataRead >= m_dataSize) return 0;
+        return (uint32_t)std::min<uint64_t>(bytes2Read, m_dataSize - m_dataRead);
+    }
+
+    size_t WaveStreamReader::ReadBytes(uint32_t bytes2Read, uint8_t* bytes){
+        if (!m_fp || !m_headerRead) return 0;
+        if (bytes == nullptr) return 0;
+
+        bytes2Read = Limit(bytes2Read);
+        if (bytes2Read == 0) return 0;
+
+        size_t nRead = fread(bytes, sizeof(uint8_t), bytes2Read, m_fp);
+        m_dataRead += nRead;
+        if (m_swap && nRead > 0) {
+            ByteSwapSamples(bytes, nRead, m_header.riff.fmt.bits_per_sample / 8);
+        }
+        return nRead;
+    }
+
+    size_t WaveStreamReader::ReadBytes(uint32_t bytes2Read, std::vector<uint8_t>& bytes){
+        if (!m_fp) return 0;
+
+        bytes.resize(bytes2Read);
+        size_t nRead = ReadBytes(bytes2Read, bytes.data());
+        bytes.resize(nRead);
+        return nRead;
+    }
+
+    size_t WaveStreamReader::ReadShorts(uint32_t shorts2Read, uint16_t* shorts){
+        return ReadBytes(shorts2Read * 2, (uint8_t*)shorts) / 2;
+    }
+
+    size_t WaveStreamReader::ReadShorts(uint32_t shorts2Read, std::vector<uint16_t>& shorts){
+        if (!m_fp) return 0;
+
+        shorts.resize(shorts2Read);
+        size_t nRead = ReadShorts(shorts2Read, shorts.data());
+        shorts.resize(nRead);
+        return nRead;
+    }
+
+    size_t WaveStreamReader::ReadDuration(uint32_t durationMs, std::vector<uint8_t>& data){
+        if (!m_fp || !m_headerRead) return 0;
+
+        if (m_header.riff.fmt.audio_format != WaveAudioFormatPCM
+            && m_header.riff.fmt.audio_format != WaveAudioFormatALaw
+            && m_header.riff.fmt.audio_format != WaveAudioFormatMuLaw) {
+            return 0;
+        }
+
+        uint32_t bytesPerMs = (m_header.riff.fmt.sample_rate * m_header.riff.fmt.bits_per_sample / 8 * m_header.riff.fmt.channels) / 1000; // 每 ms 的字节数
+        return ReadBytes(bytesPerMs * durationMs, data);
+    }
+
+    size_t WaveStreamReader::ReadDuration(uint32_t durationMs, std::vector<uint16_t>& data){
+        if (!m_fp || !m_headerRead) return 0;
+
+        if (m_header.riff.fmt.audio_format != WaveAudioFormatPCM
+            && m_header.riff.fmt.audio_format != WaveAudioFormatALaw
+            && m_header.riff.fmt.audio_format != WaveAudioFormatMuLaw) {
+            return 0;
+        }
+
+        uint32_t shortsPerMs = (m_header.riff.fmt.sample_rate * m_header.riff.fmt.bits_per_sample / 16 * m_header.riff.fmt.channels) / 1000; // 每 ms 的 short 个数
+        return ReadShorts(shortsPerMs * durationMs, data);
+    }
+
+    void WaveStreamReader::Close(){
+        if (m_fp) {
+            if (m_ownsFile) {
+                fclose(m_fp);
+            }
+            m_fp = nullptr;
+            m_ownsFile = false;
+            m_headerRead = false;
+        }
+    }
+
+    ///////////////////////////////////////////////////
+    // WaveStreamWriter
+    WaveStreamWriter::WaveStreamWriter(){}
+
+    WaveStreamWriter::~WaveStreamWriter(){
+        Close();
+    }
+
+    bool WaveStreamWriter::Open(const std::string& waveFilePath, uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits,
+                                uint16_t channels, bool fixupSizes){
+        if (m_fp) return false;
+
+        // 先检查格式，避免不支持的格式时截断已有文件
+        WaveHeader header;
+        if (!header.FormatWaveHeader(audio_format, sample_rate, sample_bits, channels, 0)) return false;
+
+        bool ownsFile = false;
+        FILE* fp = PCMCodec::OpenStreamFile(waveFilePath, true, ownsFile);
+        if (!fp) return false;
+
+        if (!Attach(fp, ownsFile, audio_format, sample_rate, sample_bits, channels, fixupSizes)) {
+            if (ownsFile) fclose(fp);
+            return false;
+        }
+        return true;
+    }
+
+    bool WaveStreamWriter::Attach(FILE* fp, bool ownsFile, uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits,
+                                  uint16_t channels, bool fixupSizes){
+        if (!fp || m_fp) return false;
+        if (!m_header.FormatWaveHeader(audio_format, sample_rate, sample_bits, channels, 0)) return false;
+
+        // 长度未知
+        m_header.riff.header.size = kStreamSizePlaceholder;
+        m_header.riff.data.header.size = kStreamSizePlaceholder;
+        m_header.riff.fact.samples = 0;
+
+        m_fp = fp;
+        m_ownsFile = ownsFile;
+        m_fixupSizes = fixupSizes;
+        m_error = false;
+        m_dataLen = 0;
+        m_headerPos = PCMCodec::IsSeekableStream(fp) ? ftell(fp) : -1;
+
+        std::vector<uint8_t> buffer;
+        m_header.ToBuffer(buffer);
+        if (fwrite(&buffer[0], sizeof(uint8_t), buffer.size(), m_fp) != buffer.size()) {
+            fprintf(stderr, "write wave header failed\n");
+            m_error = true;
+        }
+        return true;
+    }
+
+    void WaveStreamWriter::Write(const uint8_t* data, uint32_t len){
+        if (!m_fp || m_error) return;
+        if (!data || len == 0) return;
+
+        size_t nWrite = fwrite(data, sizeof(uint8_t), len, m_fp);
+        m_dataLen += nWrite;
+        if (nWrite < len) {
+            m_error = true;
+        }
+    }
+
+    void WaveStreamWriter::Write(const uint16_t* data, uint32_t len){
+        Write((const uint8_t*)data, len * 2);
+    }
+
+    void WaveStreamWriter::Write(const std::vector<uint8_t>& data){
+        if (data.size() == 0) return;
+        Write(&data[0], data.size());
+    }
+
+    void WaveStreamWriter::Write(const std::vector<uint8_t>& data, size_t len){
+        if (data.size() == 0) return;
+        Write(&data[0], len);
+    }
+
+    void WaveStreamWriter::Write(const std::vector<uint16_t>& data){
+        if (data.size() == 0) return;
+        Write(&data[0], data.size());
+    }
+
+    void WaveStreamWriter::Write(const std::vector<uint16_t>& data, size_t len){
+        if (data.size() == 0) return;
+        Write(&data[0], len);
+    }
+
+    bool WaveStreamWriter::Flush(){
+        if (!m_fp) return false;
+        if (fflush(m_fp) != 0) {
+            m_error = true;
+        }
+        return !m_error;
+    }
+
+    void WaveStreamWriter::FixupSizes(){
+        std::vector<uint8_t> buffer;
+        uint64_t headerSize = (uint64_t)m_header.GetHeaderSize();
+        if (m_dataLen + headerSize - 8 > 0xFFFFFFFF) return;
+
+        m_header.FormatWaveHeader(m_header.riff.fmt.audio_format, m_header.riff.fmt.sample_rate, m_header.riff.fmt.bits_per_sample,
+                                  m_header.riff.fmt.channels, (uint32_t)m_dataLen);
+        m_header.ToBuffer(buffer);
+
+        if (!Flush()) return;
+        long end = ftell(m_fp);
+        if (end < 0 || fseek(m_fp, m_headerPos, SEEK_SET) != 0) return;
+        // 定位没有生效时不写，避免把文件头追加到数据后面
+        if (ftell(m_fp) == m_headerPos && fwrite(&buffer[0], sizeof(uint8_t), buffer.size(), m_fp) != buffer.size()) {
+            m_error = true;
+        }
+        fseek(m_fp, end, SEEK_SET);
+    }
+
+    void WaveStreamWriter::Close(){
+        if (m_fp) {
+            if (m_fixupSizes && m_headerPos >= 0 && !m_error) {
+                FixupSizes();
+            }
+            Flush();
+            if (m_ownsFile) {
+                fclose(m_fp);
+            }
+            m_fp = nullptr;
+            m_ownsFile = false;
+        }
+    }
+}
@@ -0,0 +1,149 @@
+﻿//
+// Created by JarvisChu on 2026/10/19.
+//
+
+#ifndef WAVE_STREAM_H_
+#define WAVE_STREAM_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "WaveFile.h"
+
+namespace WaveCodec {
+
+    // data 子块大小未知(流式写入)时 WaveStreamReader::GetDataSize 的返回值
+    static const uint64_t kWaveStreamUnknownSize = UINT64_MAX;
+
+    /*example code
+
+        // curl -s http://host/in.wav | ./app > out.wav
+        WaveStreamReader reader;
+        WaveHeader header;
+        if(!reader.Open("-") || !reader.ReadWaveHeader(header)) return;
+
+        WaveStreamWriter writer;
+        writer.Open("-", WaveAudioFormatPCM, header.riff.fmt.sample_rate, header.riff.fmt.bits_per_sample, header.riff.fmt.channels);
+        std::vector<uint8_t> buffer;
+        while(reader.ReadDuration(20, buffer) > 0){
+            // process buffer as you want
+            writer.Write(buffer);
+        }
+        writer.Close();   // stdout 被重定向到普通文件时回填实际大小，管道时保留流式大小
+        reader.Close();
+    */
+
+    // WaveStreamReader: 顺序读取 Wave 文件，不定位，可用于 stdin、管道、套接字(fdopen)
+    // 文件头按顺序逐块解析，fmt 之外的子块通过读取并丢弃跳过；支持 RIFF/RIFX/RF64
+    // data 子块大小为 0 或 0xFFFFFFFF(流式写入的约定)时读到流结束，否则只读取 data 子块，不会把其后的子块当作音频
+    // 错误信息输出到 stderr，不会混入 stdout 上的数据
+    class WaveStreamReader{
+    public:
+        WaveStreamReader();
+        ~WaveStreamReader();
+
+        // Open: 打开文件，"-" 为标准输入
+        bool Open(const std::string& waveFilePath);
+
+        // Attach: 使用已经打开的流，流的当前位置必须是 Wave 文件的开头
+        // * ownsFile : Close 时是否 fclose
+        bool Attach(FILE* fp, bool ownsFile = false);
+
+        // ReadWaveHeader: 读取到 data 子块头为止，RIFX 的头信息转换为本机字节序
+        // 流式写入的文件中 riff/data 的 size 字段保留原值，数据大小通过 GetDataSize 获取
+        bool ReadWaveHeader(WaveHeader& header);
+
+        // GetDataSize: data 子块的大小，RF64 时取 ds64 中的值，未知时返回 kWaveStreamUnknownSize
+        uint64_t GetDataSize() const { return m_dataSize; }
+
+        // GetBytesRead: 已读取的音频数据字节数
+        uint64_t GetBytesRead() const { return m_dataRead; }
+
+        // ReadBytes/ReadShorts: 读取音频数据，管道中数据不足时阻塞等待，返回实际读取到的个数，为 0 表示数据已结束
+        // RIFX 文件的采样转换为本机字节序，此时每次读取的长度应为 block_align 的整数倍
+        size_t ReadBytes(uint32_t bytes2Read, uint8_t* bytes);
+        size_t ReadBytes(uint32_t bytes2Read, std::vector<uint8_t>& bytes);
+        size_t ReadShorts(uint32_t shorts2Read, uint16_t* shorts);
+        size_t ReadShorts(uint32_t shorts2Read, std::vector<uint16_t>& shorts);
+
+        // ReadDuration: 读取指定时长(毫秒)的音频数据，仅支持 PCM/ALaw/ULaw 格式
+        size_t ReadDuration(uint32_t durationMs, std::vector<uint8_t>& data);
+        size_t ReadDuration(uint32_t durationMs, std::vector<uint16_t>& data);
+
+        // Close: 关闭文件，stdin 和 Attach 时 ownsFile 为 false 的流不会被关闭
+        void Close();
+    private:
+        // ReadExact: 读取 size 字节的文件头数据
+        bool ReadExact(void* buffer, size_t size);
+
+        // Discard: 读取并丢弃 size 字节，代替 fseek 跳过子块
+        bool Discard(uint64_t size);
+
+        // Limit: data 子块大小已知时，限制读取的长度不超过剩余的数据
+        uint32_t Limit(uint32_t bytes2Read) const;
+
+        FILE* m_fp = nullptr;
+        bool m_ownsFile = false;
+        bool m_headerRead = false;
+        bool m_swap = false;
+        WaveHeader m_header;
+        uint64_t m_dataSize = kWaveStreamUnknownSize;
+        uint64_t m_dataRead = 0;
+    };
+
+    // WaveStreamWriter: 顺序写 Wave 文件，不需要先预留再回填文件头，可用于 stdout、管道、套接字(fdopen)
+    // Open 时立即写出文件头，riff/data 的 size 字段为 0xFFFFFFFF、fact 的采样数为 0，表示长度未知(与 ffmpeg 写管道时的约定相同)，
+    // 读取方应读到流结束；Close 时如果输出是可以定位的普通文件(包括被重定向到文件的 stdout)，回填实际大小
+    // 格式支持与 WaveFileWriter 相同：WaveAudioFormatPCM/ALaw/MuLaw/G722/G721/GSM
+    class WaveStreamWriter{
+    public:
+        WaveStreamWriter();
+        ~WaveStreamWriter();
+
+        // Open: 打开文件并写出文件头，"-" 为标准输出
+        // * fixupSizes : Close 时输出可以定位的话是否回填实际大小；为 false 时始终保留流式大小，如文件在写入的同时被其它进程读取
+        bool Open(const std::string& waveFilePath, uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels,
+                  bool fixupSizes = true);
+
+        // Attach: 使用已经打开的流，从流的当前位置写出文件头
+        // * ownsFile : Close 时是否 fclose
+        bool Attach(FILE* fp, bool ownsFile, uint16_t audio_format, uint32_t sample_rate, uint16_t sample_bits, uint16_t channels,
+                    bool fixupSizes = true);
+
+        // Write: 写入音频数据，写失败(如管道的读端已关闭)后 HasError 返回 true
+        // 与 PCMStreamWriter 相同，调用者需要忽略 SIGPIPE，否则进程在写失败之前就被信号终止
+        void Write(const uint8_t* data, uint32_t len);
+        void Write(const uint16_t* data, uint32_t len);
+        void Write(const std::vector<uint8_t>& data);
+        void Write(const std::vector<uint8_t>& data, size_t len);
+        void Write(const std::vector<uint16_t>& data);
+        void Write(const std::vector<uint16_t>& data, size_t len);
+
+        // Flush: 将缓冲的数据写到流中，实时处理时每帧之后调用，降低下游的延迟
+        bool Flush();
+
+        // GetBytesWritten: 已写入的音频数据字节数，不包含文件头
+        uint64_t GetBytesWritten() const { return m_dataLen; }
+
+        bool HasError() const { return m_error; }
+
+        // Close: 回填大小(如果可以)，刷新并关闭文件，stdout 和 Attach 时 ownsFile 为 false 的流只刷新不关闭
+        // 数据超过 4GB 时无法用 32 位的 size 表示，保留流式大小
+        void Close();
+    private:
+        // FixupSizes: 回到文件头的位置，写入实际大小后回到末尾
+        void FixupSizes();
+
+        FILE* m_fp = nullptr;
+        bool m_ownsFile = false;
+        bool m_fixupSizes = true;
+        bool m_error = false;
+        long m_headerPos = -1;    // 文件头在流中的位置，不可定位时为 -1
+        WaveHeader m_header;
+        uint64_t m_dataLen = 0;
+    };
+}
+
+#endif //WAVE_STREAM_H_
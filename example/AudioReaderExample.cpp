@@ -0,0 +1,233 @@
+﻿#include "AudioReader/AudioFileReader.h"
+#include "AudioReader/AudioCompare.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+void print_usage(){
+    printf("AudioReaderExample <option> [params...] \n");
+    printf("e.g.\n");
+    printf("  # print the detected container and encoding of a wave/aiff file\n");
+    printf("  AudioReaderExample info in.wav\n");
+    printf("  # decode any supported wave/aiff file to raw 16bit pcm (s16) or float32 (f32)\n");
+    printf("  AudioReaderExample decode in.wav out.pcm s16\n");
+    printf("  # decode raw data, encoding: pcm|float|alaw|ulaw|g726|g722 (g726 sample_bits is the code size 2~5)\n");
+    printf("  AudioReaderExample decode_raw in.g711 alaw 8000 8 1 out.pcm s16\n");
+    printf("  # compare a processed file with the reference: snr, segmental snr, max error, bit-exactness\n");
+    printf("  # raw inputs are given as path@encoding,sample_rate,sample_bits,channels; a trailing max_delay_ms aligns the delay first\n");
+    printf("  AudioReaderExample compare ref.wav out.pcm@pcm,8000,16,1 [200]\n");
+    printf("  # compare many pairs in parallel, each line of list.txt is \"ref test\"\n");
+    printf("  AudioReaderExample compare_list list.txt [200]\n");
+}
+
+uint16_t parse_encoding(const std::string& name){
+    if(name == "pcm") return WaveAudioFormatPCM;
+    if(name == "float") return WaveAudioFormatIeeeFloat;
+    if(name == "alaw") return WaveAudioFormatALaw;
+    if(name == "ulaw") return WaveAudioFormatMuLaw;
+    if(name == "g726") return WaveAudioFormatG721;   // sample_bits 为码字位数 2~5
+    if(name == "g722") return WaveAudioFormatG722;
+    return WaveAudioFormatUnknown;
+}
+
+void print_info(const AudioReader::AudioStreamInfo& info){
+    static const char* containers[] = {"unknown", "raw", "wave", "aiff"};
+    printf("container:%s, encoding:%s, sample_rate:%d, sample_bits:%d, channels:%d, big_endian:%d, frames:%llu\n",
+           containers[info.container], AudioReader::GetEncodingName(info.encoding), info.sampleRate, info.bitsPerSample, info.channels,
+           info.bigEndian ? 1 : 0, (unsigned long long)info.totalFrames);
+}
+
+void info(int argc, char** argv){
+    if(argc < 3){
+        printf("invalid params\n");
+        return;
+    }
+
+    AudioReader::AudioFileReader reader;
+    if(reader.Open(argv[2])){
+        print_info(reader.GetInfo());
+    }
+}
+
+// 解码到文件，每次 20ms
+template <typename T>
+uint64_t decode_to_file(AudioReader::AudioFileReader& reader, FILE* fp){
+    std::vector<T> frames;
+    uint64_t total = 0;
+    size_t n;
+    while((n = reader.ReadDuration(20, frames)) > 0){
+        fwrite(frames.data(), sizeof(T), frames.size(), fp);
+        total += n;
+    }
+    return total;
+}
+
+void decode(AudioReader::AudioFileReader& reader, const std::string& dstPath, const std::string& format){
+    if(format != "s16" && format != "f32"){
+        printf("invalid output format: %s\n", format.c_str());
+        return;
+    }
+
+    FILE* fp = fopen(dstPath.c_str(), "wb");
+    if(!fp){
+        printf("open output file failed, %s\n", dstPath.c_str());
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t frames = (format == "s16") ? decode_to_file<uint16_t>(reader, fp) : decode_to_file<float>(reader, fp);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    fclose(fp);
+
+    print_info(reader.GetInfo());
+    printf("decode done, frames:%llu, format:%s, dst:%s, cost:%.2fms\n", (unsigned long long)frames, format.c_str(), dstPath.c_str(), ms);
+}
+
+// parse_input: 解析 compare 的输入，path@encoding,sample_rate,sample_bits,channels 为裸数据
+bool parse_input(const std::string& spec, AudioReader::AudioCompareInput& input){
+    input = AudioReader::AudioCompareInput();
+    size_t at = spec.rfind('@');
+    if(at == std::string::npos){
+        input.path = spec;
+        return true;
+    }
+
+    input.path = spec.substr(0, at);
+    std::string params = spec.substr(at + 1);
+    for(size_t i = 0; i < params.size(); i++){
+        if(params[i] == ',') params[i] = ' ';
+    }
+    std::istringstream iss(params);
+    std::string encoding;
+    if(!(iss >> encoding >> input.sampleRate >> input.bitsPerSample >> input.channels)){
+        printf("invalid input: %s\n", spec.c_str());
+        return false;
+    }
+    input.encoding = parse_encoding(encoding);
+    return input.encoding != WaveAudioFormatUnknown;
+}
+
+void print_compare_result(const std::string& refPath, const std::string& testPath, const AudioReader::AudioCompareResult& result){
+    if(!result.success){
+        printf("%s vs %s: compare failed\n", refPath.c_str(), testPath.c_str());
+        return;
+    }
+    printf("%s vs %s: bit_exact:%d, snr:%.2fdB, seg_snr:%.2fdB, max_err:%.6f(%.1f lsb16) at frame %llu, diff_samples:%llu, "
+           "frames:%llu(ref:%llu, test:%llu), delay:%lld\n",
+           refPath.c_str(), testPath.c_str(), result.bitExact ? 1 : 0, result.snr, result.segSnr, result.maxAbsError,
+           result.maxAbsError * 32768, (unsigned long long)result.maxErrorFrame, (unsigned long long)result.diffSamples,
+           (unsigned long long)result.frames, (unsigned long long)result.refFrames, (unsigned long long)result.testFrames,
+           (long long)result.delay);
+}
+
+void compare(int argc, char** argv){
+    AudioReader::AudioCompareInput ref, test;
+    if(argc < 4 || !parse_input(argv[2], ref) || !parse_input(argv[3], test)){
+        printf("invalid params\n");
+        return;
+    }
+
+    AudioReader::AudioCompareOptions options;
+    if(argc >= 5){
+        options.alignDelay = true;
+        options.maxDelayMs = std::stoi(argv[4]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    AudioReader::AudioCompareResult result;
+    AudioReader::CompareAudioFiles(ref, test, options, result);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    print_compare_result(ref.path, test.path, result);
+    printf("cost:%.2fms\n", ms);
+}
+
+void compare_list(int argc, char** argv){
+    if(argc < 3){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::ifstream list(argv[2]);
+    if(!list){
+        printf("open list file failed, %s\n", argv[2]);
+        return;
+    }
+
+    std::vector<AudioReader::AudioCompareJob> jobs;
+    std::string line;
+    while(std::getline(list, line)){
+        std::istringstream iss(line);
+        std::string refSpec, testSpec;
+        if(!(iss >> refSpec >> testSpec)) continue;
+
+        AudioReader::AudioCompareJob job;
+        if(parse_input(refSpec, job.ref) && parse_input(testSpec, job.test)){
+            jobs.push_back(job);
+        }
+    }
+
+    AudioReader::AudioCompareOptions options;
+    if(argc >= 4){
+        options.alignDelay = true;
+        options.maxDelayMs = std::stoi(argv[3]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t successCnt = AudioReader::BatchCompareAudioFiles(jobs, options);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t exactCnt = 0;
+    double minSnr = 0;
+    bool first = true;
+    for(size_t i = 0; i < jobs.size(); i++){
+        const AudioReader::AudioCompareResult& result = jobs[i].result;
+        print_compare_result(jobs[i].ref.path, jobs[i].test.path, result);
+        if(!result.success) continue;
+        if(result.bitExact) exactCnt++;
+        if(first || result.snr < minSnr) minSnr = result.snr;
+        first = false;
+    }
+    printf("compare done, success:%d, bit_exact:%d, total:%d, min_snr:%.2fdB, cost:%.2fms\n", (int)successCnt, (int)exactCnt,
+           (int)jobs.size(), minSnr, ms);
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2){
+        print_usage();
+        return 0;
+    }
+
+    std::string option = argv[1];
+    if(option == "info"){
+        info(argc, argv);
+    }else if(option == "decode"){
+        if(argc < 5){
+            printf("invalid params\n");
+            return 0;
+        }
+        AudioReader::AudioFileReader reader;
+        if(reader.Open(argv[2])){
+            decode(reader, argv[3], argv[4]);
+        }
+    }else if(option == "decode_raw"){
+        if(argc < 9){
+            printf("invalid params\n");
+            return 0;
+        }
+        AudioReader::AudioFileReader reader;
+        if(reader.OpenRaw(argv[2], parse_encoding(argv[3]), std::stoi(argv[4]), std::stoi(argv[5]), std::stoi(argv[6]))){
+            decode(reader, argv[7], argv[8]);
+        }
+    }else if(option == "compare"){
+        compare(argc, argv);
+    }else if(option == "compare_list"){
+        compare_list(argc, argv);
+    }else{
+        printf("invalid option\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,266 @@
+﻿#include "Pipeline/PipelineNodes.h"
+#include "WaveCodec/PlayoutScheduler.h"
+#include "AsyncIO/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// 单路流: 按 20ms 实时投递的帧 -> 分声道/重采样/G.711 编码 -> 写出
+// 每个阶段的实例和帧缓冲池都属于这一路流，回调只在一个调度线程中执行，不需要加锁
+struct StreamContext {
+    std::vector<std::unique_ptr<Pipeline::PipelineStage> > stages;
+    Pipeline::FramePool pool;
+    std::unique_ptr<WaveCodec::WaveFileWriter> writer; // 指定输出目录时写文件，否则写入内存环形缓冲区
+    std::vector<uint8_t> ring;
+    size_t ringPos = 0;
+
+    int64_t measureFromNs = 0;      // 预热结束的时刻，之前到期的帧不统计
+    std::vector<int64_t> latencyNs; // 每帧处理完成的时刻 - 应投递的时刻
+};
+
+// TrialResult: 一轮测试的结果
+struct TrialResult {
+    uint32_t streams = 0;
+    uint64_t frames = 0;     // 处理的帧数
+    uint64_t misses = 0;     // 超过截止时间的帧数，包括因落后而没来得及投递的帧
+    double   missPercent = 0;
+    double   p50Us = 0, p90Us = 0, p99Us = 0, p999Us = 0, maxUs = 0;
+    bool     passed = false;
+};
+
+static const uint32_t kFrameMs = 20;
+static const uint32_t kOutRate = 8000;
+
+static int64_t NowNs(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void print_usage(){
+    printf("ChannelLoadTest <in.wav> [seconds] [threads] [deadline_us] [max_miss_percent] [out_dir]\n");
+    printf("  simulate N concurrent streams, each reading paced %dms frames from in.wav (pcm 16bit or g711),\n", kFrameMs);
+    printf("  taking the first channel, resampling to %dHz, encoding to a-law and writing the result.\n", kOutRate);
+    printf("  N is doubled and then binary searched for the largest value whose frames finish within\n");
+    printf("  deadline_us after their scheduled time, with at most max_miss_percent misses.\n");
+    printf("  seconds: duration of each trial, default 5, the first 1/5 is warm-up and not measured\n");
+    printf("  threads: scheduler threads, 0 means cpu cores (default)\n");
+    printf("  deadline_us: default 2000; max_miss_percent: default 0.1\n");
+    printf("  out_dir: optional, write one a-law wave file per stream instead of an in-memory buffer\n");
+    printf("e.g.\n");
+    printf("  ChannelLoadTest prompt_16k_stereo.wav 5 4 2000 0.1\n");
+}
+
+// 根据输入格式建立处理环节，最终输出 8kHz 单声道 A-law
+bool build_stages(const Pipeline::AudioFormat& in, StreamContext& ctx){
+    if(in.audio_format == WaveAudioFormatALaw || in.audio_format == WaveAudioFormatMuLaw){
+        ctx.stages.push_back(std::unique_ptr<Pipeline::PipelineStage>(new Pipeline::G711DecodeStage()));
+    }
+    if(in.channels > 1){
+        ctx.stages.push_back(std::unique_ptr<Pipeline::PipelineStage>(new Pipeline::ChannelSelectStage(0)));
+    }
+    if(in.sample_rate != kOutRate){
+        ctx.stages.push_back(std::unique_ptr<Pipeline::PipelineStage>(new Pipeline::ResampleStage(kOutRate)));
+    }
+    ctx.stages.push_back(std::unique_ptr<Pipeline::PipelineStage>(new Pipeline::G711EncodeStage(WaveAudioFormatALaw)));
+
+    Pipeline::AudioFormat format = in;
+    for(size_t i = 0; i < ctx.stages.size(); i++){
+        Pipeline::AudioFormat out;
+        if(!ctx.stages[i]->Init(format, out)){
+            printf("stage %s does not support the input format\n", ctx.stages[i]->GetName());
+            return false;
+        }
+        format = out;
+    }
+    return true;
+}
+
+void process_frame(StreamContext& ctx, const WaveCodec::PlayoutFrame& playout){
+    Pipeline::AudioFrame* frame = ctx.pool.Acquire();
+    frame->sequence = playout.frame.frameIndex;
+    frame->data.assign(playout.frame.data, playout.frame.data + playout.frame.size);
+    for(size_t i = 0; i < ctx.stages.size() && frame; i++){
+        ctx.stages[i]->Process(frame, ctx.pool);
+    }
+
+    if(frame){
+        if(ctx.writer){
+            ctx.writer->Write(frame->data);
+        }else{
+            // 环形缓冲区，模拟写入 socket/jitter buffer
+            const uint8_t* data = frame->data.data();
+            size_t left = frame->data.size();
+            while(left > 0){
+                size_t n = std::min(left, ctx.ring.size() - ctx.ringPos);
+                memcpy(&ctx.ring[ctx.ringPos], data, n);
+                ctx.ringPos = (ctx.ringPos + n) % ctx.ring.size();
+                data += n;
+                left -= n;
+            }
+        }
+        ctx.pool.Release(frame);
+    }
+    if(playout.deadlineNs >= ctx.measureFromNs){
+        ctx.latencyNs.push_back(NowNs() - playout.deadlineNs);
+    }
+}
+
+double percentile_us(std::vector<int64_t>& values, double p){
+    if(values.empty()) return 0;
+    size_t k = std::min(values.size() - 1, (size_t)(p / 100 * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k] / 1000.0;
+}
+
+bool run_trial(const WaveCodec::SharedAudioSource& source, const Pipeline::AudioFormat& format, uint32_t streams, uint32_t seconds,
+               uint32_t threads, uint32_t deadlineUs, double maxMissPercent, const std::string& outDir, TrialResult& result){
+    std::vector<std::unique_ptr<StreamContext> > contexts;
+    WaveCodec::PlayoutScheduler scheduler(threads, deadlineUs);
+    const size_t framesPerStream = (size_t)seconds * 1000 / kFrameMs + 1;
+
+    for(uint32_t i = 0; i < streams; i++){
+        StreamContext* ctx = new StreamContext();
+        contexts.push_back(std::unique_ptr<StreamContext>(ctx));
+        if(!build_stages(format, *ctx)) return false;
+        ctx->latencyNs.reserve(framesPerStream);
+        if(outDir.empty()){
+            ctx->ring.resize(kOutRate); // 1 秒
+        }else{
+            ctx->writer.reset(new WaveCodec::WaveFileWriter());
+            std::string path = outDir + "/stream_" + std::to_string(i) + ".wav";
+            if(!ctx->writer->Open(path, WaveAudioFormatALaw, kOutRate, 8, 1)){
+                printf("open output file failed, %s\n", path.c_str());
+                return false;
+            }
+        }
+
+        // 各路流错开起始时间和起始位置，避免所有流在同一时刻到期
+        uint32_t startDelayMs = i % kFrameMs;
+        int id = scheduler.AddSharedSource(source, kFrameMs, i, i * 7, true, [ctx](const WaveCodec::PlayoutFrame& frame){
+            process_frame(*ctx, frame);
+        }, startDelayMs);
+        if(id < 0){
+            printf("add stream failed\n");
+            return false;
+        }
+    }
+
+    // 前 1/5 的时间为预热(首次分配内存、缺页等)，不统计
+    const int64_t warmupNs = (int64_t)seconds * 1000000000 / 5;
+    int64_t startNs = NowNs();
+    for(size_t i = 0; i < contexts.size(); i++){
+        contexts[i]->measureFromNs = startNs + warmupNs;
+    }
+    if(!scheduler.Start()) return false;
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    scheduler.Stop();
+    int64_t elapsedNs = NowNs() - startNs;
+
+    // 过载时调度线程落后，来不及投递的帧同样计为 miss
+    std::vector<int64_t> latencies;
+    latencies.reserve(framesPerStream * streams);
+    result = TrialResult();
+    result.streams = streams;
+    const int64_t deadlineNs = (int64_t)deadlineUs * 1000;
+    for(size_t i = 0; i < contexts.size(); i++){
+        StreamContext& ctx = *contexts[i];
+        for(size_t k = 0; k < ctx.latencyNs.size(); k++){
+            if(ctx.latencyNs[k] > deadlineNs) result.misses++;
+        }
+        int64_t expected = (elapsedNs - warmupNs) / ((int64_t)kFrameMs * 1000000) - 1; // 起始延迟和计时误差最多差 1 帧
+        if(expected > (int64_t)ctx.latencyNs.size()) result.misses += expected - ctx.latencyNs.size();
+
+        result.frames += ctx.latencyNs.size();
+        latencies.insert(latencies.end(), ctx.latencyNs.begin(), ctx.latencyNs.end());
+        if(ctx.writer) ctx.writer->Close();
+    }
+
+    uint64_t total = std::max<uint64_t>(result.frames, 1);
+    result.missPercent = 100.0 * result.misses / total;
+    result.p50Us = percentile_us(latencies, 50);
+    result.p90Us = percentile_us(latencies, 90);
+    result.p99Us = percentile_us(latencies, 99);
+    result.p999Us = percentile_us(latencies, 99.9);
+    result.maxUs = latencies.empty() ? 0 : *std::max_element(latencies.begin(), latencies.end()) / 1000.0;
+    result.passed = result.frames > 0 && result.missPercent <= maxMissPercent;
+    return true;
+}
+
+void print_result(const TrialResult& r){
+    printf("%8u %10llu %8.3f %9.1f %9.1f %9.1f %9.1f %10.1f  %s\n", r.streams, (unsigned long long)r.frames, r.missPercent,
+           r.p50Us, r.p90Us, r.p99Us, r.p999Us, r.maxUs, r.passed ? "pass" : "FAIL");
+    fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2){
+        print_usage();
+        return 0;
+    }
+
+    std::string srcPath(argv[1]);
+    uint32_t seconds = argc > 2 ? std::stoi(argv[2]) : 5;
+    uint32_t threads = argc > 3 ? std::stoi(argv[3]) : 0;
+    uint32_t deadlineUs = argc > 4 ? std::stoi(argv[4]) : 2000;
+    double maxMissPercent = argc > 5 ? std::stod(argv[5]) : 0.1;
+    std::string outDir = argc > 6 ? argv[6] : "";
+    if(threads == 0) threads = AsyncIO::ThreadPool::GetDefaultThreadCount();
+    if(seconds == 0) seconds = 1;
+
+    // 所有流共享一份预加载的音频数据，测试只反映处理能力，不受磁盘影响
+    WaveCodec::SharedAudioSource source;
+    if(!source.OpenWave(srcPath, true)){
+        printf("open wave file failed, %s\n", srcPath.c_str());
+        return 1;
+    }
+    Pipeline::AudioFormat format;
+    format.audio_format = source.GetAudioFormat();
+    format.sample_rate = source.GetSampleRate();
+    format.sample_bits = source.GetSampleBits();
+    format.channels = source.GetChannels();
+
+    StreamContext probe;
+    if(!build_stages(format, probe)) return 1;
+    printf("input: %s, rate:%d, bits:%d, channels:%d\n", WaveCodec::GetWaveAudioFormatString(format.audio_format).c_str(),
+           format.sample_rate, format.sample_bits, format.channels);
+    printf("chain:");
+    for(size_t i = 0; i < probe.stages.size(); i++) printf(" %s", probe.stages[i]->GetName());
+    printf(", frame:%dms, threads:%d, trial:%ds, deadline:%dus, max miss:%.3f%%\n\n", kFrameMs, threads, seconds, deadlineUs, maxMissPercent);
+    printf("%8s %10s %8s %9s %9s %9s %9s %10s\n", "streams", "frames", "miss%", "p50(us)", "p90(us)", "p99(us)", "p99.9(us)", "max(us)");
+
+    // 先按倍数增加流数直到失败，再在最后一次通过和失败之间二分，精度为 5%
+    const uint32_t kMaxStreams = 1 << 20;
+    TrialResult best, r;
+    uint32_t lo = 0, hi = 0;
+    for(uint32_t n = threads * 8; n <= kMaxStreams; n *= 2){
+        if(!run_trial(source, format, n, seconds, threads, deadlineUs, maxMissPercent, outDir, r)) return 1;
+        print_result(r);
+        if(!r.passed){
+            hi = n;
+            break;
+        }
+        lo = n;
+        best = r;
+    }
+    while(hi > 0 && hi - lo > std::max<uint32_t>(1, lo / 20)){
+        uint32_t mid = lo + (hi - lo) / 2;
+        if(!run_trial(source, format, mid, seconds, threads, deadlineUs, maxMissPercent, outDir, r)) return 1;
+        print_result(r);
+        if(r.passed){
+            lo = mid;
+            best = r;
+        }else{
+            hi = mid;
+        }
+    }
+
+    printf("\n");
+    if(lo == 0){
+        printf("no stream count meets the deadline, even %d stream(s) missed %.3f%% of frames\n", r.streams, r.missPercent);
+        return 0;
+    }
+    printf("max streams: %d (%.1f per thread/core), p50:%.1fus, p99:%.1fus, p99.9:%.1fus, max:%.1fus\n", lo, (double)lo / threads,
+           best.p50Us, best.p99Us, best.p999Us, best.maxUs);
+    return 0;
+}
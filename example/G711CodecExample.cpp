@@ -0,0 +1,174 @@
+﻿#include "G711Codec/G711File.h"
+#include "G711Codec/G722Codec.h"
+#include "G711Codec/G726Codec.h"
+#include "G711Codec/GSMCodec.h"
+#include "AsyncIO/ThreadPool.h"
+
+#include <chrono>
+
+void print_usage(){
+    printf("G711CodecExample <option> [params...] \n");
+    printf("e.g.\n");
+    printf("  # encode 16bit pcm in.wav to a-law/mu-law out.wav (format: alaw|ulaw), threads: 0 means cpu cores\n");
+    printf("  G711CodecExample encode in.wav out.wav alaw 0\n");
+    printf("  # decode g711 in.wav to 16bit pcm out.wav\n");
+    printf("  G711CodecExample decode in.wav out.wav 0\n");
+    printf("  # encode/decode raw data files, channels is used to split the input at frame boundaries\n");
+    printf("  G711CodecExample encode_raw in.pcm out.g711 alaw 1 0\n");
+    printf("  G711CodecExample decode_raw in.g711 out.pcm alaw 1 0\n");
+    printf("  # encode 16kHz 16bit pcm in.wav to g722 out.wav, decode g722 in.wav to 16bit pcm out.wav (mode: 1=64k|2=56k|3=48k)\n");
+    printf("  G711CodecExample g722_encode in.wav out.wav 1\n");
+    printf("  G711CodecExample g722_decode in.wav out.wav 1\n");
+    printf("  # encode 16bit pcm in.wav to g726 out.wav (kbps: 16|24|32|40), decode g726 in.wav to 16bit pcm out.wav\n");
+    printf("  G711CodecExample g726_encode in.wav out.wav 32\n");
+    printf("  G711CodecExample g726_decode in.wav out.wav\n");
+    printf("  # encode 8kHz 16bit mono pcm in.wav to gsm 6.10 (wav49) out.wav\n");
+    printf("  G711CodecExample gsm_encode in.wav out.wav\n");
+    printf("  # decode gsm 6.10 (wav49) wave files to 16bit pcm, several files are decoded in parallel, threads: 0 means cpu cores\n");
+    printf("  G711CodecExample gsm_decode 0 in1.wav out1.wav [in2.wav out2.wav ...]\n");
+}
+
+bool parse_format(const std::string& name, uint16_t& audio_format){
+    if(name == "alaw"){
+        audio_format = WaveAudioFormatALaw;
+    }else if(name == "ulaw"){
+        audio_format = WaveAudioFormatMuLaw;
+    }else{
+        printf("invalid format: %s\n", name.c_str());
+        return false;
+    }
+    return true;
+}
+
+void transcode(int argc, char** argv){
+    std::string option = argv[1];
+    bool encode = (option == "encode" || option == "encode_raw");
+    bool raw = (option == "encode_raw" || option == "decode_raw");
+
+    int minArgc = raw ? 7 : (encode ? 6 : 5);
+    if(argc < minArgc){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    std::string dstPath(argv[3]);
+    uint16_t audio_format = WaveAudioFormatUnknown;
+    if((encode || raw) && !parse_format(argv[4], audio_format)){
+        return;
+    }
+    uint16_t channels = raw ? std::stoi(argv[5]) : 0;
+    uint32_t threadCnt = std::stoi(argv[minArgc - 1]);
+
+    AsyncIO::ThreadPool pool(threadCnt);
+    auto start = std::chrono::steady_clock::now();
+
+    bool ret = false;
+    if(raw){
+        ret = encode ? G711Codec::G711EncodePCMFile(srcPath, dstPath, audio_format, channels, &pool)
+                     : G711Codec::G711DecodePCMFile(srcPath, dstPath, audio_format, channels, &pool);
+    }else{
+        ret = encode ? G711Codec::G711EncodeWaveFile(srcPath, dstPath, audio_format, &pool)
+                     : G711Codec::G711DecodeWaveFile(srcPath, dstPath, &pool);
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%s %s, src:%s, dst:%s, threads:%d, cost:%.2fms\n", option.c_str(), ret ? "success" : "failed",
+           srcPath.c_str(), dstPath.c_str(), pool.GetThreadCount(), ms);
+}
+
+void g722_transcode(int argc, char** argv){
+    if(argc < 5){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string option = argv[1];
+    std::string srcPath(argv[2]);
+    std::string dstPath(argv[3]);
+    int mode = std::stoi(argv[4]);
+    if(mode < G711Codec::G722Mode64k || mode > G711Codec::G722Mode48k){
+        printf("invalid mode: %d\n", mode);
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = (option == "g722_encode") ? G711Codec::G722EncodeWaveFile(srcPath, dstPath, (G711Codec::G722Mode)mode)
+                                         : G711Codec::G722DecodeWaveFile(srcPath, dstPath, (G711Codec::G722Mode)mode);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%s %s, src:%s, dst:%s, mode:%d, cost:%.2fms\n", option.c_str(), ret ? "success" : "failed",
+           srcPath.c_str(), dstPath.c_str(), mode, ms);
+}
+
+void g726_transcode(int argc, char** argv){
+    std::string option = argv[1];
+    bool encode = (option == "g726_encode");
+    if(argc < (encode ? 5 : 4)){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    std::string dstPath(argv[3]);
+    int kbps = encode ? std::stoi(argv[4]) : 0;
+    if(encode && (kbps % 8 != 0 || kbps < 16 || kbps > 40)){
+        printf("invalid bitrate: %d\n", kbps);
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = encode ? G711Codec::G726EncodeWaveFile(srcPath, dstPath, (G711Codec::G726Rate)(kbps / 8))
+                      : G711Codec::G726DecodeWaveFile(srcPath, dstPath);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%s %s, src:%s, dst:%s, cost:%.2fms\n", option.c_str(), ret ? "success" : "failed", srcPath.c_str(), dstPath.c_str(), ms);
+}
+
+void gsm_transcode(int argc, char** argv){
+    std::string option = argv[1];
+    bool encode = (option == "gsm_encode");
+    if(argc < (encode ? 4 : 5) || (!encode && (argc - 3) % 2 != 0)){
+        printf("invalid params\n");
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if(encode){
+        bool ret = G711Codec::GSMEncodeWaveFile(argv[2], argv[3]);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printf("%s %s, src:%s, dst:%s, cost:%.2fms\n", option.c_str(), ret ? "success" : "failed", argv[2], argv[3], ms);
+        return;
+    }
+
+    std::vector<std::string> srcPaths, dstPaths;
+    for(int i = 3; i + 1 < argc; i += 2){
+        srcPaths.push_back(argv[i]);
+        dstPaths.push_back(argv[i + 1]);
+    }
+    AsyncIO::ThreadPool pool(std::stoi(argv[2]));
+    size_t succeeded = G711Codec::GSMDecodeWaveFiles(srcPaths, dstPaths, &pool);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%s %zu/%zu success, threads:%d, cost:%.2fms\n", option.c_str(), succeeded, srcPaths.size(), pool.GetThreadCount(), ms);
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2){
+        print_usage();
+        return 0;
+    }
+
+    std::string option = argv[1];
+    if(option == "encode" || option == "decode" || option == "encode_raw" || option == "decode_raw"){
+        transcode(argc, argv);
+    }else if(option == "g722_encode" || option == "g722_decode"){
+        g722_transcode(argc, argv);
+    }else if(option == "g726_encode" || option == "g726_decode"){
+        g726_transcode(argc, argv);
+    }else if(option == "gsm_encode" || option == "gsm_decode"){
+        gsm_transcode(argc, argv);
+    }else{
+        printf("invalid option\n");
+    }
+
+    return 0;
+}
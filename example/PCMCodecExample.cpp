@@ -5,6 +5,8 @@
 
 #include "PCMCodec/PCMFile.h"
 #include "PCMCodec/PCMCodec.h"
+#include "PCMCodec/PCMNormalize.h"
+#include "PCMCodec/PCMCrop.h"
 
 
 void print_usage(){
@@ -16,6 +18,12 @@ void print_usage(){
     printf("  # abstract the left and right channel of in.pcm, save to out_left.pcm and out_right.pcm\n");
     printf("  # in.pcm: channels must be 2, and sampleBits must be 16\n");
     printf("  PCMCodecExample abstract in.pcm out_left.pcm out_right.pcm\n");
+    printf("  # mix the left and right channel of in.pcm into mono out.pcm, in.pcm: channels must be 2, sampleBits must be 16\n");
+    printf("  PCMCodecExample mix in.pcm out.pcm\n");
+    printf("  # analyze peak/rms/loudness of 16bit in.pcm, the result is cached in in.pcm.loudness\n");
+    printf("  PCMCodecExample analyze in.pcm 8000 1\n");
+    printf("  # normalize 16bit in.pcm to -23 LUFS (mode: peak|rms|loudness)\n");
+    printf("  PCMCodecExample normalize in.pcm out.pcm 8000 1 loudness -23\n");
 }
 
 void doCopy(int argc, char** argv){
@@ -32,43 +40,104 @@ void doCopy(int argc, char** argv){
     uint32_t startMs = std::stoi(argv[7]);
     uint32_t endMs = std::stoi(argv[8]);
 
+    if(!PCMCodec::CropPCMFile(inPCMPath, outPCMPath, sampleRate, sampleBits, channels, startMs, endMs)){
+        printf("copy failed\n");
+        return;
+    }
+
+    printf("copy success\n");
+}
+
+void abstract(int argc, char** argv){
+    if(argc < 5){
+        printf("invalid param\n");
+        return;
+    }
+
+    std::string inPCMPath(argv[2]);
+    std::string leftPCMPath(argv[3]);
+    std::string rightPCMPath(argv[4]);
+
+    if(!PCMCodec::AbstractChannel2File(inPCMPath, leftPCMPath, rightPCMPath)){
+        printf("abstract failed\n");
+        return;
+    }
+    printf("abstract success\n");
+}
+
+void mix(int argc, char** argv){
+    if(argc < 4){
+        printf("invalid param\n");
+        return;
+    }
+
     PCMCodec::PCMFileReader reader;
-    if(!reader.Open(inPCMPath, sampleRate, sampleBits, channels)){
+    if(!reader.Open(argv[2])){
         return;
     }
 
     PCMCodec::PCMFileWriter writer;
-    if(!writer.Open(outPCMPath)){
+    if(!writer.Open(argv[3])){
         return;
     }
 
-    reader.SeekToTime(startMs);
-
-    std::vector<uint8_t> buffer;
-    reader.ReadDuration(endMs-startMs, buffer);
-    writer.Write(buffer);
+    std::vector<uint16_t> buffer;
+    std::vector<uint16_t> mixed;
+    while(reader.ReadShorts(2048, buffer) > 0){
+        PCMCodec::ChannelView16 left = PCMCodec::ChannelView16::FromInterleaved(buffer, 2, 0);
+        PCMCodec::ChannelView16 right = PCMCodec::ChannelView16::FromInterleaved(buffer, 2, 1);
+        PCMCodec::Mixing(left, right, mixed);
+        writer.Write(mixed);
+    }
 
     reader.Close();
     writer.Close();
-
-    printf("copy success\n");
+    printf("mix success\n");
 }
 
-void abstract(int argc, char** argv){
+void analyze(int argc, char** argv){
     if(argc < 5){
         printf("invalid param\n");
         return;
     }
 
     std::string inPCMPath(argv[2]);
-    std::string leftPCMPath(argv[3]);
-    std::string rightPCMPath(argv[4]);
+    uint32_t sampleRate = std::stoi(argv[3]);
+    uint16_t channels = std::stoi(argv[4]);
 
-    if(!PCMCodec::AbstractChannel2File(inPCMPath, leftPCMPath, rightPCMPath)){
-        printf("abstract failed\n");
+    PCMCodec::LoudnessAnalysis analysis;
+    if(!PCMCodec::AnalyzePCMFile(inPCMPath, sampleRate, channels, analysis)){
+        printf("analyze failed\n");
         return;
     }
-    printf("abstract success\n");
+    printf("peak:%.2fdBFS, rms:%.2fdBFS, loudness:%.2fLUFS\n", analysis.GetPeakDb(), analysis.GetRMSDb(), analysis.loudness);
+}
+
+void normalize(int argc, char** argv){
+    if(argc < 8){
+        printf("invalid param\n");
+        return;
+    }
+
+    std::string inPCMPath(argv[2]);
+    std::string outPCMPath(argv[3]);
+    uint32_t sampleRate = std::stoi(argv[4]);
+    uint16_t channels = std::stoi(argv[5]);
+    std::string mode(argv[6]);
+    double targetDb = std::stod(argv[7]);
+
+    PCMCodec::NormalizeMode normalizeMode = PCMCodec::NormalizeLoudness;
+    if(mode == "peak"){
+        normalizeMode = PCMCodec::NormalizePeak;
+    }else if(mode == "rms"){
+        normalizeMode = PCMCodec::NormalizeRMS;
+    }
+
+    if(!PCMCodec::NormalizePCMFile(inPCMPath, outPCMPath, sampleRate, channels, normalizeMode, targetDb)){
+        printf("normalize failed\n");
+        return;
+    }
+    printf("normalize success\n");
 }
 
 int main(int argc, char** argv)
@@ -83,6 +152,12 @@ int main(int argc, char** argv)
         doCopy(argc, argv);
     }else if(option == "abstract"){
         abstract(argc, argv);
+    }else if(option == "mix"){
+        mix(argc, argv);
+    }else if(option == "analyze"){
+        analyze(argc, argv);
+    }else if(option == "normalize"){
+        normalize(argc, argv);
     }else{
         printf("invalid option\n");
     }
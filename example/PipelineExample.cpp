@@ -0,0 +1,176 @@
+﻿#include "Pipeline/PipelineNodes.h"
+#include "Pipeline/StreamBatch.h"
+#include "G711Codec/G711Codec.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+void print_usage(){
+    printf("PipelineExample <option> [params...] \n");
+    printf("e.g.\n");
+    printf("  # convert in.wav through stages to out.wav (or out.pcm), stages run in order\n");
+    printf("  # stages: left | right | mix | gain:<value> | resample:<rate> | alaw | ulaw | decode\n");
+    printf("  # a stage prefixed with @ starts a new thread, a single @ at the end runs the writer on a new thread\n");
+    printf("  PipelineExample convert in.wav out.wav left @resample:8000 alaw\n");
+    printf("  # same as convert, but read a raw pcm file with the given sample rate, sample bits and channels\n");
+    printf("  PipelineExample convert_raw in.pcm 16000 16 2 out.wav mix gain:0.5 @\n");
+    printf("  # process 4000 A-law streams in conferences of 3 with StreamBatch for 500 ticks(20ms), print the cost per tick\n");
+    printf("  PipelineExample batch 4000 3 500\n");
+}
+
+bool ends_with(const std::string& str, const std::string& suffix){
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool add_stage(Pipeline::Pipeline& pipeline, std::string name){
+    bool newThread = false;
+    if(!name.empty() && name[0] == '@'){
+        newThread = true;
+        name = name.substr(1);
+    }
+
+    Pipeline::PipelineStage* stage = nullptr;
+    if(name == "left"){
+        stage = new Pipeline::ChannelSelectStage(0);
+    }else if(name == "right"){
+        stage = new Pipeline::ChannelSelectStage(1);
+    }else if(name == "mix"){
+        stage = new Pipeline::MixStage();
+    }else if(name.compare(0, 5, "gain:") == 0){
+        stage = new Pipeline::GainStage(std::stod(name.substr(5)));
+    }else if(name.compare(0, 9, "resample:") == 0){
+        stage = new Pipeline::ResampleStage(std::stoi(name.substr(9)));
+    }else if(name == "alaw"){
+        stage = new Pipeline::G711EncodeStage(WaveAudioFormatALaw);
+    }else if(name == "ulaw"){
+        stage = new Pipeline::G711EncodeStage(WaveAudioFormatMuLaw);
+    }else if(name == "decode"){
+        stage = new Pipeline::G711DecodeStage();
+    }else{
+        printf("invalid stage: %s\n", name.c_str());
+        return false;
+    }
+
+    pipeline.AddStage(std::unique_ptr<Pipeline::PipelineStage>(stage), newThread);
+    return true;
+}
+
+void convert(int argc, char** argv){
+    std::string option = argv[1];
+    bool raw = (option == "convert_raw");
+    int firstStage = raw ? 7 : 4;
+    if(argc < firstStage){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    std::string dstPath(argv[firstStage - 1]);
+
+    Pipeline::Pipeline pipeline;
+    if(raw){
+        Pipeline::AudioFormat format;
+        format.sample_rate = std::stoi(argv[3]);
+        format.sample_bits = std::stoi(argv[4]);
+        format.channels = std::stoi(argv[5]);
+        pipeline.SetSource(std::unique_ptr<Pipeline::PipelineSource>(new Pipeline::PCMFileSource(srcPath, format)));
+    }else{
+        pipeline.SetSource(std::unique_ptr<Pipeline::PipelineSource>(new Pipeline::WaveFileSource(srcPath)));
+    }
+
+    bool sinkNewThread = false;
+    for(int i = firstStage; i < argc; i++){
+        std::string name = argv[i];
+        if(name == "@" && i == argc - 1){
+            sinkNewThread = true;
+        }else if(!add_stage(pipeline, name)){
+            return;
+        }
+    }
+
+    Pipeline::PipelineSink* sink = nullptr;
+    if(ends_with(dstPath, ".pcm")){
+        sink = new Pipeline::PCMFileSink(dstPath);
+    }else{
+        sink = new Pipeline::WaveFileSink(dstPath);
+    }
+    pipeline.SetSink(std::unique_ptr<Pipeline::PipelineSink>(sink), sinkNewThread);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = pipeline.Run();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const Pipeline::AudioFormat& out = pipeline.GetOutputFormat();
+    printf("%s %s, src:%s, dst:%s, output: %s %dHz %dbit %dch, frames:%llu, allocated frames:%zu, cost:%.2fms\n",
+           option.c_str(), ret ? "success" : "failed", srcPath.c_str(), dstPath.c_str(),
+           WaveCodec::GetWaveAudioFormatString(out.audio_format).c_str(), out.sample_rate, out.sample_bits, out.channels,
+           (unsigned long long)pipeline.GetFrameCount(), pipeline.GetAllocatedFrames(), ms);
+}
+
+void batch(int argc, char** argv){
+    if(argc < 3){
+        printf("invalid params\n");
+        return;
+    }
+    uint32_t streams = (uint32_t)std::stoul(argv[2]);
+    uint32_t groupSize = argc > 3 ? (uint32_t)std::stoul(argv[3]) : 3;
+    uint32_t ticks = argc > 4 ? (uint32_t)std::stoul(argv[4]) : 500;
+    if(groupSize == 0) groupSize = 1;
+
+    Pipeline::StreamBatch batch(streams);
+    if(!batch.IsValid()) return;
+    for(uint32_t i = 0; i < streams; i++){
+        batch.SetCodec(i, WaveAudioFormatALaw, WaveAudioFormatALaw);
+        batch.SetMixGroup(i, groupSize > 1 ? (int32_t)(i / groupSize) : -1);
+        batch.SetGain(i, 0.5f + (i % 4) * 0.25f);
+        batch.SetEnabled(i, true);
+    }
+
+    // 每路输入一个不同频率的正弦波
+    const uint32_t n = batch.GetFrameSamples();
+    std::vector<std::vector<uint8_t>> frames(streams, std::vector<uint8_t>(n));
+    for(uint32_t i = 0; i < streams; i++){
+        std::vector<uint16_t> pcm(n);
+        for(uint32_t k = 0; k < n; k++){
+            pcm[k] = (uint16_t)(int16_t)(8000 * sin(2 * 3.14159265358979 * (200 + i % 1000) * k / 8000.0));
+        }
+        G711Codec::ALawEncode(pcm.data(), n, frames[i].data());
+    }
+
+    double total = 0, worst = 0;
+    for(uint32_t t = 0; t < ticks; t++){
+        auto start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < streams; i++){
+            memcpy(batch.GetInput(i), frames[i].data(), n);
+        }
+        batch.Process();
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        total += us;
+        worst = std::max(worst, us);
+    }
+
+    double avg = total / ticks;
+    printf("batch: %u streams, group size %u, %u ticks, avg %.0f us/tick (%.1f%% of 20ms), max %.0f us, %.0f ns/stream\n",
+           streams, groupSize, ticks, avg, avg / 200.0, worst, avg * 1000 / streams);
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2){
+        print_usage();
+        return 0;
+    }
+
+    std::string option = argv[1];
+    if(option == "convert" || option == "convert_raw"){
+        convert(argc, argv);
+    }else if(option == "batch"){
+        batch(argc, argv);
+    }else{
+        printf("invalid option\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+﻿#include "Spectrum/SpectrumFeature.h"
+#include "Spectrum/ToneDetector.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+void print_usage(){
+    printf("SpectrumExample <option> [params...] \n");
+    printf("e.g.\n");
+    printf("  # extract log-mel features of 16bit in.wav to out.f32 (float32 rows), fft size 512, hop 160, 40 mel bands\n");
+    printf("  SpectrumExample mel in.wav out.f32 512 160 40\n");
+    printf("  # extract log power spectrogram (fft size/2 + 1 bins per row)\n");
+    printf("  SpectrumExample spectrogram in.wav out.f32 512 256\n");
+    printf("  # same for raw 16bit pcm files, with sample rate and channels\n");
+    printf("  SpectrumExample mel_raw in.pcm 16000 1 out.f32 512 160 40\n");
+    printf("  # detect dtmf digits and extra single tones (Hz) in 16bit in.wav, each channel is a stream\n");
+    printf("  SpectrumExample tones in.wav 450 350 440\n");
+    printf("  SpectrumExample tones_raw in.pcm 8000 1 450\n");
+    printf("  # detect dtmf on 4000 synthetic 8kHz streams for 10 seconds of audio, report the cost\n");
+    printf("  SpectrumExample tones_bench 4000 10\n");
+}
+
+void extract(int argc, char** argv){
+    std::string option = argv[1];
+    bool mel = (option == "mel" || option == "mel_raw");
+    bool raw = (option == "mel_raw" || option == "spectrogram_raw");
+
+    int first = raw ? 4 : 2; // 输出文件的参数位置 - 1
+    int minArgc = first + (mel ? 5 : 4);
+    if(argc < minArgc){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    std::string dstPath(argv[first + 1]);
+    Spectrum::FeatureConfig config;
+    config.fftSize = std::stoi(argv[first + 2]);
+    config.hopSize = std::stoi(argv[first + 3]);
+    config.melBands = mel ? std::stoi(argv[first + 4]) : 0;
+
+    std::vector<float> features;
+    uint32_t rowSize = 0;
+    auto start = std::chrono::steady_clock::now();
+    bool ret = raw ? Spectrum::ExtractPCMFileFeatures(srcPath, std::stoi(argv[3]), std::stoi(argv[4]), config, features, rowSize)
+                   : Spectrum::ExtractWaveFileFeatures(srcPath, config, features, rowSize);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if(!ret){
+        printf("%s failed, src:%s\n", option.c_str(), srcPath.c_str());
+        return;
+    }
+
+    FILE* fp = fopen(dstPath.c_str(), "wb");
+    if(!fp){
+        printf("open file failed, %s\n", dstPath.c_str());
+        return;
+    }
+    if(!features.empty()) fwrite(features.data(), sizeof(float), features.size(), fp);
+    fclose(fp);
+
+    printf("%s success, src:%s, dst:%s, frames:%zu, row size:%d, cost:%.2fms\n", option.c_str(), srcPath.c_str(), dstPath.c_str(),
+           rowSize ? features.size() / rowSize : 0, rowSize, ms);
+}
+
+void tones(int argc, char** argv){
+    std::string option = argv[1];
+    bool raw = (option == "tones_raw");
+    int first = raw ? 5 : 3; // 第一个单音频率的参数位置
+    if(argc < first){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    std::vector<float> freqs;
+    for(int i = first; i < argc; i++) freqs.push_back(std::stof(argv[i]));
+
+    std::vector<Spectrum::ToneEvent> events;
+    auto start = std::chrono::steady_clock::now();
+    bool ret = raw ? Spectrum::DetectPCMFileTones(srcPath, std::stoi(argv[3]), std::stoi(argv[4]), freqs, events)
+                   : Spectrum::DetectWaveFileTones(srcPath, freqs, events);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if(!ret){
+        printf("%s failed, src:%s\n", option.c_str(), srcPath.c_str());
+        return;
+    }
+
+    for(size_t i = 0; i < events.size(); i++){
+        const Spectrum::ToneEvent& event = events[i];
+        if(event.digit){
+            printf("  [%u] sample %llu: digit %c %s\n", event.stream, (unsigned long long)event.position, event.digit, event.on ? "on" : "off");
+        }else{
+            printf("  [%u] sample %llu: tone %.0fHz %s\n", event.stream, (unsigned long long)event.position, freqs[event.tone], event.on ? "on" : "off");
+        }
+    }
+    printf("%s success, src:%s, events:%zu, cost:%.2fms\n", option.c_str(), srcPath.c_str(), events.size(), ms);
+}
+
+void tones_bench(int argc, char** argv){
+    if(argc < 4){
+        printf("invalid params\n");
+        return;
+    }
+
+    const uint32_t streams = std::stoi(argv[2]);
+    const uint32_t seconds = std::stoi(argv[3]);
+    const uint32_t frameSamples = 160;
+    Spectrum::ToneDetector detector(streams);
+    if(!detector.IsValid()) return;
+    for(uint32_t i = 0; i < streams; i++) detector.SetEnabled(i, true);
+
+    // 每路 1 秒的信号循环使用: 按键 "0123456789" 各 50ms，间隔 50ms
+    static const float rows[4] = {697, 770, 852, 941};
+    static const float cols[4] = {1209, 1336, 1477, 1633};
+    static const int keys[10] = {13, 0, 1, 2, 4, 5, 6, 8, 9, 10}; // "0123456789" 在 4x4 键盘中的位置
+    std::vector<uint16_t> signal(8000);
+    for(uint32_t i = 0; i < signal.size(); i++){
+        int key = keys[i / 800];
+        float v = (i % 800 < 400) ? 6000 * (sinf(6.2831853f * rows[key / 4] * i / 8000) + sinf(6.2831853f * cols[key % 4] * i / 8000)) : 0;
+        signal[i] = (uint16_t)(int16_t)v;
+    }
+
+    std::vector<const uint16_t*> frames(streams);
+    uint64_t digits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t tick = 0; tick < seconds * 50; tick++){
+        for(uint32_t i = 0; i < streams; i++){
+            frames[i] = &signal[((tick + i) % 50) * frameSamples]; // 各路错开
+        }
+        detector.Process(frames.data(), frameSamples);
+        for(size_t i = 0; i < detector.GetEvents().size(); i++){
+            if(detector.GetEvents()[i].on) digits++;
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double samples = (double)streams * seconds * 8000;
+    printf("tones_bench done, streams:%u, seconds:%u, digits:%llu(expected about %llu), cost:%.2fms, %.2fns/sample, %.0f realtime streams per core\n",
+           streams, seconds, (unsigned long long)digits, (unsigned long long)streams * seconds * 10, ms, ms * 1e6 / samples,
+           streams * seconds * 1000.0 / ms);
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2){
+        print_usage();
+        return 0;
+    }
+
+    std::string option = argv[1];
+    if(option == "mel" || option == "spectrogram" || option == "mel_raw" || option == "spectrogram_raw"){
+        extract(argc, argv);
+    }else if(option == "tones" || option == "tones_raw"){
+        tones(argc, argv);
+    }else if(option == "tones_bench"){
+        tones_bench(argc, argv);
+    }else{
+        printf("invalid option\n");
+    }
+
+    return 0;
+}
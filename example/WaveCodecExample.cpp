@@ -1,10 +1,76 @@
 ﻿#include "WaveCodec/WaveFile.h"
+#include "WaveCodec/WaveBatch.h"
+#include "WaveCodec/WaveCatalog.h"
+#include "WaveCodec/FramePacketizer.h"
+#include "WaveCodec/AiffFile.h"
+#include "WaveCodec/WaveChunks.h"
+#include "WaveCodec/WaveEdit.h"
+#include "WaveCodec/WaveRequantize.h"
+#include "WaveCodec/PlayoutScheduler.h"
+#include "WaveCodec/LosslessArchive.h"
+#include "WaveCodec/WaveStream.h"
+#include "PCMCodec/PCMStream.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
 
 void print_usage(){
     printf("WaveCodecExample <option> [params...] \n");
     printf("e.g.\n");
     printf("  WaveCodecExample decode in.wav out.pcm\n");
     printf("  WaveCodecExample encode in.pcm out.wav 8000 16 1\n");
+    printf("  # decode/encode many files at once, outputs are saved to out_dir\n");
+    printf("  WaveCodecExample batch_decode out_dir in1.wav in2.wav ...\n");
+    printf("  WaveCodecExample batch_encode out_dir 8000 16 1 in1.pcm in2.pcm ...\n");
+    printf("  # batch_decode/batch_encode/batch_requantize accept a trailing cache option, duplicated inputs are not converted again\n");
+    printf("  WaveCodecExample batch_decode out_dir in1.wav in2.wav ... -cache cache_dir 1024(max MB)\n");
+    printf("  # build a header catalog of all wave files under root_dir, then query it\n");
+    printf("  WaveCodecExample catalog_build root_dir catalog.wcat\n");
+    printf("  WaveCodecExample catalog_query catalog.wcat in.wav\n");
+    printf("  # packetize in.wav into 20ms frames for 1000 streams sharing one copy, 500 frames per stream\n");
+    printf("  WaveCodecExample packetize in.wav 20 1000 500\n");
+    printf("  # aiff/aifc <-> pcm, decode also accepts big-endian RIFX wave files\n");
+    printf("  WaveCodecExample aiff2pcm in.aiff out.pcm\n");
+    printf("  WaveCodecExample pcm2aiff in.pcm out.aiff 44100 16 2\n");
+    printf("  # list all chunks of in.wav, optionally save the payload of one chunk (e.g. bext) to out.bin\n");
+    printf("  WaveCodecExample chunks in.wav [bext out.bin]\n");
+    printf("  # concatenate wave files of the same format into out.wav, data is copied inside the kernel\n");
+    printf("  WaveCodecExample concat out.wav in1.wav in2.wav ...\n");
+    printf("  # crop in.wav from startMs to endMs into out.wav\n");
+    printf("  WaveCodecExample crop in.wav out.wav 1000 3000\n");
+    printf("  # reduce in.wav (24/32bit pcm or float) to 16bit, dither: none|tpdf|shaped\n");
+    printf("  WaveCodecExample requantize in.wav out.wav 16 shaped\n");
+    printf("  WaveCodecExample batch_requantize out_dir 16 shaped in1.wav in2.wav ...\n");
+    printf("  # play wave files in real time with 2 scheduler threads and 20ms frames, report deadline misses\n");
+    printf("  WaveCodecExample playout 2 20 in1.wav in2.wav ...\n");
+    printf("  # play in.wav as 500 looping streams sharing one copy for 10000ms with 2 scheduler threads\n");
+    printf("  WaveCodecExample playout_loop in.wav 20 500 10000 2\n");
+    printf("  # lossless archive (.pla), blocks are compressed/decompressed in parallel, decode restores the original file byte by byte\n");
+    printf("  WaveCodecExample lossless_encode in.wav out.pla\n");
+    printf("  WaveCodecExample lossless_encode_pcm in.pcm 44100 16 2 out.pla\n");
+    printf("  WaveCodecExample lossless_decode in.pla out.wav\n");
+    printf("  # decode/encode without seeking, \"-\" is stdin/stdout, e.g. cat in.wav | WaveCodecExample stream_decode - - | ...\n");
+    printf("  # stream_encode writes streaming sizes (0xFFFFFFFF) to pipes, the real sizes are patched when the output is a regular file\n");
+    printf("  WaveCodecExample stream_decode in.wav|- out.pcm|-\n");
+    printf("  WaveCodecExample stream_encode in.pcm|- out.wav|- 8000 16 1\n");
+}
+
+// 转换结果缓存，由命令行末尾的 -cache cache_dir max_mb 指定
+std::unique_ptr<WaveCodec::ConversionCache> g_cache;
+
+void print_cache_stats(){
+    if(!g_cache) return;
+    printf("cache hits:%llu, misses:%llu, entries:%d, bytes:%llu\n", (unsigned long long)g_cache->GetHitCount(),
+           (unsigned long long)g_cache->GetMissCount(), (int)g_cache->GetEntryCount(), (unsigned long long)g_cache->GetTotalBytes());
+}
+
+// out_dir/in_file_name.ext
+std::string make_out_path(const std::string& outDir, const std::string& inPath, const std::string& ext){
+    std::string name = inPath.substr(inPath.find_last_of("/\\") + 1);
+    name = name.substr(0, name.find_last_of('.')) + ext;
+    return outDir + "/" + name;
 }
 
 void decode(int argc, char** argv){
@@ -44,6 +110,510 @@ void encode(int argc, char** argv){
     }
 }
 
+void batch_decode(int argc, char** argv){
+    if(argc < 4){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string outDir(argv[2]);
+    std::vector<WaveCodec::BatchConvertJob> jobs;
+    for(int i = 3; i < argc; i++){
+        WaveCodec::BatchConvertJob job;
+        job.srcPath = argv[i];
+        job.dstPath = make_out_path(outDir, job.srcPath, ".pcm");
+        jobs.push_back(job);
+    }
+
+    size_t successCnt = WaveCodec::BatchWave2PCMFile(jobs, nullptr, g_cache.get());
+    printf("BatchWave2PCMFile done, success:%d, total:%d\n", (int)successCnt, (int)jobs.size());
+    print_cache_stats();
+}
+
+void batch_encode(int argc, char** argv){
+    if(argc < 7){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string outDir(argv[2]);
+    uint32_t sampleRate = std::stoi(argv[3]);
+    uint16_t sampleBits = std::stoi(argv[4]);
+    uint16_t channels = std::stoi(argv[5]);
+
+    std::vector<WaveCodec::BatchConvertJob> jobs;
+    for(int i = 6; i < argc; i++){
+        WaveCodec::BatchConvertJob job;
+        job.srcPath = argv[i];
+        job.dstPath = make_out_path(outDir, job.srcPath, ".wav");
+        job.sample_rate = sampleRate;
+        job.sample_bits = sampleBits;
+        job.channels = channels;
+        jobs.push_back(job);
+    }
+
+    size_t successCnt = WaveCodec::BatchPCM2WaveFile(jobs, nullptr, g_cache.get());
+    printf("BatchPCM2WaveFile done, success:%d, total:%d\n", (int)successCnt, (int)jobs.size());
+    print_cache_stats();
+}
+
+void catalog_build(int argc, char** argv){
+    if(argc < 4){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string rootDir(argv[2]);
+    std::string indexPath(argv[3]);
+    int64_t cnt = WaveCodec::WaveCatalog::Build(rootDir, indexPath);
+    if(cnt >= 0){
+        printf("WaveCatalog::Build success, files:%lld, indexPath:%s\n", (long long)cnt, indexPath.c_str());
+    }else{
+        printf("WaveCatalog::Build failed, rootDir:%s, indexPath:%s\n", rootDir.c_str(), indexPath.c_str());
+    }
+}
+
+void catalog_query(int argc, char** argv){
+    if(argc < 4){
+        printf("invalid params\n");
+        return;
+    }
+
+    WaveCodec::WaveCatalog catalog;
+    if(!catalog.Open(argv[2])){
+        printf("open catalog failed, %s\n", argv[2]);
+        return;
+    }
+
+    WaveCodec::WaveFileInfo info;
+    bool fromCatalog = false;
+    if(!catalog.Lookup(argv[3], info, &fromCatalog)){
+        printf("lookup failed, %s\n", argv[3]);
+        return;
+    }
+
+    const WaveCodec::SubChunkFmt& fmt = info.header.riff.fmt;
+    printf("%s: audio_format:%d(%s), sample_rate:%d, sample_bits:%d, channels:%d, data_offset:%u, data_size:%u, duration:%llums, from_catalog:%d\n",
+           argv[3], fmt.audio_format, WaveCodec::GetWaveAudioFormatString(fmt.audio_format).c_str(), fmt.sample_rate, fmt.bits_per_sample,
+           fmt.channels, info.dataOffset, info.dataSize, (unsigned long long)info.GetDurationMs(), fromCatalog);
+}
+
+void packetize(int argc, char** argv){
+    if(argc < 6){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string wavPath(argv[2]);
+    uint32_t frameMs = std::stoi(argv[3]);
+    uint32_t streamCnt = std::stoi(argv[4]);
+    uint32_t frameCnt = std::stoi(argv[5]);
+
+    WaveCodec::SharedAudioSource source;
+    if(!source.OpenWave(wavPath)){
+        printf("open wave file failed, %s\n", wavPath.c_str());
+        return;
+    }
+
+    std::vector<WaveCodec::FramePacketizer> streams;
+    for(uint32_t i = 0; i < streamCnt; i++){
+        streams.push_back(WaveCodec::FramePacketizer(source, frameMs, i, i * 7));
+        if(!streams.back().IsValid()){
+            printf("invalid frame duration: %dms\n", frameMs);
+            return;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t bytes = 0;
+    uint32_t checksum = 0;
+    WaveCodec::MediaFrame frame;
+    for(uint32_t n = 0; n < frameCnt; n++){
+        for(uint32_t i = 0; i < streamCnt; i++){
+            if(!streams[i].NextFrame(frame)) continue;
+            bytes += frame.size;
+            checksum += frame.data[0] + frame.sequence;
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("packetize done, streams:%d, frames:%llu, bytes:%llu, checksum:%u, cost:%.2fms\n", streamCnt,
+           (unsigned long long)streamCnt * frameCnt, (unsigned long long)bytes, checksum, ms);
+}
+
+void aiff2pcm(int argc, char** argv){
+    if(argc < 4){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string aiffPath(argv[2]);
+    std::string pcmPath(argv[3]);
+    uint32_t sampleRate = 0;
+    uint16_t sampleBits = 0;
+    uint16_t channels = 0;
+
+    if(WaveCodec::AIFF2PCMFile(aiffPath, pcmPath, sampleRate, sampleBits, channels)){
+        printf("AIFF2PCMFile success, aiffPath:%s, pcmPath:%s, sampleRate:%d, sampleBits:%d, channels:%d\n",
+               aiffPath.c_str(), pcmPath.c_str(), sampleRate, sampleBits, channels);
+    }else{
+        printf("AIFF2PCMFile failed, aiffPath:%s, pcmPath:%s\n", aiffPath.c_str(), pcmPath.c_str());
+    }
+}
+
+void pcm2aiff(int argc, char** argv){
+    if(argc < 7){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string pcmPath(argv[2]);
+    std::string aiffPath(argv[3]);
+    uint32_t sampleRate = std::stoi(argv[4]);
+    uint16_t sampleBits = std::stoi(argv[5]);
+    uint16_t channels = std::stoi(argv[6]);
+
+    if(WaveCodec::PCM2AIFFFile(pcmPath, sampleRate, sampleBits, channels, aiffPath)){
+        printf("PCM2AIFFFile success, pcmPath:%s, aiffPath:%s, sampleRate:%d, sampleBits:%d, channels:%d\n",
+               pcmPath.c_str(), aiffPath.c_str(), sampleRate, sampleBits, channels);
+    }else{
+        printf("PCM2AIFFFile failed, pcmPath:%s, aiffPath:%s\n", pcmPath.c_str(), aiffPath.c_str());
+    }
+}
+
+void chunks(int argc, char** argv){
+    if(argc < 3){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string wavPath(argv[2]);
+    WaveCodec::RiffChunkDirectory dir;
+    if(!dir.Open(wavPath)){
+        printf("open wave file failed, %s\n", wavPath.c_str());
+        return;
+    }
+
+    printf("%s: file_size:%llu, big_endian:%d, chunks:%d\n", wavPath.c_str(), (unsigned long long)dir.GetFileSize(),
+           dir.IsBigEndian(), (int)dir.GetChunkCount());
+    for(size_t i = 0; i < dir.GetChunkCount(); i++){
+        const WaveCodec::RiffChunk& chunk = dir.GetChunk(i);
+        printf("  [%d] %s offset:%llu size:%llu\n", (int)i, chunk.GetName().c_str(),
+               (unsigned long long)chunk.offset, (unsigned long long)chunk.size);
+    }
+
+    if(argc < 5) return;
+
+    int index = dir.FindChunk(argv[3]);
+    const std::vector<uint8_t>* payload = dir.LoadChunk(index);
+    if(!payload){
+        printf("chunk not found, %s\n", argv[3]);
+        return;
+    }
+
+    FILE* fp = fopen(argv[4], "wb");
+    if(!fp){
+        printf("open file failed, %s\n", argv[4]);
+        return;
+    }
+    if(!payload->empty()){
+        fwrite(&(*payload)[0], sizeof(uint8_t), payload->size(), fp);
+    }
+    fclose(fp);
+    printf("chunk %s saved to %s, size:%d\n", argv[3], argv[4], (int)payload->size());
+}
+
+void concat(int argc, char** argv){
+    if(argc < 4){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string dstPath(argv[2]);
+    std::vector<std::string> srcPaths;
+    for(int i = 3; i < argc; i++){
+        srcPaths.push_back(argv[i]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = WaveCodec::ConcatWaveFiles(srcPaths, dstPath);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("ConcatWaveFiles %s, files:%d, dst:%s, cost:%.2fms\n", ret ? "success" : "failed", (int)srcPaths.size(), dstPath.c_str(), ms);
+}
+
+void crop(int argc, char** argv){
+    if(argc < 6){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    std::string dstPath(argv[3]);
+    uint32_t startMs = std::stoi(argv[4]);
+    uint32_t endMs = std::stoi(argv[5]);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = WaveCodec::CropWaveFile(srcPath, dstPath, startMs, endMs);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("CropWaveFile %s, src:%s, dst:%s, range:[%d, %d)ms, cost:%.2fms\n", ret ? "success" : "failed", srcPath.c_str(), dstPath.c_str(),
+           startMs, endMs, ms);
+}
+
+bool parse_dither_mode(const std::string& name, PCMCodec::DitherMode& mode){
+    if(name == "none") mode = PCMCodec::DitherNone;
+    else if(name == "tpdf") mode = PCMCodec::DitherTPDF;
+    else if(name == "shaped") mode = PCMCodec::DitherShaped;
+    else return false;
+    return true;
+}
+
+void requantize(int argc, char** argv){
+    PCMCodec::DitherMode mode;
+    if(argc < 6 || !parse_dither_mode(argv[5], mode)){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    std::string dstPath(argv[3]);
+    uint16_t targetBits = std::stoi(argv[4]);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = WaveCodec::RequantizeWaveFile(srcPath, dstPath, targetBits, mode);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("RequantizeWaveFile %s, src:%s, dst:%s, bits:%d, cost:%.2fms\n", ret ? "success" : "failed", srcPath.c_str(), dstPath.c_str(),
+           targetBits, ms);
+}
+
+void batch_requantize(int argc, char** argv){
+    PCMCodec::DitherMode mode;
+    if(argc < 6 || !parse_dither_mode(argv[4], mode)){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string outDir(argv[2]);
+    uint16_t targetBits = std::stoi(argv[3]);
+    std::vector<WaveCodec::BatchConvertJob> jobs;
+    for(int i = 5; i < argc; i++){
+        WaveCodec::BatchConvertJob job;
+        job.srcPath = argv[i];
+        job.dstPath = make_out_path(outDir, job.srcPath, ".wav");
+        jobs.push_back(job);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t successCnt = WaveCodec::BatchRequantizeWaveFiles(jobs, targetBits, mode, nullptr, g_cache.get());
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("BatchRequantizeWaveFiles done, success:%d, total:%d, cost:%.2fms\n", (int)successCnt, (int)jobs.size(), ms);
+    print_cache_stats();
+}
+
+void print_playout_stats(const WaveCodec::PlayoutScheduler& scheduler, uint64_t bytes, double ms){
+    WaveCodec::PlayoutStats stats;
+    scheduler.GetTotalStats(stats);
+    printf("playout done, streams:%d, frames:%llu, bytes:%llu, misses:%llu, late mean:%.1fus max:%.1fus, cost:%.2fms\n",
+           (int)scheduler.GetStreamCount(), (unsigned long long)stats.frames, (unsigned long long)bytes,
+           (unsigned long long)stats.deadlineMisses, stats.meanLateUs, stats.maxLateUs, ms);
+}
+
+void playout(int argc, char** argv){
+    if(argc < 5){
+        printf("invalid params\n");
+        return;
+    }
+
+    uint32_t threadCnt = std::stoi(argv[2]);
+    uint32_t frameMs = std::stoi(argv[3]);
+
+    std::atomic<uint64_t> bytes(0);
+    WaveCodec::PlayoutScheduler scheduler(threadCnt);
+    for(int i = 4; i < argc; i++){
+        // 各路流的起始时间在一帧内错开
+        int id = scheduler.AddWaveFile(argv[i], frameMs, [&bytes](const WaveCodec::PlayoutFrame& frame){
+            bytes += frame.frame.size;
+        }, (uint32_t)(i - 4) % frameMs);
+        if(id < 0){
+            printf("add stream failed, %s\n", argv[i]);
+            return;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.Start();
+    scheduler.Wait();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    print_playout_stats(scheduler, bytes, ms);
+}
+
+void playout_loop(int argc, char** argv){
+    if(argc < 7){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string wavPath(argv[2]);
+    uint32_t frameMs = std::stoi(argv[3]);
+    uint32_t streamCnt = std::stoi(argv[4]);
+    uint32_t durationMs = std::stoi(argv[5]);
+    uint32_t threadCnt = std::stoi(argv[6]);
+
+    WaveCodec::SharedAudioSource source;
+    if(!source.OpenWave(wavPath)){
+        printf("open wave file failed, %s\n", wavPath.c_str());
+        return;
+    }
+
+    std::atomic<uint64_t> bytes(0);
+    WaveCodec::PlayoutScheduler scheduler(threadCnt);
+    for(uint32_t i = 0; i < streamCnt; i++){
+        int id = scheduler.AddSharedSource(source, frameMs, i, i * 7, true, [&bytes](const WaveCodec::PlayoutFrame& frame){
+            bytes += frame.frame.size;
+        }, i % frameMs);
+        if(id < 0) return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+    scheduler.Stop();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    print_playout_stats(scheduler, bytes, ms);
+}
+
+void lossless_encode(int argc, char** argv){
+    if(argc < 4){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    std::string dstPath(argv[3]);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = WaveCodec::LosslessEncodeWaveFile(srcPath, dstPath);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("LosslessEncodeWaveFile %s, src:%s, dst:%s, cost:%.2fms\n", ret ? "success" : "failed", srcPath.c_str(), dstPath.c_str(), ms);
+}
+
+void lossless_encode_pcm(int argc, char** argv){
+    if(argc < 7){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    uint32_t sampleRate = std::stoi(argv[3]);
+    uint16_t sampleBits = std::stoi(argv[4]);
+    uint16_t channels = std::stoi(argv[5]);
+    std::string dstPath(argv[6]);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = WaveCodec::LosslessEncodePCMFile(srcPath, dstPath, sampleRate, sampleBits, channels);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("LosslessEncodePCMFile %s, src:%s, dst:%s, cost:%.2fms\n", ret ? "success" : "failed", srcPath.c_str(), dstPath.c_str(), ms);
+}
+
+void lossless_decode(int argc, char** argv){
+    if(argc < 4){
+        printf("invalid params\n");
+        return;
+    }
+
+    std::string srcPath(argv[2]);
+    std::string dstPath(argv[3]);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = WaveCodec::LosslessDecodeFile(srcPath, dstPath);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("LosslessDecodeFile %s, src:%s, dst:%s, cost:%.2fms\n", ret ? "success" : "failed", srcPath.c_str(), dstPath.c_str(), ms);
+}
+
+// 下游提前退出(如 | head)时不被 SIGPIPE 终止，由 writer.HasError() 报告写失败
+void ignore_sigpipe(){
+#ifndef WIN32
+    signal(SIGPIPE, SIG_IGN);
+#endif
+}
+
+// 输出可能是 stdout，stream_decode/stream_encode 的信息输出到 stderr
+void stream_decode(int argc, char** argv){
+    if(argc < 4){
+        fprintf(stderr, "invalid params\n");
+        return;
+    }
+    ignore_sigpipe();
+
+    std::string wavPath(argv[2]);
+    std::string pcmPath(argv[3]);
+
+    auto start = std::chrono::steady_clock::now();
+    WaveCodec::WaveStreamReader reader;
+    WaveCodec::WaveHeader header;
+    if(!reader.Open(wavPath) || !reader.ReadWaveHeader(header)){
+        fprintf(stderr, "open wave stream failed, wavPath:%s\n", wavPath.c_str());
+        return;
+    }
+    PCMCodec::PCMStreamWriter writer;
+    if(!writer.Open(pcmPath)){
+        fprintf(stderr, "open pcm stream failed, pcmPath:%s\n", pcmPath.c_str());
+        return;
+    }
+
+    // 每次读取 block_align 的整数倍，RIFX 文件的采样才能正确转换字节序
+    uint32_t blockAlign = header.riff.fmt.block_align ? header.riff.fmt.block_align : 1;
+    std::vector<uint8_t> buffer;
+    while(reader.ReadBytes(64 * 1024 / blockAlign * blockAlign, buffer) > 0 && !writer.HasError()){
+        writer.Write(buffer);
+    }
+    writer.Close();
+    reader.Close();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "stream_decode %s, wavPath:%s, pcmPath:%s, %s, sample_rate:%u, sample_bits:%d, channels:%d, bytes:%llu, cost:%.2fms\n",
+            writer.HasError() ? "failed" : "success", wavPath.c_str(), pcmPath.c_str(),
+            WaveCodec::GetWaveAudioFormatString(header.riff.fmt.audio_format).c_str(), header.riff.fmt.sample_rate,
+            header.riff.fmt.bits_per_sample, header.riff.fmt.channels, (unsigned long long)reader.GetBytesRead(), ms);
+}
+
+void stream_encode(int argc, char** argv){
+    if(argc < 7){
+        fprintf(stderr, "invalid params\n");
+        return;
+    }
+    ignore_sigpipe();
+
+    std::string pcmPath(argv[2]);
+    std::string wavPath(argv[3]);
+    uint32_t sampleRate = std::stoi(argv[4]);
+    uint16_t sampleBits = std::stoi(argv[5]);
+    uint16_t channels = std::stoi(argv[6]);
+
+    auto start = std::chrono::steady_clock::now();
+    PCMCodec::PCMStreamReader reader;
+    if(!reader.Open(pcmPath)){
+        fprintf(stderr, "open pcm stream failed, pcmPath:%s\n", pcmPath.c_str());
+        return;
+    }
+    WaveCodec::WaveStreamWriter writer;
+    if(!writer.Open(wavPath, WaveAudioFormatPCM, sampleRate, sampleBits, channels)){
+        fprintf(stderr, "open wave stream failed, wavPath:%s\n", wavPath.c_str());
+        return;
+    }
+
+    std::vector<uint8_t> buffer;
+    while(reader.ReadBytes(64 * 1024, buffer) > 0 && !writer.HasError()){
+        writer.Write(buffer);
+    }
+    writer.Close();
+    reader.Close();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "stream_encode %s, pcmPath:%s, wavPath:%s, sampleRate:%d, sampleBits:%d, channels:%d, bytes:%llu, cost:%.2fms\n",
+            writer.HasError() ? "failed" : "success", pcmPath.c_str(), wavPath.c_str(), sampleRate, sampleBits, channels,
+            (unsigned long long)writer.GetBytesWritten(), ms);
+}
+
 int main(int argc, char** argv)
 {
     if(argc < 2){
@@ -52,10 +622,52 @@ int main(int argc, char** argv)
     }
 
     std::string option = argv[1];
+    if(argc >= 5 && std::string(argv[argc - 3]) == "-cache"){
+        g_cache.reset(new WaveCodec::ConversionCache(argv[argc - 2], (uint64_t)std::stoi(argv[argc - 1]) << 20));
+        argc -= 3;
+    }
     if(option == "decode"){
         decode(argc, argv);
     }else if(option == "encode"){
         encode(argc, argv);
+    }else if(option == "batch_decode"){
+        batch_decode(argc, argv);
+    }else if(option == "batch_encode"){
+        batch_encode(argc, argv);
+    }else if(option == "catalog_build"){
+        catalog_build(argc, argv);
+    }else if(option == "catalog_query"){
+        catalog_query(argc, argv);
+    }else if(option == "packetize"){
+        packetize(argc, argv);
+    }else if(option == "aiff2pcm"){
+        aiff2pcm(argc, argv);
+    }else if(option == "pcm2aiff"){
+        pcm2aiff(argc, argv);
+    }else if(option == "chunks"){
+        chunks(argc, argv);
+    }else if(option == "concat"){
+        concat(argc, argv);
+    }else if(option == "crop"){
+        crop(argc, argv);
+    }else if(option == "requantize"){
+        requantize(argc, argv);
+    }else if(option == "batch_requantize"){
+        batch_requantize(argc, argv);
+    }else if(option == "playout"){
+        playout(argc, argv);
+    }else if(option == "playout_loop"){
+        playout_loop(argc, argv);
+    }else if(option == "lossless_encode"){
+        lossless_encode(argc, argv);
+    }else if(option == "lossless_encode_pcm"){
+        lossless_encode_pcm(argc, argv);
+    }else if(option == "lossless_decode"){
+        lossless_decode(argc, argv);
+    }else if(option == "stream_decode"){
+        stream_decode(argc, argv);
+    }else if(option == "stream_encode"){
+        stream_encode(argc, argv);
     }else{
         printf("invalid option\n");
     }